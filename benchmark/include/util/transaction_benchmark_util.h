@@ -1,5 +1,7 @@
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -136,7 +138,25 @@ class LargeTransactionBenchmarkObject {
    */
   const storage::BlockLayout &Layout() const { return layout_; }
 
+  /**
+   * @return average time in microseconds from a transaction asking to commit until its commit callback is invoked,
+   * which with logging enabled is when the commit is persistent, or 0 if no callback was invoked yet
+   */
+  double AverageCommitLatencyUs() const {
+    const uint64_t num_commits = num_commit_callbacks_.load();
+    if (num_commits == 0) return 0.0;
+    return static_cast<double>(total_commit_latency_ns_.load()) / static_cast<double>(num_commits) / 1000.0;
+  }
+
  private:
+  // Passed as the argument of the commit callback, to measure how long the commit took to become persistent
+  struct CommitLatencyArg {
+    LargeTransactionBenchmarkObject *test_object_;
+    std::chrono::high_resolution_clock::time_point commit_start_;
+  };
+
+  static void CommitLatencyCallback(void *arg);
+
   void SimulateOneTransaction(RandomWorkloadTransaction *txn, uint32_t txn_id);
 
   template <class Random>
@@ -152,6 +172,7 @@ class LargeTransactionBenchmarkObject {
   transaction::TransactionContext *initial_txn_;
   bool gc_on_;
   uint64_t abort_count_;
+  std::atomic<uint64_t> total_commit_latency_ns_{0}, num_commit_callbacks_{0};
 
   // tuple content is meaningless if bookkeeping is off.
   std::vector<storage::TupleSlot> inserted_tuples_;
@@ -148,8 +148,11 @@ BENCHMARK_DEFINE_F(TPCCBenchmark, ScaleFactor4WithoutLogging)(benchmark::State &
   }
 }
 
+// The benchmark argument selects the kind of log device (see LogDeviceType)
 // NOLINTNEXTLINE
 BENCHMARK_DEFINE_F(TPCCBenchmark, ScaleFactor4WithLogging)(benchmark::State &state) {
+  storage::LogManagerOptions log_options;
+  log_options.device_type_ = static_cast<storage::LogDeviceType>(state.range(0));
   // one TPCC worker = one TPCC terminal = one thread
   std::vector<Worker> workers;
   workers.reserve(num_threads_);
@@ -169,7 +172,7 @@ BENCHMARK_DEFINE_F(TPCCBenchmark, ScaleFactor4WithLogging)(benchmark::State &sta
   for (auto _ : state) {
     unlink(LOG_FILE_NAME);
     // we need transactions, TPCC database, and GC
-    log_manager_ = new storage::LogManager(LOG_FILE_NAME, &buffer_pool_);
+    log_manager_ = new storage::LogManager(LOG_FILE_NAME, &buffer_pool_, log_options);
     transaction::TransactionManager txn_manager(&buffer_pool_, true, log_manager_);
 
     // build the TPCC database
@@ -234,5 +237,9 @@ BENCHMARK_REGISTER_F(TPCCBenchmark, ScaleFactor4WithoutLogging)
 BENCHMARK_REGISTER_F(TPCCBenchmark, ScaleFactor4WithLogging)
     ->Unit(benchmark::kMillisecond)
     ->UseManualTime()
-    ->MinTime(10);
+    ->MinTime(10)
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::POSIX))
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::NULL_DEVICE))
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::MEMORY))
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::SIMULATED));
 }  // namespace terrier::tpcc
@@ -50,7 +50,7 @@ class GarbageCollectorBenchmark : public benchmark::Fixture {
 };
 
 // Create a table with 100,000 tuples, then run 100,000 txns running update statements. Then run GC and profile how long
-// the unlinking stage takes for those txns
+// the unlinking stage takes for those txns, when split across the given number of GC threads
 // NOLINTNEXTLINE
 BENCHMARK_DEFINE_F(GarbageCollectorBenchmark, UnlinkTime)(benchmark::State &state) {
   // NOLINTNEXTLINE
@@ -58,7 +58,7 @@ BENCHMARK_DEFINE_F(GarbageCollectorBenchmark, UnlinkTime)(benchmark::State &stat
     // generate our table and instantiate GC
     LargeTransactionBenchmarkObject tested({8, 8, 8}, initial_table_size, txn_length, update_select_ratio,
                                            &block_store_, &buffer_pool_, &generator_, true);
-    gc_ = new storage::GarbageCollector(tested.GetTxnManager());
+    gc_ = new storage::GarbageCollector(tested.GetTxnManager(), static_cast<uint32_t>(state.range(0)));
 
     // clean up insert txn
     gc_->PerformGarbageCollection();
@@ -89,7 +89,7 @@ BENCHMARK_DEFINE_F(GarbageCollectorBenchmark, UnlinkTime)(benchmark::State &stat
 }
 
 // Create a table with 100,000 tuples, then run 100,000 txns running update statements. Then run GC and profile how long
-// the deallocation stage takes for those txns
+// the deallocation stage takes for those txns, when split across the given number of GC threads
 // NOLINTNEXTLINE
 BENCHMARK_DEFINE_F(GarbageCollectorBenchmark, ReclaimTime)(benchmark::State &state) {
   // NOLINTNEXTLINE
@@ -97,7 +97,7 @@ BENCHMARK_DEFINE_F(GarbageCollectorBenchmark, ReclaimTime)(benchmark::State &sta
     // generate our table and instantiate GC
     LargeTransactionBenchmarkObject tested({8, 8, 8}, initial_table_size, txn_length, update_select_ratio,
                                            &block_store_, &buffer_pool_, &generator_, true);
-    gc_ = new storage::GarbageCollector(tested.GetTxnManager());
+    gc_ = new storage::GarbageCollector(tested.GetTxnManager(), static_cast<uint32_t>(state.range(0)));
 
     // clean up insert txn
     gc_->PerformGarbageCollection();
@@ -150,11 +150,22 @@ BENCHMARK_DEFINE_F(GarbageCollectorBenchmark, HighContention)(benchmark::State &
   state.SetItemsProcessed(state.iterations() * num_txns - lag_count);
 }
 
-BENCHMARK_REGISTER_F(GarbageCollectorBenchmark, UnlinkTime)->Unit(benchmark::kMillisecond)->UseManualTime()->MinTime(1);
+BENCHMARK_REGISTER_F(GarbageCollectorBenchmark, UnlinkTime)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(1)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8);
 BENCHMARK_REGISTER_F(GarbageCollectorBenchmark, ReclaimTime)
     ->Unit(benchmark::kMillisecond)
     ->UseManualTime()
-    ->MinTime(1);
+    ->MinTime(1)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8);
 BENCHMARK_REGISTER_F(GarbageCollectorBenchmark, HighContention)
     ->Unit(benchmark::kMillisecond)
     ->UseManualTime()
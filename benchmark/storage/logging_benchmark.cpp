@@ -1,9 +1,16 @@
+#include <sys/stat.h>
+#include <cstring>
 #include <vector>
 #include "benchmark/benchmark.h"
 #include "common/scoped_timer.h"
+#include "storage/garbage_collector.h"
 #include "storage/garbage_collector_thread.h"
 #include "storage/storage_defs.h"
 #include "storage/write_ahead_log/log_manager.h"
+#include "storage/write_ahead_log/log_reader.h"
+#include "storage/write_ahead_log/log_serializer.h"
+#include "util/catalog_test_util.h"
+#include "util/storage_test_util.h"
 #include "util/transaction_benchmark_util.h"
 
 #define LOG_FILE_NAME "/mnt/ramdisk/benchmark.txt"
@@ -12,16 +19,9 @@ namespace terrier {
 
 class LoggingBenchmark : public benchmark::Fixture {
  public:
-  void StartLogging() {
-    logging_ = true;
-    log_thread_ = std::thread([this] { LogThreadLoop(); });
-  }
+  void StartLogging() { log_manager_->Start(); }
 
-  void EndLogging() {
-    logging_ = false;
-    log_thread_.join();
-    log_manager_->Shutdown();
-  }
+  void EndLogging() { log_manager_->Shutdown(); }
 
   void TearDown(const benchmark::State &state) final { unlink(LOG_FILE_NAME); }
 
@@ -35,31 +35,23 @@ class LoggingBenchmark : public benchmark::Fixture {
   storage::LogManager *log_manager_ = nullptr;
   storage::GarbageCollectorThread *gc_thread_ = nullptr;
   const std::chrono::milliseconds gc_period_{10};
-
- private:
-  std::thread log_thread_;
-  volatile bool logging_ = false;
-  const std::chrono::milliseconds log_period_milli_{10};
-
-  void LogThreadLoop() {
-    while (logging_) {
-      std::this_thread::sleep_for(log_period_milli_);
-      log_manager_->Process();
-    }
-  }
 };
 
 /**
- * Run a TPCC-like workload (5 statements per txn, 10% insert, 40% update, 50% select).
+ * Run a TPCC-like workload (5 statements per txn, 10% insert, 40% update, 50% select), with the kind of log device
+ * given by the benchmark argument (see LogDeviceType).
  */
 // NOLINTNEXTLINE
 BENCHMARK_DEFINE_F(LoggingBenchmark, TPCCish)(benchmark::State &state) {
   uint64_t abort_count = 0;
+  double commit_latency_us = 0.0;
   const uint32_t txn_length = 5;
   const std::vector<double> insert_update_select_ratio = {0.1, 0.4, 0.5};
+  storage::LogManagerOptions options;
+  options.device_type_ = static_cast<storage::LogDeviceType>(state.range(0));
   // NOLINTNEXTLINE
   for (auto _ : state) {
-    log_manager_ = new storage::LogManager(LOG_FILE_NAME, &buffer_pool_);
+    log_manager_ = new storage::LogManager(LOG_FILE_NAME, &buffer_pool_, options);
     LargeTransactionBenchmarkObject tested(attr_sizes, initial_table_size, txn_length, insert_update_select_ratio,
                                            &block_store_, &buffer_pool_, &generator_, true, log_manager_);
     log_manager_->Process();  // log all of the Inserts from table creation
@@ -72,10 +64,12 @@ BENCHMARK_DEFINE_F(LoggingBenchmark, TPCCish)(benchmark::State &state) {
     }
     state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
     EndLogging();
+    commit_latency_us += tested.AverageCommitLatencyUs();
     delete gc_thread_;
     delete log_manager_;
   }
   state.SetItemsProcessed(state.iterations() * num_txns - abort_count);
+  state.counters["commit_latency_us"] = commit_latency_us / static_cast<double>(state.iterations());
 }
 
 /**
@@ -84,6 +78,7 @@ BENCHMARK_DEFINE_F(LoggingBenchmark, TPCCish)(benchmark::State &state) {
 // NOLINTNEXTLINE
 BENCHMARK_DEFINE_F(LoggingBenchmark, HighAbortRate)(benchmark::State &state) {
   uint64_t abort_count = 0;
+  double commit_latency_us = 0.0;
   const uint32_t txn_length = 40;
   const std::vector<double> insert_update_select_ratio = {0.0, 0.8, 0.2};
   // NOLINTNEXTLINE
@@ -102,10 +97,12 @@ BENCHMARK_DEFINE_F(LoggingBenchmark, HighAbortRate)(benchmark::State &state) {
     }
     state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
     EndLogging();
+    commit_latency_us += tested.AverageCommitLatencyUs();
     delete gc_thread_;
     delete log_manager_;
   }
   state.SetItemsProcessed(state.iterations() * num_txns - abort_count);
+  state.counters["commit_latency_us"] = commit_latency_us / static_cast<double>(state.iterations());
 }
 
 /**
@@ -114,6 +111,7 @@ BENCHMARK_DEFINE_F(LoggingBenchmark, HighAbortRate)(benchmark::State &state) {
 // NOLINTNEXTLINE
 BENCHMARK_DEFINE_F(LoggingBenchmark, SingleStatementInsert)(benchmark::State &state) {
   uint64_t abort_count = 0;
+  double commit_latency_us = 0.0;
   const uint32_t txn_length = 1;
   const std::vector<double> insert_update_select_ratio = {1, 0, 0};
   // NOLINTNEXTLINE
@@ -130,10 +128,12 @@ BENCHMARK_DEFINE_F(LoggingBenchmark, SingleStatementInsert)(benchmark::State &st
     }
     state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
     EndLogging();
+    commit_latency_us += tested.AverageCommitLatencyUs();
     delete gc_thread_;
     delete log_manager_;
   }
   state.SetItemsProcessed(state.iterations() * num_txns - abort_count);
+  state.counters["commit_latency_us"] = commit_latency_us / static_cast<double>(state.iterations());
 }
 
 /**
@@ -142,6 +142,7 @@ BENCHMARK_DEFINE_F(LoggingBenchmark, SingleStatementInsert)(benchmark::State &st
 // NOLINTNEXTLINE
 BENCHMARK_DEFINE_F(LoggingBenchmark, SingleStatementUpdate)(benchmark::State &state) {
   uint64_t abort_count = 0;
+  double commit_latency_us = 0.0;
   const uint32_t txn_length = 1;
   const std::vector<double> insert_update_select_ratio = {0, 1, 0};
   // NOLINTNEXTLINE
@@ -159,10 +160,12 @@ BENCHMARK_DEFINE_F(LoggingBenchmark, SingleStatementUpdate)(benchmark::State &st
     }
     state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
     EndLogging();
+    commit_latency_us += tested.AverageCommitLatencyUs();
     delete gc_thread_;
     delete log_manager_;
   }
   state.SetItemsProcessed(state.iterations() * num_txns - abort_count);
+  state.counters["commit_latency_us"] = commit_latency_us / static_cast<double>(state.iterations());
 }
 
 /**
@@ -171,6 +174,7 @@ BENCHMARK_DEFINE_F(LoggingBenchmark, SingleStatementUpdate)(benchmark::State &st
 // NOLINTNEXTLINE
 BENCHMARK_DEFINE_F(LoggingBenchmark, SingleStatementSelect)(benchmark::State &state) {
   uint64_t abort_count = 0;
+  double commit_latency_us = 0.0;
   const uint32_t txn_length = 1;
   const std::vector<double> insert_update_select_ratio = {0, 0, 1};
   // NOLINTNEXTLINE
@@ -188,13 +192,283 @@ BENCHMARK_DEFINE_F(LoggingBenchmark, SingleStatementSelect)(benchmark::State &st
     }
     state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
     EndLogging();
+    commit_latency_us += tested.AverageCommitLatencyUs();
+    delete gc_thread_;
+    delete log_manager_;
+  }
+  state.SetItemsProcessed(state.iterations() * num_txns - abort_count);
+  state.counters["commit_latency_us"] = commit_latency_us / static_cast<double>(state.iterations());
+}
+
+/**
+ * Single statement update throughput and commit latency, with the group commit window given by the benchmark argument
+ * in microseconds. Larger windows make every fsync persist more commits, at the cost of higher commit latency.
+ */
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(LoggingBenchmark, GroupCommit)(benchmark::State &state) {
+  uint64_t abort_count = 0;
+  double commit_latency_us = 0.0;
+  const uint32_t txn_length = 1;
+  const std::vector<double> insert_update_select_ratio = {0, 1, 0};
+  storage::LogManagerOptions options;
+  options.flush_interval_ = std::chrono::microseconds{state.range(0)};
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    log_manager_ = new storage::LogManager(LOG_FILE_NAME, &buffer_pool_, options);
+    LargeTransactionBenchmarkObject tested(attr_sizes, initial_table_size, txn_length, insert_update_select_ratio,
+                                           &block_store_, &buffer_pool_, &generator_, true, log_manager_);
+    log_manager_->Process();  // log all of the Inserts from table creation
+    gc_thread_ = new storage::GarbageCollectorThread(tested.GetTxnManager(), gc_period_);
+    StartLogging();
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer timer(&elapsed_ms);
+      abort_count += tested.SimulateOltp(num_txns, num_concurrent_txns_);
+      EndLogging();  // commits are only done once they are persistent
+    }
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    commit_latency_us += tested.AverageCommitLatencyUs();
+    delete gc_thread_;
+    delete log_manager_;
+  }
+  state.SetItemsProcessed(state.iterations() * num_txns - abort_count);
+  state.counters["commit_latency_us"] = commit_latency_us / static_cast<double>(state.iterations());
+}
+
+/**
+ * Single statement update throughput and commit latency, with the number of log streams given by the benchmark
+ * argument. Every stream is serialized by its own thread to its own file.
+ */
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(LoggingBenchmark, MultiStream)(benchmark::State &state) {
+  uint64_t abort_count = 0;
+  double commit_latency_us = 0.0;
+  const uint32_t txn_length = 1;
+  const std::vector<double> insert_update_select_ratio = {0, 1, 0};
+  storage::LogManagerOptions options;
+  options.num_streams_ = static_cast<uint32_t>(state.range(0));
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    log_manager_ = new storage::LogManager(LOG_FILE_NAME, &buffer_pool_, options);
+    LargeTransactionBenchmarkObject tested(attr_sizes, initial_table_size, txn_length, insert_update_select_ratio,
+                                           &block_store_, &buffer_pool_, &generator_, true, log_manager_);
+    log_manager_->Process();  // log all of the Inserts from table creation
+    gc_thread_ = new storage::GarbageCollectorThread(tested.GetTxnManager(), gc_period_);
+    StartLogging();
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer timer(&elapsed_ms);
+      abort_count += tested.SimulateOltp(num_txns, num_concurrent_txns_);
+      EndLogging();  // commits are only done once they are persistent
+    }
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    commit_latency_us += tested.AverageCommitLatencyUs();
+    delete gc_thread_;
+    delete log_manager_;
+    for (uint32_t i = 0; i < options.num_streams_; i++)
+      unlink(storage::LogManager::StreamFilePath(LOG_FILE_NAME, i, options.num_streams_).c_str());
+  }
+  state.SetItemsProcessed(state.iterations() * num_txns - abort_count);
+  state.counters["commit_latency_us"] = commit_latency_us / static_cast<double>(state.iterations());
+}
+
+/**
+ * Single statement update throughput and commit latency, with the kind of log device given by the benchmark argument
+ * (0 for posix, 1 for direct, 2 for io_uring, 3 for null, 4 for memory, 5 for simulated). Comparing against the null
+ * device separates the cost of producing the log from the cost of the device.
+ */
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(LoggingBenchmark, LogDevice)(benchmark::State &state) {
+  uint64_t abort_count = 0;
+  double commit_latency_us = 0.0;
+  const uint32_t txn_length = 1;
+  const std::vector<double> insert_update_select_ratio = {0, 1, 0};
+  storage::LogManagerOptions options;
+  options.device_type_ = static_cast<storage::LogDeviceType>(state.range(0));
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    log_manager_ = new storage::LogManager(LOG_FILE_NAME, &buffer_pool_, options);
+    LargeTransactionBenchmarkObject tested(attr_sizes, initial_table_size, txn_length, insert_update_select_ratio,
+                                           &block_store_, &buffer_pool_, &generator_, true, log_manager_);
+    log_manager_->Process();  // log all of the Inserts from table creation
+    gc_thread_ = new storage::GarbageCollectorThread(tested.GetTxnManager(), gc_period_);
+    StartLogging();
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer timer(&elapsed_ms);
+      abort_count += tested.SimulateOltp(num_txns, num_concurrent_txns_);
+      EndLogging();  // commits are only done once they are persistent
+    }
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    commit_latency_us += tested.AverageCommitLatencyUs();
+    delete gc_thread_;
+    delete log_manager_;
+    unlink(LOG_FILE_NAME);
+  }
+  state.SetItemsProcessed(state.iterations() * num_txns - abort_count);
+  state.counters["commit_latency_us"] = commit_latency_us / static_cast<double>(state.iterations());
+}
+
+/**
+ * Run the TPCCish workload with the log compressed (1) or not (0), as given by the benchmark argument, reporting the
+ * bytes written to the log per transaction along with the throughput lost to compression.
+ */
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(LoggingBenchmark, Compression)(benchmark::State &state) {
+  uint64_t abort_count = 0;
+  double commit_latency_us = 0.0, log_bytes = 0.0;
+  const uint32_t txn_length = 5;
+  const std::vector<double> insert_update_select_ratio = {0.1, 0.4, 0.5};
+  storage::LogManagerOptions options;
+  options.compress_ = state.range(0) != 0;
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    unlink(LOG_FILE_NAME);
+    log_manager_ = new storage::LogManager(LOG_FILE_NAME, &buffer_pool_, options);
+    LargeTransactionBenchmarkObject tested(attr_sizes, initial_table_size, txn_length, insert_update_select_ratio,
+                                           &block_store_, &buffer_pool_, &generator_, true, log_manager_);
+    log_manager_->Process();  // log all of the Inserts from table creation
+    struct stat file_stat;
+    stat(LOG_FILE_NAME, &file_stat);
+    const off_t initial_log_size = file_stat.st_size;
+    gc_thread_ = new storage::GarbageCollectorThread(tested.GetTxnManager(), gc_period_);
+    StartLogging();
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer timer(&elapsed_ms);
+      abort_count += tested.SimulateOltp(num_txns, num_concurrent_txns_);
+    }
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    EndLogging();
+    stat(LOG_FILE_NAME, &file_stat);
+    log_bytes += static_cast<double>(file_stat.st_size - initial_log_size);
+    commit_latency_us += tested.AverageCommitLatencyUs();
     delete gc_thread_;
     delete log_manager_;
   }
   state.SetItemsProcessed(state.iterations() * num_txns - abort_count);
+  state.counters["commit_latency_us"] = commit_latency_us / static_cast<double>(state.iterations());
+  state.counters["log_bytes_per_txn"] = log_bytes / static_cast<double>(state.iterations() * num_txns);
+}
+
+/**
+ * Serialization throughput of redo records inserting into a table, comparing the LogSerializer against dumping the
+ * records from memory as they are, which was the log format before varlen values were serialized. The first benchmark
+ * argument selects a table of fixed-size columns (0) or one that also has varlen columns (1), the second one selects
+ * the raw dump (0) or the LogSerializer (1).
+ */
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(LoggingBenchmark, Serialization)(benchmark::State &state) {
+  const uint32_t num_records = 100000;
+  std::vector<uint8_t> layout_attr_sizes = attr_sizes;
+  if (state.range(0) != 0) layout_attr_sizes[1] = layout_attr_sizes[2] = VARLEN_COLUMN;
+  const bool serialize = state.range(1) != 0;
+  const storage::BlockLayout layout(layout_attr_sizes);
+  const storage::ProjectedRowInitializer initializer =
+      storage::ProjectedRowInitializer::Create(layout, StorageTestUtil::ProjectionListAllColumns(layout));
+
+  // The serializer needs the records to be in a table to know their layout
+  transaction::TransactionManager txn_manager(&buffer_pool_, true, LOGGING_DISABLED);
+  storage::GarbageCollector gc(&txn_manager);
+  auto *table = new storage::DataTable(&block_store_, layout, storage::layout_version_t(0));
+  auto *txn = txn_manager.BeginTransaction();
+  std::vector<storage::LogRecord *> records;
+  uint64_t out_size = 0;
+  for (uint32_t i = 0; i < num_records; i++) {
+    byte *buf = common::AllocationUtil::AllocateAligned(storage::RedoRecord::Size(initializer));
+    storage::LogRecord *record = storage::RedoRecord::Initialize(buf, txn->StartTime(), CatalogTestUtil::test_db_oid,
+                                                                 CatalogTestUtil::test_table_oid, initializer);
+    auto *redo = record->GetUnderlyingRecordBodyAs<storage::RedoRecord>();
+    StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.0, &generator_);
+    redo->SetTupleSlot(table->Insert(txn, *redo->Delta()));
+    records.push_back(record);
+    out_size += serialize ? storage::LogSerializer::SerializedSize(*record) : record->Size();
+  }
+  std::vector<byte> out(out_size);
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer timer(&elapsed_ms);
+      byte *pos = out.data();
+      for (storage::LogRecord *record : records) {
+        if (serialize) {
+          pos += storage::LogSerializer::Serialize(*record, pos);
+        } else {
+          std::memcpy(pos, record, record->Size());
+          pos += record->Size();
+        }
+      }
+      benchmark::DoNotOptimize(out.data());
+    }
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+  }
+  state.SetItemsProcessed(state.iterations() * num_records);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * out_size));
+
+  txn_manager.Commit(txn, [](void *) {}, nullptr);
+  for (storage::LogRecord *record : records) delete[] reinterpret_cast<byte *>(record);
+  gc.PerformGarbageCollection();
+  gc.PerformGarbageCollection();
+  delete table;
+}
+
+/**
+ * Read back the log of the TPCCish workload, as recovery does. The benchmark argument selects reading it sequentially
+ * through a BufferedLogReader (0), or through a MappedLogReader with the given number of decoders.
+ */
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(LoggingBenchmark, ReadLog)(benchmark::State &state) {
+  const uint32_t txn_length = 5;
+  const std::vector<double> insert_update_select_ratio = {0.1, 0.4, 0.5};
+  const auto num_decoders = static_cast<uint32_t>(state.range(0));
+  unlink(LOG_FILE_NAME);
+  {
+    log_manager_ = new storage::LogManager(LOG_FILE_NAME, &buffer_pool_);
+    LargeTransactionBenchmarkObject tested(attr_sizes, initial_table_size, txn_length, insert_update_select_ratio,
+                                           &block_store_, &buffer_pool_, &generator_, true, log_manager_);
+    log_manager_->Process();
+    gc_thread_ = new storage::GarbageCollectorThread(tested.GetTxnManager(), gc_period_);
+    StartLogging();
+    tested.SimulateOltp(num_txns, num_concurrent_txns_);
+    EndLogging();
+    delete gc_thread_;
+    delete log_manager_;
+  }
+  uint64_t num_records = 0;
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    std::vector<storage::LogRecord *> records;
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer timer(&elapsed_ms);
+      if (num_decoders == 0) {
+        storage::BufferedLogReader in(LOG_FILE_NAME);
+        while (in.HasMore()) {
+          storage::LogRecord *record = storage::LogReader::ReadRecord(&in);
+          if (record == nullptr) break;
+          records.push_back(record);
+        }
+      } else {
+        storage::MappedLogReader in(LOG_FILE_NAME);
+        records = storage::LogReader::ReadRecords(&in, num_decoders);
+      }
+    }
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    num_records += records.size();
+    for (storage::LogRecord *record : records) delete[] reinterpret_cast<byte *>(record);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(num_records));
 }
 
-BENCHMARK_REGISTER_F(LoggingBenchmark, TPCCish)->Unit(benchmark::kMillisecond)->UseManualTime()->MinTime(3);
+BENCHMARK_REGISTER_F(LoggingBenchmark, TPCCish)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3)
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::POSIX))
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::NULL_DEVICE))
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::MEMORY))
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::SIMULATED));
 
 BENCHMARK_REGISTER_F(LoggingBenchmark, HighAbortRate)->Unit(benchmark::kMillisecond)->UseManualTime()->MinTime(10);
 
@@ -212,4 +486,55 @@ BENCHMARK_REGISTER_F(LoggingBenchmark, SingleStatementSelect)
     ->Unit(benchmark::kMillisecond)
     ->UseManualTime()
     ->MinTime(1);
+
+BENCHMARK_REGISTER_F(LoggingBenchmark, GroupCommit)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(1)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000);
+
+BENCHMARK_REGISTER_F(LoggingBenchmark, MultiStream)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(1)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4);
+
+BENCHMARK_REGISTER_F(LoggingBenchmark, LogDevice)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(1)
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::POSIX))
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::DIRECT))
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::IO_URING))
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::NULL_DEVICE))
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::MEMORY))
+    ->Arg(static_cast<int64_t>(storage::LogDeviceType::SIMULATED));
+
+BENCHMARK_REGISTER_F(LoggingBenchmark, Compression)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3)
+    ->Arg(0)
+    ->Arg(1);
+
+BENCHMARK_REGISTER_F(LoggingBenchmark, ReadLog)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(4);
+
+BENCHMARK_REGISTER_F(LoggingBenchmark, Serialization)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(1)
+    ->Args({0, 0})
+    ->Args({0, 1})
+    ->Args({1, 0})
+    ->Args({1, 1});
 }  // namespace terrier
@@ -0,0 +1,114 @@
+#include <vector>
+#include "benchmark/benchmark.h"
+#include "common/scoped_timer.h"
+#include "common/worker_pool.h"
+#include "storage/data_table.h"
+#include "storage/garbage_collector_thread.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
+#include "util/multithread_test_util.h"
+#include "util/storage_test_util.h"
+
+namespace terrier {
+
+// Measures how the throughput of beginning and committing transactions scales with the number of threads, given as the
+// argument of each benchmark. The transactions do as little as possible, so that the transaction manager is all that is
+// measured.
+class TransactionManagerBenchmark : public benchmark::Fixture {
+ public:
+  void SetUp(const benchmark::State &state) final {
+    redo_buffer_ = common::AllocationUtil::AllocateAligned(initializer_.ProjectedRowSize());
+    redo_ = initializer_.InitializeRow(redo_buffer_);
+    StorageTestUtil::PopulateRandomRow(redo_, layout_, 0, &generator_);
+  }
+
+  void TearDown(const benchmark::State &state) final { delete[] redo_buffer_; }
+
+  // Runs num_txns_ transactions split across the given number of threads, each of which inserts a tuple unless it is
+  // read-only, and returns the elapsed time in milliseconds. Snapshot transactions are begun as read-only ones.
+  uint64_t RunTransactions(const uint32_t num_threads, const bool read_only, const bool snapshot = false) {
+    storage::DataTable table(&block_store_, layout_, storage::layout_version_t(0));
+    transaction::TransactionManager txn_manager(&buffer_pool_, true, LOGGING_DISABLED, true, txn_reuse_limit_);
+    storage::GarbageCollectorThread gc_thread(&txn_manager, gc_period_);
+    auto workload = [&](uint32_t id) {
+      for (uint32_t i = 0; i < num_txns_ / num_threads; i++) {
+        auto *txn = snapshot ? txn_manager.BeginReadOnlyTransaction() : txn_manager.BeginTransaction();
+        if (!read_only) table.Insert(txn, *redo_);
+        txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+      }
+    };
+    common::WorkerPool thread_pool(num_threads, {});
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer timer(&elapsed_ms);
+      MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads, workload);
+    }
+    return elapsed_ms;
+  }
+
+  const storage::BlockLayout layout_{{8, 8}};
+  const storage::ProjectedRowInitializer initializer_ =
+      storage::ProjectedRowInitializer::Create(layout_, StorageTestUtil::ProjectionListAllColumns(layout_));
+  const uint32_t num_txns_ = 1000000;
+  std::default_random_engine generator_;
+  storage::BlockStore block_store_{1000, 1000};
+  storage::RecordBufferSegmentPool buffer_pool_{num_txns_, num_txns_};
+  const std::chrono::milliseconds gc_period_{10};
+  // Covers the transactions a single thread begins within a GC period, so that the GC returns all of them for reuse
+  const uint32_t txn_reuse_limit_ = 1 << 14;
+
+  byte *redo_buffer_;
+  storage::ProjectedRow *redo_;
+};
+
+// Begins and commits read-only transactions, which never join a commit group
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(TransactionManagerBenchmark, ReadOnlyBeginCommit)(benchmark::State &state) {
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    const uint64_t elapsed_ms = RunTransactions(static_cast<uint32_t>(state.range(0)), true);
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+  }
+  state.SetItemsProcessed(state.iterations() * num_txns_);
+}
+
+// Begins and commits transactions through the read-only fast path, which the GC never sees
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(TransactionManagerBenchmark, SnapshotBeginCommit)(benchmark::State &state) {
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    const uint64_t elapsed_ms = RunTransactions(static_cast<uint32_t>(state.range(0)), true, true);
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+  }
+  state.SetItemsProcessed(state.iterations() * num_txns_);
+}
+
+// Begins transactions that insert a single tuple and commit, so that every commit installs its timestamp
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(TransactionManagerBenchmark, UpdatingBeginCommit)(benchmark::State &state) {
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    const uint64_t elapsed_ms = RunTransactions(static_cast<uint32_t>(state.range(0)), false);
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+  }
+  state.SetItemsProcessed(state.iterations() * num_txns_);
+}
+
+BENCHMARK_REGISTER_F(TransactionManagerBenchmark, ReadOnlyBeginCommit)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->RangeMultiplier(2)
+    ->Range(1, 64);
+
+BENCHMARK_REGISTER_F(TransactionManagerBenchmark, SnapshotBeginCommit)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->RangeMultiplier(2)
+    ->Range(1, 64);
+
+BENCHMARK_REGISTER_F(TransactionManagerBenchmark, UpdatingBeginCommit)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->RangeMultiplier(2)
+    ->Range(1, 64);
+}  // namespace terrier
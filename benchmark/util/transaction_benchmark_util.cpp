@@ -62,7 +62,18 @@ void RandomWorkloadTransaction::Finish() {
   if (aborted_)
     test_object_->txn_manager_.Abort(txn_);
   else
-    commit_time_ = test_object_->txn_manager_.Commit(txn_, TestCallbacks::EmptyCallback, nullptr);
+    commit_time_ = test_object_->txn_manager_.Commit(
+        txn_, LargeTransactionBenchmarkObject::CommitLatencyCallback,
+        new LargeTransactionBenchmarkObject::CommitLatencyArg{test_object_, std::chrono::high_resolution_clock::now()});
+}
+
+void LargeTransactionBenchmarkObject::CommitLatencyCallback(void *const arg) {
+  auto *const latency_arg = reinterpret_cast<CommitLatencyArg *>(arg);
+  const auto latency = std::chrono::high_resolution_clock::now() - latency_arg->commit_start_;
+  latency_arg->test_object_->total_commit_latency_ns_ +=
+      static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+  latency_arg->test_object_->num_commit_callbacks_++;
+  delete latency_arg;
 }
 
 LargeTransactionBenchmarkObject::LargeTransactionBenchmarkObject(const std::vector<uint8_t> &attr_sizes,
@@ -15,6 +15,10 @@ struct Constants {
    * Buffer segment size, in bytes.
    */
   static const uint32_t BUFFER_SEGMENT_SIZE = 1 << 12;
+  /**
+   * Cache line size, in bytes. Data written by different threads is aligned to it to avoid false sharing.
+   */
+  static const uint32_t CACHELINE_SIZE = 64;
   /**
    * Maximum number of columns a table is allowed to have. It should be sufficiently small such that  if all
    * columns are as large as they can be there is still at last one slot for every block.
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <nmmintrin.h>
 #include <algorithm>
+#include <array>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 #include "common/strong_typedef.h"
 namespace terrier::common {
@@ -36,6 +39,23 @@ class HashUtil {
     return hash;
   }
 
+  /**
+   * Scrambles the bits of a hash so that every bit of the input affects every bit of the output, using the finalizer of
+   * MurmurHash3. Useful when only part of the hash is used (e.g. for modulo or as a prefix), as HashBytes does not
+   * distribute small inputs well over all bits.
+   *
+   * @param hash hash to scramble
+   * @return scrambled hash
+   */
+  static hash_t Mix(hash_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
   /**
    * Combines two hashes together by hashing them again.
    * @param l left hash
@@ -106,6 +126,61 @@ class HashUtil {
     // HACK HACK HACK
     return Hash(std::string(str));
   }
+
+  /**
+   * Computes the CRC32C (Castagnoli) checksum of length number of bytes. The checksum of consecutive ranges of bytes
+   * can be computed by passing the checksum of the previous range along. Uses the SSE4.2 crc32 instruction if the CPU
+   * supports it, and a lookup table otherwise.
+   * @param bytes bytes to checksum
+   * @param length number of bytes
+   * @param crc checksum of the bytes before, or 0 for the first range
+   * @return checksum of the bytes so far
+   */
+  static uint32_t Crc32c(const byte *bytes, const uint64_t length, uint32_t crc = 0) {
+    static const bool hardware = __builtin_cpu_supports("sse4.2");
+    return hardware ? Crc32cHardware(bytes, length, crc) : Crc32cSoftware(bytes, length, crc);
+  }
+
+  /**
+   * Computes the CRC32C checksum like Crc32c, but always with the lookup table
+   * @param bytes bytes to checksum
+   * @param length number of bytes
+   * @param crc checksum of the bytes before, or 0 for the first range
+   * @return checksum of the bytes so far
+   */
+  static uint32_t Crc32cSoftware(const byte *bytes, const uint64_t length, uint32_t crc = 0) {
+    static const std::array<uint32_t, 256> table = Crc32cTable();
+    crc = ~crc;
+    for (uint64_t i = 0; i < length; ++i) crc = table[(crc ^ static_cast<uint8_t>(bytes[i])) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+  }
+
+ private:
+  // Only called if the CPU supports SSE4.2, which the rest of the code is not compiled for
+  __attribute__((target("sse4.2"))) static uint32_t Crc32cHardware(const byte *bytes, const uint64_t length,
+                                                                   const uint32_t crc) {
+    uint64_t result = ~crc;
+    uint64_t i = 0;
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, bytes + i, sizeof(uint64_t));
+      result = _mm_crc32_u64(result, word);
+    }
+    auto result32 = static_cast<uint32_t>(result);
+    for (; i < length; i++) result32 = _mm_crc32_u8(result32, static_cast<uint8_t>(bytes[i]));
+    return ~result32;
+  }
+
+  // Lookup table for computing the CRC32C one byte at a time, using the reflected Castagnoli polynomial
+  static std::array<uint32_t, 256> Crc32cTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ ((crc & 1) != 0 ? 0x82F63B78 : 0);
+      table[i] = crc;
+    }
+    return table;
+  }
 };
 
 }  // namespace terrier::common
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "common/hash_util.h"
+#include "common/macros.h"
+
+namespace terrier::common {
+
+/**
+ * A HyperLogLog sketch for estimating the number of distinct values in a multiset, as described in Flajolet et al.,
+ * "HyperLogLog: the analysis of a near-optimal cardinality estimation algorithm". The sketch uses 2^precision one-byte
+ * registers, and has a standard error of roughly 1.04 / sqrt(2^precision).
+ *
+ * Updates are lock-free and safe to issue concurrently with each other and with estimates. Values can only ever be
+ * added, never removed, so the estimate is an upper bound on the number of distinct values ever inserted.
+ */
+class HyperLogLog {
+ public:
+  /**
+   * Default precision, giving 1024 registers and roughly 3% standard error.
+   */
+  static constexpr uint8_t DEFAULT_PRECISION = 10;
+
+  /**
+   * Constructs an empty sketch
+   * @param precision number of bits of the hash used to select a register. Must be in [4, 16].
+   */
+  explicit HyperLogLog(const uint8_t precision = DEFAULT_PRECISION)
+      : precision_(precision), num_registers_(1u << precision), registers_(new std::atomic<uint8_t>[num_registers_]) {
+    TERRIER_ASSERT(precision >= 4 && precision <= 16, "HyperLogLog precision out of range");
+    Clear();
+  }
+
+  /**
+   * Destructs the sketch
+   */
+  ~HyperLogLog() { delete[] registers_; }
+
+  DISALLOW_COPY_AND_MOVE(HyperLogLog)
+
+  /**
+   * Adds a value, given as its hash, to the sketch.
+   * @param hash hash of the value to add. Does not need to be well-distributed, as it is mixed again here.
+   */
+  void AddHash(hash_t hash) {
+    hash = HashUtil::Mix(hash);
+    const uint32_t index = static_cast<uint32_t>(hash >> (64 - precision_));
+    // Rank is the position of the leftmost 1-bit in the remaining bits. The sentinel bit bounds the rank for hashes
+    // whose remaining bits are all 0.
+    const uint64_t remaining = (hash << precision_) | (1ull << (precision_ - 1));
+    const auto rank = static_cast<uint8_t>(__builtin_clzll(remaining) + 1);
+    std::atomic<uint8_t> &reg = registers_[index];
+    uint8_t curr = reg.load(std::memory_order_relaxed);
+    while (rank > curr && !reg.compare_exchange_weak(curr, rank, std::memory_order_relaxed)) {
+    }
+  }
+
+  /**
+   * Adds a value to the sketch
+   * @param bytes start of the value
+   * @param size size of the value in bytes
+   */
+  void Add(const byte *const bytes, const uint64_t size) {
+    // HashUtil::HashBytes does not spread small inputs well enough for the sketch, so we hash word by word here
+    hash_t hash = size;
+    uint64_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, bytes + i, sizeof(uint64_t));
+      hash = HashUtil::Mix(hash ^ word);
+    }
+    if (i < size) {
+      uint64_t word = 0;
+      std::memcpy(&word, bytes + i, size - i);
+      hash = HashUtil::Mix(hash ^ word);
+    }
+    AddHash(hash);
+  }
+
+  /**
+   * @return estimate of the number of distinct values added to the sketch so far
+   */
+  uint64_t Estimate() const {
+    double sum = 0.0;
+    uint32_t zeros = 0;
+    for (uint32_t i = 0; i < num_registers_; i++) {
+      const uint8_t reg = registers_[i].load(std::memory_order_relaxed);
+      if (reg == 0) zeros++;
+      sum += std::ldexp(1.0, -reg);
+    }
+    const auto m = static_cast<double>(num_registers_);
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    const double estimate = alpha * m * m / sum;
+    // Small range correction: fall back to linear counting while there are still empty registers
+    if (estimate <= 2.5 * m && zeros != 0) return static_cast<uint64_t>(std::llround(m * std::log(m / zeros)));
+    return static_cast<uint64_t>(std::llround(estimate));
+  }
+
+  /**
+   * Resets the sketch to be empty. Not safe to call concurrently with updates.
+   */
+  void Clear() {
+    for (uint32_t i = 0; i < num_registers_; i++) registers_[i].store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  const uint8_t precision_;
+  const uint32_t num_registers_;
+  std::atomic<uint8_t> *const registers_;
+};
+}  // namespace terrier::common
@@ -10,6 +10,7 @@
 #include "settings/settings_manager.h"
 #include "settings/settings_param.h"
 #include "storage/garbage_collector_thread.h"
+#include "storage/write_ahead_log/log_manager.h"
 #include "transaction/transaction_manager.h"
 
 namespace terrier {
@@ -39,9 +40,12 @@ class DBMain {
   ~DBMain() {
     if (initialized) {
       ForceShutdown();
+      // Persists the last commits, so that the GC can then free all transactions
+      log_manager_->Shutdown();
       delete gc_thread_;
       delete settings_manager_;
       delete txn_manager_;
+      delete log_manager_;
       delete buffer_segment_pool_;
       delete thread_pool_;
 
@@ -58,6 +62,7 @@ class DBMain {
    *    Debug loggers
    *    Stats registry (counters)
    *    Buffer segment pools
+   *    Log manager
    *    Transaction manager
    *    Garbage collector thread
    *    Catalog
@@ -86,6 +91,7 @@ class DBMain {
   friend class settings::Callbacks;
   std::shared_ptr<common::StatisticsRegistry> main_stat_reg_;
   std::unordered_map<settings::Param, settings::ParamInfo> param_map_;
+  storage::LogManager *log_manager_;
   transaction::TransactionManager *txn_manager_;
   settings::SettingsManager *settings_manager_;
   storage::GarbageCollectorThread *gc_thread_;
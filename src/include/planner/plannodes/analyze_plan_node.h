@@ -6,6 +6,7 @@
 #include <vector>
 #include "parser/analyze_statement.h"
 #include "planner/plannodes/abstract_plan_node.h"
+#include "storage/storage_defs.h"
 
 namespace terrier::planner {
 
@@ -62,6 +63,17 @@ class AnalyzePlanNode : public AbstractPlanNode {
       return *this;
     }
 
+    /**
+     * @param sampling_method method used to sample the target table
+     * @param sample_rate fraction of tuples (BERNOULLI) or blocks (SYSTEM) of the target table to sample
+     * @return builder object
+     */
+    Builder &SetSampling(storage::SamplingMethod sampling_method, double sample_rate) {
+      sampling_method_ = sampling_method;
+      sample_rate_ = sample_rate;
+      return *this;
+    }
+
     /**
      * Build the analyze plan node
      * @return plan node
@@ -69,7 +81,8 @@ class AnalyzePlanNode : public AbstractPlanNode {
     std::shared_ptr<AnalyzePlanNode> Build() {
       return std::shared_ptr<AnalyzePlanNode>(new AnalyzePlanNode(std::move(children_), std::move(output_schema_),
                                                                   database_oid_, namespace_oid_, table_oid_,
-                                                                  std::move(column_oids_)));
+                                                                  std::move(column_oids_), sampling_method_,
+                                                                  sample_rate_));
     }
 
    protected:
@@ -92,6 +105,16 @@ class AnalyzePlanNode : public AbstractPlanNode {
      * oids of the columns to be analyzed
      */
     std::vector<catalog::col_oid_t> column_oids_;
+
+    /**
+     * method used to sample the target table
+     */
+    storage::SamplingMethod sampling_method_ = storage::SamplingMethod::BERNOULLI;
+
+    /**
+     * fraction of the target table to sample, 1 analyzes every tuple
+     */
+    double sample_rate_ = 1.0;
   };
 
  private:
@@ -101,16 +124,21 @@ class AnalyzePlanNode : public AbstractPlanNode {
    * @param database_oid OID of the database
    * @param table_oid OID of the target SQL table
    * @param column_oids OIDs of the columns of the target table
+   * @param sampling_method method used to sample the target table
+   * @param sample_rate fraction of tuples (BERNOULLI) or blocks (SYSTEM) of the target table to sample
    */
   AnalyzePlanNode(std::vector<std::shared_ptr<AbstractPlanNode>> &&children,
                   std::shared_ptr<OutputSchema> output_schema, catalog::db_oid_t database_oid,
                   catalog::namespace_oid_t namespace_oid, catalog::table_oid_t table_oid,
-                  std::vector<catalog::col_oid_t> &&column_oids)
+                  std::vector<catalog::col_oid_t> &&column_oids, storage::SamplingMethod sampling_method,
+                  double sample_rate)
       : AbstractPlanNode(std::move(children), std::move(output_schema)),
         database_oid_(database_oid),
         namespace_oid_(namespace_oid),
         table_oid_(table_oid),
-        column_oids_(std::move(column_oids)) {}
+        column_oids_(std::move(column_oids)),
+        sampling_method_(sampling_method),
+        sample_rate_(sample_rate) {}
 
  public:
   /**
@@ -145,6 +173,16 @@ class AnalyzePlanNode : public AbstractPlanNode {
    */
   std::vector<catalog::col_oid_t> GetColumnOids() const { return column_oids_; }
 
+  /**
+   * @return the method used to sample the target table
+   */
+  storage::SamplingMethod GetSamplingMethod() const { return sampling_method_; }
+
+  /**
+   * @return the fraction of tuples (BERNOULLI) or blocks (SYSTEM) of the target table to sample
+   */
+  double GetSampleRate() const { return sample_rate_; }
+
   /**
    * @return the hashed value of this plan node
    */
@@ -175,6 +213,16 @@ class AnalyzePlanNode : public AbstractPlanNode {
    * OIDs of the columns to be analyzed
    */
   std::vector<catalog::col_oid_t> column_oids_;
+
+  /**
+   * Method used to sample the target table
+   */
+  storage::SamplingMethod sampling_method_ = storage::SamplingMethod::BERNOULLI;
+
+  /**
+   * Fraction of the target table to sample, 1 analyzes every tuple
+   */
+  double sample_rate_ = 1.0;
 };
 
 }  // namespace terrier::planner
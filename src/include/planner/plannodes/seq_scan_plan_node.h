@@ -9,6 +9,7 @@
 #include "parser/expression/abstract_expression.h"
 #include "planner/plannodes/abstract_plan_node.h"
 #include "planner/plannodes/abstract_scan_plan_node.h"
+#include "storage/storage_defs.h"
 
 namespace terrier::planner {
 
@@ -38,14 +39,26 @@ class SeqScanPlanNode : public AbstractScanPlanNode {
       return *this;
     }
 
+    /**
+     * Only scan a random sample of the table, as in TABLESAMPLE
+     * @param sampling_method method used to sample the table
+     * @param sample_rate fraction of tuples (BERNOULLI) or blocks (SYSTEM) of the table to sample
+     * @return builder object
+     */
+    Builder &SetSampling(storage::SamplingMethod sampling_method, double sample_rate) {
+      sampling_method_ = sampling_method;
+      sample_rate_ = sample_rate;
+      return *this;
+    }
+
     /**
      * Build the sequential scan plan node
      * @return plan node
      */
     std::shared_ptr<SeqScanPlanNode> Build() {
-      return std::shared_ptr<SeqScanPlanNode>(
-          new SeqScanPlanNode(std::move(children_), std::move(output_schema_), std::move(scan_predicate_),
-                              is_for_update_, is_parallel_, database_oid_, namespace_oid_, table_oid_));
+      return std::shared_ptr<SeqScanPlanNode>(new SeqScanPlanNode(
+          std::move(children_), std::move(output_schema_), std::move(scan_predicate_), is_for_update_, is_parallel_,
+          database_oid_, namespace_oid_, table_oid_, sampling_method_, sample_rate_));
     }
 
    protected:
@@ -53,6 +66,16 @@ class SeqScanPlanNode : public AbstractScanPlanNode {
      * OID for table being scanned
      */
     catalog::table_oid_t table_oid_;
+
+    /**
+     * Method used to sample the table
+     */
+    storage::SamplingMethod sampling_method_ = storage::SamplingMethod::BERNOULLI;
+
+    /**
+     * Fraction of the table to sample, 1 scans every tuple
+     */
+    double sample_rate_ = 1.0;
   };
 
  private:
@@ -64,14 +87,19 @@ class SeqScanPlanNode : public AbstractScanPlanNode {
    * @param is_parallel flag for parallel scan
    * @param database_oid database oid for scan
    * @param table_oid OID for table to scan
+   * @param sampling_method method used to sample the table
+   * @param sample_rate fraction of tuples (BERNOULLI) or blocks (SYSTEM) of the table to sample
    */
   SeqScanPlanNode(std::vector<std::shared_ptr<AbstractPlanNode>> &&children,
                   std::shared_ptr<OutputSchema> output_schema, std::shared_ptr<parser::AbstractExpression> predicate,
                   bool is_for_update, bool is_parallel, catalog::db_oid_t database_oid,
-                  catalog::namespace_oid_t namespace_oid, catalog::table_oid_t table_oid)
+                  catalog::namespace_oid_t namespace_oid, catalog::table_oid_t table_oid,
+                  storage::SamplingMethod sampling_method, double sample_rate)
       : AbstractScanPlanNode(std::move(children), std::move(output_schema), std::move(predicate), is_for_update,
                              is_parallel, database_oid, namespace_oid),
-        table_oid_(table_oid) {}
+        table_oid_(table_oid),
+        sampling_method_(sampling_method),
+        sample_rate_(sample_rate) {}
 
  public:
   /**
@@ -91,6 +119,16 @@ class SeqScanPlanNode : public AbstractScanPlanNode {
    */
   catalog::table_oid_t GetTableOid() const { return table_oid_; }
 
+  /**
+   * @return the method used to sample the table
+   */
+  storage::SamplingMethod GetSamplingMethod() const { return sampling_method_; }
+
+  /**
+   * @return the fraction of tuples (BERNOULLI) or blocks (SYSTEM) of the table to sample, 1 if not sampling
+   */
+  double GetSampleRate() const { return sample_rate_; }
+
   /**
    * @return the hashed value of this plan node
    */
@@ -106,6 +144,16 @@ class SeqScanPlanNode : public AbstractScanPlanNode {
    * OID for table being scanned
    */
   catalog::table_oid_t table_oid_;
+
+  /**
+   * Method used to sample the table
+   */
+  storage::SamplingMethod sampling_method_ = storage::SamplingMethod::BERNOULLI;
+
+  /**
+   * Fraction of the table to sample, 1 scans every tuple
+   */
+  double sample_rate_ = 1.0;
 };
 
 DEFINE_JSON_DECLARATIONS(SeqScanPlanNode);
@@ -16,6 +16,84 @@ SETTING_int(record_buffer_segment_reuse,
 SETTING_int(gc_interval, "Garbage collector thread interval (default: 10)", 10, 1, 10000, false,
     terrier::settings::Callbacks::NoOp)
 
+// Number of garbage collector threads
+SETTING_int(gc_num_threads,
+    "Number of threads that share the unlinking and deallocation of a garbage collection pass (default: 1)", 1, 1, 64,
+    false, terrier::settings::Callbacks::NoOp)
+
 // Number of worker pool threads
 SETTING_int(num_worker_threads, "The number of worker pool threads (default: 4)", 4, 1, 1000, true,
     terrier::settings::Callbacks::WorkerPoolThreads)
+
+// Write ahead log file
+SETTING_string(log_file_path, "The path to the write ahead log file (default: wal.log)", "wal.log", false,
+    terrier::settings::Callbacks::NoOp)
+
+// Number of write ahead log streams
+SETTING_int(log_num_streams,
+    "Number of write ahead log streams, each serialized by its own thread to its own file (default: 1)", 1, 1, 64,
+    false, terrier::settings::Callbacks::NoOp)
+
+// Write ahead log device
+SETTING_string(log_device,
+    "How the write ahead log is written to disk: posix (page cache and fsync), direct (O_DIRECT into preallocated "
+    "files and fdatasync) or io_uring (asynchronous writes and fdatasync). For benchmarking, it can also be discarded "
+    "(null), kept in a ring buffer in memory (memory), or kept in memory with simulated sync latencies (simulated), "
+    "none of which can be recovered from (default: posix)", "posix", false, terrier::settings::Callbacks::NoOp)
+
+// Simulated write ahead log sync latency
+SETTING_int(log_simulated_sync_median,
+    "Median latency in microseconds of a sync of the simulated write ahead log device (default: 200)", 200, 0,
+    1000000, false, terrier::settings::Callbacks::NoOp)
+
+// Simulated write ahead log sync latency tail
+SETTING_int(log_simulated_sync_p99,
+    "99th percentile latency in microseconds of a sync of the simulated write ahead log device (default: 1000)", 1000,
+    0, 1000000, false, terrier::settings::Callbacks::NoOp)
+
+// Write ahead log segment size
+SETTING_int(log_segment_size,
+    "Size in bytes of the segments the write ahead log streams are split into, or 0 to write every stream to a "
+    "single file (default: 0)", 0, 0, 1073741824, false, terrier::settings::Callbacks::NoOp)
+
+// Write ahead log archive directory
+SETTING_string(log_archive_dir,
+    "Directory log segments no longer needed after a checkpoint are moved to, or empty to delete them (default: )", "",
+    false, terrier::settings::Callbacks::NoOp)
+
+// Synchronous commit
+SETTING_bool(synchronous_commit,
+    "Whether transactions wait for their commit record to be persistent before their commit is acknowledged, unless "
+    "they choose otherwise. Asynchronous commits can be lost on a crash (default: true)", true, false,
+    terrier::settings::Callbacks::NoOp)
+
+// Maximum asynchronous commit lag
+SETTING_int(log_max_commit_lag,
+    "Maximum time in microseconds the write ahead log holds back records while no commit waits for them, i.e. how "
+    "much of the asynchronously committed transactions can be lost on a crash (default: 10000)", 10000, 1, 10000000,
+    false, terrier::settings::Callbacks::NoOp)
+
+// Write ahead log compression
+SETTING_bool(log_compression,
+    "Whether the write ahead log is compressed, which trades CPU time for fewer bytes written (default: false)", false,
+    false, terrier::settings::Callbacks::NoOp)
+
+// Log write batch size
+SETTING_int(log_write_batch_size,
+    "Number of bytes serialized after which the log serializer writes them out with a single gather write "
+    "(default: 1048576)", 1048576, 4096, 1073741824, false, terrier::settings::Callbacks::NoOp)
+
+// Log serializer thread interval
+SETTING_int(log_serialization_interval,
+    "Time in microseconds the log serializer thread sleeps between two rounds of serialization (default: 100)", 100,
+    1, 1000000, false, terrier::settings::Callbacks::NoOp)
+
+// Log flusher thread interval, i.e. the group commit window
+SETTING_int(log_flush_interval,
+    "Maximum time in microseconds between two flushes of the write ahead log, i.e. the group commit window "
+    "(default: 1000)", 1000, 1, 1000000, false, terrier::settings::Callbacks::NoOp)
+
+// Log flush threshold
+SETTING_int(log_flush_threshold,
+    "Number of bytes written to the write ahead log after which it is flushed without waiting for the flush interval "
+    "(default: 1048576)", 1048576, 1, 1073741824, false, terrier::settings::Callbacks::NoOp)
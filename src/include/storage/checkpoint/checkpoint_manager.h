@@ -0,0 +1,108 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "catalog/catalog_defs.h"
+#include "catalog/schema.h"
+#include "storage/sql_table.h"
+#include "storage/storage_defs.h"
+#include "storage/write_ahead_log/log_io.h"
+#include "transaction/transaction_defs.h"
+
+namespace terrier::transaction {
+class TransactionManager;
+}  // namespace terrier::transaction
+
+namespace terrier::storage {
+
+/**
+ * A CheckpointManager takes transactionally consistent snapshots of a set of tables and writes them out to disk, so
+ * that recovery can load the snapshot and only replay the log written after it, instead of the entire log.
+ *
+ * A checkpoint is taken within a single transaction, and is therefore consistent as of its start time: it contains
+ * exactly the changes of the transactions that committed before it. Since reads never block writers, concurrent
+ * transactions are free to keep going while the checkpoint is written. The checkpoint transaction does hold back
+ * garbage collection while it runs, though.
+ *
+ * Every table is written to its own file in a columnar format. The file starts with a header of the table oid and
+ * the oid and size of every column, followed by batches of the form:
+ *   | num_tuples | tuple slots | column 0 | column 1 | ... |
+ * and terminated by a batch of 0 tuples. Each column consists of its null bitmap, followed by the values packed one
+ * after the other for fixed-length columns, or, for varlen columns, by an array of num_tuples + 1 offsets into a
+ * gathered array of the values, much like an Arrow list.
+ *
+ * The files of a checkpoint are named after its timestamp, and a checkpoint only becomes valid once its metadata file,
+ * listing its timestamp and tables, has been atomically put in place. A crash half-way through a checkpoint therefore
+ * leaves the previous checkpoint intact.
+ */
+class CheckpointManager {
+ public:
+  /**
+   * Default number of tuples scanned and written out at a time
+   */
+  static constexpr uint32_t DEFAULT_BATCH_SIZE = 1 << 10;
+
+  /**
+   * Constructs a new CheckpointManager
+   * @param checkpoint_dir directory to write checkpoints to and read them from. The directory must already exist.
+   * @param txn_manager the transaction manager to take checkpoints and load them with
+   * @param batch_size number of tuples scanned and written out at a time
+   */
+  CheckpointManager(std::string checkpoint_dir, transaction::TransactionManager *const txn_manager,
+                    const uint32_t batch_size = DEFAULT_BATCH_SIZE)
+      : checkpoint_dir_(std::move(checkpoint_dir)), txn_manager_(txn_manager), batch_size_(batch_size) {}
+
+  /**
+   * Takes a checkpoint of the given tables, replacing the previous checkpoint once it is durable. Log segments only
+   * needed to recover up to the checkpoint are then removed, if the transaction manager logs to a segmented log.
+   * @param tables tables to checkpoint, along with their schemas
+   * @return timestamp of the checkpoint. Transactions that committed before it are contained in the checkpoint, and
+   *         do not need to be replayed from the log.
+   * @throws runtime_error if the checkpoint could not be written
+   */
+  transaction::timestamp_t Checkpoint(const std::vector<std::pair<SqlTable *, const catalog::Schema *>> &tables);
+
+  /**
+   * @return true if there is a complete checkpoint to recover from, false otherwise
+   */
+  bool HasCheckpoint() const;
+
+  /**
+   * Loads the last complete checkpoint into the given tables, which are expected to be empty. Tuples are inserted in
+   * batches by their own transactions, so garbage collection should be running for large checkpoints.
+   * @param db_oid database the tables belong to
+   * @param tables tables to load the checkpoint into, along with their schemas. This must include every table in the
+   *               checkpoint, with the same columns as when the checkpoint was taken.
+   * @param slot_map if not nullptr, filled with a mapping from the slots tuples were in when the checkpoint was taken to
+   *                 the slots they were loaded into, which is needed to replay log records written after the checkpoint
+   * @return timestamp of the checkpoint loaded. Only transactions that committed after it need to be replayed.
+   * @throws runtime_error if there is no checkpoint, or it does not match the given tables
+   */
+  transaction::timestamp_t Recover(catalog::db_oid_t db_oid,
+                                   const std::vector<std::pair<SqlTable *, const catalog::Schema *>> &tables,
+                                   std::unordered_map<TupleSlot, TupleSlot> *slot_map);
+
+ private:
+  const std::string checkpoint_dir_;
+  transaction::TransactionManager *const txn_manager_;
+  const uint32_t batch_size_;
+
+  // Writes out the given table as visible to the txn
+  void WriteTable(transaction::TransactionContext *txn, const SqlTable &table, const catalog::Schema &schema,
+                  BufferedLogWriter *out) const;
+
+  // Inserts the tuples from the given checkpoint file into the table
+  void LoadTable(catalog::db_oid_t db_oid, SqlTable *table, const catalog::Schema &schema, BufferedLogReader *in,
+                 std::unordered_map<TupleSlot, TupleSlot> *slot_map) const;
+
+  // Reads the metadata of the last complete checkpoint, returns false if there is none
+  bool ReadMetadata(transaction::timestamp_t *timestamp, std::vector<catalog::table_oid_t> *table_oids) const;
+
+  std::string MetadataPath() const { return checkpoint_dir_ + "/checkpoint.meta"; }
+
+  std::string TablePath(const transaction::timestamp_t timestamp, const catalog::table_oid_t oid) const {
+    return checkpoint_dir_ + "/checkpoint_" + std::to_string(!timestamp) + "_" + std::to_string(!oid) + ".table";
+  }
+};
+}  // namespace terrier::storage
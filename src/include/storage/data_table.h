@@ -1,10 +1,13 @@
 #pragma once
 #include <list>
+#include <memory>
+#include <random>
 #include <unordered_map>
 #include <vector>
 #include "common/performance_counter.h"
 #include "storage/projected_columns.h"
 #include "storage/storage_defs.h"
+#include "storage/table_statistics.h"
 #include "storage/tuple_access_strategy.h"
 #include "storage/undo_record.h"
 
@@ -103,6 +106,55 @@ class DataTable {
     std::list<RawBlock *>::const_iterator block_;
     TupleSlot current_slot_;
   };
+
+  /**
+   * Iterator over a random sample of the slots in the data table, drawn according to a SamplingMethod. The blocks of
+   * the table are fixed when the iterator is created, and the iterator jumps directly from one sampled slot to the
+   * next, so that the cost of a sampling scan is proportional to the size of the sample instead of the size of the
+   * table.
+   */
+  class SampleIterator {
+   public:
+    /**
+     * @return true if there are no more slots in the sample, false otherwise
+     */
+    bool Done() const { return block_ >= blocks_.size(); }
+
+    /**
+     * @return the current sampled slot. Only valid if Done() is false
+     */
+    TupleSlot operator*() const { return {blocks_[block_], offset_}; }
+
+    /**
+     * Advances the iterator to the next slot in the sample
+     * @return self-reference after the iterator is advanced
+     */
+    SampleIterator &operator++();
+
+   private:
+    friend class DataTable;
+    SampleIterator(std::vector<RawBlock *> &&blocks, uint32_t slots_per_block, SamplingMethod method, double rate,
+                   uint64_t seed);
+
+    // Moves the iterator forward by the given number of slots (BERNOULLI) or blocks (SYSTEM)
+    void Skip(uint64_t distance);
+
+    // Draws the number of slots (BERNOULLI) or blocks (SYSTEM) to skip before the next sample
+    uint64_t NextGap() { return sample_all_ ? 0 : gap_(generator_); }
+
+    std::vector<RawBlock *> blocks_;
+    const uint32_t slots_per_block_;
+    const SamplingMethod method_;
+    std::mt19937_64 generator_;
+    // The geometric distribution only takes probabilities strictly between 0 and 1. With a rate of 1 there are no gaps,
+    // and with a rate of 0 there are no blocks to sample from.
+    const bool sample_all_;
+    // The gaps between successive samples in a Bernoulli process are geometrically distributed
+    std::geometric_distribution<uint64_t> gap_;
+    uint64_t block_ = 0;
+    uint32_t offset_ = 0;
+  };
+
   /**
    * Constructs a new DataTable with the given layout, using the given BlockStore as the source
    * of its storage blocks. The first column must be size 8 and is effectively hidden from upper levels.
@@ -110,8 +162,11 @@ class DataTable {
    * @param store the Block store to use.
    * @param layout the initial layout of this DataTable. First 2 columns must be 8 bytes.
    * @param layout_version the layout version of this DataTable
+   * @param collect_statistics whether committing transactions maintain the statistics of this DataTable, which they
+   *                           otherwise do not pay for
    */
-  DataTable(BlockStore *store, const BlockLayout &layout, layout_version_t layout_version);
+  DataTable(BlockStore *store, const BlockLayout &layout, layout_version_t layout_version,
+            bool collect_statistics = false);
 
   /**
    * Destructs a DataTable, frees all its blocks and any potential varlen entries.
@@ -148,6 +203,30 @@ class DataTable {
    */
   void Scan(transaction::TransactionContext *txn, SlotIterator *start_pos, ProjectedColumns *out_buffer) const;
 
+  /**
+   * Creates an iterator over a random sample of the slots in the table. Tuples inserted into new blocks after the call
+   * are never part of the sample.
+   *
+   * @param method sampling method to use
+   * @param rate probability of each tuple (BERNOULLI) or block (SYSTEM) being part of the sample, between 0 and 1
+   * @param seed seed for the random number generator, the same seed on the same table gives the same sample
+   * @return iterator to the first slot in the sample
+   */
+  SampleIterator BeginSample(SamplingMethod method, double rate, uint64_t seed) const;
+
+  /**
+   * Scans the random sample given by the iterator and materializes as many tuples as would fit into the given buffer,
+   * as visible to the transaction given. The semantics are the same as Scan, except only sampled slots are considered.
+   * Sampled slots that are not visible to the transaction are skipped, so the sampling rate applies to the table
+   * physically and not to what is visible to the transaction.
+   *
+   * @param txn the calling transaction
+   * @param sample iterator over the sample to scan, mutated to point to the next sampled slot not yet scanned
+   * @param out_buffer output buffer. The object should already contain projection list information. This buffer is
+   *                   always cleared of old values.
+   */
+  void SampleScan(transaction::TransactionContext *txn, SampleIterator *sample, ProjectedColumns *out_buffer) const;
+
   /**
    * @return the first tuple slot contained in the data table
    */
@@ -206,11 +285,28 @@ class DataTable {
    */
   DataTableCounter *GetDataTableCounter() { return &data_table_counter_; }
 
+  /**
+   * @return whether this table maintains statistics, see the constructor
+   */
+  bool CollectsStatistics() const { return statistics_ != nullptr; }
+
+  /**
+   * Return the statistics of the committed contents of this table. These are maintained incrementally as transactions
+   * commit and can be read at any time without scanning the table. Only tables that collect statistics have them.
+   * @return statistics of the data table
+   */
+  const TableStatistics &GetTableStatistics() const {
+    TERRIER_ASSERT(CollectsStatistics(), "this table does not collect statistics");
+    return *statistics_;
+  }
+
  private:
   // The GarbageCollector needs to modify VersionPtrs when pruning version chains
   friend class GarbageCollector;
   // The TransactionManager needs to modify VersionPtrs when rolling back aborts
   friend class transaction::TransactionManager;
+  // The LogSerializer needs the layout of logged tuples to know which of their values are varlen
+  friend class LogSerializer;
   // The index wrappers need access to IsVisible and HasConflict
   friend class index::Index;
   template <typename KeyType>
@@ -234,6 +330,8 @@ class DataTable {
   // only happen when blocks are full, thus we can afford to be optimistic
   std::atomic<RawBlock *> insertion_head_ = nullptr;
   mutable DataTableCounter data_table_counter_;
+  // nullptr if the table does not collect statistics
+  const std::unique_ptr<TableStatistics> statistics_;
 
   // A templatized version for select, so that we can use the same code for both row and column access.
   // the method is explicitly instantiated for ProjectedRow and ProjectedColumns::RowView
@@ -265,11 +363,32 @@ class DataTable {
   bool CompareAndSwapVersionPtr(TupleSlot slot, const TupleAccessStrategy &accessor, UndoRecord *expected,
                                 UndoRecord *desired);
 
+  // Unlinks every undo record of the tuple's version chain that is older than the given timestamp, which must not be
+  // newer than the start time of any running transaction. The undo records are only unlinked, freeing them is up to
+  // the GC. Invoked by the GC thread that owns the slot, and by the transaction holding the write lock on the tuple.
+  // Below the head of the chain, both only ever cut it off, which is why they do not need to exclude each other.
+  void TruncateVersionChain(TupleSlot slot, transaction::timestamp_t oldest);
+
+  // Invoked by writers on the previous head of the chain after they installed a new one. Truncates the chain if that
+  // record is older than the oldest running transaction the TransactionManager last computed, so that hot tuples do
+  // not build up long chains between GC runs. Readers never modify the chain.
+  void PruneVersionChain(const transaction::TransactionContext &txn, TupleSlot slot, const UndoRecord *record);
+
   // Allocates a new block to be used as insertion head.
   void NewBlock(RawBlock *expected_val);
 
   void DeallocateVarlensOnShutdown(RawBlock *block);
 
+  // Folds the changes of a committing transaction to a tuple into the table statistics. Must be called before the
+  // transaction's commit timestamp is installed, while it still holds the write lock on the tuple, and only if the
+  // table collects statistics.
+  void UpdateStatisticsOnCommit(const transaction::TransactionContext &txn, const UndoRecord &record);
+
+  // Returns the delta of the oldest update to the column among the undo records of the transaction from the given one
+  // on, and the index of the column in it, or nullptr if there is none. Its value is the column's before-image.
+  static const ProjectedRow *OldestDeltaOf(const UndoRecord *from, transaction::timestamp_t txn_id, col_id_t col_id,
+                                           uint16_t *index);
+
   /**
    * Determine if a Tuple is visible (present and not deleted) to the given transaction. It's effectively Select's logic
    * (follow a version chain if present) without the materialization. If the logic of Select changes, this should change
@@ -1,7 +1,12 @@
 #pragma once
 
-#include <queue>
+#include <functional>
+#include <memory>
+#include <unordered_set>
 #include <utility>
+#include <vector>
+#include "common/constants.h"
+#include "common/worker_pool.h"
 #include "transaction/transaction_context.h"
 #include "transaction/transaction_defs.h"
 #include "transaction/transaction_manager.h"
@@ -11,8 +16,23 @@ namespace terrier::storage {
 /**
  * The garbage collector is responsible for processing a queue of completed transactions from the transaction manager.
  * Based on the contents of this queue, it unlinks the UndoRecords from their version chains when no running
- * transactions can view those versions anymore. It then stores those transactions to attempt to deallocate on the next
- * iteration if no running transactions can still hold references to them.
+ * transactions can view those versions anymore. It then defers the deallocation of those transactions like any other
+ * deferred action of the transaction manager, until no running transactions can still hold references to them. These
+ * actions refer to the GC, so the GC must outlive them, unless the transaction manager is destroyed before they run.
+ *
+ * Both the unlinking and the deallocation of a GC invocation can be spread across several GC threads. The invoking
+ * thread always takes part, and the others come from a worker pool owned by the GC. The transactions of a batch are
+ * split into one contiguous range per thread. While unlinking, each thread hands the undo records of its range to the
+ * thread that owns their tuple slot, so that every version chain is truncated once per invocation, and before its
+ * deleted slot is reclaimed. Each pair of threads exchanges records through its own list, and the threads only
+ * synchronize between the two halves of the work, so they share no latches. How this scales with the number of GC
+ * threads has not been measured on multi-core hardware yet, so the GC works on a single thread by default.
+ *
+ * Committed transactions are only unlinked once the log manager is done with them. While it walks the unlink queue, the
+ * GC thus finds the oldest start time of the transactions that are running, or that it has not unlinked yet. It runs
+ * the deferred actions up to that watermark, so an action may free whatever the transactions running when it was
+ * deferred refer to. Index entries, dropped tables, and the undo buffers and loose varlens of unlinked transactions are
+ * all reclaimed this way.
  */
 class GarbageCollector {
  public:
@@ -20,12 +40,9 @@ class GarbageCollector {
    * Constructor for the Garbage Collector that requires a pointer to the TransactionManager. This is necessary for the
    * GC to invoke the TM's function for handing off the completed transactions queue.
    * @param txn_manager pointer to the TransactionManager
+   * @param num_gc_threads number of threads that share the work of a GC invocation, including the invoking thread
    */
-  explicit GarbageCollector(transaction::TransactionManager *txn_manager)
-      : txn_manager_(txn_manager), last_unlinked_{0} {
-    TERRIER_ASSERT(txn_manager_->GCEnabled(),
-                   "The TransactionManager needs to be instantiated with gc_enabled true for GC to work!");
-  }
+  explicit GarbageCollector(transaction::TransactionManager *txn_manager, uint32_t num_gc_threads = 1);
 
   /**
    * Deallocates transactions that can no longer be referenced by running transactions, and unlinks UndoRecords that
@@ -40,7 +57,7 @@ class GarbageCollector {
 
  private:
   /**
-   * Process the deallocate queue
+   * Process the deallocate queue, which holds the txns whose deferred deallocation ran in this invocation
    * @return number of txns (not UndoRecords) processed for debugging/testing
    */
   uint32_t ProcessDeallocateQueue();
@@ -56,21 +73,36 @@ class GarbageCollector {
    */
   void ProcessDeferredActions();
 
+  // Defers the deallocation of unlinked or aborted txns until no running txn can hold a reference to them anymore
+  void DeferDeallocation(std::vector<transaction::TransactionContext *> &&txns);
+
   void ReclaimSlotIfDeleted(UndoRecord *undo_record) const;
 
   void ReclaimBufferIfVarlen(transaction::TransactionContext *txn, UndoRecord *undo_record) const;
 
-  void TruncateVersionChain(DataTable *table, TupleSlot slot, transaction::timestamp_t oldest) const;
+  // Runs task(i) for every GC thread i, and returns once all of them are done
+  void RunOnAllThreads(const std::function<void(uint32_t)> &task);
+
+  // Work of a single GC thread. Only the GC thread owning it accesses it while the GC threads run.
+  struct alignas(common::Constants::CACHELINE_SIZE) Partition {
+    // records_[i] holds the undo records this thread routed to GC thread i
+    std::vector<std::vector<UndoRecord *>> records_;
+    // slots this thread has already truncated in this GC invocation
+    std::unordered_set<TupleSlot> visited_slots_;
+  };
 
   transaction::TransactionManager *const txn_manager_;
-  // timestamp of the last time GC unlinked anything. We need this to know when unlinked versions are safe to deallocate
-  transaction::timestamp_t last_unlinked_;
-  // queue of txns that have been unlinked, and should possible be deleted on next GC run
-  transaction::TransactionQueue txns_to_deallocate_;
+  // not newer than the start time of any txn that is running or in txns_to_unlink_, see ProcessUnlinkQueue
+  transaction::timestamp_t oldest_unprocessed_;
+  // txns whose deferred deallocation ran, and that are deleted in this GC run
+  std::vector<transaction::TransactionContext *> txns_to_deallocate_;
   // queue of txns that need to be unlinked
   transaction::TransactionQueue txns_to_unlink_;
-  // queue of unexecuted deferred actions
-  std::queue<std::pair<transaction::timestamp_t, transaction::Action>> deferred_actions_;
+  // txns split between the GC threads in the current phase
+  std::vector<transaction::TransactionContext *> batch_;
+  std::vector<Partition> partitions_;
+  // threads helping the invoking thread, or nullptr if it works alone
+  std::unique_ptr<common::WorkerPool> helpers_;
 };
 
 }  // namespace terrier::storage
@@ -15,11 +15,13 @@ class GarbageCollectorThread {
   /**
    * @param txn_manager pointer to the txn manager for the GC to communicate with
    * @param gc_period sleep time between GC invocations
+   * @param num_gc_threads number of threads that share the work of a GC invocation, including this one
    */
-  GarbageCollectorThread(transaction::TransactionManager *const txn_manager, const std::chrono::milliseconds gc_period)
+  GarbageCollectorThread(transaction::TransactionManager *const txn_manager, const std::chrono::milliseconds gc_period,
+                         const uint32_t num_gc_threads = 1)
       : run_gc_(true),
         gc_paused_(false),
-        gc_(txn_manager),
+        gc_(txn_manager, num_gc_threads),
         gc_period_(gc_period),
         gc_thread_(std::thread([this] { GCThreadLoop(); })) {}
 
@@ -0,0 +1,214 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+#include "catalog/schema.h"
+#include "common/shared_latch.h"
+#include "common/worker_pool.h"
+#include "storage/sql_table.h"
+#include "storage/storage_defs.h"
+
+namespace terrier::transaction {
+class TransactionManager;
+}  // namespace terrier::transaction
+
+namespace terrier::storage {
+
+/**
+ * Strategies for routing tuples of a PartitionedSqlTable to its partitions
+ */
+enum class PartitionStrategy : uint8_t { HASH = 0, RANGE };
+
+/**
+ * A PartitionedSqlTable splits the tuples of a table across multiple partitions, each of which is a SqlTable with its
+ * own DataTable, and therefore its own list of blocks and insertion head. Tuples are routed to partitions by the value
+ * of a single partition key column, either by its hash into a fixed number of partitions, or by the range of values it
+ * falls into.
+ *
+ * Since every partition has the same schema, the col_oid to col_id translation is the same for every partition, and
+ * projections generated by this class can be used with any of them. A TupleSlot identifies its partition through the
+ * block it lives in, so operations on existing tuples do not need the partition key.
+ *
+ * Range partitions can be created and dropped at any time, which makes retention of time-based data a matter of
+ * dropping the oldest partition instead of deleting its tuples one by one.
+ */
+class PartitionedSqlTable {
+ public:
+  /**
+   * Constructs a new PartitionedSqlTable. A hash partitioned table is created with all of its partitions. A range
+   * partitioned table starts out with no partitions, and they need to be created with CreateRangePartition.
+   *
+   * @param store the Block store to use.
+   * @param schema the Schema of this table, shared by all partitions
+   * @param oid unique identifier for this table
+   * @param partition_key the column to partition on. For RANGE, it must be an integer column.
+   * @param strategy how tuples are routed to partitions
+   * @param num_hash_partitions number of partitions to create for HASH, must be 0 for RANGE
+   */
+  PartitionedSqlTable(BlockStore *store, const catalog::Schema &schema, catalog::table_oid_t oid,
+                      catalog::col_oid_t partition_key, PartitionStrategy strategy, uint32_t num_hash_partitions = 0);
+
+  /**
+   * Destructs a PartitionedSqlTable, frees all of its partitions.
+   */
+  ~PartitionedSqlTable();
+
+  DISALLOW_COPY_AND_MOVE(PartitionedSqlTable)
+
+  /**
+   * Materializes a single tuple from the given slot, as visible at the timestamp of the calling txn.
+   *
+   * @param txn the calling transaction
+   * @param slot the tuple slot to read
+   * @param out_buffer output buffer. The object should already contain projection list information. @see ProjectedRow.
+   * @return true if tuple is visible to this txn and ProjectedRow has been populated, false otherwise
+   */
+  bool Select(transaction::TransactionContext *const txn, const TupleSlot slot, ProjectedRow *const out_buffer) const {
+    return slot.GetBlock()->data_table_->Select(txn, slot, out_buffer);
+  }
+
+  /**
+   * Update the tuple according to the redo buffer given. The partition key cannot be updated this way, as the tuple
+   * might have to move to a different partition. Do so with a Delete followed by an Insert instead.
+   *
+   * @param txn the calling transaction
+   * @param redo the desired change to be applied. This should be the after-image of the attributes of interest. The
+   * TupleSlot in this RedoRecord must be set to the intended tuple.
+   * @return true if successful, false otherwise
+   */
+  bool Update(transaction::TransactionContext *txn, RedoRecord *redo) const;
+
+  /**
+   * Inserts a tuple, as given in the redo, into the partition its partition key belongs to.
+   *
+   * @param txn the calling transaction
+   * @param redo after-image of the inserted tuple. The TupleSlot in this RedoRecord will be set to the inserted
+   * location.
+   * @return true if successful, false if no partition accepts the tuple's partition key (a null key, or a key outside
+   * of all ranges)
+   */
+  bool Insert(transaction::TransactionContext *txn, RedoRecord *redo) const;
+
+  /**
+   * Deletes the given TupleSlot, this will call StageWrite on the provided txn to generate the RedoRecord for delete.
+   * @param txn the calling transaction
+   * @param slot the slot of the tuple to delete
+   * @return true if successful, false otherwise
+   */
+  bool Delete(transaction::TransactionContext *const txn, const TupleSlot slot) const {
+    return slot.GetBlock()->data_table_->Delete(txn, slot);
+  }
+
+  /**
+   * Creates a new, empty range partition holding keys from lower_bound (inclusive) up to the lower bound of the next
+   * partition (exclusive). The last partition is unbounded above. Tuples whose keys are less than the lowest lower
+   * bound are rejected.
+   * @param lower_bound smallest key of the partition
+   * @return true if the partition was created, false if there already is a partition starting at this bound
+   */
+  bool CreateRangePartition(int64_t lower_bound);
+
+  /**
+   * Drops the range partition starting at the given lower bound, along with all of its tuples. Keys in its range will
+   * belong to the preceding partition from now on. The partition is unlinked right away, but only freed once the GC
+   * has deallocated every transaction that might have accessed it, which requires garbage collection to be running.
+   * @param txn_manager the transaction manager to defer freeing the partition to
+   * @param lower_bound smallest key of the partition
+   * @return true if the partition was dropped, false if no partition starts at this bound
+   */
+  bool DropRangePartition(transaction::TransactionManager *txn_manager, int64_t lower_bound);
+
+  /**
+   * @return the number of partitions in this table
+   */
+  uint32_t NumPartitions() const {
+    common::SharedLatch::ScopedSharedLatch guard(&partitions_latch_);
+    return static_cast<uint32_t>(partitions_.size());
+  }
+
+  /**
+   * @return all partitions of this table
+   */
+  std::vector<SqlTable *> Partitions() const;
+
+  /**
+   * Partition pruning for a predicate of the form low <= key <= high on an integer partition key. Only the partitions
+   * returned can contain tuples satisfying the predicate. For HASH partitioning, only equality (low == high) can be
+   * pruned, for any other range all partitions are returned.
+   * @param low smallest key of interest (inclusive)
+   * @param high largest key of interest (inclusive)
+   * @return partitions that can contain tuples with keys in the given range
+   */
+  std::vector<SqlTable *> PrunePartitions(int64_t low, int64_t high) const;
+
+  /**
+   * Scans the given partitions in parallel, one task per partition on the given worker pool, and hands every batch of
+   * tuples to the consumer. The consumer is called concurrently from different workers, and the ProjectedColumns it is
+   * given are only valid for the duration of the call. Blocks until all partitions are scanned.
+   *
+   * @param txn the calling transaction, which must be read-only (see TransactionManager::BeginReadOnlyTransaction) as
+   *            all workers scan on its behalf
+   * @param partitions partitions to scan, usually from Partitions() or PrunePartitions()
+   * @param col_oids set of col_oids to be projected
+   * @param max_tuples the maximum number of tuples in a batch
+   * @param workers worker pool to run the scans on
+   * @param consumer called with the index of the partition in partitions and each batch of tuples scanned from it
+   * @warning col_oids must be a set (no repeats)
+   */
+  void ParallelScan(transaction::TransactionContext *txn, const std::vector<SqlTable *> &partitions,
+                    const std::vector<catalog::col_oid_t> &col_oids, uint32_t max_tuples, common::WorkerPool *workers,
+                    const std::function<void(uint32_t, ProjectedColumns *)> &consumer) const;
+
+  /**
+   * @return table's unique identifier
+   */
+  catalog::table_oid_t Oid() const { return oid_; }
+
+  /**
+   * Generates an ProjectedColumnsInitializer usable with any of the partitions. @see SqlTable
+   * @param col_oids set of col_oids to be projected
+   * @param max_tuples the maximum number of tuples to store in the ProjectedColumn
+   * @return pair of: initializer to create ProjectedColumns, and a mapping between col_oid and the offset within the
+   * ProjectedColumn
+   * @warning col_oids must be a set (no repeats)
+   */
+  std::pair<ProjectedColumnsInitializer, ProjectionMap> InitializerForProjectedColumns(
+      const std::vector<catalog::col_oid_t> &col_oids, const uint32_t max_tuples) const {
+    return prototype_.InitializerForProjectedColumns(col_oids, max_tuples);
+  }
+
+  /**
+   * Generates an ProjectedRowInitializer usable with any of the partitions. @see SqlTable
+   * @param col_oids set of col_oids to be projected
+   * @return pair of: initializer to create ProjectedRow, and a mapping between col_oid and the offset within the
+   * ProjectedRow
+   * @warning col_oids must be a set (no repeats)
+   */
+  std::pair<ProjectedRowInitializer, ProjectionMap> InitializerForProjectedRow(
+      const std::vector<catalog::col_oid_t> &col_oids) const {
+    return prototype_.InitializerForProjectedRow(col_oids);
+  }
+
+ private:
+  BlockStore *const block_store_;
+  const catalog::Schema schema_;
+  const catalog::table_oid_t oid_;
+  const PartitionStrategy strategy_;
+  // Never holds any tuples. Every partition has the same schema and therefore the same layout and column mapping as
+  // this table, so it is used to generate projections and look up column ids regardless of which partitions exist.
+  const SqlTable prototype_;
+  const col_id_t key_col_id_;
+  const uint8_t key_attr_size_;
+  const bool key_is_varlen_;
+
+  // Partitions keyed by their lower bound for RANGE, and their index for HASH
+  std::map<int64_t, SqlTable *> partitions_;
+  mutable common::SharedLatch partitions_latch_;
+
+  // Returns the partition the key belongs to, or nullptr if there is none. Caller must hold the partitions latch.
+  SqlTable *PartitionForKey(const byte *key) const;
+
+  int64_t ReadIntegerKey(const byte *key) const;
+};
+}  // namespace terrier::storage
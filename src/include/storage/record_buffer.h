@@ -280,6 +280,7 @@ class UndoBuffer {
    */
   ~UndoBuffer() {
     for (auto *segment : buffers_) buffer_pool_->Release(segment);
+    if (warm_segment_ != nullptr) buffer_pool_->Release(warm_segment_);
   }
 
   /**
@@ -309,9 +310,17 @@ class UndoBuffer {
    */
   byte *LastRecord() const { return last_record_; }
 
+  /**
+   * Removes all UndoRecords, so that the buffer can be reused by another transaction. One segment is kept for the
+   * next entries, the others are released back to the buffer pool.
+   */
+  void Reset();
+
  private:
   RecordBufferSegmentPool *buffer_pool_;
   std::vector<RecordBufferSegment *> buffers_;
+  // empty segment handed out before any segment from the buffer pool, or nullptr
+  RecordBufferSegment *warm_segment_ = nullptr;
   byte *last_record_ = nullptr;
 };
 
@@ -332,6 +341,13 @@ class RedoBuffer {
   RedoBuffer(LogManager *log_manager, RecordBufferSegmentPool *buffer_pool)
       : log_manager_(log_manager), buffer_pool_(buffer_pool) {}
 
+  /**
+   * Destructs this buffer, releases the segment it keeps for reuse back to the buffer pool it draws from.
+   */
+  ~RedoBuffer() {
+    if (warm_segment_ != nullptr) buffer_pool_->Release(warm_segment_);
+  }
+
   /**
    * Reserve a redo record with the given size, in bytes. The returned pointer is guaranteed to be valid until NewEntry
    * is called again, or when the buffer is explicitly flushed by the call Finish().
@@ -352,10 +368,24 @@ class RedoBuffer {
    */
   byte *LastRecord() const { return last_record_; }
 
+  /**
+   * Reopens a finalized redo buffer, so that it can be reused by another transaction.
+   */
+  void Reset() {
+    buffer_seg_ = nullptr;
+    last_record_ = nullptr;
+  }
+
  private:
+  // Hands out the segment kept from the last finalize, if any, so that it is not returned to the buffer pool just to
+  // be requested again
+  RecordBufferSegment *NewSegment();
+
   LogManager *const log_manager_;
   RecordBufferSegmentPool *const buffer_pool_;
   RecordBufferSegment *buffer_seg_ = nullptr;
+  // segment that was not handed to the log manager by the last finalize, or nullptr
+  RecordBufferSegment *warm_segment_ = nullptr;
   // reserved for aborts where we will potentially need to garbage collect the last operation (which caused the abort)
   byte *last_record_ = nullptr;
 };
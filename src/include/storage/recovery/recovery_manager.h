@@ -0,0 +1,90 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "catalog/catalog_defs.h"
+#include "storage/sql_table.h"
+#include "storage/storage_defs.h"
+#include "storage/write_ahead_log/log_record.h"
+#include "transaction/transaction_defs.h"
+
+namespace terrier::transaction {
+class TransactionManager;
+}  // namespace terrier::transaction
+
+namespace terrier::storage {
+
+/**
+ * A RecoveryManager rebuilds the state of a set of tables after a crash by replaying the write-ahead log into them,
+ * optionally on top of a checkpoint loaded by the CheckpointManager.
+ *
+ * The log is read back in commit order by a LogReader, which discards the records of transactions that aborted or had
+ * not committed by the time of the crash. Tuples are not loaded back into the slots they were logged with, so the
+ * RecoveryManager keeps a mapping from the slots in the log to the slots tuples were replayed into, and translates the
+ * updates and deletes that follow.
+ *
+ * Replay is parallelized by partitioning the logged slots by their hash. All changes to the same slot go to the same
+ * partition, and every partition replays them in commit order, so partitions can proceed independently of each other.
+ * Every partition replays its part of each logged transaction with a transaction of its own.
+ *
+ * A restarted system appends to the same log files, and transactions of all runs are told apart by their timestamps.
+ * Timestamps therefore have to keep growing across restarts: before the restarted system begins any transaction, its
+ * TransactionManager has to be advanced past the NewestTimestamp of the recovery. Log records also refer to tuples by
+ * the slots they had in the run that logged them, so the restarted system has to take a checkpoint of the recovered
+ * tables before it changes them. The next recovery then starts from that checkpoint, and skips the earlier runs.
+ */
+class RecoveryManager {
+ public:
+  /**
+   * Constructs a new RecoveryManager
+   * @param log_file_paths paths of the files of all streams of the log to recover from (see LogManager::LogFilePaths)
+   * @param txn_manager the transaction manager to replay the log with. Transactions from it should not be logged.
+   * @param num_threads number of threads to replay the log with
+   */
+  RecoveryManager(std::vector<std::string> log_file_paths, transaction::TransactionManager *const txn_manager,
+                  const uint32_t num_threads = 1)
+      : log_file_paths_(std::move(log_file_paths)), txn_manager_(txn_manager), num_threads_(num_threads) {}
+
+  /**
+   * Replays the changes of all transactions in the log that committed after the given checkpoint into the given
+   * tables. Garbage collection should be running for large logs.
+   * @param tables tables to replay the log into. This must include every table with records in the log.
+   * @param slot_map if not nullptr, a mapping from the slots tuples were in when they were logged to their slots in the
+   *                 given tables, as filled in by loading the checkpoint. It is updated with the tuples inserted and
+   *                 deleted during replay.
+   * @param checkpoint_time timestamp of the checkpoint the tables were loaded from, if any. Transactions that committed
+   *                        before it are already contained in the checkpoint, and are skipped.
+   * @return number of transactions replayed
+   * @throws runtime_error if the log cannot be read, or contains records for a table that was not given, in which case
+   *                       nothing is replayed
+   */
+  uint64_t Recover(const std::vector<SqlTable *> &tables, std::unordered_map<TupleSlot, TupleSlot> *slot_map,
+                   transaction::timestamp_t checkpoint_time = transaction::timestamp_t(0));
+
+  /**
+   * @return newest timestamp of the last recovery, out of the timestamps in the log and of the checkpoint. The
+   *         TransactionManager of the restarted system has to be advanced past it (see
+   *         TransactionManager::AdvanceTimestampsPast).
+   */
+  transaction::timestamp_t NewestTimestamp() const { return newest_timestamp_; }
+
+ private:
+  // The changes to a subset of the logged slots
+  struct ReplayPartition {
+    // Records of every logged transaction that touched the partition, in commit order
+    std::vector<std::vector<LogRecord *>> txns_;
+    uint64_t last_txn_ = UINT64_MAX;
+    // Logged slots the partition inserted or deleted (mapped to TupleSlot(nullptr, 0)) during replay
+    std::unordered_map<TupleSlot, TupleSlot> replayed_slots_;
+  };
+
+  const std::vector<std::string> log_file_paths_;
+  transaction::TransactionManager *const txn_manager_;
+  const uint32_t num_threads_;
+  transaction::timestamp_t newest_timestamp_{0};
+
+  void Replay(ReplayPartition *partition, const std::unordered_map<catalog::table_oid_t, SqlTable *> &tables,
+              const std::unordered_map<TupleSlot, TupleSlot> &slot_map);
+};
+}  // namespace terrier::storage
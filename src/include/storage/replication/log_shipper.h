@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+#include "common/macros.h"
+#include "common/strong_typedef.h"
+#include "transaction/transaction_defs.h"
+
+namespace terrier::storage {
+/**
+ * Streams the write-ahead log of a LogManager to a replica (see ReplicaApplier) over a Unix domain socket.
+ *
+ * Once registered with a LogManager, the flusher ships the frames of every group of records it persists, as they were
+ * written to the log files, along with the new persisted watermark. Every transaction committing below the watermark
+ * has all of its records in the batches shipped so far, so the replica can apply exactly those. Along with it goes a
+ * start time older than every transaction still running, so that the replica can tell which transactions aborted
+ * without a trace in the log. Shipping happens after the commits of the group are acknowledged, so replication adds no
+ * latency to commits, but a replica that cannot keep up eventually blocks the flusher.
+ *
+ * If the replica goes away, the shipper logs an error and stops shipping. The primary keeps running, and the replica
+ * has to be rebuilt.
+ */
+class LogShipper {
+ public:
+  /**
+   * Header of every batch sent to the replica, followed by size_ bytes of frames
+   */
+  struct BatchHeader {
+    /**
+     * Number of bytes of frames in the batch
+     */
+    uint64_t size_;
+    /**
+     * Persisted watermark of the primary once the batch was persisted
+     */
+    transaction::timestamp_t watermark_;
+    /**
+     * Every transaction of the primary that began below this time has ended, and if it committed, its commit record is
+     * in the batches shipped so far
+     */
+    transaction::timestamp_t oldest_running_;
+  };
+
+  /**
+   * Connects to a replica
+   * @param socket_path path of the Unix domain socket the replica listens on
+   * @throws runtime_error if the replica cannot be connected to
+   */
+  explicit LogShipper(const std::string &socket_path);
+
+  /**
+   * Disconnects from the replica, which then applies what it was sent and stops
+   */
+  ~LogShipper();
+
+  DISALLOW_COPY_AND_MOVE(LogShipper)
+
+  /**
+   * Sends a batch to the replica. Only called by the flusher of the LogManager the shipper is registered with.
+   * @param frames frames persisted since the last batch, in the order they were written out by each log stream
+   * @param watermark persisted watermark once the frames are persistent
+   * @param oldest_running time below which every transaction that began has ended, once the frames are persistent
+   */
+  void Ship(const std::vector<byte> &frames, transaction::timestamp_t watermark,
+            transaction::timestamp_t oldest_running);
+
+  /**
+   * @return whether batches still reach the replica
+   */
+  bool Connected() const { return fd_ != -1; }
+
+ private:
+  // -1 once the replica went away
+  std::atomic<int> fd_;
+};
+}  // namespace terrier::storage
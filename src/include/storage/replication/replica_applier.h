@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+#include "catalog/catalog_defs.h"
+#include "common/macros.h"
+#include "storage/sql_table.h"
+#include "storage/storage_defs.h"
+#include "storage/write_ahead_log/log_record.h"
+#include "transaction/transaction_defs.h"
+
+namespace terrier::transaction {
+class TransactionManager;
+}  // namespace terrier::transaction
+
+namespace terrier::storage {
+/**
+ * The receiving end of a LogShipper, which maintains a read replica of a set of tables by continuously replaying the
+ * write-ahead log of the primary into tables of its own.
+ *
+ * The applier listens on a Unix domain socket, and a thread of its own receives the batches of log frames shipped by
+ * the primary. Records are grouped by transaction until the persisted watermark shipped along with them passes the
+ * transaction's commit. Every time the watermark advances, all transactions that committed below it are replayed in
+ * commit order with a single transaction on the replica, so a transaction on the replica sees the state of the primary
+ * as of some watermark, never part of a primary transaction or a later transaction without an earlier one. Records
+ * of transactions that began below the oldest running time shipped along with the watermark but did not commit belong
+ * to aborted transactions, and are dropped.
+ *
+ * Like the RecoveryManager, the applier translates the slots tuples were logged with into the slots of their copies in
+ * the replica. The replica starts out empty, so it has to be connected before the primary logs the tables it
+ * replicates. It also has to hold every table the primary logs: like the RecoveryManager, it refuses records of a table
+ * it was not given, and stops replicating rather than silently diverging from the primary.
+ */
+class ReplicaApplier {
+ public:
+  /**
+   * Starts listening for a LogShipper, and applying the batches it ships
+   * @param socket_path path of the Unix domain socket to listen on, which must not exist yet
+   * @param tables tables of the replica, which must have the same oids and schemas as the tables the primary logs
+   * @param txn_manager the transaction manager of the replica. Transactions from it should not be logged.
+   * @throws runtime_error if the socket cannot be listened on
+   */
+  ReplicaApplier(std::string socket_path, const std::vector<SqlTable *> &tables,
+                 transaction::TransactionManager *txn_manager);
+
+  /**
+   * Stops applying (see Stop) and removes the socket
+   */
+  ~ReplicaApplier();
+
+  DISALLOW_COPY_AND_MOVE(ReplicaApplier)
+
+  /**
+   * @return timestamp of the primary such that every transaction that committed on the primary below it is visible to
+   *         transactions beginning on the replica, and no other transaction is
+   */
+  transaction::timestamp_t VisibleTimestamp() const { return visible_timestamp_.load(); }
+
+  /**
+   * @return number of primary transactions applied to the replica so far
+   */
+  uint64_t NumApplied() const { return num_applied_.load(); }
+
+  /**
+   * Blocks until the given transaction of the primary is visible on the replica, or replication stopped because the
+   * primary disconnected or shipped records the replica cannot apply
+   * @param commit_time commit timestamp of a transaction on the primary that has committed
+   * @return whether the transaction is visible
+   */
+  bool WaitForVisible(transaction::timestamp_t commit_time);
+
+  /**
+   * Stops listening and applying. Batches that were not received yet are lost, so a primary that is done should
+   * disconnect its shipper first, and be waited for with WaitForVisible.
+   */
+  void Stop();
+
+ private:
+  // The connection is STOPPED once Stop() is called, and NOT_CONNECTED before the primary connects
+  static constexpr int NOT_CONNECTED = -1, STOPPED = -2;
+
+  const std::string socket_path_;
+  std::unordered_map<catalog::table_oid_t, SqlTable *> tables_;
+  transaction::TransactionManager *const txn_manager_;
+  int listen_fd_;
+  std::atomic<int> connection_fd_{NOT_CONNECTED};
+
+  // Only accessed by the applier thread
+  // Records received so far, by the begin timestamp of the transaction they belong to
+  std::unordered_map<transaction::timestamp_t, std::vector<LogRecord *>> pending_txns_;
+  // Maps the slots tuples were logged with to their slots in the replica
+  std::unordered_map<TupleSlot, TupleSlot> slot_map_;
+  std::vector<byte> batch_, decompressed_;
+
+  std::atomic<transaction::timestamp_t> visible_timestamp_{transaction::timestamp_t(0)};
+  std::atomic<uint64_t> num_applied_{0};
+  std::mutex visible_latch_;
+  // Notified whenever the visible timestamp advances, or the primary disconnects
+  std::condition_variable visible_cv_;
+  bool disconnected_ = false;
+
+  std::thread applier_thread_;
+
+  void ApplierThreadLoop();
+
+  // Deserializes the records of every frame in the batch into the pending transactions, and returns whether the batch
+  // was well-formed
+  bool ReceiveBatch();
+
+  // Applies every pending transaction that committed below the watermark in a single transaction, and makes them
+  // visible. Drops the pending transactions that aborted, according to the oldest running time. Returns false without
+  // applying any of them if one of them wrote to a table the replica does not hold.
+  bool ApplyUpTo(transaction::timestamp_t watermark, transaction::timestamp_t oldest_running);
+};
+}  // namespace terrier::storage
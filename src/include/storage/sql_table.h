@@ -110,6 +110,32 @@ class SqlTable {
     return table_.data_table->Scan(txn, start_pos, out_buffer);
   }
 
+  /**
+   * Creates an iterator over a random sample of the slots in the table, e.g. for ANALYZE or TABLESAMPLE.
+   *
+   * @param method sampling method to use
+   * @param rate probability of each tuple (BERNOULLI) or block (SYSTEM) being part of the sample, between 0 and 1
+   * @param seed seed for the random number generator
+   * @return iterator to the first slot in the sample
+   */
+  DataTable::SampleIterator BeginSample(const SamplingMethod method, const double rate, const uint64_t seed) const {
+    return table_.data_table->BeginSample(method, rate, seed);
+  }
+
+  /**
+   * Scans the random sample given by the iterator and materializes as many tuples as would fit into the given buffer,
+   * as visible to the transaction given. See DataTable::SampleScan.
+   *
+   * @param txn the calling transaction
+   * @param sample iterator over the sample to scan, mutated to point to the next sampled slot not yet scanned
+   * @param out_buffer output buffer. The object should already contain projection list information. This buffer is
+   *                   always cleared of old values.
+   */
+  void SampleScan(transaction::TransactionContext *const txn, DataTable::SampleIterator *const sample,
+                  ProjectedColumns *const out_buffer) const {
+    return table_.data_table->SampleScan(txn, sample, out_buffer);
+  }
+
   /**
    * @return table's unique identifier
    */
@@ -172,6 +198,10 @@ class SqlTable {
   }
 
  private:
+  // The RecoveryManager and ReplicaApplier need the layout of the table to know which values of a logged tuple are
+  // varlen
+  friend class RecoveryManager;
+  friend class ReplicaApplier;
   BlockStore *const block_store_;
   const catalog::table_oid_t oid_;
 
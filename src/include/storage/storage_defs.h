@@ -202,9 +202,21 @@ enum class DeltaRecordType : uint8_t { UPDATE = 0, INSERT, DELETE };
  */
 enum class LogRecordType : uint8_t { REDO = 1, DELETE, COMMIT };
 
+/**
+ * Methods of drawing a random sample from a table. BERNOULLI includes every tuple independently with the sampling
+ * rate as probability, SYSTEM does the same with whole blocks. SYSTEM sampling is cheaper as it only touches the chosen
+ * blocks, but the sample is less random as tuples in the same block are correlated.
+ */
+enum class SamplingMethod : uint8_t { BERNOULLI = 0, SYSTEM };
+
 /**
  * A varlen entry is always a 32-bit size field and the varlen content,
  * with exactly size many bytes (no extra nul in the end).
+ *
+ * Values larger than InlineThreshold() are stored out-of-line, and the 16-byte entry only holds a reference to them
+ * (plus a prefix for quick comparisons). Tuples, undo records, redo records and ProjectedRows therefore only ever copy
+ * the entry, never the content, regardless of how large the value is. An update that does not touch a varlen column
+ * does not carry it in its delta, and a read that does not project it never dereferences the content pointer.
  */
 class VarlenEntry {
  public:
@@ -314,7 +326,13 @@ struct VarlenContentDeepEqual {
    */
   bool operator()(const VarlenEntry &lhs, const VarlenEntry &rhs) const {
     if (lhs.Size() != rhs.Size()) return false;
-    // TODO(Tianyu): Can optimize using prefixes
+    // The prefix is stored within the entry itself, so a mismatch there saves us from touching out-of-line content
+    if (lhs.Size() >= VarlenEntry::PrefixSize() &&
+        std::memcmp(lhs.Prefix(), rhs.Prefix(), VarlenEntry::PrefixSize()) != 0)
+      return false;
+    // Two entries referencing the same out-of-line buffer (e.g. copied around by updates to other columns) are equal
+    // without needing to scan through the content.
+    if (lhs.Content() == rhs.Content()) return true;
     return std::memcmp(lhs.Content(), rhs.Content(), lhs.Size()) == 0;
   }
 };
@@ -341,6 +359,11 @@ struct VarlenContentCompare {
    * @return whether lhs < rhs in lexicographic order
    */
   bool operator()(const VarlenEntry &lhs, const VarlenEntry &rhs) const {
+    // Try to decide on the prefixes first to avoid touching out-of-line content
+    if (lhs.Size() >= VarlenEntry::PrefixSize() && rhs.Size() >= VarlenEntry::PrefixSize()) {
+      int prefix_res = std::memcmp(lhs.Prefix(), rhs.Prefix(), VarlenEntry::PrefixSize());
+      if (prefix_res != 0) return prefix_res < 0;
+    }
     // Compare up to the minimum of the two sizes
     int res = std::memcmp(lhs.Content(), rhs.Content(), std::min(lhs.Size(), rhs.Size()));
     if (res == 0) {
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "common/hyper_log_log.h"
+#include "common/macros.h"
+#include "storage/block_layout.h"
+#include "storage/storage_defs.h"
+
+namespace terrier::storage {
+
+/**
+ * Statistics about the committed values of a single column in a DataTable, maintained incrementally as transactions
+ * commit. Readers see the effect of every transaction that committed before the read began, and possibly some that
+ * are committing concurrently; the numbers are meant for estimation, not for exact answers.
+ *
+ * Null counts track deletes and updates precisely. The distinct value estimate and min/max only ever grow, as neither
+ * can be maintained under removal without rescanning the table, so they describe all values ever committed to
+ * the column.
+ */
+class ColumnStatistics {
+ public:
+  /**
+   * Constructs empty statistics for a column
+   * @param attr_size size of the column, as given by BlockLayout
+   * @param is_varlen whether the column is varlen
+   */
+  ColumnStatistics(const uint8_t attr_size, const bool is_varlen) : attr_size_(attr_size), is_varlen_(is_varlen) {
+    TERRIER_ASSERT(is_varlen || attr_size == 1 || attr_size == 2 || attr_size == 4 || attr_size == 8,
+                   "fixed-length columns are read as integers");
+  }
+
+  DISALLOW_COPY_AND_MOVE(ColumnStatistics)
+
+  /**
+   * @return number of committed, visible null values in the column
+   */
+  int64_t NullCount() const { return null_count_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return estimate of the number of distinct non-null values committed to the column
+   */
+  uint64_t DistinctValues() const { return distinct_values_.Estimate(); }
+
+  /**
+   * Min and max are tracked for fixed-length columns, on the raw value interpreted as a signed integer of the
+   * column's size. The storage layer is oblivious to SQL types, so it is up to the caller to decide whether this
+   * ordering is meaningful for the column's type.
+   * @return whether this column has a min and max value
+   */
+  bool HasMinMax() const { return !is_varlen_ && Min() <= Max(); }
+
+  /**
+   * @return smallest non-null value committed to the column. Only meaningful if HasMinMax() is true
+   */
+  int64_t Min() const { return min_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return largest non-null value committed to the column. Only meaningful if HasMinMax() is true
+   */
+  int64_t Max() const { return max_.load(std::memory_order_relaxed); }
+
+ private:
+  friend class DataTable;
+  const uint8_t attr_size_;
+  const bool is_varlen_;
+  std::atomic<int64_t> null_count_{0};
+  common::HyperLogLog distinct_values_;
+  std::atomic<int64_t> min_{std::numeric_limits<int64_t>::max()};
+  std::atomic<int64_t> max_{std::numeric_limits<int64_t>::min()};
+
+  // Folds a new committed value (after-image) into the statistics. value is nullptr for a SQL null
+  void AddValue(const byte *const value) {
+    if (value == nullptr) {
+      null_count_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (is_varlen_) {
+      auto *const entry = reinterpret_cast<const VarlenEntry *>(value);
+      distinct_values_.Add(entry->Content(), entry->Size());
+      return;
+    }
+    distinct_values_.Add(value, attr_size_);
+    const int64_t val = ReadSigned(value);
+    int64_t curr = min_.load(std::memory_order_relaxed);
+    while (val < curr && !min_.compare_exchange_weak(curr, val, std::memory_order_relaxed)) {
+    }
+    curr = max_.load(std::memory_order_relaxed);
+    while (val > curr && !max_.compare_exchange_weak(curr, val, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Removes a value that is no longer visible (before-image). value is nullptr for a SQL null
+  void RemoveValue(const byte *const value) {
+    if (value == nullptr) null_count_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  int64_t ReadSigned(const byte *const value) const {
+    switch (attr_size_) {
+      case 1:
+        return *reinterpret_cast<const int8_t *>(value);
+      case 2:
+        return *reinterpret_cast<const int16_t *>(value);
+      case 4:
+        return *reinterpret_cast<const int32_t *>(value);
+      default:
+        TERRIER_ASSERT(attr_size_ == 8, "checked by the constructor");
+        return *reinterpret_cast<const int64_t *>(value);
+    }
+  }
+};
+
+/**
+ * Statistics about the committed contents of a DataTable, maintained incrementally as transactions commit so they can
+ * be read by the optimizer without scanning the table. See ColumnStatistics for the consistency guarantees.
+ */
+class TableStatistics {
+ public:
+  /**
+   * Constructs empty statistics for a table
+   * @param layout layout of the table
+   */
+  explicit TableStatistics(const BlockLayout &layout) {
+    columns_.reserve(layout.NumColumns());
+    for (uint16_t i = 0; i < layout.NumColumns(); i++) {
+      const col_id_t col_id(i);
+      // Reserved columns are not visible to upper levels, and we do not keep statistics for them
+      columns_.emplace_back(i < NUM_RESERVED_COLUMNS
+                                ? nullptr
+                                : new ColumnStatistics(layout.AttrSize(col_id), layout.IsVarlen(col_id)));
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(TableStatistics)
+
+  /**
+   * @return number of committed, visible tuples in the table
+   */
+  int64_t NumTuples() const { return num_tuples_.load(std::memory_order_relaxed); }
+
+  /**
+   * @param col_id id of the column. Must not be a reserved column
+   * @return statistics of the given column
+   */
+  const ColumnStatistics &GetColumnStatistics(const col_id_t col_id) const {
+    TERRIER_ASSERT((!col_id) >= NUM_RESERVED_COLUMNS && (!col_id) < columns_.size(), "column id out of range");
+    return *columns_[!col_id];
+  }
+
+ private:
+  friend class DataTable;
+  std::atomic<int64_t> num_tuples_{0};
+  std::vector<std::unique_ptr<ColumnStatistics>> columns_;
+
+  ColumnStatistics *MutableColumnStatistics(const col_id_t col_id) { return columns_[!col_id].get(); }
+};
+}  // namespace terrier::storage
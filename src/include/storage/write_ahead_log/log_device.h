@@ -0,0 +1,318 @@
+#pragma once
+#include <sys/uio.h>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "common/allocator.h"
+#include "common/macros.h"
+#include "storage/write_ahead_log/log_io.h"
+
+namespace terrier::storage {
+/**
+ * Kinds of LogDevice a LogManager can write its log streams to
+ */
+enum class LogDeviceType : uint8_t {
+  /** Buffered appends and fsync (PosixLogDevice) */
+  POSIX,
+  /** O_DIRECT writes into a preallocated file and fdatasync (DirectLogDevice) */
+  DIRECT,
+  /** Asynchronous writes and fdatasync through io_uring (IoUringLogDevice) */
+  IO_URING,
+  /** Discards appends, and syncs immediately (NullLogDevice) */
+  NULL_DEVICE,
+  /** Copies appends into a ring buffer in memory, and syncs immediately (MemoryLogDevice) */
+  MEMORY,
+  /** Copies appends into a ring buffer in memory, and syncs after a simulated latency (SimulatedLogDevice) */
+  SIMULATED
+};
+
+/**
+ * Distribution of the latency of the syncs of a SimulatedLogDevice. Latencies are log-normally distributed, like those
+ * of real devices, with the long tail given by the 99th percentile.
+ */
+struct SimulatedSyncLatency {
+  /**
+   * Median latency of a sync
+   */
+  std::chrono::microseconds median_{200};
+  /**
+   * 99th percentile latency of a sync. If it is not above the median, every sync takes the median latency.
+   */
+  std::chrono::microseconds p99_{1000};
+};
+
+/**
+ * A LogDevice is the file a single log stream is written to. It decouples the LogManager from the way records reach
+ * the disk, so that different I/O strategies can be plugged in.
+ *
+ * Appends are issued by one thread (the stream's serializer), while syncs may be issued concurrently by another thread
+ * (the flusher). A sync makes persistent at least every append that completed before the sync was started. Syncs are
+ * split into a start and a finish, so that the flusher can start syncs on the devices of all streams before waiting
+ * on any of them.
+ */
+class LogDevice {
+ public:
+  virtual ~LogDevice() = default;
+
+  /**
+   * Opens a log device of the given type. If io_uring is not supported by the kernel, a PosixLogDevice is opened
+   * instead.
+   * @param type type of the device
+   * @param path path to the log file. If it exists, the log is appended to its end. Devices that do not write files
+   *             only use it to seed their simulated latencies, so that every run of a benchmark sees the same ones.
+   * @param expected_size number of bytes expected to be written to the file, or 0 if unknown. Devices that preallocate
+   *                      their files use it as their preallocation size.
+   * @param sync_latency distribution of the sync latency of a SimulatedLogDevice
+   * @return the opened device
+   * @throws runtime_error if the log file cannot be opened
+   */
+  static std::unique_ptr<LogDevice> Open(LogDeviceType type, const std::string &path, uint64_t expected_size = 0,
+                                         const SimulatedSyncLatency &sync_latency = SimulatedSyncLatency());
+
+  /**
+   * @param name name of a device type, i.e. "posix", "direct", "io_uring", "null", "memory" or "simulated"
+   * @return the device type with the given name
+   * @throws runtime_error if there is no device type with the given name
+   */
+  static LogDeviceType TypeFromString(const std::string &name);
+
+  /**
+   * @param type type of a device
+   * @return whether devices of the given type write the log to a file, which can be read back. The other devices are
+   *         meant for benchmarking the LogManager without a disk.
+   */
+  static bool WritesFile(LogDeviceType type) { return type <= LogDeviceType::IO_URING; }
+
+  /**
+   * Appends the given memory regions to the log, in order. The append may still be in progress when the call returns,
+   * so the regions must stay valid until the next call to Append or WaitForAppends returns.
+   * @param iov memory regions to append. The array itself may be modified or reused once the call returns.
+   * @param iovcnt number of memory regions
+   */
+  virtual void Append(struct iovec *iov, size_t iovcnt) = 0;
+
+  /**
+   * Waits for all appends to complete, such that the next sync covers them
+   */
+  virtual void WaitForAppends() {}
+
+  /**
+   * Starts making all appends that completed so far persistent. Must be followed by a call to FinishSync before the
+   * next sync is started.
+   */
+  virtual void StartSync() {}
+
+  /**
+   * Waits for the sync started last to make its appends persistent
+   */
+  virtual void FinishSync() = 0;
+
+  /**
+   * Makes all appends that completed so far persistent
+   */
+  void Sync() {
+    StartSync();
+    FinishSync();
+  }
+
+  /**
+   * Must be called before the device is destructed, once all appends and syncs are done.
+   */
+  virtual void Close() = 0;
+};
+
+/**
+ * Appends through the page cache with writev, and calls fsync.
+ */
+class PosixLogDevice : public LogDevice {
+ public:
+  /**
+   * @param path path to the log file
+   */
+  explicit PosixLogDevice(const std::string &path) : out_(path.c_str()) {}
+
+  void Append(struct iovec *iov, size_t iovcnt) override { out_.WriteGather(iov, iovcnt); }
+
+  void FinishSync() override { out_.Sync(); }
+
+  void Close() override { out_.Close(); }
+
+ private:
+  BufferedLogWriter out_;
+};
+
+/**
+ * Writes with O_DIRECT into a log file that is preallocated with fallocate in fixed-size extents, and calls fdatasync.
+ *
+ * O_DIRECT bypasses the page cache, but only writes whole blocks from aligned memory, so appends are copied into an
+ * aligned staging buffer and written out padded with zeros. The last, partially filled block is written again by the
+ * next append. Since the file is preallocated, its size only changes once per extent, and fdatasync does not have to
+ * persist any file metadata for the appends in between. The end of the file is padded with zeros, which LogReader
+ * skips over.
+ */
+class DirectLogDevice : public LogDevice {
+ public:
+  /**
+   * Size of the blocks O_DIRECT writes are aligned to
+   */
+  static constexpr uint32_t IO_BLOCK_SIZE = 1 << 12;
+
+  /**
+   * Default size of the extents the log file is preallocated in
+   */
+  static constexpr uint64_t DEFAULT_EXTENT_SIZE = 1 << 26;
+
+  /**
+   * Size of the staging buffer appends are copied into
+   */
+  static constexpr uint32_t STAGING_SIZE = 1 << 20;
+
+  /**
+   * @param path path to the log file. If it exists, appends resume at the block after the last non-zero block.
+   * @param extent_size number of bytes the log file is extended by when it is full
+   * @throws runtime_error if the file system does not support O_DIRECT or fallocate
+   */
+  explicit DirectLogDevice(const std::string &path, uint64_t extent_size = DEFAULT_EXTENT_SIZE);
+
+  ~DirectLogDevice() override;
+
+  DISALLOW_COPY_AND_MOVE(DirectLogDevice)
+
+  void Append(struct iovec *iov, size_t iovcnt) override;
+
+  void FinishSync() override;
+
+  void Close() override { PosixIoWrappers::Close(fd_); }
+
+ private:
+  int fd_;
+  const uint64_t extent_size_;
+  uint64_t allocated_size_;
+  // Block-aligned file offset the staging buffer is written to
+  uint64_t write_offset_ = 0;
+  byte *staging_;
+  // Number of bytes in the staging buffer. Between appends, this is the partially filled last block.
+  uint32_t staged_ = 0;
+
+  // Writes out the staging buffer, and keeps only its partially filled last block
+  void WriteStaged();
+};
+
+// The io_uring instance of an IoUringLogDevice
+class IoUring;
+
+/**
+ * Submits writes and fdatasync calls through io_uring, so that the serializer can go on serializing the next batch of
+ * records while the previous one is being written. Appends and syncs are submitted to two separate rings, as they are
+ * issued from different threads.
+ */
+class IoUringLogDevice : public LogDevice {
+ public:
+  /**
+   * @param path path to the log file
+   * @throws runtime_error if the kernel does not support io_uring
+   */
+  explicit IoUringLogDevice(const std::string &path);
+
+  ~IoUringLogDevice() override;
+
+  DISALLOW_COPY_AND_MOVE(IoUringLogDevice)
+
+  void Append(struct iovec *iov, size_t iovcnt) override;
+
+  void WaitForAppends() override;
+
+  void StartSync() override;
+
+  void FinishSync() override;
+
+  void Close() override { PosixIoWrappers::Close(fd_); }
+
+ private:
+  int fd_;
+  uint64_t write_offset_;
+  std::unique_ptr<IoUring> append_ring_, sync_ring_;
+  // Memory regions of the append in progress, starting at append_offset_
+  std::vector<iovec> in_flight_;
+  uint64_t append_offset_ = 0, append_size_ = 0;
+  bool append_in_flight_ = false;
+};
+
+/**
+ * Discards appends and syncs immediately, so that the cost of producing the log can be measured without the cost of
+ * writing it anywhere.
+ */
+class NullLogDevice : public LogDevice {
+ public:
+  void Append(struct iovec *iov, size_t iovcnt) override {}
+
+  void FinishSync() override {}
+
+  void Close() override {}
+};
+
+/**
+ * Copies appends into a ring buffer in memory, overwriting the oldest bytes once it is full, and syncs immediately.
+ * Appending costs about as much as appending to the page cache does, without any of the cost or variance of a disk.
+ */
+class MemoryLogDevice : public LogDevice {
+ public:
+  /**
+   * Default size of the ring buffer
+   */
+  static constexpr uint64_t DEFAULT_CAPACITY = 1 << 22;
+
+  /**
+   * @param capacity size of the ring buffer
+   */
+  explicit MemoryLogDevice(uint64_t capacity = DEFAULT_CAPACITY) : ring_(capacity) {}
+
+  void Append(struct iovec *iov, size_t iovcnt) override;
+
+  void FinishSync() override {}
+
+  void Close() override {}
+
+  /**
+   * @return number of bytes appended so far
+   */
+  uint64_t BytesAppended() const { return bytes_appended_; }
+
+  /**
+   * @return the ring buffer, which holds byte i of the log at i modulo its size, unless it was overwritten since
+   */
+  const std::vector<byte> &Ring() const { return ring_; }
+
+ private:
+  std::vector<byte> ring_;
+  uint64_t bytes_appended_ = 0;
+};
+
+/**
+ * A MemoryLogDevice whose syncs take as long as syncs of a real device might, with latencies drawn from a given
+ * distribution by a pseudo-random generator with a fixed seed. This makes the effect of sync latency on group commit
+ * reproducible on any machine. Syncs started on several devices wait out their latencies in parallel.
+ */
+class SimulatedLogDevice : public MemoryLogDevice {
+ public:
+  /**
+   * @param sync_latency distribution of the sync latency
+   * @param seed seed of the generator the latencies are drawn with
+   */
+  SimulatedLogDevice(const SimulatedSyncLatency &sync_latency, uint64_t seed);
+
+  void StartSync() override;
+
+  void FinishSync() override;
+
+ private:
+  std::mt19937_64 generator_;
+  std::lognormal_distribution<double> latency_us_;
+  // Whether every sync takes the median latency
+  const bool constant_;
+  const std::chrono::microseconds median_;
+  std::chrono::steady_clock::time_point sync_done_;
+};
+}  // namespace terrier::storage
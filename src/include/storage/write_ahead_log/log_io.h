@@ -7,6 +7,7 @@
 #include <cerrno>
 #include <cstring>
 #include <string>
+#include <vector>
 #include "common/macros.h"
 #include "loggers/storage_logger.h"
 
@@ -69,7 +70,95 @@ struct PosixIoWrappers {
    * @throws runtime_error if the underlying posix call failed
    */
   static void WriteFully(int fd, const void *buf, size_t nbyte);
+
+  /**
+   * Wrapper around the posix writev call, where a single function call will always write all of the given memory
+   * regions out, in order.
+   * @param fd posix fildes arg
+   * @param iov posix iov arg. The array is modified to keep track of partial writes.
+   * @param iovcnt number of memory regions in iov, which can exceed IOV_MAX
+   * @throws runtime_error if the underlying posix call failed
+   */
+  static void WriteVFully(int fd, struct iovec *iov, size_t iovcnt);
+
+  /**
+   * Wrapper around the posix pwritev call, where a single function call will always write all of the given memory
+   * regions out, in order, starting at the given offset.
+   * @param fd posix fildes arg
+   * @param iov posix iov arg. The array is modified to keep track of partial writes.
+   * @param iovcnt number of memory regions in iov, which can exceed IOV_MAX
+   * @param offset posix offset arg
+   * @throws runtime_error if the underlying posix call failed
+   */
+  static void PWriteVFully(int fd, struct iovec *iov, size_t iovcnt, off_t offset);
 };
+/**
+ * Header of a frame of log records. The LogManager writes every region of serialized records out as a frame, made up
+ * of this header followed by the records, either as they are or compressed in the LZ4 block format. Frames always hold
+ * whole records, and their checksum lets readers tell a frame torn by a crash apart from valid data (see
+ * BufferedLogReader).
+ */
+struct LogFrameHeader {
+  /**
+   * Marks the start of a frame. It is neither zero, a log record type, nor the first byte of a segment header, so a
+   * frame cannot be mistaken for anything else in the log.
+   */
+  static constexpr uint8_t MARKER = 0xCF;
+
+  /**
+   * Always MARKER
+   */
+  uint8_t marker_ = MARKER;
+  /**
+   * 1 if the records are compressed, 0 if they follow the header as they are
+   */
+  uint8_t compressed_ = 0;
+  /**
+   * Unused
+   */
+  uint8_t padding_[2] = {};
+  /**
+   * Number of bytes following the header
+   */
+  uint32_t payload_size_ = 0;
+  /**
+   * Number of bytes of records in the frame, once decompressed
+   */
+  uint32_t records_size_ = 0;
+  /**
+   * CRC32C of all of the fields above but the marker, and of the payload
+   */
+  uint32_t checksum_ = 0;
+
+  /**
+   * @param records records to write out as they are, right after the header
+   * @param size number of bytes of records
+   * @return header of the frame
+   */
+  static LogFrameHeader Uncompressed(const void *records, uint32_t size);
+
+  /**
+   * @param size number of bytes of records to compress
+   * @return maximum size of the frame the records compress to
+   */
+  static uint32_t MaxFrameSize(uint32_t size);
+
+  /**
+   * Compresses a region of serialized records into a frame
+   * @param records the records to compress
+   * @param size number of bytes of records
+   * @param out buffer of at least MaxFrameSize(size) bytes to write the frame to
+   * @return size of the frame, or 0 if the records do not compress to less than their size, in which case they are
+   *         better written out uncompressed
+   */
+  static uint32_t Compress(const void *records, uint32_t size, void *out);
+
+  /**
+   * @return checksum of the frame with this header and the given payload
+   */
+  uint32_t ComputeChecksum(const void *payload) const;
+};
+
 // TODO(Tianyu):  we need control over when and what to flush as the log manager. Thus, we need to write our
 // own wrapper around lower level I/O functions. I could be wrong, and in that case we should
 // revert to using STL.
@@ -77,7 +166,6 @@ struct PosixIoWrappers {
  * Handles buffered writes to the write ahead log, and provides control over flushing.
  */
 class BufferedLogWriter {
-  // TODO(Tianyu): Checksum
  public:
   /**
    * Instantiates a new BufferedLogWriter to write to the specified log file.
@@ -112,11 +200,39 @@ class BufferedLogWriter {
     }
   }
 
+  /**
+   * Write to the log file the given memory regions, in order, without copying them into the buffer. Any buffered writes
+   * are written out first. Like a flushed buffer, the regions are only guaranteed to be persistent after a Sync.
+   * @param iov memory regions to write. The array is modified in the process.
+   * @param iovcnt number of memory regions
+   */
+  void WriteGather(struct iovec *iov, size_t iovcnt) {
+    FlushBuffer();
+    PosixIoWrappers::WriteVFully(out_, iov, iovcnt);
+  }
+
   /**
    * Flush any buffered writes and call fsync to make sure that all writes are consistent.
    */
   void Persist() {
     FlushBuffer();
+    Sync();
+  }
+
+  /**
+   * Hands any buffered writes to the OS without waiting for them to be persistent.
+   */
+  void FlushBuffer() {
+    WriteUnsynced(buffer_, buffer_size_);
+    buffer_size_ = 0;
+  }
+
+  /**
+   * Call fsync to make sure that all writes flushed out of the buffer so far are persistent. Safe to call concurrently
+   * with BufferWrite and FlushBuffer from a different thread, in which case writes concurrent with the call may or may
+   * not be persisted by it.
+   */
+  void Sync() {
     if (fsync(out_) == -1) throw std::runtime_error("fsync failed with errno " + std::to_string(errno));
   }
 
@@ -128,29 +244,42 @@ class BufferedLogWriter {
   bool CanBuffer(uint32_t size) { return BUFFER_SIZE - buffer_size_ >= size; }
 
   void WriteUnsynced(const void *data, uint32_t size) { PosixIoWrappers::WriteFully(out_, data, size); }
-
-  void FlushBuffer() {
-    WriteUnsynced(buffer_, buffer_size_);
-    buffer_size_ = 0;
-  }
 };
 
 /**
- * Buffered reads from the write ahead log
+ * Buffered reads from the write ahead log. Frames of records (see LogFrameHeader) are checked and decompressed when
+ * SkipPadding reaches them, and their records are read from the frame. A crash in the middle of a write can leave a
+ * torn write at the end of the log: a frame cut short, one that fails its checksum, or bytes that do not start a
+ * frame. Everything from a torn write on is treated as the end of the log.
  */
 class BufferedLogReader {
-  // TODO(Tianyu): Checksum
  public:
   /**
    * Instantiates a new BufferedLogReader to read from the specified log file.
    * @param log_file_path path to the the log file to read from.
    */
-  explicit BufferedLogReader(const char *log_file_path) : in_(PosixIoWrappers::Open(log_file_path, O_RDONLY)) {}
+  explicit BufferedLogReader(const char *log_file_path) : in_(PosixIoWrappers::Open(log_file_path, O_RDONLY)) {
+    struct stat file_stat;
+    if (fstat(in_, &file_stat) == -1) {
+      close(in_);
+      throw std::runtime_error("fstat failed with errno " + std::to_string(errno));
+    }
+    file_size_ = static_cast<uint64_t>(file_stat.st_size);
+  }
+
+  /**
+   * Closes the underlying log file if the reader stopped before reaching its end
+   */
+  ~BufferedLogReader() {
+    if (in_ != -1) close(in_);
+  }
+
+  DISALLOW_COPY_AND_MOVE(BufferedLogReader)
 
   /**
    * @return if there are contents left in the write ahead log
    */
-  bool HasMore() { return filled_size_ > read_head_ || in_ != -1; }
+  bool HasMore() { return frame_head_ < frame_.size() || filled_size_ > read_head_ || in_ != -1; }
 
   /**
    * Read the specified number of bytes into the target location from the write ahead log. The method reads as many as
@@ -163,6 +292,24 @@ class BufferedLogReader {
    */
   bool Read(void *dest, uint32_t size);
 
+  /**
+   * Skips over zero bytes in the log, up to the next non-zero byte or the end of the log. Log devices that write in
+   * whole blocks pad the log with zeros. This must be called before reading each record, so that frames of compressed
+   * records are decompressed.
+   */
+  void SkipPadding();
+
+  /**
+   * @return whether the log ended at a torn write, rather than the end of the file
+   */
+  bool EndedAtTornWrite() const { return torn_; }
+
+  /**
+   * @return number of bytes at the start of the log file up to the end of the last frame read intact. If the log ended
+   *         at a torn write, the file can be truncated to this size to cut the torn write off.
+   */
+  uint64_t IntactSize() const { return intact_size_; }
+
   /**
    * Read a value of the specified type from the log. An exception is thrown if the log file does not
    * have enough bytes left for a well formed value
@@ -181,6 +328,16 @@ class BufferedLogReader {
   int in_;  // or -1 if closed
   uint32_t read_head_ = 0, filled_size_ = 0;
   char buffer_[BUFFER_SIZE];
+  uint64_t file_size_;
+  // Number of bytes read from the file into the buffer so far
+  uint64_t file_offset_ = 0;
+  uint64_t intact_size_ = 0;
+  bool torn_ = false;
+  // Records of the frame being read
+  std::vector<char> frame_;
+  uint32_t frame_head_ = 0;
+  // Payload of the frame being read
+  std::vector<char> payload_;
 
   void ReadFromBuffer(void *dest, uint32_t size) {
     TERRIER_ASSERT(read_head_ + size <= filled_size_, "Not enough bytes in buffer for the read");
@@ -189,5 +346,14 @@ class BufferedLogReader {
   }
 
   void RefillBuffer();
+
+  // Offset in the file of the read head
+  uint64_t Offset() const { return file_offset_ - (filled_size_ - read_head_); }
+
+  // Reads the frame starting at the read head, or ends the log at a torn write if it is not intact
+  void ReadFrame();
+
+  // Stops reading at a torn write, discarding what is left of the log
+  void EndLog();
 };
 }  // namespace terrier::storage
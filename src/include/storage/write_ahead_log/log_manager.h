@@ -1,21 +1,133 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <utility>
 #include <vector>
 #include "common/spin_latch.h"
 #include "common/strong_typedef.h"
 #include "storage/record_buffer.h"
+#include "storage/replication/log_shipper.h"
+#include "storage/write_ahead_log/log_device.h"
 #include "storage/write_ahead_log/log_io.h"
 #include "storage/write_ahead_log/log_record.h"
+#include "storage/write_ahead_log/log_segment.h"
 #include "transaction/transaction_defs.h"
 
+namespace terrier::transaction {
+class TransactionManager;
+}  // namespace terrier::transaction
+
 namespace terrier::storage {
+/**
+ * Tunables of a LogManager. Every field has a sensible default, so callers only set the ones they care about.
+ */
+struct LogManagerOptions {
+  /**
+   * Time the serializer threads sleep between two rounds of serialization
+   */
+  std::chrono::microseconds serialization_interval_{100};
+  /**
+   * Maximum time between two flushes, i.e. the group commit window
+   */
+  std::chrono::microseconds flush_interval_{1000};
+  /**
+   * Number of bytes written after which a flush happens without waiting for the flush interval
+   */
+  uint64_t flush_threshold_ = 1 << 20;
+  /**
+   * Number of log streams. With more than one stream, each stream writes to its own file, named as given by
+   * LogManager::StreamFilePath, and the TransactionManager must be registered (which it does on construction) before
+   * any transaction commits.
+   */
+  uint32_t num_streams_ = 1;
+  /**
+   * Number of bytes serialized after which they are written out with a single gather write, even if the serializer is
+   * not done. Serialized records are held on to until written, so this bounds the memory of a stream.
+   */
+  uint64_t write_batch_size_ = 1 << 20;
+  /**
+   * Kind of LogDevice the streams are written to. Devices that do not write files (see LogDevice::WritesFile) do not
+   * produce a log that can be recovered from, and are meant for benchmarking.
+   */
+  LogDeviceType device_type_ = LogDeviceType::POSIX;
+  /**
+   * If not 0, every stream is split into segments of about this many bytes, written to the files named by
+   * LogSegmentHeader::FilePath. A segment can exceed this size by the records serialized in one round of serialization.
+   */
+  uint64_t segment_size_ = 0;
+  /**
+   * Directory segments made unnecessary by a checkpoint are moved to, or empty to delete them
+   */
+  std::string archive_dir_;
+  /**
+   * Maximum time records are held back from being persisted while no commit waits for them, i.e. how much of the
+   * asynchronously committed transactions can be lost on a crash. Records are only held back for longer than the flush
+   * interval if this is longer.
+   */
+  std::chrono::microseconds max_commit_lag_{10000};
+  /**
+   * Whether to compress the log. Compression trades serializer CPU time for fewer bytes written.
+   */
+  bool compress_ = false;
+  /**
+   * Distribution of the sync latency, if the streams are written to SimulatedLogDevices
+   */
+  SimulatedSyncLatency sync_latency_;
+};
+
 /**
  * A LogManager is responsible for serializing log records out and keeping track of whether changes from a transaction
  * are persistent.
+ *
+ * The log is split into one or more streams, each with its own queue of log buffers and its own log file. A worker
+ * thread always hands its buffers to the same stream, so streams can be serialized in parallel. Once started, the
+ * LogManager runs one serializer thread per stream, which periodically drains the log buffers handed to the stream,
+ * serializes their records and appends them to the stream's LogDevice. Records are serialized in the format of the
+ * LogSerializer into memory owned by the stream, so log buffers are returned to the buffer pool right away, and the
+ * serialized records are written out with gather writes. A device may still be writing out one batch while the next
+ * one is serialized. A single flusher thread periodically syncs the log devices, and then invokes the commit callbacks
+ * of all transactions whose commits have become persistent, so that a single sync makes a whole group of commits
+ * persistent. The serializers keep serializing and writing the next group while the flusher waits for the sync. A
+ * flush happens once the flush interval has passed since the last one, or earlier once the number of bytes written
+ * since the last flush reaches the flush threshold. The flush interval bounds the latency a commit waits for its
+ * group, and the threshold bounds the amount of unpersisted log.
+ *
+ * With more than one stream, a commit record being persisted is not enough for the commit to be acknowledged, as the
+ * transaction may depend on an earlier transaction whose records went to a stream that has not been flushed yet.
+ * Instead, the LogManager maintains a persisted timestamp watermark: every transaction with a commit timestamp below
+ * it has all of its records persisted, in whatever stream they are. Only commits below the watermark are acknowledged.
+ * The watermark only waits for transactions in the middle of committing, so transactions that keep running for long,
+ * like a checkpoint or an analytical read, do not hold back acknowledgements.
+ * Recovery reads all streams and replays transactions in commit timestamp order (see LogReader).
+ *
+ * Transactions can also commit asynchronously (see TransactionContext::SetSynchronousCommit), in which case they are
+ * acknowledged as soon as their commit record is handed to the LogManager. While no commit waits to be acknowledged,
+ * the flusher holds records back for up to a maximum commit lag, so that a single sync persists more of them.
+ *
+ * Each stream can also be split into segments of a given size. A stream then writes to a numbered sequence of segment
+ * files, each starting with a LogSegmentHeader, and moves on to a new segment once the current one is full. Full
+ * segments are retired to the flusher, which seals them with their final header once their records are persistent.
+ * Every restart begins a new segment, sealing the segments left unsealed by a crash first. Once a checkpoint
+ * completes, sealed segments it makes unnecessary are deleted or moved to an archive directory (see
+ * RemoveSegmentsBefore).
+ *
+ * Every region of serialized records in a write batch is written out as a frame (see LogFrameHeader), whose checksum
+ * lets readers detect a write torn by a crash at the end of the log. A stream that is not split into segments cuts such
+ * a torn write off its log file before appending to it again. The log can also be compressed, in which case the
+ * records of a frame are compressed, unless they do not get smaller.
+ *
+ * Once persisted, frames can also be shipped to a read replica (see LogShipper) along with the persisted watermark, and
+ * the start time of the oldest transaction that might still be running.
+ *
+ * Without starting the threads, the LogManager can also be driven manually by calling Process() from a single thread.
  */
 class LogManager {
  public:
@@ -23,22 +135,63 @@ class LogManager {
    * Constructs a new LogManager, writing its logs out to the given file.
    *
    * @param log_file_path path to the desired log file location. If the log file does not exist, one will be created;
-   *                      otherwise, changes are appended to the end of the file.
+   *                      otherwise, changes are appended to the end of the file. With more than one stream, each
+   *                      stream writes to its own file, named as given by StreamFilePath.
    * @param buffer_pool the object pool to draw log buffers from. This must be the same pool transactions draw their
    *                    buffers from
+   * @param options tunables of the log (see LogManagerOptions)
+   * @throws runtime_error if the log is split into segments, but not written to files
    */
-  LogManager(const char *log_file_path, RecordBufferSegmentPool *const buffer_pool)
-      : out_(log_file_path), buffer_pool_(buffer_pool) {}
+  LogManager(const char *log_file_path, RecordBufferSegmentPool *buffer_pool,
+             const LogManagerOptions &options = LogManagerOptions());
 
   /**
-   * Must be called when no other threads are doing work
+   * @param log_file_path path given to the LogManager
+   * @param stream_id id of the stream, between 0 and num_streams - 1
+   * @param num_streams number of streams of the LogManager
+   * @return path of the log file the given stream writes to
    */
-  void Shutdown() {
-    Process();
-    Flush();
-    out_.Close();
+  static std::string StreamFilePath(const std::string &log_file_path, uint32_t stream_id, uint32_t num_streams) {
+    return num_streams == 1 ? log_file_path : log_file_path + "." + std::to_string(stream_id);
   }
 
+  /**
+   * @param log_file_path path given to the LogManager
+   * @param num_streams number of streams of the LogManager
+   * @return paths of all files of the log that exist, to be read by a LogReader. These are the segments of every
+   *         stream that is split into segments, or otherwise its log file.
+   */
+  static std::vector<std::string> LogFilePaths(const std::string &log_file_path, uint32_t num_streams);
+
+  /**
+   * @return number of log streams
+   */
+  uint32_t NumStreams() const { return static_cast<uint32_t>(streams_.size()); }
+
+  /**
+   * Registers the transaction manager whose transactions are logged. This is done by the TransactionManager itself.
+   * @param txn_manager the transaction manager handing buffers to this LogManager
+   */
+  void RegisterTransactionManager(transaction::TransactionManager *txn_manager) { txn_manager_ = txn_manager; }
+
+  /**
+   * Registers a LogShipper to stream the log to a replica as it is persisted. Must be called before the LogManager is
+   * started, and before any log buffers are handed to it.
+   * @param shipper the shipper connected to the replica
+   */
+  void RegisterLogShipper(LogShipper *shipper) { shipper_ = shipper; }
+
+  /**
+   * Starts the serializer and flusher threads. Process() must not be called manually afterwards.
+   */
+  void Start();
+
+  /**
+   * Must be called when no other threads are doing work. Stops the serializer and flusher threads if they were started,
+   * making sure all log records handed to the LogManager so far are persisted and their callbacks invoked.
+   */
+  void Shutdown();
+
   /**
    * Returns a (perhaps partially) filled log buffer to the log manager to be consumed. Caller should drop its
    * reference to the buffer after the method returns immediately, as it would no longer be safe to read from or
@@ -46,47 +199,226 @@ class LogManager {
    *
    * @param buffer_segment the (perhaps partially) filled log buffer ready to be consumed
    */
-  void AddBufferToFlushQueue(RecordBufferSegment *const buffer_segment) {
-    common::SpinLatch::ScopedSpinLatch guard(&flush_queue_latch_);
-    flush_queue_.push(buffer_segment);
-  }
+  void AddBufferToFlushQueue(RecordBufferSegment *buffer_segment);
 
   /**
    * Process all the accumulated log records and serialize them out to disk. A flush will always happen at the end.
    * (Beware the performance consequences of calling flush too frequently) This method should only be called from a
-   * dedicated
-   * logging thread.
+   * dedicated logging thread, and only if the LogManager was not started.
    */
   void Process();
 
   /**
    * Flush the logs to make sure all serialized records before this invocation are persistent. Callbacks from committed
-   * transactions are also invoked when possible. This method should only be called from a dedicated logging thread.
+   * transactions are also invoked when possible. This method should only be called from a dedicated logging thread,
+   * and only if the LogManager was not started.
    *
    * Usually this method is called from Process(), but can also be called by itself if need be.
    */
   void Flush();
 
+  /**
+   * @return timestamp below which all commits are persistent and have been acknowledged
+   */
+  transaction::timestamp_t PersistedWatermark() const { return persisted_watermark_.load(); }
+
+  /**
+   * Blocks until the given commit is persistent, i.e. the persisted watermark passes it, flushing without waiting for
+   * the flush interval or the maximum commit lag. This lets an asynchronously committed transaction, or any client
+   * that needs a durability guarantee for what it has read, wait for the log to catch up. If the LogManager was not
+   * started, this drives it manually instead, and must then only be called from the thread calling Process(). A single
+   * round of processing is enough then, as the commit has already handed over all of its records.
+   * @param commit_time commit timestamp of a transaction that has committed. Its TransactionManager must be registered,
+   *                    as there is no watermark without it.
+   */
+  void WaitForPersisted(transaction::timestamp_t commit_time);
+
+  /**
+   * Deletes, or moves to the archive directory, every sealed segment that only contains records of transactions that
+   * began before the given time. This is called by the CheckpointManager once a checkpoint is complete, with the start
+   * time of the oldest transaction running when the checkpoint started: such transactions had committed before the
+   * checkpoint, or aborted. Can be called concurrently with the serializer and flusher threads.
+   * @param safe_time start time of the oldest transaction running when the checkpoint started
+   * @return number of segments removed
+   * @throws runtime_error if a segment cannot be removed
+   */
+  uint64_t RemoveSegmentsBefore(transaction::timestamp_t safe_time);
+
  private:
-  // TODO(Tianyu): This can be changed later to be include things that are not necessarily backed by a disk
-  // (e.g. logs can be streamed out to the network for remote replication)
-  BufferedLogWriter out_;
+  // A commit waiting to be acknowledged. Asynchronous commits are acknowledged on commit, and never wait here.
+  struct PendingCommit {
+    transaction::timestamp_t commit_time_;
+    transaction::callback_fn callback_;
+    void *callback_arg_;
+  };
+
+  // A segment that is done, along with its final header
+  struct SealedSegment {
+    std::string file_path_;
+    LogSegmentHeader header_;
+  };
+
+  // A full segment waiting for the flusher to make it persistent and seal it
+  struct RetiredSegment {
+    std::unique_ptr<LogDevice> device_;
+    SealedSegment segment_;
+  };
+
+  // Memory records are serialized into. It grows in chunks, so memory handed out stays in place until it is cleared.
+  class SerializationBuffer {
+   public:
+    // Returns size bytes of memory, valid until the next Clear()
+    byte *Allocate(uint32_t size);
+
+    // Makes all memory available again, keeping the chunks around for reuse
+    void Clear() {
+      current_chunk_ = 0;
+      chunk_used_ = 0;
+    }
+
+   private:
+    static constexpr uint32_t CHUNK_SIZE = 1 << 16;
+    std::vector<std::vector<byte>> chunks_;
+    uint64_t current_chunk_ = 0;
+    uint32_t chunk_used_ = 0;
+  };
+
+  struct LogStream {
+    explicit LogStream(std::string file_path) : file_path_(std::move(file_path)) {}
+
+    const std::string file_path_;
+    std::unique_ptr<LogDevice> device_;
+
+    // The segment being written, if the stream is split into segments. The placeholder header written at its start
+    // is never modified, as the device may still be writing it. The final header is filled in during serialization.
+    LogSegmentHeader segment_placeholder_, segment_header_;
+    uint64_t segment_bytes_ = 0;
+
+    // TODO(Tianyu): Might not be necessary, since commit on txn manager is already protected with a latch
+    common::SpinLatch flush_queue_latch_;
+    // TODO(Tianyu): benchmark for if these should be concurrent data structures, and if we should apply the same
+    // optimization we applied to the GC queue.
+    std::queue<RecordBufferSegment *> flush_queue_;
+
+    // These do not need to be thread safe since the only thread adding or removing from it is the serializing thread
+    // Memory regions serialized but not yet written, and the memory they point into
+    std::vector<iovec> pending_writes_;
+    SerializationBuffer serialized_;
+    // The memory of the batch the device may still be writing out
+    SerializationBuffer in_flight_serialized_;
+    // Frames of compressed records and headers of uncompressed frames pointed to by pending_writes_ once it is framed,
+    // and the same for the batch in flight
+    std::vector<byte> compressed_, in_flight_compressed_;
+    std::vector<LogFrameHeader> frame_headers_, in_flight_frame_headers_;
+    // Memory regions of the framed batch, swapped with pending_writes_
+    std::vector<iovec> framed_writes_;
+    std::vector<PendingCommit> commits_in_buffer_;
+    // Copy of the frames written out since the last hand off, if the log is shipped to a replica
+    std::vector<byte> frames_to_ship_;
+    uint64_t bytes_in_buffer_ = 0;
+    transaction::timestamp_t safe_time_in_buffer_{0};
+    // Only taken if the log is shipped, see OldestRunningTime
+    transaction::timestamp_t oldest_running_in_buffer_{0};
+
+    // Handed over from the serializer thread to the flusher thread, protected by persist_latch_. Everything in here
+    // has been written out to the log file already, and is only waiting for an fsync. Once it is done, every
+    // transaction committing below safe_time_to_persist_ has all of its records in this stream persisted.
+    std::vector<PendingCommit> commits_to_persist_;
+    std::vector<byte> frames_to_persist_;
+    uint64_t bytes_to_persist_ = 0;
+    transaction::timestamp_t safe_time_to_persist_{0}, oldest_running_to_persist_{0};
+
+    std::thread serializer_thread_;
+  };
+
+  std::vector<std::unique_ptr<LogStream>> streams_;
   RecordBufferSegmentPool *buffer_pool_;
+  const std::chrono::microseconds serialization_interval_, flush_interval_;
+  const uint64_t flush_threshold_, write_batch_size_;
+  const LogDeviceType device_type_;
+  const uint64_t segment_size_;
+  const std::string archive_dir_;
+  const std::chrono::microseconds max_commit_lag_;
+  const bool compress_;
+  const SimulatedSyncLatency sync_latency_;
+  std::atomic<transaction::TransactionManager *> txn_manager_{nullptr};
+  LogShipper *shipper_ = nullptr;
 
-  // TODO(Tianyu): Might not be necessary, since commit on txn manager is already protected with a latch
-  common::SpinLatch flush_queue_latch_;
-  // TODO(Tianyu): benchmark for if these should be concurrent data structures, and if we should apply the same
-  // optimization we applied to the GC queue.
-  std::queue<RecordBufferSegment *> flush_queue_;
+  std::mutex persist_latch_;
+  std::condition_variable persist_cv_;
+  // Sum of bytes_to_persist_ over all streams
+  uint64_t bytes_to_persist_ = 0;
+  // When the oldest of the bytes to persist were handed off, which bounds how long they can be held back
+  std::chrono::steady_clock::time_point oldest_handoff_;
+  // Set by WaitForPersisted to make the flusher persist without waiting
+  bool flush_requested_ = false;
+  // Notified whenever the persisted watermark advances
+  std::condition_variable persisted_cv_;
+  std::vector<RetiredSegment> retired_segments_;
 
-  // These do not need to be thread safe since the only thread adding or removing from it is the flushing thread
-  std::vector<std::pair<transaction::callback_fn, void *>> commits_in_buffer_;
+  std::mutex sealed_segments_latch_;
+  std::vector<SealedSegment> sealed_segments_;
 
-  void SerializeRecord(const LogRecord &record);
+  // Only accessed by the flusher. Commits whose records are persistent, but that might still wait for the watermark
+  std::vector<PendingCommit> commits_persisted_;
+  std::atomic<transaction::timestamp_t> persisted_watermark_{transaction::timestamp_t(0)};
+  // Only accessed by the flusher. Frames persisted, but not shipped yet, and the watermark and oldest running time
+  // shipped last
+  std::vector<byte> frames_to_ship_;
+  transaction::timestamp_t shipped_watermark_{0}, shipped_oldest_running_{0};
 
-  template <class T>
-  void WriteValue(const T &val) {
-    out_.BufferWrite(&val, sizeof(T));
-  }
+  volatile bool run_serializer_ = false, run_flusher_ = false;
+  std::thread flusher_thread_;
+
+  // Returns a timestamp such that every transaction committing below it has already handed all of its log buffers to
+  // the LogManager
+  transaction::timestamp_t SafeTime() const;
+
+  // Returns a timestamp such that every transaction that began below it has ended, and thus handed all of its log
+  // buffers to the LogManager if it committed
+  transaction::timestamp_t OldestRunningTime() const;
+
+  // Takes the times that hold for everything queued in the stream so far, before it is drained
+  void TakeSafeTimes(LogStream *stream) const;
+
+  // Serializes all records in the flush queue of the stream into its write buffer
+  void SerializeQueuedBuffers(LogStream *stream);
+
+  // Starts writing out everything serialized so far in the stream, and reuses the memory of the previous batch, which
+  // the device is done with, for serializing the next one
+  void WritePending(LogStream *stream);
+
+  // Replaces the regions of serialized records about to be written with frames
+  void FramePending(LogStream *stream);
+
+  // Waits for the device to write out everything handed to it
+  void FinishWrites(LogStream *stream);
+
+  // Writes out everything serialized so far in the stream, and hands the commits in it to the flusher thread
+  void HandOffToFlusher(LogStream *stream);
+
+  // Creates the segment of the stream with the given id, and returns the device to write the rest of it to
+  std::unique_ptr<LogDevice> OpenSegment(LogStream *stream, uint64_t segment_id);
+
+  // Seals the segments of the stream left unsealed by a previous run, and returns the id of the next segment
+  uint64_t SealExistingSegments(LogStream *stream);
+
+  // Writes the final header of a segment, which must have been persisted and closed
+  void SealSegment(SealedSegment segment);
+
+  // Whether the flusher, whose current flush interval started at the given time, has to persist what was handed off to
+  // it now rather than wait for more. Must be called holding persist_latch_.
+  bool MustPersist(std::chrono::steady_clock::time_point now,
+                   std::chrono::steady_clock::time_point interval_start) const;
+
+  // Persists everything handed off to the flusher, and acknowledges the commits below the new watermark. Must be
+  // called holding the given lock on persist_latch_, which is released while waiting for the disk.
+  void PersistHandedOff(std::unique_lock<std::mutex> *lock);
+
+  void SerializerThreadLoop(LogStream *stream);
+
+  void FlusherThreadLoop();
+
+  void SerializeRecord(LogStream *stream, const LogRecord &record);
 };
 }  // namespace terrier::storage
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "common/macros.h"
+#include "storage/write_ahead_log/log_io.h"
+#include "storage/write_ahead_log/log_record.h"
+#include "storage/write_ahead_log/mapped_log_reader.h"
+
+namespace terrier::storage {
+/**
+ * Reads back a write-ahead log written by a LogManager, which may be split across several stream files, and returns
+ * the records of committed transactions one transaction at a time, in commit timestamp order.
+ *
+ * A transaction's records can appear in any stream, and the streams are not synchronized with each other, so the
+ * reader reads all of them fully, grouping records by transaction. Transactions without a commit record (because they
+ * aborted, or were still running at the time of a crash) are discarded. A torn write at the end of a stream, as left
+ * behind by a crash in the middle of a write, ends the stream.
+ *
+ * Log files are read through a MappedLogReader. While one thread locates the frames of a file, which has the kernel
+ * read the file ahead, several threads decode the frames located so far in parallel, and the records of the frames are
+ * put back in order once the whole file is decoded.
+ */
+class LogReader {
+ public:
+  /**
+   * Default number of threads decoding the frames of a log file
+   */
+  static constexpr uint32_t DEFAULT_NUM_DECODERS = 4;
+
+  /**
+   * Reads in the given log files.
+   * @param log_file_paths paths of the files of all streams of the log, which may be segment files (see
+   *                       LogManager::LogFilePaths)
+   * @param num_decoders number of threads decoding the frames of a log file, including the calling thread. There are
+   *                     never more decoders than hardware threads.
+   * @throws runtime_error if a file cannot be read
+   */
+  explicit LogReader(const std::vector<std::string> &log_file_paths, uint32_t num_decoders = DEFAULT_NUM_DECODERS);
+
+  /**
+   * Frees the records of transactions that were not read out
+   */
+  ~LogReader();
+
+  DISALLOW_COPY_AND_MOVE(LogReader)
+
+  /**
+   * @return whether there are committed transactions left to read
+   */
+  bool HasMore() const { return next_txn_ < txns_.size(); }
+
+  /**
+   * Returns the records of the next committed transaction, in the order the transaction generated them, with its commit
+   * record last. The caller takes ownership of the records, and is responsible for freeing them with
+   * delete[] reinterpret_cast<byte *>(record).
+   * @return records of the committed transaction with the next lowest commit timestamp
+   */
+  std::vector<LogRecord *> NextTransaction() {
+    TERRIER_ASSERT(HasMore(), "No more transactions in the log");
+    return std::move(txns_[next_txn_++]);
+  }
+
+  /**
+   * @return number of transactions discarded because they did not commit
+   */
+  uint64_t NumDiscarded() const { return num_discarded_; }
+
+  /**
+   * @return newest begin or commit timestamp of any record read, including those of discarded transactions, or
+   *         timestamp 0 if the log is empty
+   */
+  transaction::timestamp_t NewestTimestamp() const { return newest_timestamp_; }
+
+  /**
+   * Deserializes the next log record from the given log file, skipping over any padding in front of it.
+   * @param in the log file to read from
+   * @return the record read (see LogSerializer::Deserialize), to be freed by the caller with
+   *         delete[] reinterpret_cast<byte *>(record), or nullptr if the log file ended before a complete record could
+   *         be read or the record is malformed
+   */
+  static LogRecord *ReadRecord(BufferedLogReader *in);
+
+  /**
+   * Deserializes all of the records of the given log file
+   * @param in the log file to read from
+   * @param num_decoders number of threads decoding the frames of the file, including the calling thread
+   * @return the records read, in the order they were written
+   */
+  static std::vector<LogRecord *> ReadRecords(MappedLogReader *in, uint32_t num_decoders);
+
+ private:
+  std::vector<std::vector<LogRecord *>> txns_;
+  uint64_t next_txn_ = 0;
+  uint64_t num_discarded_ = 0;
+  transaction::timestamp_t newest_timestamp_{0};
+};
+}  // namespace terrier::storage
@@ -108,6 +108,12 @@ class RedoRecord {
    */
   void SetTupleSlot(const TupleSlot tuple_slot) { tuple_slot_ = tuple_slot; }
 
+  /**
+   * @return layout version of the table the record was written to the log with. Only records read back from the log
+   *         have one, records in memory take it from the block of their tuple slot when they are serialized.
+   */
+  layout_version_t GetLayoutVersion() const { return layout_version_; }
+
   /**
    * @return inlined delta that (was/is to be) applied to the tuple in the table
    */
@@ -148,42 +154,18 @@ class RedoRecord {
     body->db_oid_ = db_oid;
     body->table_oid_ = table_oid;
     body->tuple_slot_ = TupleSlot(nullptr, 0);
+    body->layout_version_ = layout_version_t(0);
     initializer.InitializeRow(body->Delta());
     return result;
   }
 
-  /**
-   * TODO(Tianyu): Remove this as we clean up serialization
-   * Hacky back door for BufferedLogReader. Essentially, the current implementation dumps memory content straight out
-   * to disk, which we then read directly back into the projected row. After the serialization format is decided, write
-   * a real factory method for recovery.
-   * @param head
-   * @param size
-   * @param txn_begin
-   * @param db_oid database oid of this redo record
-   * @param table_oid table oid of this redo record
-   * @param tuple_slot
-   * @return
-   */
-  static LogRecord *PartialInitialize(byte *const head, const uint32_t size, const transaction::timestamp_t txn_begin,
-                                      const catalog::db_oid_t db_oid, const catalog::table_oid_t table_oid,
-                                      const TupleSlot tuple_slot) {
-    LogRecord *result = LogRecord::InitializeHeader(head, LogRecordType::REDO, size, txn_begin);
-    auto *body = result->GetUnderlyingRecordBodyAs<RedoRecord>();
-    body->db_oid_ = db_oid;
-    body->table_oid_ = table_oid;
-    body->tuple_slot_ = tuple_slot;
-    return result;
-  }
-
  private:
-  // TODO(Tianyu): We will eventually need to consult the DataTable to determine how to serialize a given column
-  // (varlen? compressed? from an outdated schema?) For now we just assume we can serialize everything out as-is,
-  // and the reader still have access to the layout on recovery and can deserialize. This is why we are not
-  // just taking an oid.
+  // The LogSerializer fills in the layout version of records read back from the log
+  friend class LogSerializer;
   catalog::db_oid_t db_oid_;
   catalog::table_oid_t table_oid_;
   TupleSlot tuple_slot_;
+  layout_version_t layout_version_;
   // This needs to be aligned to 8 bytes to ensure the real size of RedoRecord (plus actual ProjectedRow) is also
   // a multiple of 8.
   uint64_t varlen_contents_[0];
@@ -270,6 +252,14 @@ class CommitRecord {
    */
   static uint32_t Size() { return static_cast<uint32_t>(sizeof(LogRecord) + sizeof(CommitRecord)); }
 
+  /**
+   * @return Size of the entire record of this type, in bytes, in the log. Only the header and the commit timestamp are
+   * written out, as the rest is only meaningful in memory.
+   */
+  static uint32_t SerializedSize() {
+    return static_cast<uint32_t>(sizeof(LogRecord) + sizeof(transaction::timestamp_t));
+  }
+
   /**
    * Initialize an entire LogRecord (header included) to have an underlying commit record, using the parameters
    * supplied.
@@ -277,7 +267,8 @@ class CommitRecord {
    * @param head pointer location to initialize, this is also the returned address (reinterpreted)
    * @param txn_begin begin timestamp of the transaction that generated this log record
    * @param txn_commit the commit timestamp of the transaction that generated this log record
-   * @param callback function pointer of the callback to invoke when commit is
+   * @param callback function pointer of the callback to invoke when commit is persistent, or nullptr if the commit was
+   *                 already acknowledged because it is asynchronous
    * @param callback_arg a void * argument that can be passed to the callback function when invoked
    * @param is_read_only indicates whether the transaction generating this log record is read-only or not
    * @param txn pointer to the committing transaction
@@ -0,0 +1,95 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "storage/write_ahead_log/log_record.h"
+#include "transaction/transaction_defs.h"
+
+namespace terrier::storage {
+/**
+ * Header at the start of every log segment file. A log stream split into segments writes to a numbered sequence of
+ * segment files, moving on to the next one once the current one reaches a size limit.
+ *
+ * A segment starts out with a placeholder header, in which only the segment id is filled in. Once the segment is done
+ * and its records are persistent, the header is rewritten with the commit timestamps of the segment and the
+ * segment is marked sealed. A segment that is not sealed was still being written when the system stopped.
+ */
+struct LogSegmentHeader {
+  /**
+   * Marks the start of a segment file. Its first byte is neither zero nor a log record type, so the header cannot be
+   * mistaken for a record or for padding.
+   */
+  static constexpr uint32_t MAGIC = 0x47455354;  // "TSEG"
+
+  /**
+   * Always MAGIC
+   */
+  uint32_t magic_ = MAGIC;
+  /**
+   * Whether the timestamps below are filled in
+   */
+  uint32_t sealed_ = 0;
+  /**
+   * Position of the segment in its log stream
+   */
+  uint64_t segment_id_ = 0;
+  /**
+   * Earliest commit timestamp of the commit records in the segment, or 0 if there are none
+   */
+  transaction::timestamp_t first_commit_{0};
+  /**
+   * Latest commit timestamp of the commit records in the segment, or 0 if there are none
+   */
+  transaction::timestamp_t last_commit_{0};
+  /**
+   * Latest begin timestamp of any transaction with records in the segment. Transactions that began before a checkpoint
+   * commit before it, unless they were still running when the checkpoint started, so records of transactions that
+   * began before the oldest running transaction at the start of a checkpoint are never needed after it.
+   */
+  transaction::timestamp_t newest_txn_begin_{0};
+
+  /**
+   * @param stream_file_path path of the log stream
+   * @param segment_id id of the segment
+   * @return path of the file of the given segment of the log stream
+   */
+  static std::string FilePath(const std::string &stream_file_path, const uint64_t segment_id) {
+    return stream_file_path + ".segment." + std::to_string(segment_id);
+  }
+
+  /**
+   * @param stream_file_path path of the log stream
+   * @return ids of the existing segments of the log stream, in ascending order
+   * @throws runtime_error if the directory of the log stream cannot be read
+   */
+  static std::vector<uint64_t> ListSegments(const std::string &stream_file_path);
+
+  /**
+   * Reads the header of a segment file
+   * @param path path of the segment file
+   * @param header header to fill in
+   * @return false if the file is not a segment file
+   * @throws runtime_error if the file cannot be read
+   */
+  static bool Read(const std::string &path, LogSegmentHeader *header);
+
+  /**
+   * Updates the timestamps of this header with a record in the segment
+   * @param record the record
+   */
+  void Track(const LogRecord &record) {
+    if (newest_txn_begin_ < record.TxnBegin()) newest_txn_begin_ = record.TxnBegin();
+    if (record.RecordType() != LogRecordType::COMMIT) return;
+    const transaction::timestamp_t commit_time = record.GetUnderlyingRecordBodyAs<CommitRecord>()->CommitTime();
+    if (first_commit_ == transaction::timestamp_t(0) || commit_time < first_commit_) first_commit_ = commit_time;
+    if (last_commit_ < commit_time) last_commit_ = commit_time;
+  }
+
+  /**
+   * Writes this header over the header of the given segment file, and makes it persistent. This must only be done once
+   * nothing is writing to the file anymore.
+   * @param path path of the segment file
+   * @throws runtime_error if the file cannot be written
+   */
+  void Write(const std::string &path) const;
+};
+}  // namespace terrier::storage
@@ -0,0 +1,52 @@
+#pragma once
+#include "storage/write_ahead_log/log_record.h"
+
+namespace terrier::storage {
+/**
+ * Converts log records between their form in memory and their form in the log. The log is self-describing: records
+ * can be decoded without the tables they were written from, which is what recovery and other consumers of the log
+ * (such as log shipping) rely on.
+ *
+ * Every record starts with the LogRecord header, whose size field is the size of the serialized record. The header is
+ * followed by a body that depends on the record type:
+ *   - REDO: database oid (4 bytes), table oid (4), tuple slot (8), layout version of the table (2), number of columns
+ *     n (2), the column ids (2 * n), the attribute sizes of the columns (n, VARLEN_COLUMN for varlen columns), and a
+ *     null bitmap (RawBitmap::SizeInBytes(n)). The values of the non-null columns follow, unaligned and in the same
+ *     order, each taking up its attribute size. A varlen value only takes up 4 bytes for its size there, and its
+ *     contents follow after the last value, out of band, in the same order.
+ *   - DELETE: database oid (4), table oid (4), tuple slot (8)
+ *   - COMMIT: commit timestamp (8)
+ * Tuple slots are written out as they were in memory, and only serve to identify tuples across the records of the log.
+ */
+class LogSerializer {
+ public:
+  LogSerializer() = delete;
+
+  /**
+   * @param record a record in memory. Redo records must have their tuple slot set.
+   * @return number of bytes the record takes up in the log
+   */
+  static uint32_t SerializedSize(const LogRecord &record);
+
+  /**
+   * Serializes a record
+   * @param record a record in memory. Redo records must have their tuple slot set.
+   * @param out buffer of at least SerializedSize(record) bytes to serialize the record into
+   * @return number of bytes written, i.e. SerializedSize(record)
+   */
+  static uint32_t Serialize(const LogRecord &record, byte *out);
+
+  /**
+   * Deserializes a record. Varlen values of a redo record that are not inlined point into the record itself, and are
+   * not reclaimable, so they have to be copied before they are installed into a table.
+   * @param in a serialized record, starting with its header
+   * @return the record in memory, to be freed by the caller with delete[] reinterpret_cast<byte *>(record), or nullptr
+   *         if the serialized record is malformed
+   */
+  static LogRecord *Deserialize(const byte *in);
+
+ private:
+  // Layout of the table a redo record was generated for
+  static const BlockLayout &LoggedLayout(const RedoRecord &redo);
+};
+}  // namespace terrier::storage
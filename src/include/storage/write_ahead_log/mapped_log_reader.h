@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include "common/macros.h"
+#include "common/strong_typedef.h"
+#include "storage/write_ahead_log/log_io.h"
+
+namespace terrier::storage {
+/**
+ * Reads the write ahead log through a read-only memory mapping of the log file, without any read calls or copies.
+ * Frames (see LogFrameHeader) are located one after the other from their headers, and the records of an uncompressed
+ * frame are handed out as views into the mapping. The kernel is asked to read the file ahead of the frame located
+ * last, so that reading the log from disk overlaps with decoding the frames located before.
+ *
+ * Locating frames is not thread-safe, but decoding them is, so that the frames of a log can be decoded in parallel.
+ * Like BufferedLogReader, the reader treats a torn write as the end of the log: NextFrame stops at bytes that do not
+ * start a frame or at a frame cut short, and Decode rejects a frame that fails its checksum.
+ */
+class MappedLogReader {
+ public:
+  /**
+   * Number of bytes of the file the kernel is asked to read ahead of the frame located last
+   */
+  static constexpr uint64_t READAHEAD_SIZE = 1 << 24;
+
+  /**
+   * A frame located in the mapping
+   */
+  struct Frame {
+    /**
+     * Header of the frame, copied out of the mapping, where it is not aligned
+     */
+    LogFrameHeader header_;
+    /**
+     * Payload of the frame in the mapping
+     */
+    const byte *payload_;
+  };
+
+  /**
+   * Maps the given log file
+   * @param log_file_path path to the log file to read from
+   * @param offset number of bytes at the start of the file that are not part of the log, such as a segment header
+   * @throws runtime_error if the file cannot be opened or mapped
+   */
+  explicit MappedLogReader(const char *log_file_path, uint64_t offset = 0);
+
+  /**
+   * Unmaps the log file. Views handed out by the reader are invalid afterwards.
+   */
+  ~MappedLogReader();
+
+  DISALLOW_COPY_AND_MOVE(MappedLogReader)
+
+  /**
+   * Locates the next frame, skipping over any padding in front of it
+   * @param[out] frame the frame located
+   * @return whether there was another frame before the end of the log
+   */
+  bool NextFrame(Frame *frame);
+
+  /**
+   * Verifies a frame and decompresses it if needed. Safe to call concurrently from multiple threads.
+   * @param frame a frame located by NextFrame
+   * @param buffer memory to decompress the frame into, if it is compressed
+   * @return the serialized records of the frame, records_size_ bytes long, pointing into the mapping or the buffer, or
+   *         nullptr if the frame is torn
+   */
+  static const byte *Decode(const Frame &frame, std::vector<byte> *buffer);
+
+  /**
+   * Hands out the serialized records of a decoded frame one at a time
+   * @param records the serialized records of the frame
+   * @param size number of bytes of records in the frame
+   * @param[in,out] offset offset of the next record in the frame, advanced past the record returned
+   * @return view of the next serialized record (see LogSerializer), or nullptr if there is no whole record left
+   */
+  static const byte *NextRecord(const byte *records, uint32_t size, uint32_t *offset);
+
+ private:
+  const byte *mapping_ = nullptr;
+  uint64_t size_ = 0;
+  // Offset of the next frame to be located
+  uint64_t head_;
+  // Offset up to which the kernel was asked to read the file ahead
+  uint64_t readahead_end_;
+};
+}  // namespace terrier::storage
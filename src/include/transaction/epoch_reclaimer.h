@@ -0,0 +1,60 @@
+#pragma once
+#include <array>
+#include <utility>
+#include <vector>
+#include "common/constants.h"
+#include "common/macros.h"
+#include "common/spin_latch.h"
+#include "common/strong_typedef.h"
+#include "transaction/timestamp_allocator.h"
+#include "transaction/transaction_defs.h"
+
+namespace terrier::transaction {
+/**
+ * Holds actions that clean up something running transactions may still see, such as an unlinked index entry or a
+ * dropped table, until no running transaction can see it anymore.
+ *
+ * An action is retired with a timestamp that is newer than the start timestamp of every transaction that may still see
+ * what the action cleans up. The running transactions announce their start timestamps through RunningTransactions, so
+ * the action is safe to run once the oldest of those is not older than its timestamp. Threads retire into the list of
+ * their own TimestampAllocator lane, so retiring only latches a list no other thread uses in the common case. A single
+ * thread at a time, usually the GC, collects the lists in batches and runs the actions that have become safe.
+ */
+class EpochReclaimer {
+ public:
+  EpochReclaimer() = default;
+  DISALLOW_COPY_AND_MOVE(EpochReclaimer)
+
+  /**
+   * Retires an action
+   * @param retire_time timestamp newer than the start timestamp of every transaction that may interfere with the action
+   * @param action the action to run once no such transaction runs anymore
+   */
+  void Retire(timestamp_t retire_time, Action action);
+
+  /**
+   * Moves the actions retired since the last call to the actions pending to be run. Only one thread at a time may
+   * collect or run actions.
+   * @return the newest timestamp any pending action was retired with, or timestamp 0 if there is none
+   */
+  timestamp_t Collect();
+
+  /**
+   * Runs the pending actions that are safe to run, in the order they were collected. Actions retired while they run
+   * are only run after the next call to Collect. Only one thread at a time may collect or run actions.
+   * @param oldest_start_time timestamp that is not newer than the start timestamp of any running transaction
+   * @return number of actions run
+   */
+  uint32_t Reclaim(timestamp_t oldest_start_time);
+
+ private:
+  struct alignas(common::Constants::CACHELINE_SIZE) Shard {
+    common::SpinLatch latch_;
+    std::vector<std::pair<timestamp_t, Action>> retired_;
+  };
+
+  std::array<Shard, TimestampAllocator::NUM_LANES> shards_;
+  // Only accessed by the thread collecting and running actions
+  std::vector<std::pair<timestamp_t, Action>> pending_;
+};
+}  // namespace terrier::transaction
@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <limits>
+#include <vector>
+#include "common/constants.h"
+#include "common/macros.h"
+#include "common/spin_latch.h"
+#include "common/strong_typedef.h"
+#include "transaction/timestamp_allocator.h"
+#include "transaction/transaction_defs.h"
+
+namespace terrier::transaction {
+/**
+ * Keeps track of the start timestamps of the running transactions of a TransactionManager, and of the finished
+ * transactions that still have to be handed to the GC.
+ *
+ * The registry is split into shards, one for each lane of the TimestampAllocator, and a transaction is registered in
+ * the shard of the lane its start timestamp was drawn from. Threads draw from their own lanes, so beginning and
+ * finishing transactions only latches a shard no other thread uses in the common case. Every shard maintains the
+ * oldest start timestamp registered with it as transactions come and go, so that the oldest running transaction can be
+ * found without latching anything.
+ */
+class RunningTransactions {
+ public:
+  RunningTransactions() = default;
+  DISALLOW_COPY_AND_MOVE(RunningTransactions)
+
+  /**
+   * Registers a running transaction
+   * @param start_time start timestamp of the transaction
+   */
+  void Add(timestamp_t start_time);
+
+  /**
+   * Unregisters a transaction
+   * @param start_time start timestamp of the transaction
+   * @param completed the finished transaction, to be handed to the GC, or nullptr if the GC is disabled
+   */
+  void Remove(timestamp_t start_time, TransactionContext *completed);
+
+  /**
+   * @param none_running timestamp to return if no transaction is registered
+   * @return the oldest start timestamp of all registered transactions, or none_running if it is older
+   */
+  timestamp_t Oldest(timestamp_t none_running) const;
+
+  /**
+   * @return the transactions finished since the last call, which are no longer kept here
+   */
+  TransactionQueue TakeCompleted();
+
+ private:
+  static constexpr timestamp_t NONE_RUNNING = timestamp_t(std::numeric_limits<uint64_t>::max());
+
+  struct alignas(common::Constants::CACHELINE_SIZE) Shard {
+    // Protects everything but oldest_
+    common::SpinLatch latch_;
+    // Usually only holds the transactions of a single thread, so scanning it is cheap
+    std::vector<timestamp_t> running_;
+    std::atomic<timestamp_t> oldest_{NONE_RUNNING};
+    TransactionQueue completed_;
+  };
+
+  std::array<Shard, TimestampAllocator::NUM_LANES> shards_;
+};
+}  // namespace terrier::transaction
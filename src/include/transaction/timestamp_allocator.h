@@ -0,0 +1,150 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include "common/constants.h"
+#include "common/macros.h"
+#include "common/strong_typedef.h"
+#include "transaction/transaction_defs.h"
+
+namespace terrier::transaction {
+/**
+ * Hands out the start and commit timestamps of a TransactionManager without serializing all threads on one counter.
+ *
+ * Time advances in epochs. A timestamp consists of an epoch in its high bits and an offset within the epoch in its low
+ * bits. Every transaction that begins while an epoch e is visible gets a start timestamp of epoch e, so they all read
+ * the same snapshot. Offsets only have to be unique among transactions of the same epoch. They are split into lanes,
+ * and each thread draws offsets from the block of its own lane, so beginning a transaction writes no shared data in
+ * the common case. A lane that runs out of offsets closes its epoch early.
+ *
+ * Updating transactions commit in groups. A committing transaction joins the open epoch e and gets commit timestamp
+ * e + 1 with an offset of zero, which is newer than every start timestamp of epoch e and older than every start
+ * timestamp of epoch e + 1. Joining only touches a counter in the lane of the thread. Once a member of the group has
+ * installed its commit timestamps, it closes the epoch, waits for the other members to install theirs, and makes epoch
+ * e + 1 visible. New transactions thus see either all or none of a group, and never a group that is still installing
+ * its timestamps. Transactions committing together cannot have written the same tuple, so it does not matter that they
+ * share a commit timestamp.
+ */
+class TimestampAllocator {
+ public:
+  /**
+   * Number of lanes the offsets of an epoch are split into
+   */
+  static constexpr uint32_t NUM_LANES = 64;
+
+  TimestampAllocator() = default;
+  DISALLOW_COPY_AND_MOVE(TimestampAllocator)
+
+  /**
+   * @return a start timestamp in the visible epoch, unique among all start timestamps handed out
+   */
+  timestamp_t StartTimestamp();
+
+  /**
+   * A snapshot start timestamp reads the same versions as every start timestamp of the visible epoch, but is not
+   * unique, so it can only be used by transactions that do not write. It has offset zero within the lane of the calling
+   * thread, and is never equal to a start timestamp handed out by StartTimestamp.
+   * @return a snapshot start timestamp in the visible epoch
+   */
+  timestamp_t SnapshotStartTimestamp() const;
+
+  /**
+   * @param start_time a start timestamp handed out by this allocator
+   * @return whether the start timestamp is in the visible epoch, in which case it is not older than any value returned
+   *         by OldestStartTimestamp so far, save for a snapshot start timestamp that reads the same versions as that
+   *         value
+   */
+  bool IsCurrent(const timestamp_t start_time) const { return EpochOf(start_time) == visible_epoch_.load(); }
+
+  /**
+   * @param start_time a start timestamp handed out by this allocator
+   * @return commit timestamp of the newest commit group visible to a transaction with the given start timestamp
+   */
+  static timestamp_t SnapshotTimestamp(const timestamp_t start_time) {
+    return timestamp_t(EpochStart(EpochOf(start_time)));
+  }
+
+  /**
+   * @return the lane the calling thread draws its start timestamps from
+   */
+  static uint32_t ThreadLane();
+
+  /**
+   * @param start_time a start timestamp handed out by this allocator
+   * @return the lane the start timestamp was drawn from
+   */
+  static uint32_t LaneOf(const timestamp_t start_time) {
+    return static_cast<uint32_t>(!start_time >> SEQUENCE_BITS) & (NUM_LANES - 1);
+  }
+
+  /**
+   * @return the oldest start timestamp a transaction beginning from now on can get
+   */
+  timestamp_t OldestStartTimestamp() const { return timestamp_t(EpochStart(visible_epoch_.load()) + 1); }
+
+  /**
+   * Unlike Advance, this does not close the open epoch. Transactions that begin before the visible epoch changes still
+   * get older start timestamps.
+   * @return a timestamp newer than all start timestamps handed out so far, and not newer than any start timestamp
+   *         handed out once the visible epoch changed
+   */
+  timestamp_t RetireTimestamp() const { return timestamp_t(EpochStart(visible_epoch_.load() + 1)); }
+
+  /**
+   * Joins the open commit group. The caller has to install the returned commit timestamp on everything it wrote before
+   * calling FinishCommit.
+   * @return commit timestamp of the group
+   */
+  timestamp_t JoinCommit();
+
+  /**
+   * Leaves the commit group joined with JoinCommit, and blocks until the group is visible to transactions that begin
+   * @param commit_time the commit timestamp returned by JoinCommit
+   */
+  void FinishCommit(timestamp_t commit_time);
+
+  /**
+   * Moves time past the given timestamp, such that every timestamp handed out from now on is newer. This lets a
+   * restarted system continue the timeline of the log it recovered from. Must not be called while transactions run.
+   * @param timestamp a timestamp handed out by an earlier allocator
+   */
+  void AdvancePast(const timestamp_t timestamp) {
+    const uint64_t epoch = EpochOf(timestamp) + 1;
+    if (epoch <= visible_epoch_.load()) return;
+    visible_epoch_.store(epoch);
+    open_epoch_.store(epoch);
+  }
+
+  /**
+   * Closes the open epoch
+   * @return a timestamp newer than all start timestamps handed out so far, and older than all that are handed out
+   *         from now on
+   */
+  timestamp_t Advance() {
+    const timestamp_t result = JoinCommit();
+    FinishCommit(result);
+    return result;
+  }
+
+ private:
+  static constexpr uint64_t SEQUENCE_BITS = 10, LANE_BITS = 6, EPOCH_SHIFT = SEQUENCE_BITS + LANE_BITS;
+  static constexpr uint64_t MAX_SEQUENCE = (1u << SEQUENCE_BITS) - 1;
+  static_assert(NUM_LANES == 1u << LANE_BITS, "every lane needs an id in the offset");
+
+  struct alignas(common::Constants::CACHELINE_SIZE) Lane {
+    // Epoch of the last offset handed out in the high bits, sequence number within the lane in the low bits
+    std::atomic<uint64_t> last_start_{0};
+    // Number of transactions that joined a commit group through this lane, by parity of the epoch of the group
+    std::array<std::atomic<uint32_t>, 2> committing_{};
+  };
+
+  static uint64_t EpochStart(const uint64_t epoch) { return epoch << EPOCH_SHIFT; }
+  static uint64_t EpochOf(const timestamp_t timestamp) { return !timestamp >> EPOCH_SHIFT; }
+
+  // Epoch that new transactions begin in. All commit groups of older epochs have installed their timestamps.
+  std::atomic<uint64_t> visible_epoch_{0};
+  // Epoch whose commit group new committing transactions join. Either equal to the visible epoch, or one ahead while
+  // the group of the visible epoch is closed and finishing.
+  std::atomic<uint64_t> open_epoch_{0};
+  std::array<Lane, NUM_LANES> lanes_;
+};
+}  // namespace terrier::transaction
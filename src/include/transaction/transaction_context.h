@@ -68,6 +68,7 @@ class TransactionContext {
    */
   storage::UndoRecord *UndoRecordForUpdate(storage::DataTable *const table, const storage::TupleSlot slot,
                                            const storage::ProjectedRow &redo) {
+    TERRIER_ASSERT(!read_only_, "read-only transactions cannot write");
     const uint32_t size = storage::UndoRecord::Size(redo);
     return storage::UndoRecord::InitializeUpdate(undo_buffer_.NewEntry(size), txn_id_.load(), slot, table, redo);
   }
@@ -79,6 +80,7 @@ class TransactionContext {
    * @return a persistent pointer to the head of a memory chunk large enough to hold the undo record
    */
   storage::UndoRecord *UndoRecordForInsert(storage::DataTable *const table, const storage::TupleSlot slot) {
+    TERRIER_ASSERT(!read_only_, "read-only transactions cannot write");
     byte *const result = undo_buffer_.NewEntry(sizeof(storage::UndoRecord));
     return storage::UndoRecord::InitializeInsert(result, txn_id_.load(), slot, table);
   }
@@ -90,6 +92,7 @@ class TransactionContext {
    * @return a persistent pointer to the head of a memory chunk large enough to hold the undo record
    */
   storage::UndoRecord *UndoRecordForDelete(storage::DataTable *const table, const storage::TupleSlot slot) {
+    TERRIER_ASSERT(!read_only_, "read-only transactions cannot write");
     byte *const result = undo_buffer_.NewEntry(sizeof(storage::UndoRecord));
     return storage::UndoRecord::InitializeDelete(result, txn_id_.load(), slot, table);
   }
@@ -104,6 +107,7 @@ class TransactionContext {
    */
   storage::RedoRecord *StageWrite(const catalog::db_oid_t db_oid, const catalog::table_oid_t table_oid,
                                   const storage::ProjectedRowInitializer &initializer) {
+    TERRIER_ASSERT(!read_only_, "read-only transactions cannot write");
     const uint32_t size = storage::RedoRecord::Size(initializer);
     auto *const log_record =
         storage::RedoRecord::Initialize(redo_buffer_.NewEntry(size), start_time_, db_oid, table_oid, initializer);
@@ -118,6 +122,7 @@ class TransactionContext {
    */
   void StageDelete(const catalog::db_oid_t db_oid, const catalog::table_oid_t table_oid,
                    const storage::TupleSlot slot) {
+    TERRIER_ASSERT(!read_only_, "read-only transactions cannot write");
     const uint32_t size = storage::DeleteRecord::Size();
     storage::DeleteRecord::Initialize(redo_buffer_.NewEntry(size), start_time_, db_oid, table_oid, slot);
   }
@@ -138,17 +143,39 @@ class TransactionContext {
   /**
    * Get the transaction manager responsible for this context (should be singleton).
    * @warning This should only be used to support dynamically generating deferred actions
-   *          at abort or commit.  We need to expose the transaction manager because that
-   *          is where the deferred actions queue exists.
-   * @return the transaction manager
+   *          at abort or commit, and to prune version chains.  We need to expose the transaction
+   *          manager because that is where the deferred actions queue and the oldest running
+   *          transaction exist.
+   * @return the transaction manager, or nullptr if the context was created outside of one
    */
-  TransactionManager *GetTransactionManager() { return txn_mgr_; }
+  TransactionManager *GetTransactionManager() const { return txn_mgr_; }
+
+  /**
+   * Sets whether this transaction commits synchronously, which it does unless its transaction manager defaults to
+   * asynchronous commits. A synchronous commit invokes its commit callback once its commit record is persistent. An
+   * asynchronous commit invokes it as soon as the commit record is handed to the log manager, which persists it within
+   * its maximum commit lag, so the transaction can be lost on a crash even though its commit was acknowledged.
+   * Either way, its changes become visible to other transactions on commit. Has no effect if logging is disabled.
+   * @param synchronous_commit true to commit synchronously, false to commit asynchronously
+   */
+  void SetSynchronousCommit(const bool synchronous_commit) { synchronous_commit_ = synchronous_commit; }
+
+  /**
+   * @return whether this transaction commits synchronously
+   */
+  bool SynchronousCommit() const { return synchronous_commit_; }
+
+  /**
+   * @return whether this transaction was begun as read-only (see TransactionManager::BeginReadOnlyTransaction)
+   */
+  bool IsReadOnly() const { return read_only_; }
 
  private:
   friend class storage::GarbageCollector;
+  friend class TransactionContextPool;
   friend class TransactionManager;
   friend class storage::LogManager;
-  const timestamp_t start_time_;
+  timestamp_t start_time_;
   std::atomic<timestamp_t> txn_id_;
   storage::UndoBuffer undo_buffer_;
   storage::RedoBuffer redo_buffer_;
@@ -167,5 +194,22 @@ class TransactionContext {
   // log manager will set this to be true when log records are processed (not necessarily flushed, but will not be read
   // again in the future), so it can be garbage-collected safely.
   bool log_processed_ = false;
+
+  bool synchronous_commit_ = true;
+
+  bool read_only_ = false;
+
+  // Clears everything the finished transaction left behind, so that the context can be reused by a new transaction
+  void Clear() {
+    for (const byte *ptr : loose_ptrs_) delete[] ptr;
+    // Keeps the capacity, unlike the lists of actions whose nodes are freed either way
+    loose_ptrs_.clear();
+    abort_actions_.clear();
+    commit_actions_.clear();
+    undo_buffer_.Reset();
+    redo_buffer_.Reset();
+    log_processed_ = false;
+    read_only_ = false;
+  }
 };
 }  // namespace terrier::transaction
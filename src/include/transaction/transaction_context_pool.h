@@ -0,0 +1,87 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "common/constants.h"
+#include "common/macros.h"
+#include "common/spin_latch.h"
+#include "storage/record_buffer.h"
+#include "transaction/timestamp_allocator.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_defs.h"
+
+namespace terrier::storage {
+class LogManager;
+}  // namespace terrier::storage
+
+namespace terrier::transaction {
+/**
+ * Recycles the TransactionContexts of a TransactionManager, so that beginning a transaction does not allocate a new
+ * context, buffer segments and containers every time.
+ *
+ * Like RunningTransactions, the pool is split into one shard for each lane of the TimestampAllocator. A context is
+ * drawn from the shard of the lane its start timestamp came from, and returned to the same shard when it is released.
+ * A context therefore goes back to the thread that began its transaction, even though the GC is the one releasing it,
+ * and a thread only latches a shard no other thread uses in the common case. A reused context keeps a warm segment in
+ * each of its buffers and the capacity of its containers.
+ *
+ * Contexts only come back once the GC deallocates them, in one batch per GC run. Reuse thus only pays off if a shard
+ * can keep the transactions its threads begin between two GC runs.
+ */
+class TransactionContextPool {
+ public:
+  /**
+   * Default maximum number of contexts kept for reuse in a single shard
+   */
+  static constexpr uint32_t DEFAULT_REUSE_LIMIT_PER_LANE = 128;
+
+  /**
+   * Initializes a new pool of transaction contexts.
+   * @param buffer_pool the buffer pool transactions draw their buffer segments from
+   * @param log_manager pointer to log manager in the system, or nullptr, if logging is disabled
+   * @param transaction_manager pointer to the transaction manager that begins the transactions
+   * @param reuse_limit_per_lane maximum number of contexts kept for reuse in a single shard. Contexts released beyond
+   *                             that are deleted. A kept context holds on to a segment of each of its buffers, which
+   *                             count against the size limit of the buffer pool.
+   */
+  TransactionContextPool(storage::RecordBufferSegmentPool *const buffer_pool, storage::LogManager *const log_manager,
+                         TransactionManager *const transaction_manager, const uint32_t reuse_limit_per_lane)
+      : buffer_pool_(buffer_pool),
+        log_manager_(log_manager),
+        txn_mgr_(transaction_manager),
+        reuse_limit_per_lane_(reuse_limit_per_lane) {}
+
+  /**
+   * Deletes the contexts kept for reuse
+   */
+  ~TransactionContextPool();
+
+  DISALLOW_COPY_AND_MOVE(TransactionContextPool)
+
+  /**
+   * Hands out a context for a new transaction, reusing a released one if possible
+   * @param start the start timestamp of the transaction
+   * @param txn_id the id of the transaction, should be larger than all start time and commit time
+   * @return the transaction context
+   */
+  TransactionContext *Get(timestamp_t start, timestamp_t txn_id);
+
+  /**
+   * Takes back the context of a finished transaction that no one refers to anymore. It is either kept for reuse or
+   * deleted.
+   * @param txn the transaction context, which must have been handed out by this pool
+   */
+  void Release(TransactionContext *txn);
+
+ private:
+  struct alignas(common::Constants::CACHELINE_SIZE) Shard {
+    common::SpinLatch latch_;
+    std::vector<TransactionContext *> reusable_;
+  };
+
+  storage::RecordBufferSegmentPool *const buffer_pool_;
+  storage::LogManager *const log_manager_;
+  TransactionManager *const txn_mgr_;
+  const uint32_t reuse_limit_per_lane_;
+  std::array<Shard, TimestampAllocator::NUM_LANES> shards_;
+};
+}  // namespace terrier::transaction
@@ -1,15 +1,16 @@
 #pragma once
-#include <queue>
-#include <unordered_set>
+#include <atomic>
 #include <utility>
-#include "common/gate.h"
-#include "common/spin_latch.h"
 #include "common/strong_typedef.h"
 #include "storage/data_table.h"
 #include "storage/record_buffer.h"
 #include "storage/undo_record.h"
 #include "storage/write_ahead_log/log_manager.h"
+#include "transaction/epoch_reclaimer.h"
+#include "transaction/running_transactions.h"
+#include "transaction/timestamp_allocator.h"
 #include "transaction/transaction_context.h"
+#include "transaction/transaction_context_pool.h"
 #include "transaction/transaction_defs.h"
 
 namespace terrier::transaction {
@@ -26,10 +27,21 @@ class TransactionManager {
    * @param buffer_pool the buffer pool to use for transaction undo buffers
    * @param gc_enabled true if txns should be stored in a local queue to hand off to the GC, false otherwise
    * @param log_manager the log manager in the system, or LOGGING_DISABLED(nulllptr) if logging is turned off.
+   * @param synchronous_commit whether transactions commit synchronously unless they choose otherwise (see
+   *                           TransactionContext::SetSynchronousCommit)
+   * @param txn_reuse_limit_per_lane maximum number of finished transaction contexts kept for reuse by the threads of a
+   *                                 TimestampAllocator lane. Contexts come back once the GC deallocates them, so this
+   *                                 should cover the transactions these threads begin between two GC runs.
    */
   TransactionManager(storage::RecordBufferSegmentPool *const buffer_pool, const bool gc_enabled,
-                     storage::LogManager *log_manager)
-      : buffer_pool_(buffer_pool), gc_enabled_(gc_enabled), log_manager_(log_manager) {}
+                     storage::LogManager *log_manager, const bool synchronous_commit = true,
+                     const uint32_t txn_reuse_limit_per_lane = TransactionContextPool::DEFAULT_REUSE_LIMIT_PER_LANE)
+      : gc_enabled_(gc_enabled),
+        log_manager_(log_manager),
+        synchronous_commit_(synchronous_commit),
+        txn_pool_(buffer_pool, log_manager, this, txn_reuse_limit_per_lane) {
+    if (log_manager_ != LOGGING_DISABLED) log_manager_->RegisterTransactionManager(this);
+  }
 
   /**
    * Begins a transaction.
@@ -37,10 +49,21 @@ class TransactionManager {
    */
   TransactionContext *BeginTransaction();
 
+  /**
+   * Begins a read-only transaction, which reads the latest snapshot like a transaction begun with BeginTransaction but
+   * cannot write. It does not get a unique start timestamp, commits without a commit record, and is never handed to
+   * the GC. Its commit callback is invoked right away, even if it read changes whose commit records are not persistent
+   * yet. Its context is recycled as soon as it commits or aborts, so it must not be deleted, whether the GC is enabled
+   * or not.
+   * @return transaction context for the newly begun transaction
+   */
+  TransactionContext *BeginReadOnlyTransaction();
+
   /**
    * Commits a transaction, making all of its changes visible to others.
    * @param txn the transaction to commit
-   * @param callback function pointer of the callback to invoke when commit is
+   * @param callback function pointer of the callback to invoke when commit is persistent, or right away if the
+   *                 transaction commits asynchronously
    * @param callback_arg a void * argument that can be passed to the callback function when invoked
    * @return commit timestamp of this transaction
    */
@@ -61,9 +84,39 @@ class TransactionManager {
   timestamp_t OldestTransactionStartTime() const;
 
   /**
-   * @return unique timestamp based on current time, and advances one tick
+   * Returns what OldestTransactionStartTime returned recently, without scanning the running transactions. The result
+   * is possibly less recent, but still older than any transactions alive. Writers use it to prune the version
+   * chains of the tuples they update.
+   * @return timestamp that is older than any transactions alive, or timestamp 0 if none was computed yet
+   */
+  timestamp_t LastOldestTransactionStartTime() const { return last_oldest_txn_.load(); }
+
+  /**
+   * Unlike OldestTransactionStartTime, this does not wait for running transactions to end, but only for transactions
+   * that are in the middle of committing. A transaction that only read commits at its snapshot, which can be older.
+   * @return timestamp such that every updating transaction committing below it has finished committing, and thus
+   *         handed its commit record to the log manager, while every transaction committing later commits above it
+   */
+  timestamp_t CommittedTimestamp() const { return timestamps_.OldestStartTimestamp(); }
+
+  /**
+   * @return timestamp newer than the start time of every transaction begun so far, and older than the start time of
+   *         every transaction begun later
+   */
+  timestamp_t GetTimestamp() { return timestamps_.Advance(); }
+
+  /**
+   * Moves the timestamps handed out by this transaction manager past the given timestamp, so that a restarted system
+   * begins and commits its transactions after everything in the log it recovered from (see
+   * RecoveryManager::NewestTimestamp). Must be called before any transaction begins.
+   * @param timestamp newest timestamp of the recovered log
+   */
+  void AdvanceTimestampsPast(const timestamp_t timestamp) { timestamps_.AdvancePast(timestamp); }
+
+  /**
+   * @return the log manager transactions are logged to, or LOGGING_DISABLED if logging is turned off
    */
-  timestamp_t GetTimestamp() { return time_++; }
+  storage::LogManager *GetLogManager() const { return log_manager_; }
 
   /**
    * @return true if gc_enabled and storing completed txns in local queue, false otherwise
@@ -77,39 +130,55 @@ class TransactionManager {
   TransactionQueue CompletedTransactionsForGC();
 
   /**
-   * Adds the action to a buffered list of deferred actions.  This action will
-   * be triggered no sooner than when the epoch (timestamp of oldest running
-   * transaction) is more recent than the time this function was called.
+   * Frees a transaction handed to the GC, keeping its context for reuse by a later transaction.
+   * @param txn the finished transaction, which no one refers to anymore
+   */
+  void DeallocateTransaction(TransactionContext *txn) { txn_pool_.Release(txn); }
+
+  /**
+   * Adds the action to a buffered list of deferred actions. The action runs once every transaction that was running
+   * when it was deferred has finished, and the GC is done unlinking it and the log manager is done with it. It thus
+   * may free anything these transactions may have read or written, such as an index entry or a dropped table.
    * @param a functional implementation of the action that is deferred
    */
   void DeferAction(Action a);
 
   /**
-   * Transfers the buffered list of deferred actions to the GC for eventual
-   * execution.
-   * @return the deferred actions as a sorted queue of pairs where the timestamp is
-   *         earliest epoch the associated action can safely fire
+   * Collects the actions deferred since the last call, for ProcessDeferredActions to run once they are safe. Invoked
+   * by the GC before it reads the oldest running transaction, and must not be invoked by more than one thread at a
+   * time.
+   */
+  void CollectDeferredActions();
+
+  /**
+   * Runs the collected actions that no transaction can interfere with anymore. Invoked by the GC, and must not be
+   * invoked by more than one thread at a time.
+   * @param oldest_unprocessed timestamp that is not newer than the start time of any transaction that is running, or
+   *                           finished but not unlinked or logged yet
+   * @return number of deferred actions run
    */
-  std::queue<std::pair<timestamp_t, Action>> DeferredActionsForGC();
+  uint32_t ProcessDeferredActions(const timestamp_t oldest_unprocessed) {
+    return deferred_actions_.Reclaim(oldest_unprocessed);
+  }
 
  private:
-  storage::RecordBufferSegmentPool *buffer_pool_;
-  // TODO(Tianyu): Timestamp generation needs to be more efficient (batches)
   // TODO(Tianyu): We don't handle timestamp wrap-arounds. I doubt this would be an issue though.
-  std::atomic<timestamp_t> time_{timestamp_t(0)};
-
-  common::Gate txn_gate_;
+  TimestampAllocator timestamps_;
 
-  // TODO(Matt): consider a different data structure if this becomes a measured bottleneck
-  std::unordered_set<timestamp_t> curr_running_txns_;
-  mutable common::SpinLatch curr_running_txns_latch_;
+  // Also holds the completed transactions for the GC
+  RunningTransactions curr_running_txns_;
+  // Published by OldestTransactionStartTime. No transaction that begins later is older, so it stays safe to use.
+  mutable std::atomic<timestamp_t> last_oldest_txn_{timestamp_t(0)};
 
   bool gc_enabled_ = false;
-  TransactionQueue completed_txns_;
   storage::LogManager *const log_manager_;
+  const bool synchronous_commit_;
+  TransactionContextPool txn_pool_;
+
+  EpochReclaimer deferred_actions_;
 
-  std::queue<std::pair<timestamp_t, Action>> deferred_actions_;
-  mutable common::SpinLatch deferred_actions_latch_;
+  // Unregisters a transaction begun with BeginReadOnlyTransaction and recycles it
+  void EndReadOnly(TransactionContext *txn);
 
   timestamp_t ReadOnlyCommitCriticalSection(TransactionContext *txn, transaction::callback_fn callback,
                                             void *callback_arg);
@@ -117,7 +186,8 @@ class TransactionManager {
   timestamp_t UpdatingCommitCriticalSection(TransactionContext *txn, transaction::callback_fn callback,
                                             void *callback_arg);
 
-  void LogCommit(TransactionContext *txn, timestamp_t commit_time, transaction::callback_fn callback,
+  // Returns true if the caller has to invoke the callback, because the log manager does not
+  bool LogCommit(TransactionContext *txn, timestamp_t commit_time, transaction::callback_fn callback,
                  void *callback_arg);
 
   void Rollback(TransactionContext *txn, const storage::UndoRecord &record) const;
@@ -1,8 +1,10 @@
 #include "main/db_main.h"
 #include <memory>
+#include <string>
 #include "loggers/loggers_util.h"
 #include "settings/settings_manager.h"
 #include "storage/garbage_collector_thread.h"
+#include "storage/write_ahead_log/log_manager.h"
 #include "transaction/transaction_manager.h"
 #include "transaction/transaction_util.h"
 
@@ -20,10 +22,45 @@ void DBMain::Init() {
           param_map_.find(settings::Param::record_buffer_segment_size)->second.value_),
       type::TransientValuePeeker::PeekInteger(
           param_map_.find(settings::Param::record_buffer_segment_reuse)->second.value_));
-  txn_manager_ = new transaction::TransactionManager(buffer_segment_pool_, true, nullptr);
-  gc_thread_ = new storage::GarbageCollectorThread(txn_manager_,
-                                                   std::chrono::milliseconds{type::TransientValuePeeker::PeekInteger(
-                                                       param_map_.find(settings::Param::gc_interval)->second.value_)});
+  storage::LogManagerOptions log_options;
+  log_options.serialization_interval_ = std::chrono::microseconds{type::TransientValuePeeker::PeekInteger(
+      param_map_.find(settings::Param::log_serialization_interval)->second.value_)};
+  log_options.flush_interval_ = std::chrono::microseconds{
+      type::TransientValuePeeker::PeekInteger(param_map_.find(settings::Param::log_flush_interval)->second.value_)};
+  log_options.flush_threshold_ = static_cast<uint64_t>(
+      type::TransientValuePeeker::PeekInteger(param_map_.find(settings::Param::log_flush_threshold)->second.value_));
+  log_options.num_streams_ = static_cast<uint32_t>(
+      type::TransientValuePeeker::PeekInteger(param_map_.find(settings::Param::log_num_streams)->second.value_));
+  log_options.write_batch_size_ = static_cast<uint64_t>(
+      type::TransientValuePeeker::PeekInteger(param_map_.find(settings::Param::log_write_batch_size)->second.value_));
+  log_options.device_type_ = storage::LogDevice::TypeFromString(std::string(
+      type::TransientValuePeeker::PeekVarChar(param_map_.find(settings::Param::log_device)->second.value_)));
+  log_options.segment_size_ = static_cast<uint64_t>(
+      type::TransientValuePeeker::PeekInteger(param_map_.find(settings::Param::log_segment_size)->second.value_));
+  log_options.archive_dir_ = std::string(
+      type::TransientValuePeeker::PeekVarChar(param_map_.find(settings::Param::log_archive_dir)->second.value_));
+  log_options.max_commit_lag_ = std::chrono::microseconds{
+      type::TransientValuePeeker::PeekInteger(param_map_.find(settings::Param::log_max_commit_lag)->second.value_)};
+  log_options.compress_ =
+      type::TransientValuePeeker::PeekBoolean(param_map_.find(settings::Param::log_compression)->second.value_);
+  log_options.sync_latency_.median_ = std::chrono::microseconds{type::TransientValuePeeker::PeekInteger(
+      param_map_.find(settings::Param::log_simulated_sync_median)->second.value_)};
+  log_options.sync_latency_.p99_ = std::chrono::microseconds{type::TransientValuePeeker::PeekInteger(
+      param_map_.find(settings::Param::log_simulated_sync_p99)->second.value_)};
+  log_manager_ = new storage::LogManager(
+      std::string(type::TransientValuePeeker::PeekVarChar(param_map_.find(settings::Param::log_file_path)->second.value_))
+          .c_str(),
+      buffer_segment_pool_, log_options);
+  log_manager_->Start();
+  txn_manager_ = new transaction::TransactionManager(
+      buffer_segment_pool_, true, log_manager_,
+      type::TransientValuePeeker::PeekBoolean(param_map_.find(settings::Param::synchronous_commit)->second.value_));
+  gc_thread_ = new storage::GarbageCollectorThread(
+      txn_manager_,
+      std::chrono::milliseconds{
+          type::TransientValuePeeker::PeekInteger(param_map_.find(settings::Param::gc_interval)->second.value_)},
+      static_cast<uint32_t>(
+          type::TransientValuePeeker::PeekInteger(param_map_.find(settings::Param::gc_num_threads)->second.value_)));
   transaction::TransactionContext *txn = txn_manager_->BeginTransaction();
   settings_manager_ = new settings::SettingsManager(this);
   txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
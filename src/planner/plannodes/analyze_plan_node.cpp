@@ -28,6 +28,10 @@ common::hash_t AnalyzePlanNode::Hash() const {
     hash = common::HashUtil::CombineHashes(hash, common::HashUtil::Hash(&column_oid));
   }
 
+  // Hash sampling
+  hash = common::HashUtil::CombineHashes(hash, common::HashUtil::Hash(sampling_method_));
+  hash = common::HashUtil::CombineHashes(hash, common::HashUtil::Hash(sample_rate_));
+
   return common::HashUtil::CombineHashes(hash, AbstractPlanNode::Hash());
 }
 
@@ -56,6 +60,10 @@ bool AnalyzePlanNode::operator==(const AbstractPlanNode &rhs) const {
     }
   }
 
+  // Sampling
+  if (GetSamplingMethod() != other.GetSamplingMethod()) return false;
+  if (GetSampleRate() != other.GetSampleRate()) return false;
+
   return AbstractPlanNode::operator==(rhs);
 }
 
@@ -65,6 +73,8 @@ nlohmann::json AnalyzePlanNode::ToJson() const {
   j["namespace_oid"] = namespace_oid_;
   j["table_oid"] = table_oid_;
   j["column_oids"] = column_oids_;
+  j["sampling_method"] = sampling_method_;
+  j["sample_rate"] = sample_rate_;
   return j;
 }
 
@@ -74,5 +84,7 @@ void AnalyzePlanNode::FromJson(const nlohmann::json &j) {
   namespace_oid_ = j.at("namespace_oid").get<catalog::namespace_oid_t>();
   table_oid_ = j.at("table_oid").get<catalog::table_oid_t>();
   column_oids_ = j.at("column_oids").get<std::vector<catalog::col_oid_t>>();
+  sampling_method_ = j.at("sampling_method").get<storage::SamplingMethod>();
+  sample_rate_ = j.at("sample_rate").get<double>();
 }
 }  // namespace terrier::planner
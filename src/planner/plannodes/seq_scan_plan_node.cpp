@@ -3,19 +3,31 @@
 
 namespace terrier::planner {
 
-common::hash_t SeqScanPlanNode::Hash() const { return AbstractScanPlanNode::Hash(); }
+common::hash_t SeqScanPlanNode::Hash() const {
+  common::hash_t hash = AbstractScanPlanNode::Hash();
+  hash = common::HashUtil::CombineHashes(hash, common::HashUtil::Hash(sampling_method_));
+  return common::HashUtil::CombineHashes(hash, common::HashUtil::Hash(sample_rate_));
+}
 
-bool SeqScanPlanNode::operator==(const AbstractPlanNode &rhs) const { return AbstractScanPlanNode::operator==(rhs); }
+bool SeqScanPlanNode::operator==(const AbstractPlanNode &rhs) const {
+  if (!AbstractScanPlanNode::operator==(rhs)) return false;
+  auto &other = dynamic_cast<const SeqScanPlanNode &>(rhs);
+  return sampling_method_ == other.sampling_method_ && sample_rate_ == other.sample_rate_;
+}
 
 nlohmann::json SeqScanPlanNode::ToJson() const {
   nlohmann::json j = AbstractScanPlanNode::ToJson();
   j["table_oid"] = table_oid_;
+  j["sampling_method"] = sampling_method_;
+  j["sample_rate"] = sample_rate_;
   return j;
 }
 
 void SeqScanPlanNode::FromJson(const nlohmann::json &j) {
   AbstractScanPlanNode::FromJson(j);
   table_oid_ = j.at("table_oid").get<catalog::table_oid_t>();
+  sampling_method_ = j.at("sampling_method").get<storage::SamplingMethod>();
+  sample_rate_ = j.at("sample_rate").get<double>();
 }
 
 }  // namespace terrier::planner
@@ -0,0 +1,252 @@
+#include "storage/checkpoint/checkpoint_manager.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common/allocator.h"
+#include "common/container/bitmap.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
+#include "transaction/transaction_util.h"
+
+namespace terrier::storage {
+
+namespace {
+// Replaces whatever is at the path with an empty file, and opens it for writing
+BufferedLogWriter *CreateFile(const std::string &path) {
+  if (unlink(path.c_str()) == -1 && errno != ENOENT)
+    throw std::runtime_error("Failed to remove file with errno " + std::to_string(errno));
+  return new BufferedLogWriter(path.c_str());
+}
+
+// Makes sure files created or renamed in the directory survive a crash
+void PersistDirectory(const std::string &dir) {
+  const int fd = PosixIoWrappers::Open(dir.c_str(), O_RDONLY);
+  const int ret = fsync(fd);
+  PosixIoWrappers::Close(fd);
+  if (ret == -1) throw std::runtime_error("fsync failed with errno " + std::to_string(errno));
+}
+
+void ReadOrThrow(BufferedLogReader *const in, void *const dest, const uint32_t size) {
+  if (!in->Read(dest, size)) throw std::runtime_error("checkpoint file is truncated");
+}
+
+template <class T>
+T ReadValueOrThrow(BufferedLogReader *const in) {
+  T result;
+  ReadOrThrow(in, &result, sizeof(T));
+  return result;
+}
+}  // namespace
+
+transaction::timestamp_t CheckpointManager::Checkpoint(
+    const std::vector<std::pair<SqlTable *, const catalog::Schema *>> &tables) {
+  transaction::timestamp_t old_timestamp;
+  std::vector<catalog::table_oid_t> old_table_oids;
+  const bool has_old_checkpoint = ReadMetadata(&old_timestamp, &old_table_oids);
+
+  // Transactions that began before the oldest running one are done, so the checkpoint contains all of their changes
+  const transaction::timestamp_t log_safe_time = txn_manager_->OldestTransactionStartTime();
+  // A single transaction makes the checkpoint consistent across all tables
+  transaction::TransactionContext *txn = txn_manager_->BeginTransaction();
+  const transaction::timestamp_t timestamp = txn->StartTime();
+  for (const auto &table : tables) {
+    BufferedLogWriter *out = CreateFile(TablePath(timestamp, table.first->Oid()));
+    WriteTable(txn, *table.first, *table.second, out);
+    out->Persist();
+    out->Close();
+    delete out;
+  }
+  txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // The checkpoint is complete once its metadata atomically replaces the previous one
+  const std::string tmp_path = MetadataPath() + ".tmp";
+  BufferedLogWriter *out = CreateFile(tmp_path);
+  out->BufferWrite(&timestamp, sizeof(timestamp));
+  const auto num_tables = static_cast<uint32_t>(tables.size());
+  out->BufferWrite(&num_tables, sizeof(num_tables));
+  for (const auto &table : tables) {
+    const catalog::table_oid_t oid = table.first->Oid();
+    out->BufferWrite(&oid, sizeof(oid));
+  }
+  out->Persist();
+  out->Close();
+  delete out;
+  if (rename(tmp_path.c_str(), MetadataPath().c_str()) == -1)
+    throw std::runtime_error("Failed to rename checkpoint metadata with errno " + std::to_string(errno));
+  PersistDirectory(checkpoint_dir_);
+
+  // Nothing refers to the previous checkpoint anymore
+  if (has_old_checkpoint && old_timestamp != timestamp) {
+    for (const catalog::table_oid_t oid : old_table_oids) unlink(TablePath(old_timestamp, oid).c_str());
+  }
+  // Nor are the log records of those transactions needed anymore
+  storage::LogManager *const log_manager = txn_manager_->GetLogManager();
+  if (log_manager != LOGGING_DISABLED) log_manager->RemoveSegmentsBefore(log_safe_time);
+  return timestamp;
+}
+
+bool CheckpointManager::HasCheckpoint() const {
+  struct stat info;
+  return stat(MetadataPath().c_str(), &info) == 0;
+}
+
+transaction::timestamp_t CheckpointManager::Recover(
+    const catalog::db_oid_t db_oid, const std::vector<std::pair<SqlTable *, const catalog::Schema *>> &tables,
+    std::unordered_map<TupleSlot, TupleSlot> *const slot_map) {
+  transaction::timestamp_t timestamp;
+  std::vector<catalog::table_oid_t> table_oids;
+  if (!ReadMetadata(&timestamp, &table_oids)) throw std::runtime_error("no checkpoint to recover from");
+  for (const catalog::table_oid_t oid : table_oids) {
+    auto it = std::find_if(tables.begin(), tables.end(),
+                           [=](const std::pair<SqlTable *, const catalog::Schema *> &table) {
+                             return table.first->Oid() == oid;
+                           });
+    if (it == tables.end()) throw std::runtime_error("checkpoint contains a table that was not given");
+    BufferedLogReader in(TablePath(timestamp, oid).c_str());
+    LoadTable(db_oid, it->first, *it->second, &in, slot_map);
+  }
+  return timestamp;
+}
+
+void CheckpointManager::WriteTable(transaction::TransactionContext *const txn, const SqlTable &table,
+                                   const catalog::Schema &schema, BufferedLogWriter *const out) const {
+  // Header
+  const catalog::table_oid_t table_oid = table.Oid();
+  out->BufferWrite(&table_oid, sizeof(table_oid));
+  const auto num_columns = static_cast<uint16_t>(schema.GetColumns().size());
+  out->BufferWrite(&num_columns, sizeof(num_columns));
+  std::vector<catalog::col_oid_t> col_oids;
+  for (const auto &column : schema.GetColumns()) {
+    const catalog::col_oid_t col_oid = column.GetOid();
+    const uint8_t attr_size = column.GetAttrSize();
+    out->BufferWrite(&col_oid, sizeof(col_oid));
+    out->BufferWrite(&attr_size, sizeof(attr_size));
+    col_oids.push_back(col_oid);
+  }
+
+  // The projection orders columns by size, but they are written out in schema order
+  auto initializer = table.InitializerForProjectedColumns(col_oids, batch_size_);
+  byte *buffer = common::AllocationUtil::AllocateAligned(initializer.first.ProjectedColumnsSize());
+  ProjectedColumns *columns = initializer.first.Initialize(buffer);
+  std::vector<uint32_t> offsets;
+  auto it = table.begin();
+  while (it != table.end()) {
+    table.Scan(txn, &it, columns);
+    const uint32_t num_tuples = columns->NumTuples();
+    if (num_tuples == 0) continue;
+    out->BufferWrite(&num_tuples, sizeof(num_tuples));
+    out->BufferWrite(columns->TupleSlots(), static_cast<uint32_t>(sizeof(TupleSlot) * num_tuples));
+    for (const auto &column : schema.GetColumns()) {
+      const uint16_t offset = initializer.second.at(column.GetOid());
+      out->BufferWrite(columns->ColumnNullBitmap(offset), common::RawBitmap::SizeInBytes(num_tuples));
+      if (column.GetAttrSize() != VARLEN_COLUMN) {
+        out->BufferWrite(columns->ColumnStart(offset), column.GetAttrSize() * num_tuples);
+        continue;
+      }
+      // Gather varlen values behind an array of offsets, null values are empty
+      auto *entries = reinterpret_cast<VarlenEntry *>(columns->ColumnStart(offset));
+      offsets.assign(1, 0);
+      for (uint32_t i = 0; i < num_tuples; i++) {
+        const bool is_null = !columns->ColumnNullBitmap(offset)->Test(i);
+        offsets.push_back(offsets.back() + (is_null ? 0 : entries[i].Size()));
+      }
+      out->BufferWrite(offsets.data(), static_cast<uint32_t>(sizeof(uint32_t) * offsets.size()));
+      for (uint32_t i = 0; i < num_tuples; i++) {
+        if (offsets[i + 1] != offsets[i]) out->BufferWrite(entries[i].Content(), entries[i].Size());
+      }
+    }
+  }
+  const uint32_t end_of_table = 0;
+  out->BufferWrite(&end_of_table, sizeof(end_of_table));
+  delete[] buffer;
+}
+
+void CheckpointManager::LoadTable(const catalog::db_oid_t db_oid, SqlTable *const table,
+                                  const catalog::Schema &schema, BufferedLogReader *const in,
+                                  std::unordered_map<TupleSlot, TupleSlot> *const slot_map) const {
+  if (ReadValueOrThrow<catalog::table_oid_t>(in) != table->Oid())
+    throw std::runtime_error("checkpoint file belongs to a different table");
+  const auto num_columns = ReadValueOrThrow<uint16_t>(in);
+  std::vector<catalog::col_oid_t> col_oids;
+  std::vector<uint8_t> attr_sizes;
+  for (uint16_t i = 0; i < num_columns; i++) {
+    const auto col_oid = ReadValueOrThrow<catalog::col_oid_t>(in);
+    const auto attr_size = ReadValueOrThrow<uint8_t>(in);
+    const auto &columns = schema.GetColumns();
+    if (std::none_of(columns.begin(), columns.end(), [=](const catalog::Schema::Column &column) {
+          return column.GetOid() == col_oid && column.GetAttrSize() == attr_size;
+        }))
+      throw std::runtime_error("checkpoint columns do not match the schema");
+    col_oids.push_back(col_oid);
+    attr_sizes.push_back(attr_size);
+  }
+  const auto initializer = table->InitializerForProjectedRow(col_oids);
+
+  std::vector<TupleSlot> slots;
+  std::vector<std::vector<byte>> null_bitmaps(num_columns), values(num_columns);
+  std::vector<std::vector<uint32_t>> offsets(num_columns);
+  while (true) {
+    const auto num_tuples = ReadValueOrThrow<uint32_t>(in);
+    if (num_tuples == 0) break;
+    slots.resize(num_tuples);
+    ReadOrThrow(in, slots.data(), static_cast<uint32_t>(sizeof(TupleSlot) * num_tuples));
+    for (uint16_t col = 0; col < num_columns; col++) {
+      null_bitmaps[col].resize(common::RawBitmap::SizeInBytes(num_tuples));
+      ReadOrThrow(in, null_bitmaps[col].data(), static_cast<uint32_t>(null_bitmaps[col].size()));
+      uint32_t values_size = attr_sizes[col] * num_tuples;
+      if (attr_sizes[col] == VARLEN_COLUMN) {
+        offsets[col].resize(num_tuples + 1);
+        ReadOrThrow(in, offsets[col].data(), static_cast<uint32_t>(sizeof(uint32_t) * offsets[col].size()));
+        values_size = offsets[col].back();
+      }
+      values[col].resize(values_size);
+      ReadOrThrow(in, values[col].data(), values_size);
+    }
+
+    // Every batch is loaded by its own transaction to keep transactions, and their undo buffers, small
+    transaction::TransactionContext *txn = txn_manager_->BeginTransaction();
+    for (uint32_t i = 0; i < num_tuples; i++) {
+      RedoRecord *redo = txn->StageWrite(db_oid, table->Oid(), initializer.first);
+      ProjectedRow *row = redo->Delta();
+      for (uint16_t col = 0; col < num_columns; col++) {
+        const uint16_t offset = initializer.second.at(col_oids[col]);
+        if (!reinterpret_cast<common::RawBitmap *>(null_bitmaps[col].data())->Test(i)) {
+          row->SetNull(offset);
+          continue;
+        }
+        byte *dest = row->AccessForceNotNull(offset);
+        if (attr_sizes[col] != VARLEN_COLUMN) {
+          std::memcpy(dest, values[col].data() + attr_sizes[col] * i, attr_sizes[col]);
+          continue;
+        }
+        const byte *content = values[col].data() + offsets[col][i];
+        const uint32_t size = offsets[col][i + 1] - offsets[col][i];
+        if (size <= VarlenEntry::InlineThreshold()) {
+          *reinterpret_cast<VarlenEntry *>(dest) = VarlenEntry::CreateInline(content, size);
+        } else {
+          // The table takes ownership of the copy
+          byte *copy = common::AllocationUtil::AllocateAligned(size);
+          std::memcpy(copy, content, size);
+          *reinterpret_cast<VarlenEntry *>(dest) = VarlenEntry::Create(copy, size, true);
+        }
+      }
+      table->Insert(txn, redo);
+      if (slot_map != nullptr) (*slot_map)[slots[i]] = redo->GetTupleSlot();
+    }
+    txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  }
+}
+
+bool CheckpointManager::ReadMetadata(transaction::timestamp_t *const timestamp,
+                                     std::vector<catalog::table_oid_t> *const table_oids) const {
+  if (!HasCheckpoint()) return false;
+  BufferedLogReader in(MetadataPath().c_str());
+  *timestamp = ReadValueOrThrow<transaction::timestamp_t>(&in);
+  const auto num_tables = ReadValueOrThrow<uint32_t>(&in);
+  table_oids->clear();
+  for (uint32_t i = 0; i < num_tables; i++) table_oids->push_back(ReadValueOrThrow<catalog::table_oid_t>(&in));
+  return true;
+}
+}  // namespace terrier::storage
@@ -1,14 +1,22 @@
 #include "storage/data_table.h"
+#include <algorithm>
 #include <cstring>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include "common/allocator.h"
 #include "storage/storage_util.h"
 #include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
 #include "transaction/transaction_util.h"
 
 namespace terrier::storage {
-DataTable::DataTable(BlockStore *const store, const BlockLayout &layout, const layout_version_t layout_version)
-    : block_store_(store), layout_version_(layout_version), accessor_(layout) {
+DataTable::DataTable(BlockStore *const store, const BlockLayout &layout, const layout_version_t layout_version,
+                     const bool collect_statistics)
+    : block_store_(store),
+      layout_version_(layout_version),
+      accessor_(layout),
+      statistics_(collect_statistics ? std::make_unique<TableStatistics>(layout) : nullptr) {
   TERRIER_ASSERT(layout.AttrSize(VERSION_POINTER_COLUMN_ID) == 8,
                  "First column must have size 8 for the version chain.");
   TERRIER_ASSERT(layout.NumColumns() > NUM_RESERVED_COLUMNS,
@@ -48,6 +56,74 @@ void DataTable::Scan(transaction::TransactionContext *const txn, SlotIterator *c
   out_buffer->SetNumTuples(filled);
 }
 
+DataTable::SampleIterator DataTable::BeginSample(const SamplingMethod method, const double rate,
+                                                 const uint64_t seed) const {
+  TERRIER_ASSERT(rate >= 0.0 && rate <= 1.0, "sampling rate must be a probability");
+  std::vector<RawBlock *> blocks;
+  // Nothing would ever be sampled with a rate of 0, so we leave the iterator empty
+  if (rate > 0.0) {
+    common::SpinLatch::ScopedSpinLatch guard(&blocks_latch_);
+    blocks.assign(blocks_.begin(), blocks_.end());
+  }
+  return {std::move(blocks), accessor_.GetBlockLayout().NumSlots(), method, rate, seed};
+}
+
+void DataTable::SampleScan(transaction::TransactionContext *const txn, SampleIterator *const sample,
+                           ProjectedColumns *const out_buffer) const {
+  uint32_t filled = 0;
+  while (filled < out_buffer->MaxTuples() && !sample->Done()) {
+    ProjectedColumns::RowView row = out_buffer->InterpretAsRow(filled);
+    const TupleSlot slot = **sample;
+    // Only fill the buffer with valid, visible tuples
+    if (SelectIntoBuffer(txn, slot, &row)) {
+      out_buffer->TupleSlots()[filled] = slot;
+      filled++;
+    }
+    ++(*sample);
+  }
+  out_buffer->SetNumTuples(filled);
+}
+
+DataTable::SampleIterator::SampleIterator(std::vector<RawBlock *> &&blocks, const uint32_t slots_per_block,
+                                          const SamplingMethod method, const double rate, const uint64_t seed)
+    : blocks_(std::move(blocks)),
+      slots_per_block_(slots_per_block),
+      method_(method),
+      generator_(seed),
+      sample_all_(rate <= 0.0 || rate >= 1.0),
+      gap_(sample_all_ ? 0.5 : rate) {
+  Skip(NextGap());
+}
+
+DataTable::SampleIterator &DataTable::SampleIterator::operator++() {
+  switch (method_) {
+    case SamplingMethod::BERNOULLI:
+      Skip(1 + NextGap());
+      break;
+    case SamplingMethod::SYSTEM:
+      // Go through every slot in a sampled block that has been handed out to an insert, then skip to the next block
+      if (++offset_ >= std::min(slots_per_block_, blocks_[block_]->insert_head_.load())) {
+        offset_ = 0;
+        Skip(1 + NextGap());
+      }
+      break;
+    default:
+      throw std::runtime_error("unexpected sampling method");
+  }
+  return *this;
+}
+
+void DataTable::SampleIterator::Skip(const uint64_t distance) {
+  if (method_ == SamplingMethod::SYSTEM) {
+    block_ += distance;
+    return;
+  }
+  // Jump over whole blocks without touching them
+  const uint64_t slot = offset_ + distance;
+  block_ += slot / slots_per_block_;
+  offset_ = static_cast<uint32_t>(slot % slots_per_block_);
+}
+
 DataTable::SlotIterator &DataTable::SlotIterator::operator++() {
   common::SpinLatch::ScopedSpinLatch guard(&table_->blocks_latch_);
   // Jump to the next block if already the last slot in the block.
@@ -112,6 +188,7 @@ bool DataTable::Update(transaction::TransactionContext *const txn, const TupleSl
     // that's difficult with this implementation
     StorageUtil::CopyAttrFromProjection(accessor_, slot, redo, i);
   }
+  PruneVersionChain(*txn, slot, version_ptr);
   data_table_counter_.IncrementNumUpdate(1);
 
   return true;
@@ -134,6 +211,8 @@ TupleSlot DataTable::Insert(transaction::TransactionContext *const txn, const Pr
     NewBlock(block);
   }
   InsertInto(txn, redo, result);
+  // Unlike Update and Delete, an insert has no conflict to fail on. It either installs the tuple or throws while
+  // getting a new block above, so the counter is only ever bumped for inserts that happened.
   data_table_counter_.IncrementNumInsert(1);
   return result;
 }
@@ -157,7 +236,6 @@ void DataTable::InsertInto(transaction::TransactionContext *txn, const Projected
 }
 
 bool DataTable::Delete(transaction::TransactionContext *const txn, const TupleSlot slot) {
-  data_table_counter_.IncrementNumDelete(1);
   UndoRecord *const undo = txn->UndoRecordForDelete(this, slot);
   UndoRecord *version_ptr;
   do {
@@ -177,6 +255,8 @@ bool DataTable::Delete(transaction::TransactionContext *const txn, const TupleSl
 
   // We have the write lock. Go ahead and flip the logically deleted bit to true
   accessor_.SetNull(slot, VERSION_POINTER_COLUMN_ID);
+  PruneVersionChain(*txn, slot, version_ptr);
+  data_table_counter_.IncrementNumDelete(1);
   return true;
 }
 
@@ -286,6 +366,59 @@ bool DataTable::CompareAndSwapVersionPtr(const TupleSlot slot, const TupleAccess
   return reinterpret_cast<std::atomic<UndoRecord *> *>(ptr_location)->compare_exchange_strong(expected, desired);
 }
 
+void DataTable::TruncateVersionChain(const TupleSlot slot, const transaction::timestamp_t oldest) {
+  UndoRecord *const version_ptr = AtomicallyReadVersionPtr(slot, accessor_);
+  // This is a legitimate case where we truncated the version chain but had to restart because the previous head
+  // was aborted.
+  if (version_ptr == nullptr) return;
+
+  // We need to special case the head of the version chain because contention with running transactions can happen
+  // here. Instead of a blind update we will need to CAS and prune the entire version chain if the head of the version
+  // chain can be GCed.
+  if (transaction::TransactionUtil::NewerThan(oldest, version_ptr->Timestamp().load())) {
+    if (!CompareAndSwapVersionPtr(slot, accessor_, version_ptr, nullptr))
+      // Keep retrying while there are conflicts, since the GC only invokes truncate once per GC period for every
+      // version chain.
+      TruncateVersionChain(slot, oldest);
+    return;
+  }
+
+  // Below the head, a version chain only changes by being cut off. A concurrent truncation either cuts it above us, in
+  // which case our cut is harmless, or at the same place, so we are safe to traverse and update pointers without CAS.
+  // The records cut off stay valid while we traverse them, as the GC waits for both running transactions and its own
+  // unlinking to finish before freeing them.
+  UndoRecord *curr = version_ptr;
+  UndoRecord *next;
+  // Traverse until we find the earliest UndoRecord that can be unlinked.
+  while (true) {
+    next = curr->Next();
+    // This is a legitimate case where we truncated the version chain but had to restart because the previous head
+    // was aborted.
+    if (next == nullptr) return;
+    if (transaction::TransactionUtil::NewerThan(oldest, next->Timestamp().load())) break;
+    curr = next;
+  }
+  // The rest of the version chain must also be invisible to any running transactions since our version
+  // is newest-to-oldest sorted.
+  curr->Next().store(nullptr);
+
+  // If the head of the version chain was not committed, it could have been aborted and requires a retry.
+  if (curr == version_ptr && !transaction::TransactionUtil::Committed(version_ptr->Timestamp().load()) &&
+      AtomicallyReadVersionPtr(slot, accessor_) != version_ptr)
+    TruncateVersionChain(slot, oldest);
+}
+
+void DataTable::PruneVersionChain(const transaction::TransactionContext &txn, const TupleSlot slot,
+                                  const UndoRecord *const record) {
+  if (record == nullptr) return;
+  // Contexts created outside of a TransactionManager have no oldest running transaction to compare against
+  transaction::TransactionManager *const txn_manager = txn.GetTransactionManager();
+  if (txn_manager == nullptr) return;
+  // Reading the last computed value costs a single load, whereas computing a new one scans all running transactions
+  const transaction::timestamp_t oldest = txn_manager->LastOldestTransactionStartTime();
+  if (transaction::TransactionUtil::NewerThan(oldest, record->Timestamp().load())) TruncateVersionChain(slot, oldest);
+}
+
 void DataTable::NewBlock(RawBlock *expected_val) {
   common::SpinLatch::ScopedSpinLatch guard(&blocks_latch_);
   // Want to stop early if another thread is already getting a new block
@@ -310,6 +443,74 @@ void DataTable::DeallocateVarlensOnShutdown(RawBlock *block) {
   }
 }
 
+void DataTable::UpdateStatisticsOnCommit(const transaction::TransactionContext &txn, const UndoRecord &record) {
+  TERRIER_ASSERT(CollectsStatistics(), "only tables that collect statistics maintain them");
+  const TupleSlot slot = record.Slot();
+  // A transaction can modify the same tuple multiple times. We fold in the net effect of all of its changes once, when
+  // we encounter the record at the head of the version chain.
+  const UndoRecord *const head = AtomicallyReadVersionPtr(slot, accessor_);
+  if (head != &record) return;
+
+  // The transaction still holds the write lock, so the tuple in the block is its after-image. The before-image is
+  // spread across its undo records on the version chain, where the oldest one for each column holds the value that was
+  // visible before the transaction started. Transactions rarely modify a tuple more than once, so looking it up in the
+  // chain for every column is cheaper than collecting it into a buffer.
+  const transaction::timestamp_t txn_id = txn.TxnId().load();
+  bool inserted = false, deleted = false;
+  for (const UndoRecord *curr = head; curr != nullptr && curr->Timestamp().load() == txn_id; curr = curr->Next()) {
+    inserted = inserted || curr->Type() == DeltaRecordType::INSERT;
+    deleted = deleted || curr->Type() == DeltaRecordType::DELETE;
+  }
+
+  // A tuple that was both inserted and deleted by the transaction is never visible to anyone else
+  if (inserted && deleted) return;
+  const BlockLayout &layout = accessor_.GetBlockLayout();
+  if (inserted) {
+    statistics_->num_tuples_.fetch_add(1, std::memory_order_relaxed);
+    for (uint16_t i = NUM_RESERVED_COLUMNS; i < layout.NumColumns(); i++) {
+      const col_id_t col_id(i);
+      statistics_->MutableColumnStatistics(col_id)->AddValue(accessor_.AccessWithNullCheck(slot, col_id));
+    }
+  } else if (deleted) {
+    statistics_->num_tuples_.fetch_sub(1, std::memory_order_relaxed);
+    for (uint16_t i = NUM_RESERVED_COLUMNS; i < layout.NumColumns(); i++) {
+      const col_id_t col_id(i);
+      uint16_t index;
+      const ProjectedRow *const delta = OldestDeltaOf(head, txn_id, col_id, &index);
+      statistics_->MutableColumnStatistics(col_id)->RemoveValue(
+          delta != nullptr ? delta->AccessWithNullCheck(index) : accessor_.AccessWithNullCheck(slot, col_id));
+    }
+  } else {
+    for (const UndoRecord *curr = head; curr != nullptr && curr->Timestamp().load() == txn_id; curr = curr->Next()) {
+      const ProjectedRow &delta = *curr->Delta();
+      for (uint16_t i = 0; i < delta.NumColumns(); i++) {
+        // Only the oldest update to a column holds its before-image
+        const col_id_t col_id = delta.ColumnIds()[i];
+        uint16_t index;
+        if (OldestDeltaOf(curr->Next(), txn_id, col_id, &index) != nullptr) continue;
+        ColumnStatistics *const column_statistics = statistics_->MutableColumnStatistics(col_id);
+        column_statistics->RemoveValue(delta.AccessWithNullCheck(i));
+        column_statistics->AddValue(accessor_.AccessWithNullCheck(slot, col_id));
+      }
+    }
+  }
+}
+
+const ProjectedRow *DataTable::OldestDeltaOf(const UndoRecord *from, const transaction::timestamp_t txn_id,
+                                             const col_id_t col_id, uint16_t *const index) {
+  const ProjectedRow *result = nullptr;
+  for (const UndoRecord *curr = from; curr != nullptr && curr->Timestamp().load() == txn_id; curr = curr->Next()) {
+    if (curr->Type() != DeltaRecordType::UPDATE) continue;
+    const ProjectedRow &delta = *curr->Delta();
+    for (uint16_t i = 0; i < delta.NumColumns(); i++) {
+      if (delta.ColumnIds()[i] != col_id) continue;
+      result = &delta;
+      *index = i;
+    }
+  }
+  return result;
+}
+
 bool DataTable::HasConflict(const transaction::TransactionContext &txn, const TupleSlot slot) const {
   UndoRecord *const version_ptr = AtomicallyReadVersionPtr(slot, accessor_);
   return HasConflict(txn, version_ptr);
@@ -1,4 +1,5 @@
 #include "storage/garbage_collector.h"
+#include <algorithm>
 #include <unordered_set>
 #include <utility>
 #include "common/container/concurrent_queue.h"
@@ -11,52 +12,55 @@
 #include "transaction/transaction_util.h"
 
 namespace terrier::storage {
+namespace {
+// Splits a batch of the given size into contiguous ranges, and returns the first index of the range of the given thread
+uint64_t RangeStart(const uint64_t batch_size, const uint32_t thread, const uint64_t num_threads) {
+  return batch_size * thread / num_threads;
+}
+}  // namespace
+
+GarbageCollector::GarbageCollector(transaction::TransactionManager *const txn_manager, const uint32_t num_gc_threads)
+    : txn_manager_(txn_manager),
+      oldest_unprocessed_{0},
+      partitions_(num_gc_threads),
+      helpers_(num_gc_threads > 1 ? std::make_unique<common::WorkerPool>(num_gc_threads - 1, common::TaskQueue())
+                                  : nullptr) {
+  TERRIER_ASSERT(txn_manager_->GCEnabled(),
+                 "The TransactionManager needs to be instantiated with gc_enabled true for GC to work!");
+  TERRIER_ASSERT(num_gc_threads > 0, "The GC needs at least one thread.");
+  for (auto &partition : partitions_) partition.records_.resize(num_gc_threads);
+}
 
 std::pair<uint32_t, uint32_t> GarbageCollector::PerformGarbageCollection() {
+  // Collecting first lets the actions deferred until now run in this invocation, see ProcessDeferredActions. The
+  // transactions unlinked by the previous invocation are among them.
+  txn_manager_->CollectDeferredActions();
+  uint32_t txns_unlinked = ProcessUnlinkQueue();
+  STORAGE_LOG_TRACE("GarbageCollector::PerformGarbageCollection(): txns_unlinked: {}", txns_unlinked);
   ProcessDeferredActions();
   uint32_t txns_deallocated = ProcessDeallocateQueue();
   STORAGE_LOG_TRACE("GarbageCollector::PerformGarbageCollection(): txns_deallocated: {}", txns_deallocated);
-  uint32_t txns_unlinked = ProcessUnlinkQueue();
-  STORAGE_LOG_TRACE("GarbageCollector::PerformGarbageCollection(): txns_unlinked: {}", txns_unlinked);
-  if (txns_unlinked > 0) {
-    // Only update this field if we actually unlinked anything, otherwise we're being too conservative about when it's
-    // safe to deallocate the transactions in our queue.
-    last_unlinked_ = txn_manager_->GetTimestamp();
-  }
-  STORAGE_LOG_TRACE("GarbageCollector::PerformGarbageCollection(): last_unlinked_: {}",
-                    static_cast<uint64_t>(last_unlinked_));
   return std::make_pair(txns_deallocated, txns_unlinked);
 }
 
 uint32_t GarbageCollector::ProcessDeallocateQueue() {
-  const transaction::timestamp_t oldest_txn = txn_manager_->OldestTransactionStartTime();
-  uint32_t txns_processed = 0;
-  transaction::TransactionContext *txn = nullptr;
-
-  if (transaction::TransactionUtil::NewerThan(oldest_txn, last_unlinked_)) {
-    transaction::TransactionQueue requeue;
-    // All of the transactions in my deallocation queue were unlinked before the oldest running txn in the system.
-    // We are now safe to deallocate these txns because no running transaction should hold a reference to them anymore
-    while (!txns_to_deallocate_.empty()) {
-      txn = txns_to_deallocate_.front();
-      txns_to_deallocate_.pop_front();
-      if (txn->log_processed_) {
-        // If the log manager is already done with this transaction, it is safe to deallocate
-        delete txn;
-        txns_processed++;
-      } else {
-        // Otherwise, the log manager may need to read the varlen pointer, so we cannot deallocate yet
-        requeue.push_front(txn);
-      }
-    }
-    txns_to_deallocate_ = std::move(requeue);
-  }
-
+  if (txns_to_deallocate_.empty()) return 0;
+  // No running transaction can hold a reference to these transactions anymore, and the log manager is done with them
+  RunOnAllThreads([this](const uint32_t thread) {
+    const uint64_t end = RangeStart(txns_to_deallocate_.size(), thread + 1, partitions_.size());
+    for (uint64_t i = RangeStart(txns_to_deallocate_.size(), thread, partitions_.size()); i < end; i++)
+      txn_manager_->DeallocateTransaction(txns_to_deallocate_[i]);
+  });
+  const auto txns_processed = static_cast<uint32_t>(txns_to_deallocate_.size());
+  txns_to_deallocate_.clear();
   return txns_processed;
 }
 
 uint32_t GarbageCollector::ProcessUnlinkQueue() {
+  // A transaction is either running, waiting to be handed to us, or in one of our queues. Reading the oldest running
+  // transaction before taking the handed off ones makes sure that no transaction escapes both.
   const transaction::timestamp_t oldest_txn = txn_manager_->OldestTransactionStartTime();
+  oldest_unprocessed_ = oldest_txn;
   transaction::TransactionContext *txn = nullptr;
 
   // Get the completed transactions from the TransactionManager
@@ -69,10 +73,8 @@ uint32_t GarbageCollector::ProcessUnlinkQueue() {
   uint32_t txns_processed = 0;
   // Certain transactions might not be yet safe to gc. Need to requeue them
   transaction::TransactionQueue requeue;
-  // It is sufficient to truncate each version chain once in a GC invocation because we only read the maximal safe
-  // timestamp once, and the version chain is sorted by timestamp. Here we keep a set of slots to truncate to avoid
-  // wasteful traversals of the version chain.
-  std::unordered_set<TupleSlot> visited_slots;
+  // Transactions to deallocate once no running transaction can hold a reference to them anymore
+  std::vector<transaction::TransactionContext *> unlinked;
 
   // Process every transaction in the unlink queue
   while (!txns_to_unlink_.empty()) {
@@ -80,29 +82,20 @@ uint32_t GarbageCollector::ProcessUnlinkQueue() {
     txns_to_unlink_.pop_front();
     if (txn->undo_buffer_.Empty()) {
       // This is a read-only transaction so this is safe to immediately delete
-      delete txn;
+      txn_manager_->DeallocateTransaction(txn);
       txns_processed++;
-    } else if (!transaction::TransactionUtil::Committed(txn->TxnId().load())) {
+    } else if (txn->log_processed_ && !transaction::TransactionUtil::Committed(txn->TxnId().load())) {
       // This is an aborted txn. There is nothing to unlink because Rollback() handled that already, but we still need
       // to safely free the txn
-      txns_to_deallocate_.push_front(txn);
+      unlinked.push_back(txn);
       txns_processed++;
-    } else if (transaction::TransactionUtil::NewerThan(oldest_txn, txn->TxnId().load())) {
+    } else if (txn->log_processed_ && transaction::TransactionUtil::NewerThan(oldest_txn, txn->TxnId().load())) {
       // Safe to garbage collect.
-      for (auto &undo_record : txn->undo_buffer_) {
-        DataTable *&table = undo_record.Table();
-        // Each version chain needs to be traversed and truncated at most once every GC period. Check
-        // if we have already visited this tuple slot; if not, proceed to prune the version chain.
-        if (visited_slots.insert(undo_record.Slot()).second)
-          TruncateVersionChain(table, undo_record.Slot(), oldest_txn);
-        // Regardless of the version chain we will need to reclaim deleted slots and any dangling pointers to varlens.
-        ReclaimSlotIfDeleted(&undo_record);
-        ReclaimBufferIfVarlen(txn, &undo_record);
-      }
-      txns_to_deallocate_.push_front(txn);
-      txns_processed++;
+      batch_.push_back(txn);
     } else {
-      // This is a committed txn that is still visible, requeue for next GC run
+      // This is a committed txn that is still visible, or the log manager may still read its records and the varlens
+      // they point to. Requeue for next GC run. Until then, it holds back the deferred actions.
+      oldest_unprocessed_ = std::min(oldest_unprocessed_, txn->StartTime());
       requeue.push_front(txn);
     }
   }
@@ -110,65 +103,71 @@ uint32_t GarbageCollector::ProcessUnlinkQueue() {
   // Requeue any txns that we were still visible to running transactions
   txns_to_unlink_ = transaction::TransactionQueue(std::move(requeue));
 
-  return txns_processed;
-}
-
-void GarbageCollector::ProcessDeferredActions() {
-  auto new_actions = txn_manager_->DeferredActionsForGC();
-  while (!new_actions.empty()) {
-    deferred_actions_.push(new_actions.front());
-    new_actions.pop();
+  if (batch_.empty()) {
+    DeferDeallocation(std::move(unlinked));
+    return txns_processed;
   }
 
-  const transaction::timestamp_t oldest_txn = txn_manager_->OldestTransactionStartTime();
+  const uint64_t num_threads = partitions_.size();
+  // Every GC thread walks the undo records of its share of the batch, and routes each record to the thread that owns
+  // its slot, so that no two threads ever truncate the same version chain in this invocation.
+  RunOnAllThreads([&](const uint32_t thread) {
+    Partition &partition = partitions_[thread];
+    const uint64_t end = RangeStart(batch_.size(), thread + 1, num_threads);
+    for (uint64_t i = RangeStart(batch_.size(), thread, num_threads); i < end; i++) {
+      for (auto &undo_record : batch_[i]->undo_buffer_) {
+        // Dangling pointers to varlens are reclaimed regardless of the version chain, and only need the transaction
+        ReclaimBufferIfVarlen(batch_[i], &undo_record);
+        partition.records_[std::hash<TupleSlot>()(undo_record.Slot()) % num_threads].push_back(&undo_record);
+      }
+    }
+  });
+  // Every GC thread then truncates the version chains of its own slots
+  RunOnAllThreads([&](const uint32_t thread) {
+    Partition &partition = partitions_[thread];
+    for (auto &sender : partitions_) {
+      for (UndoRecord *const undo_record : sender.records_[thread]) {
+        // It is sufficient to truncate each version chain once in a GC invocation because we only read the maximal
+        // safe timestamp once, and the version chain is sorted by timestamp. Here we keep a set of slots to truncate
+        // to avoid wasteful traversals of the version chain.
+        if (partition.visited_slots_.insert(undo_record->Slot()).second)
+          undo_record->Table()->TruncateVersionChain(undo_record->Slot(), oldest_txn);
+        // Regardless of the version chain we will need to reclaim deleted slots
+        ReclaimSlotIfDeleted(undo_record);
+      }
+      // Clearing keeps the capacity of the lists and the buckets of the set for the next invocation
+      sender.records_[thread].clear();
+    }
+    partition.visited_slots_.clear();
+  });
 
-  // Execute as many deferred actions as we can at this time.
-  while ((!deferred_actions_.empty()) && deferred_actions_.front().first <= oldest_txn) {
-    deferred_actions_.front().second();
-    deferred_actions_.pop();
-  }
+  unlinked.insert(unlinked.end(), batch_.begin(), batch_.end());
+  txns_processed += static_cast<uint32_t>(batch_.size());
+  batch_.clear();
+  DeferDeallocation(std::move(unlinked));
+  return txns_processed;
 }
 
-void GarbageCollector::TruncateVersionChain(DataTable *const table, const TupleSlot slot,
-                                            const transaction::timestamp_t oldest) const {
-  const TupleAccessStrategy &accessor = table->accessor_;
-  UndoRecord *const version_ptr = table->AtomicallyReadVersionPtr(slot, accessor);
-  // This is a legitimate case where we truncated the version chain but had to restart because the previous head
-  // was aborted.
-  if (version_ptr == nullptr) return;
-
-  // We need to special case the head of the version chain because contention with running transactions can happen
-  // here. Instead of a blind update we will need to CAS and prune the entire version chain if the head of the version
-  // chain can be GCed.
-  if (transaction::TransactionUtil::NewerThan(oldest, version_ptr->Timestamp().load())) {
-    if (!table->CompareAndSwapVersionPtr(slot, accessor, version_ptr, nullptr))
-      // Keep retrying while there are conflicts, since we only invoke truncate once per GC period for every
-      // version chain.
-      TruncateVersionChain(table, slot, oldest);
-    return;
-  }
+void GarbageCollector::DeferDeallocation(std::vector<transaction::TransactionContext *> &&txns) {
+  if (txns.empty()) return;
+  // Running transactions may still be reading the unlinked undo records, so the txns wait in the same list as any
+  // other deferred action. Once it runs, the next call to ProcessDeallocateQueue frees them.
+  txn_manager_->DeferAction([this, txns = std::move(txns)] {
+    txns_to_deallocate_.insert(txns_to_deallocate_.end(), txns.begin(), txns.end());
+  });
+}
 
-  // a version chain is guaranteed to not change when not at the head (assuming single-threaded GC), so we are safe
-  // to traverse and update pointers without CAS
-  UndoRecord *curr = version_ptr;
-  UndoRecord *next;
-  // Traverse until we find the earliest UndoRecord that can be unlinked.
-  while (true) {
-    next = curr->Next();
-    // This is a legitimate case where we truncated the version chain but had to restart because the previous head
-    // was aborted.
-    if (next == nullptr) return;
-    if (transaction::TransactionUtil::NewerThan(oldest, next->Timestamp().load())) break;
-    curr = next;
-  }
-  // The rest of the version chain must also be invisible to any running transactions since our version
-  // is newest-to-oldest sorted.
-  curr->Next().store(nullptr);
-
-  // If the head of the version chain was not committed, it could have been aborted and requires a retry.
-  if (curr == version_ptr && !transaction::TransactionUtil::Committed(version_ptr->Timestamp().load()) &&
-      table->AtomicallyReadVersionPtr(slot, accessor) != version_ptr)
-    TruncateVersionChain(table, slot, oldest);
+void GarbageCollector::RunOnAllThreads(const std::function<void(uint32_t)> &task) {
+  // The invoking thread takes the first share instead of waiting idle
+  for (uint32_t thread = 1; thread < partitions_.size(); thread++)
+    helpers_->SubmitTask([&task, thread] { task(thread); });
+  task(0);
+  if (helpers_ != nullptr) helpers_->WaitUntilAllFinished();
+}
+
+void GarbageCollector::ProcessDeferredActions() {
+  const uint32_t actions_run UNUSED_ATTRIBUTE = txn_manager_->ProcessDeferredActions(oldest_unprocessed_);
+  STORAGE_LOG_TRACE("GarbageCollector::ProcessDeferredActions(): actions_run: {}", actions_run);
 }
 
 void GarbageCollector::ReclaimSlotIfDeleted(UndoRecord *const undo_record) const {
@@ -0,0 +1,198 @@
+#include "storage/partitioned_sql_table.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include "common/allocator.h"
+#include "common/hash_util.h"
+#include "transaction/transaction_manager.h"
+
+namespace terrier::storage {
+
+PartitionedSqlTable::PartitionedSqlTable(BlockStore *const store, const catalog::Schema &schema,
+                                         const catalog::table_oid_t oid, const catalog::col_oid_t partition_key,
+                                         const PartitionStrategy strategy, const uint32_t num_hash_partitions)
+    : block_store_(store),
+      schema_(schema),
+      oid_(oid),
+      strategy_(strategy),
+      prototype_(store, schema, oid),
+      key_col_id_(prototype_.InitializerForProjectedRow({partition_key}).first.ColId(0)),
+      key_attr_size_(schema.GetColumn(partition_key).GetAttrSize()),
+      key_is_varlen_(key_attr_size_ == VARLEN_COLUMN) {
+  TERRIER_ASSERT(strategy != PartitionStrategy::HASH || num_hash_partitions > 0,
+                 "hash partitioned tables need at least one partition");
+  TERRIER_ASSERT(strategy != PartitionStrategy::RANGE || num_hash_partitions == 0,
+                 "range partitions are created with CreateRangePartition");
+  TERRIER_ASSERT(strategy != PartitionStrategy::RANGE || !key_is_varlen_, "range partition key must be an integer");
+  for (uint32_t i = 0; i < num_hash_partitions; i++) partitions_[i] = new SqlTable(block_store_, schema_, oid_);
+}
+
+PartitionedSqlTable::~PartitionedSqlTable() {
+  common::SharedLatch::ScopedExclusiveLatch guard(&partitions_latch_);
+  for (auto &partition : partitions_) delete partition.second;
+}
+
+bool PartitionedSqlTable::Update(transaction::TransactionContext *const txn, RedoRecord *const redo) const {
+  TERRIER_ASSERT(redo->GetTupleSlot() != TupleSlot(nullptr, 0), "TupleSlot was never set in this RedoRecord.");
+  const ProjectedRow &delta = *redo->Delta();
+  TERRIER_ASSERT(std::find(delta.ColumnIds(), delta.ColumnIds() + delta.NumColumns(), key_col_id_) ==
+                     delta.ColumnIds() + delta.NumColumns(),
+                 "the partition key cannot be updated in place");
+  return redo->GetTupleSlot().GetBlock()->data_table_->Update(txn, redo->GetTupleSlot(), delta);
+}
+
+bool PartitionedSqlTable::Insert(transaction::TransactionContext *const txn, RedoRecord *const redo) const {
+  const ProjectedRow &delta = *redo->Delta();
+  const byte *key = nullptr;
+  for (uint16_t i = 0; i < delta.NumColumns(); i++) {
+    if (delta.ColumnIds()[i] == key_col_id_) {
+      key = delta.AccessWithNullCheck(i);
+      break;
+    }
+  }
+  // A null key does not belong to any partition
+  if (key == nullptr) return false;
+
+  // The latch only protects the partition from being dropped while routing. A concurrent drop after the latch is
+  // released is safe, as the partition is not freed until this transaction finishes.
+  common::SharedLatch::ScopedSharedLatch guard(&partitions_latch_);
+  SqlTable *const partition = PartitionForKey(key);
+  if (partition == nullptr) return false;
+  partition->Insert(txn, redo);
+  return true;
+}
+
+bool PartitionedSqlTable::CreateRangePartition(const int64_t lower_bound) {
+  TERRIER_ASSERT(strategy_ == PartitionStrategy::RANGE, "only range partitions can be created");
+  // Allocate outside of the critical section. A new DataTable does not hold any blocks, so this is cheap.
+  auto *const partition = new SqlTable(block_store_, schema_, oid_);
+  common::SharedLatch::ScopedExclusiveLatch guard(&partitions_latch_);
+  if (!partitions_.emplace(lower_bound, partition).second) {
+    delete partition;
+    return false;
+  }
+  return true;
+}
+
+bool PartitionedSqlTable::DropRangePartition(transaction::TransactionManager *const txn_manager,
+                                             const int64_t lower_bound) {
+  TERRIER_ASSERT(strategy_ == PartitionStrategy::RANGE, "only range partitions can be dropped");
+  SqlTable *partition;
+  {
+    common::SharedLatch::ScopedExclusiveLatch guard(&partitions_latch_);
+    const auto it = partitions_.find(lower_bound);
+    if (it == partitions_.end()) return false;
+    partition = it->second;
+    partitions_.erase(it);
+  }
+  // Transactions that started before the drop might still be reading or writing the partition. Even once they are all
+  // done, their undo records are in the partition's version chains and their redo records may not be logged yet, which
+  // the deferred action waits for as well.
+  txn_manager->DeferAction([=] { delete partition; });
+  return true;
+}
+
+std::vector<SqlTable *> PartitionedSqlTable::Partitions() const {
+  common::SharedLatch::ScopedSharedLatch guard(&partitions_latch_);
+  std::vector<SqlTable *> result;
+  result.reserve(partitions_.size());
+  for (const auto &partition : partitions_) result.push_back(partition.second);
+  return result;
+}
+
+std::vector<SqlTable *> PartitionedSqlTable::PrunePartitions(const int64_t low, const int64_t high) const {
+  TERRIER_ASSERT(!key_is_varlen_, "pruning by range is only possible on integer keys");
+  common::SharedLatch::ScopedSharedLatch guard(&partitions_latch_);
+  std::vector<SqlTable *> result;
+  if (low > high) return result;
+  if (strategy_ == PartitionStrategy::HASH) {
+    if (low != high) {
+      for (const auto &partition : partitions_) result.push_back(partition.second);
+      return result;
+    }
+    // Point lookup, lay out the key the same way it is stored to hash it
+    byte key[sizeof(int64_t)];
+    switch (key_attr_size_) {
+      case 1:
+        *reinterpret_cast<int8_t *>(key) = static_cast<int8_t>(low);
+        break;
+      case 2:
+        *reinterpret_cast<int16_t *>(key) = static_cast<int16_t>(low);
+        break;
+      case 4:
+        *reinterpret_cast<int32_t *>(key) = static_cast<int32_t>(low);
+        break;
+      case 8:
+        *reinterpret_cast<int64_t *>(key) = low;
+        break;
+      default:
+        throw std::runtime_error("unexpected partition key size");
+    }
+    result.push_back(PartitionForKey(key));
+    return result;
+  }
+
+  // The partition containing low is the last one starting at or before it, and every partition after it up to the
+  // last one starting at or before high overlaps the range
+  auto it = partitions_.upper_bound(low);
+  if (it != partitions_.begin()) --it;
+  for (; it != partitions_.end() && it->first <= high; ++it) result.push_back(it->second);
+  return result;
+}
+
+void PartitionedSqlTable::ParallelScan(transaction::TransactionContext *const txn,
+                                       const std::vector<SqlTable *> &partitions,
+                                       const std::vector<catalog::col_oid_t> &col_oids, const uint32_t max_tuples,
+                                       common::WorkerPool *const workers,
+                                       const std::function<void(uint32_t, ProjectedColumns *)> &consumer) const {
+  // The workers share the transaction, which is only safe as long as nothing modifies it while they scan
+  TERRIER_ASSERT(txn->IsReadOnly(), "parallel scans need a transaction begun with BeginReadOnlyTransaction");
+  const ProjectedColumnsInitializer initializer = InitializerForProjectedColumns(col_oids, max_tuples).first;
+  for (uint32_t i = 0; i < partitions.size(); i++) {
+    workers->SubmitTask([&, i] {
+      SqlTable *const partition = partitions[i];
+      byte *const buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedColumnsSize());
+      ProjectedColumns *const columns = initializer.Initialize(buffer);
+      auto it = partition->begin();
+      while (it != partition->end()) {
+        partition->Scan(txn, &it, columns);
+        if (columns->NumTuples() > 0) consumer(i, columns);
+      }
+      delete[] buffer;
+    });
+  }
+  workers->WaitUntilAllFinished();
+}
+
+SqlTable *PartitionedSqlTable::PartitionForKey(const byte *const key) const {
+  if (strategy_ == PartitionStrategy::HASH) {
+    common::hash_t hash;
+    if (key_is_varlen_) {
+      auto *const entry = reinterpret_cast<const VarlenEntry *>(key);
+      hash = common::HashUtil::HashBytes(entry->Content(), entry->Size());
+    } else {
+      hash = common::HashUtil::HashBytes(key, key_attr_size_);
+    }
+    return partitions_.at(static_cast<int64_t>(common::HashUtil::Mix(hash) % partitions_.size()));
+  }
+  // The partition a key belongs to is the last one starting at or before it
+  auto it = partitions_.upper_bound(ReadIntegerKey(key));
+  if (it == partitions_.begin()) return nullptr;
+  return (--it)->second;
+}
+
+int64_t PartitionedSqlTable::ReadIntegerKey(const byte *const key) const {
+  switch (key_attr_size_) {
+    case 1:
+      return *reinterpret_cast<const int8_t *>(key);
+    case 2:
+      return *reinterpret_cast<const int16_t *>(key);
+    case 4:
+      return *reinterpret_cast<const int32_t *>(key);
+    case 8:
+      return *reinterpret_cast<const int64_t *>(key);
+    default:
+      throw std::runtime_error("unexpected partition key size");
+  }
+}
+}  // namespace terrier::storage
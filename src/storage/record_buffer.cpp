@@ -5,7 +5,8 @@ namespace terrier::storage {
 byte *UndoBuffer::NewEntry(const uint32_t size) {
   if (buffers_.empty() || !buffers_.back()->HasBytesLeft(size)) {
     // we are out of space in the buffer. Get a new buffer segment.
-    RecordBufferSegment *new_segment = buffer_pool_->Get();
+    RecordBufferSegment *new_segment = warm_segment_ != nullptr ? warm_segment_ : buffer_pool_->Get();
+    warm_segment_ = nullptr;
     TERRIER_ASSERT(reinterpret_cast<uintptr_t>(new_segment) % 8 == 0, "a delta entry should be aligned to 8 bytes");
     buffers_.push_back(new_segment);
   }
@@ -13,17 +14,35 @@ byte *UndoBuffer::NewEntry(const uint32_t size) {
   return last_record_;
 }
 
+void UndoBuffer::Reset() {
+  for (auto *segment : buffers_) {
+    if (warm_segment_ == nullptr)
+      warm_segment_ = segment->Reset();
+    else
+      buffer_pool_->Release(segment);
+  }
+  buffers_.clear();
+  last_record_ = nullptr;
+}
+
+RecordBufferSegment *RedoBuffer::NewSegment() {
+  if (warm_segment_ == nullptr) return buffer_pool_->Get();
+  RecordBufferSegment *const result = warm_segment_;
+  warm_segment_ = nullptr;
+  return result;
+}
+
 byte *RedoBuffer::NewEntry(const uint32_t size) {
   if (buffer_seg_ == nullptr) {
     // this is the first write
-    buffer_seg_ = buffer_pool_->Get();
+    buffer_seg_ = NewSegment();
   } else if (!buffer_seg_->HasBytesLeft(size)) {
     // old log buffer is full
     if (log_manager_ != LOGGING_DISABLED)
       log_manager_->AddBufferToFlushQueue(buffer_seg_);
     else
       buffer_pool_->Release(buffer_seg_);
-    buffer_seg_ = buffer_pool_->Get();
+    buffer_seg_ = NewSegment();
   }
   TERRIER_ASSERT(buffer_seg_->HasBytesLeft(size),
                  "Staged write does not fit into redo buffer (even after a fresh one is requested)");
@@ -33,9 +52,13 @@ byte *RedoBuffer::NewEntry(const uint32_t size) {
 
 void RedoBuffer::Finalize(bool committed) {
   if (buffer_seg_ == nullptr) return;
-  if (log_manager_ != LOGGING_DISABLED && committed)
+  if (log_manager_ != LOGGING_DISABLED && committed) {
     log_manager_->AddBufferToFlushQueue(buffer_seg_);
-  else
-    buffer_pool_->Release(buffer_seg_);
+  } else {
+    // Keep the segment for the next transaction that reuses this buffer, if any. The warm segment was used up by
+    // the first write.
+    TERRIER_ASSERT(warm_segment_ == nullptr, "a redo buffer with entries cannot have a warm segment left");
+    warm_segment_ = buffer_seg_->Reset();
+  }
 }
 }  // namespace terrier::storage
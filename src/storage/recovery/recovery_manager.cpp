@@ -0,0 +1,138 @@
+#include "storage/recovery/recovery_manager.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/allocator.h"
+#include "common/worker_pool.h"
+#include "storage/write_ahead_log/log_reader.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
+#include "transaction/transaction_util.h"
+
+namespace terrier::storage {
+namespace {
+catalog::table_oid_t TableOid(const LogRecord &record) {
+  return record.RecordType() == LogRecordType::REDO ? record.GetUnderlyingRecordBodyAs<RedoRecord>()->GetTableOid()
+                                                     : record.GetUnderlyingRecordBodyAs<DeleteRecord>()->GetTableOid();
+}
+
+TupleSlot LoggedSlot(const LogRecord &record) {
+  return record.RecordType() == LogRecordType::REDO ? record.GetUnderlyingRecordBodyAs<RedoRecord>()->GetTupleSlot()
+                                                     : record.GetUnderlyingRecordBodyAs<DeleteRecord>()->GetTupleSlot();
+}
+
+// Varlen values of a record read from the log point into the record, which is freed once replayed
+void CopyVarlens(const BlockLayout &layout, ProjectedRow *const delta) {
+  for (uint16_t i = 0; i < delta->NumColumns(); i++) {
+    if (!layout.IsVarlen(delta->ColumnIds()[i])) continue;
+    auto *const entry = reinterpret_cast<VarlenEntry *>(delta->AccessWithNullCheck(i));
+    if (entry == nullptr || entry->IsInlined()) continue;
+    byte *const content = common::AllocationUtil::AllocateAligned(entry->Size());
+    std::memcpy(content, entry->Content(), entry->Size());
+    *entry = VarlenEntry::Create(content, entry->Size(), true);
+  }
+}
+
+void FreeRecords(const std::vector<std::vector<LogRecord *>> &txns) {
+  for (const auto &records : txns)
+    for (LogRecord *record : records) delete[] reinterpret_cast<byte *>(record);
+}
+}  // namespace
+
+uint64_t RecoveryManager::Recover(const std::vector<SqlTable *> &tables,
+                                  std::unordered_map<TupleSlot, TupleSlot> *slot_map,
+                                  const transaction::timestamp_t checkpoint_time) {
+  std::unordered_map<TupleSlot, TupleSlot> local_slot_map;
+  if (slot_map == nullptr) slot_map = &local_slot_map;
+  std::unordered_map<catalog::table_oid_t, SqlTable *> tables_by_oid;
+  for (SqlTable *table : tables) tables_by_oid[table->Oid()] = table;
+
+  // Distribute the records of every committed transaction among the partitions
+  LogReader reader(log_file_paths_);
+  newest_timestamp_ = std::max(reader.NewestTimestamp(), checkpoint_time);
+  std::vector<std::vector<LogRecord *>> txns;
+  std::vector<ReplayPartition> partitions(num_threads_);
+  uint64_t num_replayed = 0;
+  while (reader.HasMore()) {
+    txns.emplace_back(reader.NextTransaction());
+    const std::vector<LogRecord *> &records = txns.back();
+    if (records.back()->GetUnderlyingRecordBodyAs<CommitRecord>()->CommitTime() < checkpoint_time) continue;
+    num_replayed++;
+    for (LogRecord *record : records) {
+      if (record->RecordType() == LogRecordType::COMMIT) continue;
+      const catalog::table_oid_t table_oid = TableOid(*record);
+      if (tables_by_oid.count(table_oid) == 0) {
+        FreeRecords(txns);
+        throw std::runtime_error("log contains records of table " + std::to_string(!table_oid) + " which was not given");
+      }
+      ReplayPartition &partition = partitions[std::hash<TupleSlot>()(LoggedSlot(*record)) % num_threads_];
+      if (partition.last_txn_ != txns.size()) {
+        partition.txns_.emplace_back();
+        partition.last_txn_ = txns.size();
+      }
+      partition.txns_.back().push_back(record);
+    }
+  }
+
+  {
+    common::WorkerPool thread_pool(num_threads_, {});
+    for (ReplayPartition &partition : partitions)
+      thread_pool.SubmitTask([&, p = &partition] { Replay(p, tables_by_oid, *slot_map); });
+    thread_pool.WaitUntilAllFinished();
+  }
+  FreeRecords(txns);
+
+  // Partitions own disjoint sets of logged slots, so their changes can be applied in any order
+  for (const ReplayPartition &partition : partitions) {
+    for (const auto &entry : partition.replayed_slots_) {
+      if (entry.second == TupleSlot(nullptr, 0))
+        slot_map->erase(entry.first);
+      else
+        (*slot_map)[entry.first] = entry.second;
+    }
+  }
+  return num_replayed;
+}
+
+void RecoveryManager::Replay(ReplayPartition *const partition,
+                             const std::unordered_map<catalog::table_oid_t, SqlTable *> &tables,
+                             const std::unordered_map<TupleSlot, TupleSlot> &slot_map) {
+  // Returns the slot a logged tuple currently lives in, or TupleSlot(nullptr, 0) if it does not exist
+  auto current_slot = [&](const TupleSlot logged) {
+    auto replayed = partition->replayed_slots_.find(logged);
+    if (replayed != partition->replayed_slots_.end()) return replayed->second;
+    auto loaded = slot_map.find(logged);
+    return loaded == slot_map.end() ? TupleSlot(nullptr, 0) : loaded->second;
+  };
+
+  for (const std::vector<LogRecord *> &records : partition->txns_) {
+    auto *txn = txn_manager_->BeginTransaction();
+    for (LogRecord *record : records) {
+      SqlTable *const table = tables.at(TableOid(*record));
+      const TupleSlot logged = LoggedSlot(*record);
+      const TupleSlot slot = current_slot(logged);
+      if (record->RecordType() == LogRecordType::DELETE) {
+        TERRIER_ASSERT(slot != TupleSlot(nullptr, 0), "log deletes a tuple that does not exist");
+        const bool result UNUSED_ATTRIBUTE = table->Delete(txn, slot);
+        TERRIER_ASSERT(result, "replayed delete cannot conflict");
+        partition->replayed_slots_[logged] = TupleSlot(nullptr, 0);
+        continue;
+      }
+      auto *redo = record->GetUnderlyingRecordBodyAs<RedoRecord>();
+      CopyVarlens(table->table_.layout, redo->Delta());
+      if (slot == TupleSlot(nullptr, 0)) {
+        // A slot we do not know about yet can only be a new tuple, because the log starts at the checkpoint
+        table->Insert(txn, redo);
+        partition->replayed_slots_[logged] = redo->GetTupleSlot();
+      } else {
+        redo->SetTupleSlot(slot);
+        const bool result UNUSED_ATTRIBUTE = table->Update(txn, redo);
+        TERRIER_ASSERT(result, "replayed update cannot conflict");
+      }
+    }
+    txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  }
+}
+}  // namespace terrier::storage
@@ -0,0 +1,60 @@
+#include "storage/replication/log_shipper.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "loggers/storage_logger.h"
+
+namespace terrier::storage {
+namespace {
+// Sends all of the given bytes, or returns false if the replica went away. A replica going away must not kill the
+// primary with a SIGPIPE.
+bool SendFully(const int fd, const void *const buf, const size_t nbyte) {
+  size_t sent = 0;
+  while (sent < nbyte) {
+    const ssize_t ret = send(fd, reinterpret_cast<const char *>(buf) + sent, nbyte - sent, MSG_NOSIGNAL);
+    if (ret == -1) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    sent += static_cast<size_t>(ret);
+  }
+  return true;
+}
+}  // namespace
+
+LogShipper::LogShipper(const std::string &socket_path) : fd_(socket(AF_UNIX, SOCK_STREAM, 0)) {
+  if (fd_ == -1) throw std::runtime_error("Failed to create socket with errno " + std::to_string(errno));
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    close(fd_);
+    throw std::runtime_error("Socket path " + socket_path + " is too long");
+  }
+  std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+  while (connect(fd_.load(), reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1) {
+    if (errno == EINTR) continue;
+    const int error = errno;
+    close(fd_);
+    throw std::runtime_error("Failed to connect to replica with errno " + std::to_string(error));
+  }
+}
+
+LogShipper::~LogShipper() {
+  if (fd_ != -1) close(fd_);
+}
+
+void LogShipper::Ship(const std::vector<byte> &frames, const transaction::timestamp_t watermark,
+                      const transaction::timestamp_t oldest_running) {
+  const int fd = fd_.load();
+  if (fd == -1) return;
+  const BatchHeader header{frames.size(), watermark, oldest_running};
+  if (SendFully(fd, &header, sizeof(header)) && SendFully(fd, frames.data(), frames.size())) return;
+  STORAGE_LOG_ERROR("Lost the connection to the replica with errno {}, log shipping stopped", errno);
+  fd_ = -1;
+  close(fd);
+}
+}  // namespace terrier::storage
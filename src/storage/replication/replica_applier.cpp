@@ -0,0 +1,231 @@
+#include "storage/replication/replica_applier.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/allocator.h"
+#include "loggers/storage_logger.h"
+#include "storage/replication/log_shipper.h"
+#include "storage/write_ahead_log/log_io.h"
+#include "storage/write_ahead_log/log_serializer.h"
+#include "storage/write_ahead_log/mapped_log_reader.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
+#include "transaction/transaction_util.h"
+
+namespace terrier::storage {
+namespace {
+catalog::table_oid_t TableOid(const LogRecord &record) {
+  return record.RecordType() == LogRecordType::REDO ? record.GetUnderlyingRecordBodyAs<RedoRecord>()->GetTableOid()
+                                                     : record.GetUnderlyingRecordBodyAs<DeleteRecord>()->GetTableOid();
+}
+
+TupleSlot LoggedSlot(const LogRecord &record) {
+  return record.RecordType() == LogRecordType::REDO ? record.GetUnderlyingRecordBodyAs<RedoRecord>()->GetTupleSlot()
+                                                     : record.GetUnderlyingRecordBodyAs<DeleteRecord>()->GetTupleSlot();
+}
+
+// Varlen values of a shipped record point into the record, which is freed once applied
+void CopyVarlens(const BlockLayout &layout, ProjectedRow *const delta) {
+  for (uint16_t i = 0; i < delta->NumColumns(); i++) {
+    if (!layout.IsVarlen(delta->ColumnIds()[i])) continue;
+    auto *const entry = reinterpret_cast<VarlenEntry *>(delta->AccessWithNullCheck(i));
+    if (entry == nullptr || entry->IsInlined()) continue;
+    byte *const content = common::AllocationUtil::AllocateAligned(entry->Size());
+    std::memcpy(content, entry->Content(), entry->Size());
+    *entry = VarlenEntry::Create(content, entry->Size(), true);
+  }
+}
+
+void FreeRecords(const std::vector<LogRecord *> &records) {
+  for (LogRecord *record : records) delete[] reinterpret_cast<byte *>(record);
+}
+
+transaction::timestamp_t CommitTime(const std::vector<LogRecord *> &records) {
+  return records.back()->GetUnderlyingRecordBodyAs<CommitRecord>()->CommitTime();
+}
+}  // namespace
+
+ReplicaApplier::ReplicaApplier(std::string socket_path, const std::vector<SqlTable *> &tables,
+                               transaction::TransactionManager *const txn_manager)
+    : socket_path_(std::move(socket_path)), txn_manager_(txn_manager), listen_fd_(socket(AF_UNIX, SOCK_STREAM, 0)) {
+  for (SqlTable *table : tables) tables_[table->Oid()] = table;
+  if (listen_fd_ == -1) throw std::runtime_error("Failed to create socket with errno " + std::to_string(errno));
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socket_path_.size() >= sizeof(address.sun_path)) {
+    close(listen_fd_);
+    throw std::runtime_error("Socket path " + socket_path_ + " is too long");
+  }
+  std::strncpy(address.sun_path, socket_path_.c_str(), sizeof(address.sun_path) - 1);
+  if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1 || listen(listen_fd_, 1) == -1) {
+    const int error = errno;
+    close(listen_fd_);
+    throw std::runtime_error("Failed to listen on " + socket_path_ + " with errno " + std::to_string(error));
+  }
+  applier_thread_ = std::thread([this] { ApplierThreadLoop(); });
+}
+
+ReplicaApplier::~ReplicaApplier() {
+  Stop();
+  close(listen_fd_);
+  unlink(socket_path_.c_str());
+}
+
+bool ReplicaApplier::WaitForVisible(const transaction::timestamp_t commit_time) {
+  std::unique_lock<std::mutex> lock(visible_latch_);
+  visible_cv_.wait(lock, [&] { return commit_time < VisibleTimestamp() || disconnected_; });
+  return commit_time < VisibleTimestamp();
+}
+
+void ReplicaApplier::Stop() {
+  if (!applier_thread_.joinable()) return;
+  // Wakes up the applier thread whether it waits for the primary to connect or for the next batch
+  shutdown(listen_fd_, SHUT_RDWR);
+  const int connection_fd = connection_fd_.exchange(STOPPED);
+  if (connection_fd >= 0) shutdown(connection_fd, SHUT_RDWR);
+  applier_thread_.join();
+  if (connection_fd >= 0) close(connection_fd);
+}
+
+void ReplicaApplier::ApplierThreadLoop() {
+  int fd;
+  while ((fd = accept(listen_fd_, nullptr, nullptr)) == -1 && errno == EINTR) {
+  }
+  int expected = NOT_CONNECTED;
+  // Stop() may have come first, in which case it never learns about the connection
+  if (fd != -1 && !connection_fd_.compare_exchange_strong(expected, fd)) {
+    close(fd);
+    fd = -1;
+  }
+  if (fd != -1) {
+    try {
+      LogShipper::BatchHeader header;
+      while (PosixIoWrappers::ReadFully(fd, &header, sizeof(header)) == sizeof(header)) {
+        if (header.size_ > UINT32_MAX) break;
+        batch_.resize(header.size_);
+        if (PosixIoWrappers::ReadFully(fd, batch_.data(), batch_.size()) != batch_.size()) break;
+        if (!ReceiveBatch()) {
+          STORAGE_LOG_ERROR("Received a malformed batch of log records, replication stopped");
+          break;
+        }
+        if (!ApplyUpTo(header.watermark_, header.oldest_running_)) {
+          STORAGE_LOG_ERROR("Received log records of a table the replica does not hold, replication stopped");
+          break;
+        }
+      }
+    } catch (std::runtime_error &) {
+      // The connection broke, which ends replication just like the primary disconnecting
+    }
+  }
+  for (auto &entry : pending_txns_) FreeRecords(entry.second);
+  pending_txns_.clear();
+  {
+    std::unique_lock<std::mutex> lock(visible_latch_);
+    disconnected_ = true;
+  }
+  visible_cv_.notify_all();
+}
+
+bool ReplicaApplier::ReceiveBatch() {
+  for (uint64_t offset = 0; offset < batch_.size();) {
+    MappedLogReader::Frame frame;
+    if (batch_.size() - offset < sizeof(LogFrameHeader)) return false;
+    std::memcpy(&frame.header_, batch_.data() + offset, sizeof(LogFrameHeader));
+    offset += sizeof(LogFrameHeader);
+    if (frame.header_.marker_ != LogFrameHeader::MARKER || frame.header_.payload_size_ > batch_.size() - offset)
+      return false;
+    frame.payload_ = batch_.data() + offset;
+    offset += frame.header_.payload_size_;
+    const byte *const records = MappedLogReader::Decode(frame, &decompressed_);
+    if (records == nullptr) return false;
+    for (uint32_t record_offset = 0; record_offset < frame.header_.records_size_;) {
+      const byte *const view = MappedLogReader::NextRecord(records, frame.header_.records_size_, &record_offset);
+      LogRecord *const record = view == nullptr ? nullptr : LogSerializer::Deserialize(view);
+      if (record == nullptr) return false;
+      pending_txns_[record->TxnBegin()].push_back(record);
+    }
+  }
+  return true;
+}
+
+bool ReplicaApplier::ApplyUpTo(const transaction::timestamp_t watermark,
+                               const transaction::timestamp_t oldest_running) {
+  std::vector<std::vector<LogRecord *>> committed;
+  for (auto it = pending_txns_.begin(); it != pending_txns_.end();) {
+    const std::vector<LogRecord *> &records = it->second;
+    if (records.back()->RecordType() == LogRecordType::COMMIT && CommitTime(records) < watermark) {
+      committed.emplace_back(std::move(it->second));
+    } else if (records.back()->RecordType() == LogRecordType::COMMIT || !(it->first < oldest_running)) {
+      ++it;
+      continue;
+    } else {
+      // A transaction that began below the oldest running time is done, so without a commit record it aborted
+      FreeRecords(records);
+    }
+    it = pending_txns_.erase(it);
+  }
+  // Everything committing below a watermark is shipped along with it, so nothing new can be applied without it moving
+  if (!(VisibleTimestamp() < watermark)) {
+    TERRIER_ASSERT(committed.empty(), "transactions below the watermark were applied already");
+    return true;
+  }
+  std::sort(committed.begin(), committed.end(),
+            [](const std::vector<LogRecord *> &a, const std::vector<LogRecord *> &b) {
+              return CommitTime(a) < CommitTime(b);
+            });
+  // Checked before applying anything, so the replica stays at the last watermark it fully applied
+  for (const std::vector<LogRecord *> &records : committed) {
+    for (LogRecord *record : records) {
+      if (record->RecordType() == LogRecordType::COMMIT || tables_.count(TableOid(*record)) != 0) continue;
+      for (const std::vector<LogRecord *> &txn_records : committed) FreeRecords(txn_records);
+      return false;
+    }
+  }
+
+  if (!committed.empty()) {
+    auto *const txn = txn_manager_->BeginTransaction();
+    for (const std::vector<LogRecord *> &records : committed) {
+      for (LogRecord *record : records) {
+        if (record->RecordType() == LogRecordType::COMMIT) continue;
+        auto table = tables_.find(TableOid(*record));
+        const TupleSlot logged = LoggedSlot(*record);
+        auto slot = slot_map_.find(logged);
+        if (record->RecordType() == LogRecordType::DELETE) {
+          TERRIER_ASSERT(slot != slot_map_.end(), "log deletes a tuple that does not exist");
+          const bool result UNUSED_ATTRIBUTE = table->second->Delete(txn, slot->second);
+          TERRIER_ASSERT(result, "replicated delete cannot conflict");
+          slot_map_.erase(slot);
+          continue;
+        }
+        auto *const redo = record->GetUnderlyingRecordBodyAs<RedoRecord>();
+        CopyVarlens(table->second->table_.layout, redo->Delta());
+        if (slot == slot_map_.end()) {
+          // The replica starts out empty, so a slot we do not know about yet can only be a new tuple
+          table->second->Insert(txn, redo);
+          slot_map_[logged] = redo->GetTupleSlot();
+        } else {
+          redo->SetTupleSlot(slot->second);
+          const bool result UNUSED_ATTRIBUTE = table->second->Update(txn, redo);
+          TERRIER_ASSERT(result, "replicated update cannot conflict");
+        }
+      }
+      FreeRecords(records);
+    }
+    txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(visible_latch_);
+    num_applied_ += committed.size();
+    visible_timestamp_.store(watermark);
+  }
+  visible_cv_.notify_all();
+  return true;
+}
+}  // namespace terrier::storage
@@ -0,0 +1,329 @@
+#include "storage/write_ahead_log/log_device.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace terrier::storage {
+/**
+ * A minimal io_uring instance, set up with the raw system calls. It is only used by one thread at a time, with a
+ * single operation in flight, so its completion queue never overflows.
+ */
+class IoUring {
+ public:
+  explicit IoUring(const uint32_t entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd_ == -1) throw std::runtime_error("io_uring_setup failed with errno " + std::to_string(errno));
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sq_ring_ = Map(sq_ring_size_, IORING_OFF_SQ_RING);
+    cq_ring_ = single_mmap ? sq_ring_ : Map(cq_ring_size_, IORING_OFF_CQ_RING);
+    sqes_ = reinterpret_cast<io_uring_sqe *>(Map(sqes_size_, IORING_OFF_SQES));
+    if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+      const int error = errno;
+      Unmap();
+      throw std::runtime_error("Failed to map io_uring with errno " + std::to_string(error));
+    }
+    sq_tail_ = reinterpret_cast<uint32_t *>(sq_ring_ + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<uint32_t *>(sq_ring_ + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<uint32_t *>(sq_ring_ + params.sq_off.array);
+    cq_head_ = reinterpret_cast<uint32_t *>(cq_ring_ + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<uint32_t *>(cq_ring_ + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<uint32_t *>(cq_ring_ + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq_ring_ + params.cq_off.cqes);
+  }
+
+  ~IoUring() { Unmap(); }
+
+  DISALLOW_COPY_AND_MOVE(IoUring)
+
+  /**
+   * @return whether the kernel supports io_uring
+   */
+  static bool Supported() {
+    static const bool supported = [] {
+      try {
+        IoUring probe(1);
+        return true;
+      } catch (std::runtime_error &) {
+        return false;
+      }
+    }();
+    return supported;
+  }
+
+  /**
+   * Submits the given operation
+   * @param sqe the operation
+   */
+  void Submit(const io_uring_sqe &sqe) {
+    // Only this thread moves the tail, the kernel only reads it
+    const uint32_t tail = *sq_tail_;
+    const uint32_t index = tail & sq_mask_;
+    sqes_[index] = sqe;
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    Enter(1, 0, 0);
+  }
+
+  /**
+   * Waits for the next operation to complete
+   * @return the result of the operation, which is the negated errno if it failed
+   */
+  int32_t WaitForCompletion() {
+    while (true) {
+      const uint32_t head = *cq_head_;
+      if (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+        const int32_t result = cqes_[head & cq_mask_].res;
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+        return result;
+      }
+      Enter(0, 1, IORING_ENTER_GETEVENTS);
+    }
+  }
+
+ private:
+  int ring_fd_;
+  size_t sq_ring_size_, cq_ring_size_, sqes_size_;
+  char *sq_ring_ = reinterpret_cast<char *>(MAP_FAILED), *cq_ring_ = reinterpret_cast<char *>(MAP_FAILED);
+  io_uring_sqe *sqes_ = reinterpret_cast<io_uring_sqe *>(MAP_FAILED);
+  uint32_t *sq_tail_, *sq_array_, *cq_head_, *cq_tail_;
+  uint32_t sq_mask_, cq_mask_;
+  io_uring_cqe *cqes_;
+
+  char *Map(const size_t size, const off_t offset) {
+    return reinterpret_cast<char *>(
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset));
+  }
+
+  void Unmap() {
+    if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+  }
+
+  void Enter(const uint32_t to_submit, const uint32_t min_complete, const uint32_t flags) {
+    while (syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, nullptr, 0) == -1) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error("io_uring_enter failed with errno " + std::to_string(errno));
+    }
+  }
+};
+
+std::unique_ptr<LogDevice> LogDevice::Open(const LogDeviceType type, const std::string &path,
+                                           const uint64_t expected_size, const SimulatedSyncLatency &sync_latency) {
+  switch (type) {
+    case LogDeviceType::DIRECT:
+      if (expected_size == 0) return std::make_unique<DirectLogDevice>(path);
+      return std::make_unique<DirectLogDevice>(
+          path, (expected_size + DirectLogDevice::IO_BLOCK_SIZE - 1) / DirectLogDevice::IO_BLOCK_SIZE *
+                    DirectLogDevice::IO_BLOCK_SIZE);
+    case LogDeviceType::IO_URING:
+      if (IoUring::Supported()) return std::make_unique<IoUringLogDevice>(path);
+      STORAGE_LOG_WARN("io_uring is not supported by the kernel, falling back to posix log I/O");
+      return std::make_unique<PosixLogDevice>(path);
+    case LogDeviceType::NULL_DEVICE:
+      return std::make_unique<NullLogDevice>();
+    case LogDeviceType::MEMORY:
+      return std::make_unique<MemoryLogDevice>();
+    case LogDeviceType::SIMULATED:
+      return std::make_unique<SimulatedLogDevice>(sync_latency, std::hash<std::string>()(path));
+    default:
+      return std::make_unique<PosixLogDevice>(path);
+  }
+}
+
+LogDeviceType LogDevice::TypeFromString(const std::string &name) {
+  if (name == "posix") return LogDeviceType::POSIX;
+  if (name == "direct") return LogDeviceType::DIRECT;
+  if (name == "io_uring") return LogDeviceType::IO_URING;
+  if (name == "null") return LogDeviceType::NULL_DEVICE;
+  if (name == "memory") return LogDeviceType::MEMORY;
+  if (name == "simulated") return LogDeviceType::SIMULATED;
+  throw std::runtime_error("unknown log device " + name);
+}
+
+DirectLogDevice::DirectLogDevice(const std::string &path, const uint64_t extent_size)
+    : fd_(PosixIoWrappers::Open(path.c_str(), O_RDWR | O_CREAT | O_DIRECT, S_IRUSR | S_IWUSR)),
+      extent_size_(extent_size),
+      staging_(reinterpret_cast<byte *>(std::aligned_alloc(IO_BLOCK_SIZE, STAGING_SIZE))) {
+  TERRIER_ASSERT(extent_size_ > 0 && extent_size_ % IO_BLOCK_SIZE == 0, "extents must be made up of whole blocks");
+  struct stat file_stat;
+  if (fstat(fd_, &file_stat) == -1) throw std::runtime_error("fstat failed with errno " + std::to_string(errno));
+  allocated_size_ = static_cast<uint64_t>(file_stat.st_size);
+  // Resume after the last block with any data in it. Everything after it is preallocated space or padding.
+  uint64_t end = (allocated_size_ + IO_BLOCK_SIZE - 1) / IO_BLOCK_SIZE * IO_BLOCK_SIZE;
+  while (end > 0 && write_offset_ == 0) {
+    const uint64_t start = end > STAGING_SIZE ? end - STAGING_SIZE : 0;
+    if (lseek(fd_, static_cast<off_t>(start), SEEK_SET) == -1)
+      throw std::runtime_error("lseek failed with errno " + std::to_string(errno));
+    const uint32_t size = PosixIoWrappers::ReadFully(fd_, staging_, end - start);
+    for (uint32_t i = size; i > 0; i--) {
+      if (staging_[i - 1] != byte(0)) {
+        write_offset_ = start + (i + IO_BLOCK_SIZE - 1) / IO_BLOCK_SIZE * IO_BLOCK_SIZE;
+        break;
+      }
+    }
+    end = start;
+  }
+}
+
+DirectLogDevice::~DirectLogDevice() { std::free(staging_); }
+
+void DirectLogDevice::Append(struct iovec *const iov, const size_t iovcnt) {
+  if (iovcnt == 0) return;
+  for (size_t i = 0; i < iovcnt; i++) {
+    const auto *data = reinterpret_cast<const byte *>(iov[i].iov_base);
+    size_t remaining = iov[i].iov_len;
+    while (remaining > 0) {
+      const auto size = static_cast<uint32_t>(std::min<size_t>(remaining, STAGING_SIZE - staged_));
+      std::memcpy(staging_ + staged_, data, size);
+      staged_ += size;
+      data += size;
+      remaining -= size;
+      if (staged_ == STAGING_SIZE) WriteStaged();
+    }
+  }
+  if (staged_ > 0) WriteStaged();
+}
+
+void DirectLogDevice::FinishSync() {
+  if (fdatasync(fd_) == -1) throw std::runtime_error("fdatasync failed with errno " + std::to_string(errno));
+}
+
+void DirectLogDevice::WriteStaged() {
+  const uint32_t padded_size = (staged_ + IO_BLOCK_SIZE - 1) / IO_BLOCK_SIZE * IO_BLOCK_SIZE;
+  std::memset(staging_ + staged_, 0, padded_size - staged_);
+  while (write_offset_ + padded_size > allocated_size_) {
+    if (fallocate(fd_, 0, static_cast<off_t>(allocated_size_), static_cast<off_t>(extent_size_)) == -1)
+      throw std::runtime_error("fallocate failed with errno " + std::to_string(errno));
+    allocated_size_ += extent_size_;
+  }
+  iovec region{staging_, padded_size};
+  PosixIoWrappers::PWriteVFully(fd_, &region, 1, static_cast<off_t>(write_offset_));
+  // Keep the partially filled last block, which is written again with the next append
+  const uint32_t full_size = staged_ / IO_BLOCK_SIZE * IO_BLOCK_SIZE;
+  std::memmove(staging_, staging_ + full_size, staged_ - full_size);
+  write_offset_ += full_size;
+  staged_ -= full_size;
+}
+
+IoUringLogDevice::IoUringLogDevice(const std::string &path)
+    : fd_(PosixIoWrappers::Open(path.c_str(), O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR)),
+      append_ring_(new IoUring(1)),
+      sync_ring_(new IoUring(1)) {
+  struct stat file_stat;
+  if (fstat(fd_, &file_stat) == -1) throw std::runtime_error("fstat failed with errno " + std::to_string(errno));
+  write_offset_ = static_cast<uint64_t>(file_stat.st_size);
+}
+
+IoUringLogDevice::~IoUringLogDevice() = default;
+
+void IoUringLogDevice::Append(struct iovec *const iov, const size_t iovcnt) {
+  WaitForAppends();
+  if (iovcnt == 0) return;
+  in_flight_.assign(iov, iov + iovcnt);
+  append_offset_ = write_offset_;
+  append_size_ = 0;
+  for (const iovec &region : in_flight_) append_size_ += region.iov_len;
+  write_offset_ += append_size_;
+
+  io_uring_sqe sqe;
+  std::memset(&sqe, 0, sizeof(sqe));
+  sqe.opcode = IORING_OP_WRITEV;
+  sqe.fd = fd_;
+  sqe.addr = reinterpret_cast<uint64_t>(in_flight_.data());
+  sqe.len = static_cast<uint32_t>(std::min<size_t>(in_flight_.size(), IOV_MAX));
+  sqe.off = append_offset_;
+  append_ring_->Submit(sqe);
+  append_in_flight_ = true;
+}
+
+void IoUringLogDevice::WaitForAppends() {
+  if (!append_in_flight_) return;
+  append_in_flight_ = false;
+  const int32_t result = append_ring_->WaitForCompletion();
+  if (result < 0) throw std::runtime_error("Write to log file failed with errno " + std::to_string(-result));
+  auto written = static_cast<uint64_t>(result);
+  if (written == append_size_) return;
+  // A write cut short, or with more regions than a single write takes, is finished synchronously
+  size_t first = 0;
+  for (uint64_t skipped = written; skipped > 0; first++) {
+    if (skipped < in_flight_[first].iov_len) {
+      in_flight_[first].iov_base = reinterpret_cast<char *>(in_flight_[first].iov_base) + skipped;
+      in_flight_[first].iov_len -= skipped;
+      break;
+    }
+    skipped -= in_flight_[first].iov_len;
+  }
+  PosixIoWrappers::PWriteVFully(fd_, &in_flight_[first], in_flight_.size() - first,
+                                static_cast<off_t>(append_offset_ + written));
+}
+
+void IoUringLogDevice::StartSync() {
+  io_uring_sqe sqe;
+  std::memset(&sqe, 0, sizeof(sqe));
+  sqe.opcode = IORING_OP_FSYNC;
+  sqe.fd = fd_;
+  sqe.fsync_flags = IORING_FSYNC_DATASYNC;
+  sync_ring_->Submit(sqe);
+}
+
+void IoUringLogDevice::FinishSync() {
+  const int32_t result = sync_ring_->WaitForCompletion();
+  if (result < 0) throw std::runtime_error("fdatasync failed with errno " + std::to_string(-result));
+}
+
+void MemoryLogDevice::Append(struct iovec *const iov, const size_t iovcnt) {
+  for (size_t i = 0; i < iovcnt; i++) {
+    const auto *in = reinterpret_cast<const byte *>(iov[i].iov_base);
+    uint64_t size = iov[i].iov_len;
+    // Only the last bytes of a region larger than the ring survive
+    if (size > ring_.size()) {
+      in += size - ring_.size();
+      bytes_appended_ += size - ring_.size();
+      size = ring_.size();
+    }
+    while (size > 0) {
+      const uint64_t offset = bytes_appended_ % ring_.size();
+      const uint64_t chunk = std::min(size, ring_.size() - offset);
+      std::memcpy(ring_.data() + offset, in, chunk);
+      in += chunk;
+      size -= chunk;
+      bytes_appended_ += chunk;
+    }
+  }
+}
+
+SimulatedLogDevice::SimulatedLogDevice(const SimulatedSyncLatency &sync_latency, const uint64_t seed)
+    : generator_(seed),
+      constant_(sync_latency.median_.count() == 0 || !(sync_latency.p99_ > sync_latency.median_)),
+      median_(sync_latency.median_) {
+  if (constant_) return;
+  // The log of a log-normal variable is normal, with the 99th percentile 2.326 standard deviations above the median
+  const auto median_us = static_cast<double>(sync_latency.median_.count());
+  const auto p99_us = static_cast<double>(sync_latency.p99_.count());
+  latency_us_ = std::lognormal_distribution<double>(std::log(median_us), std::log(p99_us / median_us) / 2.326);
+}
+
+void SimulatedLogDevice::StartSync() {
+  const auto latency = constant_ ? median_ : std::chrono::microseconds(static_cast<int64_t>(latency_us_(generator_)));
+  sync_done_ = std::chrono::steady_clock::now() + latency;
+}
+
+void SimulatedLogDevice::FinishSync() { std::this_thread::sleep_until(sync_done_); }
+}  // namespace terrier::storage
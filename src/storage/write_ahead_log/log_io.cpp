@@ -1,6 +1,29 @@
 #include "storage/write_ahead_log/log_io.h"
 #include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <vector>
+#include "common/hash_util.h"
+#include "lz_block/lz_block.h"
 namespace terrier::storage {
+namespace {
+// Skips over the given number of bytes written from the memory regions, and returns the number of bytes written
+size_t SkipWritten(struct iovec **iov, size_t *iovcnt, size_t written) {
+  const size_t result = written;
+  // Resume in the middle of a region that was only written partially
+  while (*iovcnt > 0 && written >= (*iov)->iov_len) {
+    written -= (*iov)->iov_len;
+    (*iov)++;
+    (*iovcnt)--;
+  }
+  if (written > 0) {
+    (*iov)->iov_base = reinterpret_cast<char *>((*iov)->iov_base) + written;
+    (*iov)->iov_len -= written;
+  }
+  return result;
+}
+}  // namespace
+
 void PosixIoWrappers::Close(int fd) {
   while (true) {
     int ret = close(fd);
@@ -38,7 +61,66 @@ void PosixIoWrappers::WriteFully(int fd, const void *buf, size_t nbyte) {
   }
 }
 
+void PosixIoWrappers::WriteVFully(int fd, struct iovec *iov, size_t iovcnt) {
+  while (iovcnt > 0) {
+    ssize_t ret = writev(fd, iov, static_cast<int>(std::min<size_t>(iovcnt, IOV_MAX)));
+    if (ret == -1) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error("Write to log file failed with errno " + std::to_string(errno));
+    }
+    SkipWritten(&iov, &iovcnt, static_cast<size_t>(ret));
+  }
+}
+
+void PosixIoWrappers::PWriteVFully(int fd, struct iovec *iov, size_t iovcnt, off_t offset) {
+  while (iovcnt > 0) {
+    ssize_t ret = pwritev(fd, iov, static_cast<int>(std::min<size_t>(iovcnt, IOV_MAX)), offset);
+    if (ret == -1) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error("Write to log file failed with errno " + std::to_string(errno));
+    }
+    offset += static_cast<off_t>(SkipWritten(&iov, &iovcnt, static_cast<size_t>(ret)));
+  }
+}
+
+LogFrameHeader LogFrameHeader::Uncompressed(const void *const records, const uint32_t size) {
+  LogFrameHeader header;
+  header.payload_size_ = header.records_size_ = size;
+  header.checksum_ = header.ComputeChecksum(records);
+  return header;
+}
+
+uint32_t LogFrameHeader::MaxFrameSize(const uint32_t size) {
+  return static_cast<uint32_t>(sizeof(LogFrameHeader) + lz_block::CompressBound(size));
+}
+
+uint32_t LogFrameHeader::Compress(const void *const records, const uint32_t size, void *const out) {
+  LogFrameHeader header;
+  header.compressed_ = 1;
+  header.records_size_ = size;
+  auto *const compressed = reinterpret_cast<uint8_t *>(out) + sizeof(LogFrameHeader);
+  header.payload_size_ =
+      static_cast<uint32_t>(lz_block::Compress(reinterpret_cast<const uint8_t *>(records), size, compressed));
+  if (header.payload_size_ >= size) return 0;
+  header.checksum_ = header.ComputeChecksum(compressed);
+  std::memcpy(out, &header, sizeof(LogFrameHeader));
+  return static_cast<uint32_t>(sizeof(LogFrameHeader)) + header.payload_size_;
+}
+
+uint32_t LogFrameHeader::ComputeChecksum(const void *const payload) const {
+  const uint32_t fields = common::HashUtil::Crc32c(reinterpret_cast<const byte *>(this) + sizeof(marker_),
+                                                   offsetof(LogFrameHeader, checksum_) - sizeof(marker_));
+  return common::HashUtil::Crc32c(reinterpret_cast<const byte *>(payload), payload_size_, fields);
+}
+
 bool BufferedLogReader::Read(void *dest, uint32_t size) {
+  if (frame_head_ < frame_.size()) {
+    // Records never span frames
+    if (frame_head_ + size > frame_.size()) return false;
+    std::memcpy(dest, frame_.data() + frame_head_, size);
+    frame_head_ += size;
+    return true;
+  }
   if (read_head_ + size <= filled_size_) {
     // bytes to read are already buffered.
     ReadFromBuffer(dest, size);
@@ -56,11 +138,65 @@ bool BufferedLogReader::Read(void *dest, uint32_t size) {
   return true;
 }
 
+void BufferedLogReader::SkipPadding() {
+  if (frame_head_ < frame_.size()) return;
+  while (true) {
+    if (read_head_ == filled_size_) {
+      if (in_ == -1) return;
+      RefillBuffer();
+      continue;
+    }
+    if (buffer_[read_head_] != 0) break;
+    read_head_++;
+  }
+  // Records are only ever written out in frames
+  if (static_cast<uint8_t>(buffer_[read_head_]) == LogFrameHeader::MARKER)
+    ReadFrame();
+  else
+    EndLog();
+}
+
+void BufferedLogReader::ReadFrame() {
+  LogFrameHeader header;
+  // Sizes cannot be trusted before the checksum is verified, but a payload can never be larger than the file
+  bool intact = Read(&header, sizeof(header)) && header.payload_size_ <= file_size_ - Offset();
+  if (intact) {
+    payload_.resize(header.payload_size_);
+    intact = Read(payload_.data(), header.payload_size_) && header.ComputeChecksum(payload_.data()) == header.checksum_;
+  }
+  if (intact && header.compressed_ == 0) {
+    intact = header.records_size_ == header.payload_size_;
+    frame_.swap(payload_);
+  } else if (intact) {
+    frame_.resize(header.records_size_);
+    intact = lz_block::Decompress(reinterpret_cast<const uint8_t *>(payload_.data()), payload_.size(),
+                                  reinterpret_cast<uint8_t *>(frame_.data()), frame_.size());
+  }
+  if (!intact) {
+    EndLog();
+    return;
+  }
+  frame_head_ = 0;
+  intact_size_ = Offset();
+}
+
+void BufferedLogReader::EndLog() {
+  torn_ = true;
+  frame_.clear();
+  frame_head_ = 0;
+  read_head_ = filled_size_ = 0;
+  if (in_ != -1) {
+    PosixIoWrappers::Close(in_);
+    in_ = -1;
+  }
+}
+
 void BufferedLogReader::RefillBuffer() {
   TERRIER_ASSERT(read_head_ == filled_size_, "Refilling a buffer that is not fully read results in loss of data");
   if (in_ == -1) throw std::runtime_error("No more bytes left in the log file");
   read_head_ = 0;
   filled_size_ = PosixIoWrappers::ReadFully(in_, buffer_, BUFFER_SIZE);
+  file_offset_ += filled_size_;
   if (filled_size_ < BUFFER_SIZE) {
     // TODO(Tianyu): Is it better to make this an explicit close?
     PosixIoWrappers::Close(in_);
@@ -1,67 +1,526 @@
 #include "storage/write_ahead_log/log_manager.h"
 #include <transaction/transaction_context.h>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "storage/write_ahead_log/log_reader.h"
+#include "storage/write_ahead_log/log_serializer.h"
+#include "transaction/transaction_manager.h"
 
 namespace terrier::storage {
+namespace {
+// Identifies the calling worker thread. All log buffers handed over by a worker go to the same stream.
+uint32_t WorkerId() {
+  static std::atomic<uint32_t> num_workers{0};
+  static thread_local const uint32_t worker_id = num_workers++;
+  return worker_id;
+}
+
+// Recovers the final header of a segment left unsealed by a crash from its records
+LogSegmentHeader ScanSegment(const std::string &file_path, const uint64_t segment_id) {
+  LogSegmentHeader header;
+  // A crash right after a segment was created can leave it without even its placeholder header, and thus no records
+  if (LogSegmentHeader::Read(file_path, &header)) {
+    BufferedLogReader in(file_path.c_str());
+    in.Read(&header, sizeof(header));
+    while (in.HasMore()) {
+      LogRecord *record = LogReader::ReadRecord(&in);
+      if (record == nullptr) break;
+      header.Track(*record);
+      delete[] reinterpret_cast<byte *>(record);
+    }
+  }
+  header.segment_id_ = segment_id;
+  header.sealed_ = 1;
+  return header;
+}
+
+// Cuts a write torn by a crash off the end of a log file, as records appended after it could not be read
+void TruncateTornWrite(const std::string &file_path) {
+  struct stat file_stat;
+  if (stat(file_path.c_str(), &file_stat) != 0) return;
+  BufferedLogReader in(file_path.c_str());
+  while (in.HasMore()) {
+    LogRecord *record = LogReader::ReadRecord(&in);
+    if (record == nullptr) break;
+    delete[] reinterpret_cast<byte *>(record);
+  }
+  if (in.EndedAtTornWrite() && truncate(file_path.c_str(), static_cast<off_t>(in.IntactSize())) == -1)
+    throw std::runtime_error("truncate failed with errno " + std::to_string(errno));
+}
+}  // namespace
+
+LogManager::LogManager(const char *const log_file_path, RecordBufferSegmentPool *const buffer_pool,
+                       const LogManagerOptions &options)
+    : buffer_pool_(buffer_pool),
+      serialization_interval_(options.serialization_interval_),
+      flush_interval_(options.flush_interval_),
+      flush_threshold_(options.flush_threshold_),
+      write_batch_size_(options.write_batch_size_),
+      device_type_(options.device_type_),
+      segment_size_(options.segment_size_),
+      archive_dir_(options.archive_dir_),
+      max_commit_lag_(options.max_commit_lag_),
+      compress_(options.compress_),
+      sync_latency_(options.sync_latency_) {
+  const uint32_t num_streams = options.num_streams_;
+  TERRIER_ASSERT(num_streams > 0, "LogManager needs at least one stream");
+  // Segments are sealed and removed as files
+  if (segment_size_ > 0 && !LogDevice::WritesFile(device_type_))
+    throw std::runtime_error("log segments can only be written to files");
+  for (uint32_t i = 0; i < num_streams; i++) {
+    streams_.emplace_back(new LogStream(StreamFilePath(log_file_path, i, num_streams)));
+    LogStream *const stream = streams_.back().get();
+    if (segment_size_ == 0) {
+      if (LogDevice::WritesFile(device_type_)) TruncateTornWrite(stream->file_path_);
+      stream->device_ = LogDevice::Open(device_type_, stream->file_path_, 0, sync_latency_);
+    } else {
+      stream->device_ = OpenSegment(stream, SealExistingSegments(stream));
+    }
+  }
+}
+
+std::vector<std::string> LogManager::LogFilePaths(const std::string &log_file_path, const uint32_t num_streams) {
+  std::vector<std::string> result;
+  for (uint32_t i = 0; i < num_streams; i++) {
+    const std::string stream_file_path = StreamFilePath(log_file_path, i, num_streams);
+    struct stat file_stat;
+    if (stat(stream_file_path.c_str(), &file_stat) == 0) result.push_back(stream_file_path);
+    for (const uint64_t segment_id : LogSegmentHeader::ListSegments(stream_file_path))
+      result.push_back(LogSegmentHeader::FilePath(stream_file_path, segment_id));
+  }
+  return result;
+}
+
+void LogManager::Start() {
+  TERRIER_ASSERT(!run_serializer_ && !run_flusher_, "LogManager was already started");
+  run_serializer_ = run_flusher_ = true;
+  for (auto &stream : streams_)
+    stream->serializer_thread_ = std::thread([this, s = stream.get()] { SerializerThreadLoop(s); });
+  flusher_thread_ = std::thread([this] { FlusherThreadLoop(); });
+}
+
+void LogManager::Shutdown() {
+  if (run_serializer_) {
+    // The serializers hand everything they have left to the flusher before exiting, and the flusher then persists it
+    run_serializer_ = false;
+    for (auto &stream : streams_) stream->serializer_thread_.join();
+    {
+      std::unique_lock<std::mutex> lock(persist_latch_);
+      run_flusher_ = false;
+    }
+    persist_cv_.notify_one();
+    flusher_thread_.join();
+  } else {
+    Process();
+  }
+  for (auto &stream : streams_) {
+    stream->device_->Close();
+    if (segment_size_ == 0) continue;
+    const std::string segment_path =
+        LogSegmentHeader::FilePath(stream->file_path_, stream->segment_header_.segment_id_);
+    // Only keep the last segment if anything was written to it
+    if (stream->segment_bytes_ == 0)
+      unlink(segment_path.c_str());
+    else
+      SealSegment({segment_path, stream->segment_header_});
+  }
+}
+
+uint64_t LogManager::RemoveSegmentsBefore(const transaction::timestamp_t safe_time) {
+  std::unique_lock<std::mutex> lock(sealed_segments_latch_);
+  uint64_t num_removed = 0;
+  for (auto it = sealed_segments_.begin(); it != sealed_segments_.end();) {
+    if (!(it->header_.newest_txn_begin_ < safe_time)) {
+      ++it;
+      continue;
+    }
+    if (archive_dir_.empty()) {
+      if (unlink(it->file_path_.c_str()) == -1 && errno != ENOENT)
+        throw std::runtime_error("Failed to remove log segment with errno " + std::to_string(errno));
+    } else {
+      const size_t separator = it->file_path_.find_last_of('/');
+      const std::string archive_path =
+          archive_dir_ + "/" + (separator == std::string::npos ? it->file_path_ : it->file_path_.substr(separator + 1));
+      if (rename(it->file_path_.c_str(), archive_path.c_str()) == -1)
+        throw std::runtime_error("Failed to archive log segment with errno " + std::to_string(errno));
+    }
+    it = sealed_segments_.erase(it);
+    num_removed++;
+  }
+  return num_removed;
+}
+
+void LogManager::WaitForPersisted(const transaction::timestamp_t commit_time) {
+  TERRIER_ASSERT(txn_manager_.load() != nullptr && commit_time < txn_manager_.load()->CommittedTimestamp(),
+                 "Only a commit that is done can be waited for, and only with a registered transaction manager");
+  if (!run_flusher_) {
+    if (!(commit_time < PersistedWatermark())) Process();
+    TERRIER_ASSERT(commit_time < PersistedWatermark(), "Processing everything handed over persists every commit");
+    return;
+  }
+  std::unique_lock<std::mutex> lock(persist_latch_);
+  while (!(commit_time < PersistedWatermark())) {
+    flush_requested_ = true;
+    persist_cv_.notify_one();
+    // The commit might not have been handed off yet when the flusher wakes up, in which case it has to be asked again
+    persisted_cv_.wait_for(lock, serialization_interval_);
+  }
+}
+
+void LogManager::AddBufferToFlushQueue(RecordBufferSegment *const buffer_segment) {
+  LogStream *const stream = streams_[WorkerId() % streams_.size()].get();
+  common::SpinLatch::ScopedSpinLatch guard(&stream->flush_queue_latch_);
+  stream->flush_queue_.push(buffer_segment);
+}
+
 void LogManager::Process() {
+  for (auto &stream : streams_) {
+    TakeSafeTimes(stream.get());
+    SerializeQueuedBuffers(stream.get());
+    HandOffToFlusher(stream.get());
+  }
+  Flush();
+}
+
+void LogManager::Flush() {
+  std::unique_lock<std::mutex> lock(persist_latch_);
+  PersistHandedOff(&lock);
+}
+
+transaction::timestamp_t LogManager::SafeTime() const {
+  transaction::TransactionManager *const txn_manager = txn_manager_.load();
+  // Without a transaction manager, nothing can have committed yet
+  if (txn_manager == nullptr) return transaction::timestamp_t(0);
+  // A read-only transaction may hand over its commit record later, but there is nothing of it to persist
+  return txn_manager->CommittedTimestamp();
+}
+
+transaction::timestamp_t LogManager::OldestRunningTime() const {
+  transaction::TransactionManager *const txn_manager = txn_manager_.load();
+  if (txn_manager == nullptr) return transaction::timestamp_t(0);
+  // A transaction is only removed from the running transactions after it handed over its commit record
+  return txn_manager->OldestTransactionStartTime();
+}
+
+void LogManager::TakeSafeTimes(LogStream *const stream) const {
+  stream->safe_time_in_buffer_ = SafeTime();
+  // Only a replica needs to tell transactions that aborted from those still running, which is more expensive to find
+  if (shipper_ != nullptr) stream->oldest_running_in_buffer_ = OldestRunningTime();
+}
+
+void LogManager::SerializeQueuedBuffers(LogStream *const stream) {
   while (true) {
     RecordBufferSegment *buffer;
     // In a short critical section, try to dequeue an item
     {
-      common::SpinLatch::ScopedSpinLatch guard(&flush_queue_latch_);
-      if (flush_queue_.empty()) break;
-      buffer = flush_queue_.front();
-      flush_queue_.pop();
+      common::SpinLatch::ScopedSpinLatch guard(&stream->flush_queue_latch_);
+      if (stream->flush_queue_.empty()) break;
+      buffer = stream->flush_queue_.front();
+      stream->flush_queue_.pop();
     }
     for (LogRecord &record : IterableBufferSegment<LogRecord>(buffer)) {
       if (record.RecordType() == LogRecordType::COMMIT) {
+        TERRIER_ASSERT(streams_.size() == 1 || txn_manager_.load() != nullptr,
+                       "Commits can only be acknowledged across streams with a registered transaction manager");
         auto *commit_record = record.GetUnderlyingRecordBodyAs<CommitRecord>();
 
         // If a transaction is read-only, then the only record it generates is its commit record. This commit record is
         // necessary for the transaction's callback function to be invoked, but there is no need to serialize it, as
         // it corresponds to a transaction with nothing to redo.
-        if (!commit_record->IsReadOnly()) SerializeRecord(record);
-        commits_in_buffer_.emplace_back(commit_record->Callback(), commit_record->CallbackArg());
+        if (!commit_record->IsReadOnly()) SerializeRecord(stream, record);
+        // Asynchronous commits are acknowledged by the committing thread
+        if (commit_record->Callback() != nullptr)
+          stream->commits_in_buffer_.push_back(
+              {commit_record->CommitTime(), commit_record->Callback(), commit_record->CallbackArg()});
         // Not safe to mark read only transactions as the transactions are deallocated preemptively without waiting for
         // logging (there is nothing to log after all)
         if (!commit_record->IsReadOnly()) commit_record->Txn()->log_processed_ = true;
       } else {
         // Any record that is not a commit record is always serialized.`
-        SerializeRecord(record);
+        SerializeRecord(stream, record);
       }
     }
     buffer_pool_->Release(buffer);
+    if (stream->bytes_in_buffer_ >= write_batch_size_) WritePending(stream);
   }
-  Flush();
 }
 
-void LogManager::Flush() {
-  out_.Persist();
-  for (auto &callback : commits_in_buffer_) callback.first(callback.second);
-  commits_in_buffer_.clear();
-}
-
-void LogManager::SerializeRecord(const terrier::storage::LogRecord &record) {
-  WriteValue(record.Size());
-  WriteValue(record.RecordType());
-  WriteValue(record.TxnBegin());
-  switch (record.RecordType()) {
-    case LogRecordType::REDO: {
-      auto *record_body = record.GetUnderlyingRecordBodyAs<RedoRecord>();
-      WriteValue(record_body->GetTableOid());
-      WriteValue(record_body->GetTupleSlot());
-      // TODO(Tianyu): Need to inline varlen or other things, and figure out a better representation.
-      out_.BufferWrite(record_body->Delta(), record_body->Delta()->Size());
-      break;
+void LogManager::WritePending(LogStream *const stream) {
+  if (stream->pending_writes_.empty()) return;
+  FramePending(stream);
+  if (shipper_ != nullptr) {
+    for (const iovec &region : stream->pending_writes_) {
+      const auto *const frame = reinterpret_cast<const byte *>(region.iov_base);
+      stream->frames_to_ship_.insert(stream->frames_to_ship_.end(), frame, frame + region.iov_len);
+    }
+  }
+  // Once the device accepts the next append, it is done with the memory of the previous one
+  stream->device_->Append(stream->pending_writes_.data(), stream->pending_writes_.size());
+  std::swap(stream->serialized_, stream->in_flight_serialized_);
+  stream->compressed_.swap(stream->in_flight_compressed_);
+  stream->frame_headers_.swap(stream->in_flight_frame_headers_);
+  stream->serialized_.Clear();
+  stream->pending_writes_.clear();
+}
+
+void LogManager::FramePending(LogStream *const stream) {
+  std::vector<iovec> &regions = stream->pending_writes_;
+  if (compress_) {
+    uint64_t max_size = 0;
+    for (const iovec &region : regions) max_size += LogFrameHeader::MaxFrameSize(static_cast<uint32_t>(region.iov_len));
+    // Only ever grows, so that the memory is reused across batches
+    if (stream->compressed_.size() < max_size) stream->compressed_.resize(max_size);
+  }
+  byte *out = stream->compressed_.data();
+  // Headers are pointed to as they are added, so they must not be moved by a reallocation
+  stream->frame_headers_.clear();
+  stream->frame_headers_.reserve(regions.size());
+  stream->framed_writes_.clear();
+  for (const iovec &region : regions) {
+    const auto size = static_cast<uint32_t>(region.iov_len);
+    uint32_t frame_size = compress_ ? LogFrameHeader::Compress(region.iov_base, size, out) : 0;
+    if (frame_size > 0) {
+      stream->framed_writes_.push_back({out, frame_size});
+      out += frame_size;
+    } else {
+      stream->frame_headers_.push_back(LogFrameHeader::Uncompressed(region.iov_base, size));
+      stream->framed_writes_.push_back({&stream->frame_headers_.back(), sizeof(LogFrameHeader)});
+      stream->framed_writes_.push_back(region);
+      frame_size = static_cast<uint32_t>(sizeof(LogFrameHeader)) + size;
+    }
+    // What ends up in the log file is the frame
+    stream->bytes_in_buffer_ = stream->bytes_in_buffer_ - size + frame_size;
+    stream->segment_bytes_ = stream->segment_bytes_ - size + frame_size;
+  }
+  regions.swap(stream->framed_writes_);
+}
+
+void LogManager::FinishWrites(LogStream *const stream) {
+  stream->device_->WaitForAppends();
+  stream->in_flight_serialized_.Clear();
+}
+
+void LogManager::HandOffToFlusher(LogStream *const stream) {
+  // Records have to reach the device before the flusher can make them persistent. This only hands them to the OS, so
+  // it is cheap compared to the sync.
+  WritePending(stream);
+  FinishWrites(stream);
+  // A full segment is retired along with its last records, and the stream moves on to the next segment
+  std::unique_ptr<LogDevice> next_segment;
+  SealedSegment full_segment;
+  if (segment_size_ > 0 && stream->segment_bytes_ >= segment_size_) {
+    full_segment = {LogSegmentHeader::FilePath(stream->file_path_, stream->segment_header_.segment_id_),
+                    stream->segment_header_};
+    next_segment = OpenSegment(stream, stream->segment_header_.segment_id_ + 1);
+  }
+  bool wake_flusher;
+  {
+    // Even an idle stream hands over its safe time, so that it does not hold back the watermark
+    std::unique_lock<std::mutex> lock(persist_latch_);
+    if (next_segment != nullptr) {
+      retired_segments_.push_back({std::move(stream->device_), std::move(full_segment)});
+      stream->device_ = std::move(next_segment);
     }
-    case LogRecordType::DELETE: {
-      auto *record_body = record.GetUnderlyingRecordBodyAs<DeleteRecord>();
-      WriteValue(record_body->GetTableOid());
-      WriteValue(record_body->GetTupleSlot());
-      break;
+    stream->commits_to_persist_.insert(stream->commits_to_persist_.end(), stream->commits_in_buffer_.begin(),
+                                       stream->commits_in_buffer_.end());
+    stream->frames_to_persist_.insert(stream->frames_to_persist_.end(), stream->frames_to_ship_.begin(),
+                                      stream->frames_to_ship_.end());
+    // If the maximum commit lag is shorter than the flush interval, the flusher has to know when it starts running out
+    const bool first_handoff = bytes_to_persist_ == 0 && stream->bytes_in_buffer_ > 0;
+    if (first_handoff) oldest_handoff_ = std::chrono::steady_clock::now();
+    stream->bytes_to_persist_ += stream->bytes_in_buffer_;
+    stream->safe_time_to_persist_ = stream->safe_time_in_buffer_;
+    stream->oldest_running_to_persist_ = stream->oldest_running_in_buffer_;
+    bytes_to_persist_ += stream->bytes_in_buffer_;
+    wake_flusher = (first_handoff && max_commit_lag_ < flush_interval_) || bytes_to_persist_ >= flush_threshold_;
+  }
+  stream->commits_in_buffer_.clear();
+  stream->frames_to_ship_.clear();
+  stream->bytes_in_buffer_ = 0;
+  if (wake_flusher) persist_cv_.notify_one();
+}
+
+std::unique_ptr<LogDevice> LogManager::OpenSegment(LogStream *const stream, const uint64_t segment_id) {
+  stream->segment_placeholder_ = LogSegmentHeader();
+  stream->segment_placeholder_.segment_id_ = segment_id;
+  stream->segment_header_ = stream->segment_placeholder_;
+  stream->segment_header_.sealed_ = 1;
+  stream->segment_bytes_ = 0;
+  std::unique_ptr<LogDevice> device =
+      LogDevice::Open(device_type_, LogSegmentHeader::FilePath(stream->file_path_, segment_id), segment_size_);
+  iovec header{&stream->segment_placeholder_, sizeof(LogSegmentHeader)};
+  device->Append(&header, 1);
+  return device;
+}
+
+uint64_t LogManager::SealExistingSegments(LogStream *const stream) {
+  uint64_t next_segment_id = 0;
+  for (const uint64_t segment_id : LogSegmentHeader::ListSegments(stream->file_path_)) {
+    SealedSegment segment{LogSegmentHeader::FilePath(stream->file_path_, segment_id), LogSegmentHeader()};
+    if (LogSegmentHeader::Read(segment.file_path_, &segment.header_) && segment.header_.sealed_ != 0) {
+      std::unique_lock<std::mutex> lock(sealed_segments_latch_);
+      sealed_segments_.push_back(std::move(segment));
+    } else {
+      // Left behind by a crash
+      segment.header_ = ScanSegment(segment.file_path_, segment_id);
+      SealSegment(std::move(segment));
     }
-    case LogRecordType::COMMIT:
-      WriteValue(record.GetUnderlyingRecordBodyAs<CommitRecord>()->CommitTime());
+    next_segment_id = segment_id + 1;
+  }
+  return next_segment_id;
+}
+
+void LogManager::SealSegment(SealedSegment segment) {
+  segment.header_.Write(segment.file_path_);
+  std::unique_lock<std::mutex> lock(sealed_segments_latch_);
+  sealed_segments_.push_back(std::move(segment));
+}
+
+bool LogManager::MustPersist(const std::chrono::steady_clock::time_point now,
+                             const std::chrono::steady_clock::time_point interval_start) const {
+  if (bytes_to_persist_ >= flush_threshold_ || flush_requested_) return true;
+  if (bytes_to_persist_ > 0 && now >= oldest_handoff_ + max_commit_lag_) return true;
+  if (now < interval_start + flush_interval_) return false;
+  // Without commits waiting to be acknowledged, records can be held back until they reach the maximum commit lag
+  if (!commits_persisted_.empty()) return true;
+  for (auto &stream : streams_)
+    if (!stream->commits_to_persist_.empty()) return true;
+  return bytes_to_persist_ == 0;
+}
+
+void LogManager::PersistHandedOff(std::unique_lock<std::mutex> *const lock) {
+  flush_requested_ = false;
+  // The serializers may move on to new devices while we wait for the disk
+  std::vector<LogDevice *> to_sync;
+  std::vector<RetiredSegment> retired_segments = std::move(retired_segments_);
+  retired_segments_.clear();
+  for (RetiredSegment &retired : retired_segments) to_sync.push_back(retired.device_.get());
+  auto watermark = transaction::timestamp_t(std::numeric_limits<uint64_t>::max());
+  auto oldest_running = watermark;
+  for (auto &stream : streams_) {
+    if (stream->bytes_to_persist_ > 0) to_sync.push_back(stream->device_.get());
+    commits_persisted_.insert(commits_persisted_.end(), stream->commits_to_persist_.begin(),
+                              stream->commits_to_persist_.end());
+    stream->commits_to_persist_.clear();
+    frames_to_ship_.insert(frames_to_ship_.end(), stream->frames_to_persist_.begin(), stream->frames_to_persist_.end());
+    stream->frames_to_persist_.clear();
+    stream->bytes_to_persist_ = 0;
+    watermark = std::min(watermark, stream->safe_time_to_persist_);
+    oldest_running = std::min(oldest_running, stream->oldest_running_to_persist_);
+  }
+  bytes_to_persist_ = 0;
+  // Let the serializers keep handing over commits while we wait for the disk
+  lock->unlock();
+  // Devices that sync asynchronously sync all streams in parallel
+  for (LogDevice *device : to_sync) device->StartSync();
+  for (LogDevice *device : to_sync) device->FinishSync();
+  persisted_watermark_.store(watermark);
+  persisted_cv_.notify_all();
+
+  // Within a single stream, a transaction always hands over its commit record after those of the transactions it
+  // depends on, so everything that is persistent can be acknowledged. Across streams, only commits below the
+  // watermark are guaranteed not to depend on anything that is not persistent yet.
+  if (streams_.size() == 1) {
+    // A commit record can be persistent before its transaction is visible, and a client that is acknowledged must not
+    // begin a transaction that misses the commit. Committing transactions never wait for the log, so this is brief.
+    transaction::TransactionManager *const txn_manager = txn_manager_.load();
+    auto newest = transaction::timestamp_t(0);
+    for (auto &commit : commits_persisted_) newest = std::max(newest, commit.commit_time_);
+    if (txn_manager != nullptr && !commits_persisted_.empty()) {
+      while (!(newest < txn_manager->CommittedTimestamp())) std::this_thread::yield();
+    }
+    for (auto &commit : commits_persisted_) commit.callback_(commit.callback_arg_);
+    commits_persisted_.clear();
+  } else {
+    auto it = std::partition(commits_persisted_.begin(), commits_persisted_.end(),
+                             [=](const PendingCommit &commit) { return commit.commit_time_ >= watermark; });
+    for (auto ack = it; ack != commits_persisted_.end(); ++ack) ack->callback_(ack->callback_arg_);
+    commits_persisted_.erase(it, commits_persisted_.end());
+  }
+
+  // Retired segments are complete and persistent now
+  for (RetiredSegment &retired : retired_segments) {
+    retired.device_->Close();
+    SealSegment(std::move(retired.segment_));
+  }
+
+  // The replica only ever sees persistent records, and is sent every advance of the watermark, so that it can apply
+  // the transactions below it even when no new records come along, and likewise drop those that aborted
+  if (shipper_ != nullptr &&
+      (!frames_to_ship_.empty() || shipped_watermark_ < watermark || shipped_oldest_running_ < oldest_running)) {
+    shipper_->Ship(frames_to_ship_, watermark, oldest_running);
+    frames_to_ship_.clear();
+    shipped_watermark_ = watermark;
+    shipped_oldest_running_ = oldest_running;
+  }
+}
+
+void LogManager::SerializerThreadLoop(LogStream *const stream) {
+  while (run_serializer_) {
+    std::this_thread::sleep_for(serialization_interval_);
+    // The safe times have to be taken before draining the queue, so that they cover only buffers that are drained
+    TakeSafeTimes(stream);
+    SerializeQueuedBuffers(stream);
+    HandOffToFlusher(stream);
+  }
+  // Drain whatever was queued up before shutdown
+  TakeSafeTimes(stream);
+  SerializeQueuedBuffers(stream);
+  HandOffToFlusher(stream);
+}
+
+void LogManager::FlusherThreadLoop() {
+  std::unique_lock<std::mutex> lock(persist_latch_);
+  auto interval_start = std::chrono::steady_clock::now();
+  while (true) {
+    auto wake_time = interval_start + flush_interval_;
+    if (bytes_to_persist_ > 0) wake_time = std::min(wake_time, oldest_handoff_ + max_commit_lag_);
+    if (bytes_to_persist_ < flush_threshold_ && !flush_requested_ && run_flusher_)
+      persist_cv_.wait_until(lock, wake_time);
+    // The serializers have exited by the time run_flusher_ is cleared, so this is the last group
+    const bool last_group = !run_flusher_;
+    const auto now = std::chrono::steady_clock::now();
+    if (!last_group && !MustPersist(now, interval_start)) {
+      // Only records of asynchronous commits are waiting, but synchronous ones can arrive within the next interval
+      if (now >= interval_start + flush_interval_) interval_start = now;
+      continue;
+    }
+    PersistHandedOff(&lock);
+    if (last_group) break;
+    lock.lock();
+    interval_start = std::chrono::steady_clock::now();
+  }
+}
+
+void LogManager::SerializeRecord(LogStream *const stream, const terrier::storage::LogRecord &record) {
+  const uint32_t size = LogSerializer::SerializedSize(record);
+  byte *const serialized = stream->serialized_.Allocate(size);
+  LogSerializer::Serialize(record, serialized);
+  // Records that follow each other in the same chunk can be written out as a single region
+  std::vector<iovec> &writes = stream->pending_writes_;
+  if (!writes.empty() && reinterpret_cast<byte *>(writes.back().iov_base) + writes.back().iov_len == serialized)
+    writes.back().iov_len += size;
+  else
+    writes.push_back({serialized, size});
+  stream->bytes_in_buffer_ += size;
+  stream->segment_bytes_ += size;
+  if (segment_size_ > 0) stream->segment_header_.Track(record);
+}
+
+byte *LogManager::SerializationBuffer::Allocate(const uint32_t size) {
+  while (current_chunk_ < chunks_.size() && chunk_used_ + size > chunks_[current_chunk_].size()) {
+    current_chunk_++;
+    chunk_used_ = 0;
   }
+  // Records larger than a chunk get a chunk of their own
+  if (current_chunk_ == chunks_.size()) chunks_.emplace_back(std::max(CHUNK_SIZE, size));
+  byte *const result = chunks_[current_chunk_].data() + chunk_used_;
+  chunk_used_ += size;
+  return result;
 }
 
 }  // namespace terrier::storage
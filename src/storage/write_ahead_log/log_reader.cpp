@@ -0,0 +1,122 @@
+#include "storage/write_ahead_log/log_reader.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common/spin_latch.h"
+#include "storage/write_ahead_log/log_segment.h"
+#include "storage/write_ahead_log/log_serializer.h"
+
+namespace terrier::storage {
+namespace {
+void FreeRecords(const std::vector<LogRecord *> &records) {
+  for (LogRecord *record : records) delete[] reinterpret_cast<byte *>(record);
+}
+
+transaction::timestamp_t CommitTime(const std::vector<LogRecord *> &txn) {
+  return txn.back()->GetUnderlyingRecordBodyAs<CommitRecord>()->CommitTime();
+}
+}  // namespace
+
+LogReader::LogReader(const std::vector<std::string> &log_file_paths, const uint32_t num_decoders) {
+  TERRIER_ASSERT(num_decoders > 0, "LogReader needs at least one decoder");
+  const uint32_t max_decoders = std::max(1U, std::thread::hardware_concurrency());
+  // A transaction runs on a single worker, and thus hands all of its records to the same stream in the order it
+  // generated them. Transactions in different streams are only ordered by their commit timestamps.
+  std::unordered_map<transaction::timestamp_t, std::vector<LogRecord *>> records_by_txn;
+  for (const std::string &path : log_file_paths) {
+    LogSegmentHeader header;
+    const bool is_segment = LogSegmentHeader::Read(path, &header);
+    MappedLogReader in(path.c_str(), is_segment ? sizeof(LogSegmentHeader) : 0);
+    for (LogRecord *record : ReadRecords(&in, std::min(num_decoders, max_decoders))) {
+      records_by_txn[record->TxnBegin()].push_back(record);
+      newest_timestamp_ = std::max(newest_timestamp_, record->TxnBegin());
+    }
+  }
+  for (auto &entry : records_by_txn) {
+    if (entry.second.back()->RecordType() == LogRecordType::COMMIT) {
+      newest_timestamp_ = std::max(newest_timestamp_, CommitTime(entry.second));
+      txns_.emplace_back(std::move(entry.second));
+    } else {
+      // Aborted, or still running when the log ended
+      FreeRecords(entry.second);
+      num_discarded_++;
+    }
+  }
+  std::sort(txns_.begin(), txns_.end(), [](const std::vector<LogRecord *> &a, const std::vector<LogRecord *> &b) {
+    return CommitTime(a) < CommitTime(b);
+  });
+}
+
+LogReader::~LogReader() {
+  for (; next_txn_ < txns_.size(); next_txn_++) FreeRecords(txns_[next_txn_]);
+}
+
+LogRecord *LogReader::ReadRecord(BufferedLogReader *const in) {
+  // No record starts with a zero byte, so zeros between records are padding
+  in->SkipPadding();
+  alignas(8) byte header[sizeof(LogRecord)];
+  if (!in->Read(header, sizeof(LogRecord))) return nullptr;
+  const uint32_t size = reinterpret_cast<const LogRecord *>(header)->Size();
+  if (size < sizeof(LogRecord)) return nullptr;
+  std::vector<byte> serialized(size);
+  std::memcpy(serialized.data(), header, sizeof(LogRecord));
+  if (!in->Read(serialized.data() + sizeof(LogRecord), size - static_cast<uint32_t>(sizeof(LogRecord)))) return nullptr;
+  return LogSerializer::Deserialize(serialized.data());
+}
+
+std::vector<LogRecord *> LogReader::ReadRecords(MappedLogReader *const in, const uint32_t num_decoders) {
+  // Frames are located in order under the latch, and decoded outside of it. A deque does not move its elements as it
+  // grows, so every decoder can fill in the records of the frames it took while more frames are added.
+  common::SpinLatch latch;
+  std::deque<std::vector<LogRecord *>> frames;
+  uint64_t end = UINT64_MAX;
+  auto decode = [&] {
+    MappedLogReader::Frame frame;
+    std::vector<byte> buffer;
+    while (true) {
+      std::vector<LogRecord *> *records;
+      uint64_t frame_id;
+      {
+        common::SpinLatch::ScopedSpinLatch guard(&latch);
+        if (frames.size() >= end || !in->NextFrame(&frame)) return;
+        frame_id = frames.size();
+        records = &frames.emplace_back();
+      }
+      const byte *const serialized = MappedLogReader::Decode(frame, &buffer);
+      bool intact = serialized != nullptr;
+      for (uint32_t offset = 0; intact && offset < frame.header_.records_size_;) {
+        const byte *const view = MappedLogReader::NextRecord(serialized, frame.header_.records_size_, &offset);
+        LogRecord *const record = view == nullptr ? nullptr : LogSerializer::Deserialize(view);
+        if (record == nullptr)
+          intact = false;
+        else
+          records->push_back(record);
+      }
+      // The log ends at the first frame that is torn or malformed
+      if (!intact) {
+        common::SpinLatch::ScopedSpinLatch guard(&latch);
+        end = std::min(end, frame_id);
+        return;
+      }
+    }
+  };
+  std::vector<std::thread> decoders;
+  for (uint32_t i = 1; i < num_decoders; i++) decoders.emplace_back(decode);
+  decode();
+  for (std::thread &decoder : decoders) decoder.join();
+
+  std::vector<LogRecord *> result;
+  for (uint64_t frame_id = 0; frame_id < frames.size(); frame_id++) {
+    if (frame_id < end)
+      result.insert(result.end(), frames[frame_id].begin(), frames[frame_id].end());
+    else
+      FreeRecords(frames[frame_id]);
+  }
+  return result;
+}
+}  // namespace terrier::storage
@@ -0,0 +1,44 @@
+#include "storage/write_ahead_log/log_segment.h"
+#include <dirent.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "storage/write_ahead_log/log_io.h"
+
+namespace terrier::storage {
+std::vector<uint64_t> LogSegmentHeader::ListSegments(const std::string &stream_file_path) {
+  const size_t separator = stream_file_path.find_last_of('/');
+  const std::string dir = separator == std::string::npos ? "." : stream_file_path.substr(0, separator + 1);
+  const std::string prefix =
+      (separator == std::string::npos ? stream_file_path : stream_file_path.substr(separator + 1)) + ".segment.";
+  DIR *const entries = opendir(dir.c_str());
+  if (entries == nullptr) throw std::runtime_error("Failed to open directory with errno " + std::to_string(errno));
+  std::vector<uint64_t> result;
+  for (dirent *entry = readdir(entries); entry != nullptr; entry = readdir(entries)) {
+    const std::string name = entry->d_name;
+    if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) continue;
+    const std::string id = name.substr(prefix.size());
+    if (std::all_of(id.begin(), id.end(), [](char c) { return c >= '0' && c <= '9'; }))
+      result.push_back(std::stoull(id));
+  }
+  closedir(entries);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+bool LogSegmentHeader::Read(const std::string &path, LogSegmentHeader *const header) {
+  const int fd = PosixIoWrappers::Open(path.c_str(), O_RDONLY);
+  const uint32_t size = PosixIoWrappers::ReadFully(fd, header, sizeof(LogSegmentHeader));
+  PosixIoWrappers::Close(fd);
+  return size == sizeof(LogSegmentHeader) && header->magic_ == MAGIC;
+}
+
+void LogSegmentHeader::Write(const std::string &path) const {
+  const int fd = PosixIoWrappers::Open(path.c_str(), O_WRONLY);
+  iovec header{const_cast<LogSegmentHeader *>(this), sizeof(LogSegmentHeader)};
+  PosixIoWrappers::PWriteVFully(fd, &header, 1, 0);
+  const int ret = fsync(fd);
+  PosixIoWrappers::Close(fd);
+  if (ret == -1) throw std::runtime_error("fsync failed with errno " + std::to_string(errno));
+}
+}  // namespace terrier::storage
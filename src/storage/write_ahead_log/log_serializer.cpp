@@ -0,0 +1,283 @@
+#include "storage/write_ahead_log/log_serializer.h"
+#include <cstring>
+#include <optional>
+#include <vector>
+#include "common/allocator.h"
+#include "common/container/bitmap.h"
+
+namespace terrier::storage {
+namespace {
+// Size of the body of a serialized redo record before its column ids
+constexpr uint32_t REDO_HEADER_SIZE =
+    sizeof(catalog::db_oid_t) + sizeof(catalog::table_oid_t) + sizeof(TupleSlot) + sizeof(layout_version_t) +
+    sizeof(uint16_t);
+// Size of a serialized delete record
+constexpr uint32_t DELETE_SIZE =
+    sizeof(LogRecord) + sizeof(catalog::db_oid_t) + sizeof(catalog::table_oid_t) + sizeof(TupleSlot);
+
+// Records are packed in the log, so fields are copied rather than accessed in place
+template <class T>
+void WriteField(byte **out, const T &value) {
+  std::memcpy(*out, &value, sizeof(T));
+  *out += sizeof(T);
+}
+
+template <class T>
+T ReadField(const byte **in) {
+  T result;
+  std::memcpy(&result, *in, sizeof(T));
+  *in += sizeof(T);
+  return result;
+}
+
+// Copies a fixed-size value with a copy of constant size, which is a lot cheaper than a memcpy of variable size
+void CopyValue(byte *const dest, const byte *const src, const uint8_t attr_size) {
+  switch (attr_size) {
+    case 8:
+      std::memcpy(dest, src, 8);
+      break;
+    case 4:
+      std::memcpy(dest, src, 4);
+      break;
+    case 2:
+      std::memcpy(dest, src, 2);
+      break;
+    default:
+      *dest = *src;
+  }
+}
+
+bool IsValidAttrSize(const uint8_t attr_size) {
+  return attr_size == 1 || attr_size == 2 || attr_size == 4 || attr_size == 8 || attr_size == VARLEN_COLUMN;
+}
+
+uint8_t RealAttrSize(const uint8_t attr_size) { return attr_size == VARLEN_COLUMN ? sizeof(VarlenEntry) : attr_size; }
+
+// Creating a ProjectedRowInitializer takes several allocations, which would make up a large part of the cost of
+// deserializing a redo record. Consecutive redo records mostly have the same columns, so every thread keeps the
+// initializer of the last redo record it deserialized, along with the column ids and attribute sizes it is for.
+const ProjectedRowInitializer &CachedInitializer(const byte *const columns, const uint16_t num_cols) {
+  static thread_local std::vector<byte> cached_columns;
+  static thread_local std::optional<ProjectedRowInitializer> cached;
+  const uint32_t columns_size = num_cols * static_cast<uint32_t>(sizeof(col_id_t) + sizeof(uint8_t));
+  if (cached.has_value() && cached_columns.size() == columns_size &&
+      std::memcmp(cached_columns.data(), columns, columns_size) == 0)
+    return *cached;
+  cached_columns.assign(columns, columns + columns_size);
+  std::vector<uint16_t> col_ids(num_cols);
+  std::memcpy(col_ids.data(), columns, num_cols * sizeof(col_id_t));
+  const auto *attr_sizes = reinterpret_cast<const uint8_t *>(columns + num_cols * sizeof(col_id_t));
+  std::vector<uint8_t> real_attr_sizes(num_cols);
+  for (uint16_t i = 0; i < num_cols; i++) real_attr_sizes[i] = RealAttrSize(attr_sizes[i]);
+  cached.emplace(ProjectedRowInitializer::Create(real_attr_sizes, col_ids));
+  return *cached;
+}
+}  // namespace
+
+const BlockLayout &LogSerializer::LoggedLayout(const RedoRecord &redo) {
+  TERRIER_ASSERT(redo.GetTupleSlot() != TupleSlot(nullptr, 0), "redo records must have their tuple slot set");
+  return redo.GetTupleSlot().GetBlock()->data_table_->accessor_.GetBlockLayout();
+}
+
+uint32_t LogSerializer::SerializedSize(const LogRecord &record) {
+  switch (record.RecordType()) {
+    case LogRecordType::COMMIT:
+      return CommitRecord::SerializedSize();
+    case LogRecordType::DELETE:
+      return DELETE_SIZE;
+    case LogRecordType::REDO: {
+      const auto *redo = record.GetUnderlyingRecordBodyAs<RedoRecord>();
+      const ProjectedRow &delta = *redo->Delta();
+      const BlockLayout &layout = LoggedLayout(*redo);
+      const uint16_t num_cols = delta.NumColumns();
+      uint32_t size = static_cast<uint32_t>(sizeof(LogRecord)) + REDO_HEADER_SIZE +
+                      num_cols * static_cast<uint32_t>(sizeof(col_id_t) + sizeof(uint8_t)) +
+                      common::RawBitmap::SizeInBytes(num_cols);
+      for (uint16_t i = 0; i < num_cols; i++) {
+        const byte *value = delta.AccessWithNullCheck(i);
+        if (value == nullptr) continue;
+        const col_id_t col_id = delta.ColumnIds()[i];
+        if (layout.IsVarlen(col_id))
+          size += static_cast<uint32_t>(sizeof(uint32_t)) + reinterpret_cast<const VarlenEntry *>(value)->Size();
+        else
+          size += layout.AttrSize(col_id);
+      }
+      return size;
+    }
+    default:
+      throw std::runtime_error("unknown log record type");
+  }
+}
+
+uint32_t LogSerializer::Serialize(const LogRecord &record, byte *const out) {
+  // The header is written last, once the size of the record is known
+  byte *pos = out + sizeof(LogRecord);
+  switch (record.RecordType()) {
+    case LogRecordType::COMMIT:
+      WriteField(&pos, record.GetUnderlyingRecordBodyAs<CommitRecord>()->CommitTime());
+      break;
+    case LogRecordType::DELETE: {
+      const auto *body = record.GetUnderlyingRecordBodyAs<DeleteRecord>();
+      WriteField(&pos, body->GetDatabaseOid());
+      WriteField(&pos, body->GetTableOid());
+      WriteField(&pos, body->GetTupleSlot());
+      break;
+    }
+    case LogRecordType::REDO: {
+      const auto *redo = record.GetUnderlyingRecordBodyAs<RedoRecord>();
+      const ProjectedRow &delta = *redo->Delta();
+      const BlockLayout &layout = LoggedLayout(*redo);
+      const uint16_t num_cols = delta.NumColumns();
+      WriteField(&pos, redo->GetDatabaseOid());
+      WriteField(&pos, redo->GetTableOid());
+      WriteField(&pos, redo->GetTupleSlot());
+      WriteField(&pos, redo->GetTupleSlot().GetBlock()->layout_version_);
+      WriteField(&pos, num_cols);
+      std::memcpy(pos, delta.ColumnIds(), num_cols * sizeof(col_id_t));
+      pos += num_cols * sizeof(col_id_t);
+      const auto *attr_sizes = reinterpret_cast<const uint8_t *>(pos);
+      for (uint16_t i = 0; i < num_cols; i++) {
+        const col_id_t col_id = delta.ColumnIds()[i];
+        *pos++ = static_cast<byte>(layout.IsVarlen(col_id) ? VARLEN_COLUMN : layout.AttrSize(col_id));
+      }
+      auto *null_bitmap = reinterpret_cast<common::RawBitmap *>(pos);
+      null_bitmap->Clear(num_cols);
+      pos += common::RawBitmap::SizeInBytes(num_cols);
+
+      // Varlen contents go behind the fixed-size values
+      byte *varlen_pos = pos;
+      for (uint16_t i = 0; i < num_cols; i++) {
+        if (delta.AccessWithNullCheck(i) == nullptr) continue;
+        null_bitmap->Set(i, true);
+        varlen_pos += attr_sizes[i] == VARLEN_COLUMN ? sizeof(uint32_t) : attr_sizes[i];
+      }
+      for (uint16_t i = 0; i < num_cols; i++) {
+        if (!null_bitmap->Test(i)) continue;
+        const byte *value = delta.AccessWithNullCheck(i);
+        if (attr_sizes[i] != VARLEN_COLUMN) {
+          CopyValue(pos, value, attr_sizes[i]);
+          pos += attr_sizes[i];
+          continue;
+        }
+        const auto *entry = reinterpret_cast<const VarlenEntry *>(value);
+        WriteField(&pos, entry->Size());
+        std::memcpy(varlen_pos, entry->Content(), entry->Size());
+        varlen_pos += entry->Size();
+      }
+      pos = varlen_pos;
+      break;
+    }
+    default:
+      throw std::runtime_error("unknown log record type");
+  }
+  const auto size = static_cast<uint32_t>(pos - out);
+  TERRIER_ASSERT(size == SerializedSize(record), "serialized record does not match its expected size");
+  alignas(8) byte header[sizeof(LogRecord)] = {};
+  LogRecord::InitializeHeader(header, record.RecordType(), size, record.TxnBegin());
+  std::memcpy(out, header, sizeof(LogRecord));
+  return size;
+}
+
+LogRecord *LogSerializer::Deserialize(const byte *const in) {
+  alignas(8) byte header[sizeof(LogRecord)];
+  std::memcpy(header, in, sizeof(LogRecord));
+  const auto *record = reinterpret_cast<const LogRecord *>(header);
+  const uint32_t size = record->Size();
+  const transaction::timestamp_t txn_begin = record->TxnBegin();
+  const byte *cursor = in + sizeof(LogRecord);
+  switch (record->RecordType()) {
+    case LogRecordType::COMMIT: {
+      if (size != CommitRecord::SerializedSize()) return nullptr;
+      const auto txn_commit = ReadField<transaction::timestamp_t>(&cursor);
+      byte *buf = common::AllocationUtil::AllocateAligned(CommitRecord::Size());
+      // Okay to fill in null since nobody will invoke the callback. Read-only transactions do not write commit records.
+      return CommitRecord::Initialize(buf, txn_begin, txn_commit, nullptr, nullptr, false, nullptr);
+    }
+    case LogRecordType::DELETE: {
+      if (size != DELETE_SIZE) return nullptr;
+      const auto db_oid = ReadField<catalog::db_oid_t>(&cursor);
+      const auto table_oid = ReadField<catalog::table_oid_t>(&cursor);
+      const auto slot = ReadField<TupleSlot>(&cursor);
+      byte *buf = common::AllocationUtil::AllocateAligned(DeleteRecord::Size());
+      return DeleteRecord::Initialize(buf, txn_begin, db_oid, table_oid, slot);
+    }
+    case LogRecordType::REDO: {
+      const byte *const end = in + size;
+      if (size < sizeof(LogRecord) + REDO_HEADER_SIZE) return nullptr;
+      const auto db_oid = ReadField<catalog::db_oid_t>(&cursor);
+      const auto table_oid = ReadField<catalog::table_oid_t>(&cursor);
+      const auto slot = ReadField<TupleSlot>(&cursor);
+      const auto layout_version = ReadField<layout_version_t>(&cursor);
+      const auto num_cols = ReadField<uint16_t>(&cursor);
+      if (num_cols == 0 ||
+          end - cursor < num_cols * static_cast<int64_t>(sizeof(col_id_t) + sizeof(uint8_t)) +
+                             common::RawBitmap::SizeInBytes(num_cols))
+        return nullptr;
+      const byte *const columns = cursor;
+      cursor += num_cols * sizeof(col_id_t);
+      const auto *attr_sizes = reinterpret_cast<const uint8_t *>(cursor);
+      cursor += num_cols;
+      const auto *null_bitmap = reinterpret_cast<const common::RawBitmap *>(cursor);
+      cursor += common::RawBitmap::SizeInBytes(num_cols);
+
+      // Columns are logged in the order of the ProjectedRow, i.e. by descending attribute size
+      for (uint16_t i = 0; i < num_cols; i++) {
+        if (!IsValidAttrSize(attr_sizes[i])) return nullptr;
+        if (i > 0 && RealAttrSize(attr_sizes[i]) > RealAttrSize(attr_sizes[i - 1])) return nullptr;
+      }
+      // The values have to add up to the size of the record
+      const byte *values = cursor;
+      uint64_t values_size = 0, varlen_size = 0, out_of_line_size = 0;
+      for (uint16_t i = 0; i < num_cols; i++) {
+        if (!null_bitmap->Test(i)) continue;
+        if (attr_sizes[i] != VARLEN_COLUMN) {
+          values_size += attr_sizes[i];
+          continue;
+        }
+        if (end - values < static_cast<int64_t>(values_size + sizeof(uint32_t))) return nullptr;
+        const byte *size_field = values + values_size;
+        const uint32_t varlen_value_size = ReadField<uint32_t>(&size_field);
+        values_size += sizeof(uint32_t);
+        varlen_size += varlen_value_size;
+        if (varlen_value_size > VarlenEntry::InlineThreshold()) out_of_line_size += varlen_value_size;
+      }
+      if (static_cast<uint64_t>(end - values) != values_size + varlen_size) return nullptr;
+
+      const ProjectedRowInitializer &initializer = CachedInitializer(columns, num_cols);
+      const uint32_t record_size = RedoRecord::Size(initializer) + static_cast<uint32_t>(out_of_line_size);
+      byte *buf = common::AllocationUtil::AllocateAligned(record_size);
+      LogRecord *result = RedoRecord::Initialize(buf, txn_begin, db_oid, table_oid, initializer);
+      LogRecord::InitializeHeader(buf, LogRecordType::REDO, record_size, txn_begin);
+      auto *redo = result->GetUnderlyingRecordBodyAs<RedoRecord>();
+      redo->SetTupleSlot(slot);
+      redo->layout_version_ = layout_version;
+
+      // Out-of-line varlen values are copied behind the delta
+      ProjectedRow *delta = redo->Delta();
+      const byte *varlen_in = values + values_size;
+      byte *varlen_out = buf + RedoRecord::Size(initializer);
+      for (uint16_t i = 0; i < num_cols; i++) {
+        if (!null_bitmap->Test(i)) continue;
+        byte *dest = delta->AccessForceNotNull(i);
+        if (attr_sizes[i] != VARLEN_COLUMN) {
+          CopyValue(dest, cursor, attr_sizes[i]);
+          cursor += attr_sizes[i];
+          continue;
+        }
+        const auto varlen_value_size = ReadField<uint32_t>(&cursor);
+        if (varlen_value_size <= VarlenEntry::InlineThreshold()) {
+          *reinterpret_cast<VarlenEntry *>(dest) = VarlenEntry::CreateInline(varlen_in, varlen_value_size);
+        } else {
+          std::memcpy(varlen_out, varlen_in, varlen_value_size);
+          *reinterpret_cast<VarlenEntry *>(dest) = VarlenEntry::Create(varlen_out, varlen_value_size, false);
+          varlen_out += varlen_value_size;
+        }
+        varlen_in += varlen_value_size;
+      }
+      return result;
+    }
+    default:
+      return nullptr;
+  }
+}
+}  // namespace terrier::storage
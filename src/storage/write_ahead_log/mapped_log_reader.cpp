@@ -0,0 +1,84 @@
+#include "storage/write_ahead_log/mapped_log_reader.h"
+#include <sys/mman.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "lz_block/lz_block.h"
+#include "storage/write_ahead_log/log_record.h"
+
+namespace terrier::storage {
+MappedLogReader::MappedLogReader(const char *const log_file_path, const uint64_t offset)
+    : head_(offset), readahead_end_(offset / READAHEAD_SIZE * READAHEAD_SIZE) {
+  const int fd = PosixIoWrappers::Open(log_file_path, O_RDONLY);
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    close(fd);
+    throw std::runtime_error("fstat failed with errno " + std::to_string(errno));
+  }
+  size_ = static_cast<uint64_t>(file_stat.st_size);
+  // Nothing to map in an empty log, and mmap does not take empty mappings
+  if (size_ > head_) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    void *const mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("mmap failed with errno " + std::to_string(errno));
+    }
+    mapping_ = reinterpret_cast<const byte *>(mapping);
+    madvise(mapping, size_, MADV_SEQUENTIAL);
+  }
+  // The mapping stays valid once the file is closed
+  PosixIoWrappers::Close(fd);
+}
+
+MappedLogReader::~MappedLogReader() {
+  if (mapping_ != nullptr) munmap(const_cast<byte *>(mapping_), size_);
+}
+
+bool MappedLogReader::NextFrame(Frame *const frame) {
+  while (head_ < size_ && mapping_[head_] == byte(0)) head_++;
+  if (head_ == size_) return false;
+  // Anything but a whole frame is a torn write, and ends the log
+  if (static_cast<uint8_t>(mapping_[head_]) != LogFrameHeader::MARKER || size_ - head_ < sizeof(LogFrameHeader)) {
+    head_ = size_;
+    return false;
+  }
+  std::memcpy(&frame->header_, mapping_ + head_, sizeof(LogFrameHeader));
+  head_ += sizeof(LogFrameHeader);
+  if (frame->header_.payload_size_ > size_ - head_) {
+    head_ = size_;
+    return false;
+  }
+  frame->payload_ = mapping_ + head_;
+  head_ += frame->header_.payload_size_;
+  // Keep the kernel reading at least half a window ahead of the frames located. The windows are page aligned.
+  if (head_ + READAHEAD_SIZE / 2 > readahead_end_ && readahead_end_ < size_) {
+    madvise(const_cast<byte *>(mapping_ + readahead_end_), std::min(READAHEAD_SIZE, size_ - readahead_end_),
+            MADV_WILLNEED);
+    readahead_end_ += READAHEAD_SIZE;
+  }
+  return true;
+}
+
+const byte *MappedLogReader::Decode(const Frame &frame, std::vector<byte> *const buffer) {
+  if (frame.header_.ComputeChecksum(frame.payload_) != frame.header_.checksum_) return nullptr;
+  if (frame.header_.compressed_ == 0)
+    return frame.header_.records_size_ == frame.header_.payload_size_ ? frame.payload_ : nullptr;
+  buffer->resize(frame.header_.records_size_);
+  const bool decompressed = lz_block::Decompress(reinterpret_cast<const uint8_t *>(frame.payload_),
+                                                 frame.header_.payload_size_,
+                                                 reinterpret_cast<uint8_t *>(buffer->data()), buffer->size());
+  return decompressed ? buffer->data() : nullptr;
+}
+
+const byte *MappedLogReader::NextRecord(const byte *const records, const uint32_t size, uint32_t *const offset) {
+  if (size - *offset < sizeof(LogRecord)) return nullptr;
+  alignas(8) byte header[sizeof(LogRecord)];
+  std::memcpy(header, records + *offset, sizeof(LogRecord));
+  const uint32_t record_size = reinterpret_cast<const LogRecord *>(header)->Size();
+  if (record_size < sizeof(LogRecord) || record_size > size - *offset) return nullptr;
+  const byte *const result = records + *offset;
+  *offset += record_size;
+  return result;
+}
+}  // namespace terrier::storage
@@ -0,0 +1,40 @@
+#include "transaction/epoch_reclaimer.h"
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace terrier::transaction {
+void EpochReclaimer::Retire(const timestamp_t retire_time, Action action) {
+  Shard &shard = shards_[TimestampAllocator::ThreadLane()];
+  common::SpinLatch::ScopedSpinLatch guard(&shard.latch_);
+  shard.retired_.emplace_back(retire_time, std::move(action));
+}
+
+timestamp_t EpochReclaimer::Collect() {
+  for (Shard &shard : shards_) {
+    common::SpinLatch::ScopedSpinLatch guard(&shard.latch_);
+    // Clearing keeps the capacity, so a lane does not grow its list again for every batch
+    std::move(shard.retired_.begin(), shard.retired_.end(), std::back_inserter(pending_));
+    shard.retired_.clear();
+  }
+  timestamp_t newest = timestamp_t(0);
+  for (const auto &pending : pending_) newest = std::max(newest, pending.first);
+  return newest;
+}
+
+uint32_t EpochReclaimer::Reclaim(const timestamp_t oldest_start_time) {
+  // Actions may retire new actions when run, but those go to the lists of the lanes and never to pending_
+  auto kept = pending_.begin();
+  for (auto &pending : pending_) {
+    if (pending.first <= oldest_start_time) {
+      pending.second();
+      continue;
+    }
+    if (&*kept != &pending) *kept = std::move(pending);
+    ++kept;
+  }
+  const auto num_run = static_cast<uint32_t>(std::distance(kept, pending_.end()));
+  pending_.erase(kept, pending_.end());
+  return num_run;
+}
+}  // namespace terrier::transaction
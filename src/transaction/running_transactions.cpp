@@ -0,0 +1,41 @@
+#include "transaction/running_transactions.h"
+#include <algorithm>
+#include <utility>
+
+namespace terrier::transaction {
+void RunningTransactions::Add(const timestamp_t start_time) {
+  Shard &shard = shards_[TimestampAllocator::LaneOf(start_time)];
+  common::SpinLatch::ScopedSpinLatch guard(&shard.latch_);
+  shard.running_.push_back(start_time);
+  if (start_time < shard.oldest_.load()) shard.oldest_.store(start_time);
+}
+
+void RunningTransactions::Remove(const timestamp_t start_time, TransactionContext *const completed) {
+  Shard &shard = shards_[TimestampAllocator::LaneOf(start_time)];
+  common::SpinLatch::ScopedSpinLatch guard(&shard.latch_);
+  auto it = std::find(shard.running_.begin(), shard.running_.end(), start_time);
+  TERRIER_ASSERT(it != shard.running_.end(), "Finished transaction did not exist in global transactions table");
+  *it = shard.running_.back();
+  shard.running_.pop_back();
+  if (shard.oldest_.load() == start_time) {
+    const auto oldest = std::min_element(shard.running_.cbegin(), shard.running_.cend());
+    shard.oldest_.store(oldest == shard.running_.cend() ? NONE_RUNNING : *oldest);
+  }
+  if (completed != nullptr) shard.completed_.push_front(completed);
+}
+
+timestamp_t RunningTransactions::Oldest(const timestamp_t none_running) const {
+  timestamp_t result = none_running;
+  for (const Shard &shard : shards_) result = std::min(result, shard.oldest_.load());
+  return result;
+}
+
+TransactionQueue RunningTransactions::TakeCompleted() {
+  TransactionQueue result;
+  for (Shard &shard : shards_) {
+    common::SpinLatch::ScopedSpinLatch guard(&shard.latch_);
+    result.splice_after(result.cbefore_begin(), std::move(shard.completed_));
+  }
+  return result;
+}
+}  // namespace terrier::transaction
@@ -0,0 +1,77 @@
+#include "transaction/timestamp_allocator.h"
+#include <immintrin.h>
+#include <thread>  // NOLINT
+
+namespace terrier::transaction {
+namespace {
+// Waits are short, unless the thread being waited for was preempted, in which case it needs the core
+void Backoff(uint32_t *const spins) {
+  if ((*spins)++ < 64)
+    _mm_pause();
+  else
+    std::this_thread::yield();
+}
+}  // namespace
+
+uint32_t TimestampAllocator::ThreadLane() {
+  // Threads are assigned round-robin, so that up to NUM_LANES threads never share a lane
+  static std::atomic<uint32_t> num_threads{0};
+  static thread_local const uint32_t lane_id = num_threads++ % NUM_LANES;
+  return lane_id;
+}
+
+timestamp_t TimestampAllocator::StartTimestamp() {
+  const uint32_t lane_id = ThreadLane();
+  Lane &lane = lanes_[lane_id];
+  while (true) {
+    const uint64_t epoch = visible_epoch_.load();
+    uint64_t last = lane.last_start_.load(), next = 0;
+    bool exhausted = false;
+    do {
+      // Another thread of the lane may already have seen a newer epoch, which is just as good
+      exhausted = last >> SEQUENCE_BITS >= epoch && (last & MAX_SEQUENCE) == MAX_SEQUENCE;
+      next = last >> SEQUENCE_BITS < epoch ? epoch << SEQUENCE_BITS | 1 : last + 1;
+    } while (!exhausted && !lane.last_start_.compare_exchange_weak(last, next));
+    if (exhausted) {
+      // The lane ran out of offsets in this epoch
+      Advance();
+      continue;
+    }
+    return timestamp_t(EpochStart(next >> SEQUENCE_BITS) | lane_id << SEQUENCE_BITS | (next & MAX_SEQUENCE));
+  }
+}
+
+timestamp_t TimestampAllocator::SnapshotStartTimestamp() const {
+  // No commit timestamp lies between the start of the epoch and the offset, so the lane does not change the snapshot
+  return timestamp_t(EpochStart(visible_epoch_.load()) | ThreadLane() << SEQUENCE_BITS);
+}
+
+timestamp_t TimestampAllocator::JoinCommit() {
+  Lane &lane = lanes_[ThreadLane()];
+  while (true) {
+    const uint64_t epoch = open_epoch_.load();
+    lane.committing_[epoch % 2]++;
+    // Whoever closes the epoch waits for members counted before it closed
+    if (open_epoch_.load() == epoch) return timestamp_t(EpochStart(epoch + 1));
+    lane.committing_[epoch % 2]--;
+  }
+}
+
+void TimestampAllocator::FinishCommit(const timestamp_t commit_time) {
+  const uint64_t epoch = EpochOf(commit_time) - 1;
+  lanes_[ThreadLane()].committing_[epoch % 2]--;
+  for (uint32_t spins = 0; visible_epoch_.load() <= epoch; Backoff(&spins)) {
+    // An epoch can only be closed once the previous one is visible, so that no group joins with the same parity
+    // while the lanes are drained
+    uint64_t expected = epoch;
+    if (visible_epoch_.load() != epoch || open_epoch_.load() != epoch ||
+        !open_epoch_.compare_exchange_strong(expected, epoch + 1))
+      continue;
+    for (Lane &lane : lanes_)
+      for (uint32_t drain_spins = 0; lane.committing_[epoch % 2].load() != 0; Backoff(&drain_spins)) {
+      }
+    visible_epoch_.store(epoch + 1);
+    return;
+  }
+}
+}  // namespace terrier::transaction
@@ -0,0 +1,39 @@
+#include "transaction/transaction_context_pool.h"
+
+namespace terrier::transaction {
+TransactionContextPool::~TransactionContextPool() {
+  for (Shard &shard : shards_)
+    for (TransactionContext *txn : shard.reusable_) delete txn;
+}
+
+TransactionContext *TransactionContextPool::Get(const timestamp_t start, const timestamp_t txn_id) {
+  Shard &shard = shards_[TimestampAllocator::LaneOf(start)];
+  TransactionContext *result = nullptr;
+  {
+    common::SpinLatch::ScopedSpinLatch guard(&shard.latch_);
+    if (!shard.reusable_.empty()) {
+      result = shard.reusable_.back();
+      shard.reusable_.pop_back();
+    }
+  }
+  // Do the allocation outside of the critical section
+  if (result == nullptr) return new TransactionContext(start, txn_id, buffer_pool_, log_manager_, txn_mgr_);
+  result->start_time_ = start;
+  result->txn_id_.store(txn_id);
+  return result;
+}
+
+void TransactionContextPool::Release(TransactionContext *const txn) {
+  Shard &shard = shards_[TimestampAllocator::LaneOf(txn->StartTime())];
+  // Free what the transaction left behind outside of the critical section, as a transaction may have many loose varlens
+  txn->Clear();
+  {
+    common::SpinLatch::ScopedSpinLatch guard(&shard.latch_);
+    if (shard.reusable_.size() < reuse_limit_per_lane_) {
+      shard.reusable_.push_back(txn);
+      return;
+    }
+  }
+  delete txn;
+}
+}  // namespace terrier::transaction
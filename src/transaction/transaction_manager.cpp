@@ -1,70 +1,90 @@
 #include "transaction/transaction_manager.h"
 #include <algorithm>
-#include <queue>
 #include <utility>
 
 namespace terrier::transaction {
 TransactionContext *TransactionManager::BeginTransaction() {
-  // Ensure we do not return from this function if there are ongoing write commits
-  common::Gate::ScopedExit gate(&txn_gate_);
-
   timestamp_t start_time;
-  {
+  while (true) {
+    start_time = timestamps_.StartTimestamp();
     // There is a three-way race that needs to be prevented.  Specifically, we
     // cannot allow both a transaction to commit and the GC to poll for the
     // oldest running transaction in between this transaction acquiring its
     // begin timestamp and getting inserted into the current running
-    // transactions list.  Using the current running transactions latch
-    // prevents the GC from polling and stops the race.  This allows us to
-    // replace acquiring a shared instance of the commit latch with a
-    // read-only spin-latch and move the allocation out of a critical section.
-    common::SpinLatch::ScopedSpinLatch running_guard(&curr_running_txns_latch_);
-    start_time = time_++;
+    // transactions list.  The transaction is published first, and keeps its
+    // start timestamp only if the timestamp is still in the visible epoch
+    // afterwards.  A poll that misses the transaction reads the visible epoch
+    // before that, and thus cannot return anything newer than the start
+    // timestamp (see OldestTransactionStartTime).
+    curr_running_txns_.Add(start_time);
+    if (timestamps_.IsCurrent(start_time)) break;
+    curr_running_txns_.Remove(start_time, nullptr);
+  }
 
-    // TODO(Tianyu):
-    // Maybe embed this into the data structure, or use an object pool?
-    // Doing this with std::map or other data structure is risky though, as they may not
-    // guarantee that the iterator or underlying pointer is stable across operations.
-    // (That is, they may change as concurrent inserts and deletes happen)
-    const auto ret UNUSED_ATTRIBUTE = curr_running_txns_.emplace(start_time);
-    TERRIER_ASSERT(ret.second, "commit start time should be globally unique");
-  }  // Release latch on current running transactions
+  // Reuse a context freed by the GC if possible, outside of any critical section
+  auto *const result = txn_pool_.Get(start_time, start_time + INT64_MIN);
+  result->synchronous_commit_ = synchronous_commit_;
 
-  // Do the allocation outside of any critical section
-  auto *const result = new TransactionContext(start_time, start_time + INT64_MIN, buffer_pool_, log_manager_, this);
+  return result;
+}
 
+TransactionContext *TransactionManager::BeginReadOnlyTransaction() {
+  timestamp_t start_time;
+  while (true) {
+    // Registering the snapshot is subject to the same race as in BeginTransaction, but there is no need to draw a
+    // unique start timestamp for a transaction that never writes
+    start_time = timestamps_.SnapshotStartTimestamp();
+    curr_running_txns_.Add(start_time);
+    if (timestamps_.IsCurrent(start_time)) break;
+    curr_running_txns_.Remove(start_time, nullptr);
+  }
+
+  auto *const result = txn_pool_.Get(start_time, start_time + INT64_MIN);
+  result->read_only_ = true;
   return result;
 }
 
-void TransactionManager::LogCommit(TransactionContext *const txn, const timestamp_t commit_time,
+void TransactionManager::EndReadOnly(TransactionContext *const txn) {
+  curr_running_txns_.Remove(txn->StartTime(), nullptr);
+  // Nothing can refer to a transaction that did not write, so there is no need to wait for the GC
+  txn_pool_.Release(txn);
+}
+
+bool TransactionManager::LogCommit(TransactionContext *const txn, const timestamp_t commit_time,
                                    const callback_fn callback, void *const callback_arg) {
   txn->TxnId().store(commit_time);
+  const bool async_commit = log_manager_ != LOGGING_DISABLED && !txn->synchronous_commit_;
   if (log_manager_ != LOGGING_DISABLED) {
     // At this point the commit has already happened for the rest of the system.
     // Here we will manually add a commit record and flush the buffer to ensure the logger
     // sees this record.
     byte *const commit_record = txn->redo_buffer_.NewEntry(storage::CommitRecord::Size());
     const bool is_read_only = txn->undo_buffer_.Empty();
-    storage::CommitRecord::Initialize(commit_record, txn->StartTime(), commit_time, callback, callback_arg,
-                                      is_read_only, txn);
+    // An asynchronous commit is acknowledged by the caller, so the log manager has no callback to invoke
+    storage::CommitRecord::Initialize(commit_record, txn->StartTime(), commit_time,
+                                      async_commit ? nullptr : callback, callback_arg, is_read_only, txn);
     // Signal to the log manager that we are ready to be logged out
   } else {
     // Otherwise, logging is disabled. We should pretend to have flushed the record so the rest of the system proceeds
     // correctly
     txn->log_processed_ = true;
-    callback(callback_arg);
   }
   txn->redo_buffer_.Finalize(true);
+  // Once its commit record is queued, the log manager persists an asynchronous commit within its maximum commit lag
+  return log_manager_ == LOGGING_DISABLED || async_commit;
 }
 
 timestamp_t TransactionManager::ReadOnlyCommitCriticalSection(TransactionContext *const txn, const callback_fn callback,
                                                               void *const callback_arg) {
-  // No records to update. No commit will ever depend on us. We can do all the work outside of the critical section
-  const timestamp_t commit_time = time_++;
+  // No records to update. No commit will ever depend on us. We can do all the work outside of the critical section.
+  // The transaction commits at its snapshot, which already is older than the start time of any transaction that
+  // begins later, so there is no need to allocate a timestamp at all.
+  const timestamp_t commit_time = TimestampAllocator::SnapshotTimestamp(txn->StartTime());
   // TODO(Tianyu): Notice here that for a read-only transaction, it is necessary to communicate the commit with the
   // LogManager, so speculative reads are handled properly,  but there is no need to actually write out the read-only
   // transaction's commit record to disk.
-  LogCommit(txn, commit_time, callback, callback_arg);
+  // The snapshot is visible already, so the commit can be acknowledged right away
+  if (LogCommit(txn, commit_time, callback, callback_arg)) callback(callback_arg);
   return commit_time;
 }
 
@@ -83,19 +103,41 @@ timestamp_t TransactionManager::UpdatingCommitCriticalSection(TransactionContext
   //  Transaction 2 will incorrectly read the original version of 'a' the first
   //  time because transaction 1 hasn't made its writes visible and then reads
   //  the correct version the second time, violating snapshot isolation.
-  //  Make sure you solve this problem before you remove this gate for whatever reason.
-  common::Gate::ScopedLock gate(&txn_gate_);
-  const timestamp_t commit_time = time_++;
+  //  Joining a commit group solves this problem, as transactions only begin with
+  //  the commit timestamp of a group as part of their snapshot once every member
+  //  of the group has flipped its timestamps.
+  const timestamp_t commit_time = timestamps_.JoinCommit();
 
-  LogCommit(txn, commit_time, callback, callback_arg);
+  const bool acknowledge = LogCommit(txn, commit_time, callback, callback_arg);
   // flip all timestamps to be committed
   for (auto &it : txn->undo_buffer_) it.Timestamp().store(commit_time);
 
+  // Return only once the commit is visible, so that nothing that happens after can miss it. This includes the
+  // transactions a client begins once the commit is acknowledged.
+  timestamps_.FinishCommit(commit_time);
+  if (acknowledge) callback(callback_arg);
   return commit_time;
 }
 
 timestamp_t TransactionManager::Commit(TransactionContext *const txn, transaction::callback_fn callback,
                                        void *callback_arg) {
+  if (txn->read_only_) {
+    // The transaction only read the snapshot it began with, so there is nothing to log
+    const timestamp_t result = TimestampAllocator::SnapshotTimestamp(txn->StartTime());
+    callback(callback_arg);
+    while (!txn->commit_actions_.empty()) {
+      txn->commit_actions_.front()();
+      txn->commit_actions_.pop_front();
+    }
+    EndReadOnly(txn);
+    return result;
+  }
+
+  // The transaction still holds write locks on everything it modified, so the tables can look at its after-images
+  // without interference. This has to happen before the commit timestamp is installed and the locks are released.
+  for (auto &it : txn->undo_buffer_) {
+    if (it.Table() != nullptr && it.Table()->CollectsStatistics()) it.Table()->UpdateStatisticsOnCommit(*txn, it);
+  }
   const timestamp_t result = txn->undo_buffer_.Empty() ? ReadOnlyCommitCriticalSection(txn, callback, callback_arg)
                                                        : UpdatingCommitCriticalSection(txn, callback, callback_arg);
   while (!txn->commit_actions_.empty()) {
@@ -103,17 +145,10 @@ timestamp_t TransactionManager::Commit(TransactionContext *const txn, transactio
     txn->commit_actions_.pop_front();
   }
 
-  {
-    // In a critical section, remove this transaction from the table of running transactions
-    common::SpinLatch::ScopedSpinLatch guard(&curr_running_txns_latch_);
-    const timestamp_t start_time = txn->StartTime();
-    const size_t ret UNUSED_ATTRIBUTE = curr_running_txns_.erase(start_time);
-    TERRIER_ASSERT(ret == 1, "Committed transaction did not exist in global transactions table");
-    // It is not necessary to have to GC process read-only transactions, but it's probably faster to call free off
-    // the critical path there anyway
-    // Also note here that GC will figure out what varlen entries to GC, as opposed to in the abort case.
-    if (gc_enabled_) completed_txns_.push_front(txn);
-  }
+  // It is not necessary to have to GC process read-only transactions, but it's probably faster to call free off
+  // the critical path there anyway
+  // Also note here that GC will figure out what varlen entries to GC, as opposed to in the abort case.
+  curr_running_txns_.Remove(txn->StartTime(), gc_enabled_ ? txn : nullptr);
   return result;
 }
 
@@ -123,6 +158,10 @@ void TransactionManager::Abort(TransactionContext *const txn) {
     txn->abort_actions_.front()();
     txn->abort_actions_.pop_front();
   }
+  if (txn->read_only_) {
+    EndReadOnly(txn);
+    return;
+  }
 
   // no commit latch required here since all operations are transaction-local
   for (auto &it : txn->undo_buffer_) Rollback(txn, it);
@@ -132,14 +171,7 @@ void TransactionManager::Abort(TransactionContext *const txn) {
   // Discard the redo buffer that is not yet logged out
   txn->redo_buffer_.Finalize(false);
   txn->log_processed_ = true;
-  {
-    // In a critical section, remove this transaction from the table of running transactions
-    common::SpinLatch::ScopedSpinLatch guard(&curr_running_txns_latch_);
-    const timestamp_t start_time = txn->StartTime();
-    const size_t ret UNUSED_ATTRIBUTE = curr_running_txns_.erase(start_time);
-    TERRIER_ASSERT(ret == 1, "Aborted transaction did not exist in global transactions table");
-    if (gc_enabled_) completed_txns_.push_front(txn);
-  }
+  curr_running_txns_.Remove(txn->StartTime(), gc_enabled_ ? txn : nullptr);
 }
 
 void TransactionManager::GCLastUpdateOnAbort(TransactionContext *const txn) {
@@ -177,26 +209,27 @@ void TransactionManager::GCLastUpdateOnAbort(TransactionContext *const txn) {
 }
 
 timestamp_t TransactionManager::OldestTransactionStartTime() const {
-  common::SpinLatch::ScopedSpinLatch guard(&curr_running_txns_latch_);
-  const auto &oldest_txn = std::min_element(curr_running_txns_.cbegin(), curr_running_txns_.cend());
-  const timestamp_t result = (oldest_txn != curr_running_txns_.end()) ? *oldest_txn : time_.load();
-  return result;
+  // The visible epoch has to be read before the running transactions, see BeginTransaction
+  const timestamp_t none_running = timestamps_.OldestStartTimestamp();
+  const timestamp_t oldest = curr_running_txns_.Oldest(none_running);
+  // Racing callers may publish out of order, which only makes pruning transactions more conservative
+  last_oldest_txn_.store(oldest);
+  return oldest;
 }
 
-TransactionQueue TransactionManager::CompletedTransactionsForGC() {
-  common::SpinLatch::ScopedSpinLatch guard(&curr_running_txns_latch_);
-  return std::move(completed_txns_);
-}
+TransactionQueue TransactionManager::CompletedTransactionsForGC() { return curr_running_txns_.TakeCompleted(); }
 
 void TransactionManager::DeferAction(Action a) {
   TERRIER_ASSERT(GCEnabled(), "Need GC enabled for deferred actions to be executed.");
-  common::SpinLatch::ScopedSpinLatch guard(&deferred_actions_latch_);
-  deferred_actions_.push({time_.load(), a});
+  // Transactions that begin once the visible epoch changed can never see what the action cleans up. The epoch is not
+  // closed for every action, see CollectDeferredActions.
+  deferred_actions_.Retire(timestamps_.RetireTimestamp(), std::move(a));
 }
 
-std::queue<std::pair<timestamp_t, Action>> TransactionManager::DeferredActionsForGC() {
-  common::SpinLatch::ScopedSpinLatch guard(&deferred_actions_latch_);
-  return std::move(deferred_actions_);
+void TransactionManager::CollectDeferredActions() {
+  // Actions deferred in the visible epoch cannot run before it is closed. Closing it once for the whole batch keeps the
+  // actions from waiting on the next commit, and is much cheaper than closing it for each action.
+  if (deferred_actions_.Collect() > timestamps_.OldestStartTimestamp()) timestamps_.Advance();
 }
 
 void TransactionManager::Rollback(TransactionContext *txn, const storage::UndoRecord &record) const {
@@ -142,4 +142,29 @@ TEST(HashUtilTests, SumHashesTest) {
   EXPECT_EQ(combined0, combined1);
 }
 
+// NOLINTNEXTLINE
+TEST(HashUtilTests, Crc32cTest) {
+  // Check value of the CRC-32C standard
+  const std::string check = "123456789";
+  EXPECT_EQ(0xE3069283, common::HashUtil::Crc32c(reinterpret_cast<const byte *>(check.data()), check.size()));
+  EXPECT_EQ(0xE3069283, common::HashUtil::Crc32cSoftware(reinterpret_cast<const byte *>(check.data()), check.size()));
+
+  // Whatever the implementation, the length or the alignment, the checksum is the same, including when it is computed
+  // over consecutive ranges
+  std::default_random_engine generator;
+  std::uniform_int_distribution<uint16_t> distribution(0, UINT8_MAX);
+  std::vector<byte> bytes(1000);
+  for (auto &b : bytes) b = static_cast<byte>(distribution(generator));
+  for (uint32_t offset = 0; offset < 8; offset++) {
+    for (uint32_t length = 0; length + offset <= bytes.size(); length += 37) {
+      const byte *const start = bytes.data() + offset;
+      const uint32_t expected = common::HashUtil::Crc32cSoftware(start, length);
+      EXPECT_EQ(expected, common::HashUtil::Crc32c(start, length));
+      const uint32_t split = length / 3;
+      const uint32_t first = common::HashUtil::Crc32c(start, split);
+      EXPECT_EQ(expected, common::HashUtil::Crc32c(start + split, length - split, first));
+    }
+  }
+}
+
 }  // namespace terrier
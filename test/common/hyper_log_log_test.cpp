@@ -0,0 +1,50 @@
+#include "common/hyper_log_log.h"
+#include <cmath>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace terrier {
+
+// Checks that the estimate is within a few standard errors of the actual number of distinct values
+// NOLINTNEXTLINE
+TEST(HyperLogLogTests, Estimate) {
+  common::HyperLogLog hll;
+  EXPECT_EQ(0, hll.Estimate());
+  const double tolerance = 3 * 1.04 / std::sqrt(1u << common::HyperLogLog::DEFAULT_PRECISION);
+  uint64_t added = 0;
+  for (uint64_t target : {10u, 100u, 1000u, 10000u, 1000000u}) {
+    for (; added < target; added++) hll.Add(reinterpret_cast<const byte *>(&added), sizeof(uint64_t));
+    const auto estimate = static_cast<double>(hll.Estimate());
+    EXPECT_NEAR(static_cast<double>(target), estimate, tolerance * static_cast<double>(target) + 1);
+  }
+
+  // Duplicates should not change the estimate
+  const uint64_t estimate = hll.Estimate();
+  for (uint64_t i = 0; i < 1000; i++) hll.Add(reinterpret_cast<const byte *>(&i), sizeof(uint64_t));
+  EXPECT_EQ(estimate, hll.Estimate());
+
+  hll.Clear();
+  EXPECT_EQ(0, hll.Estimate());
+}
+
+// Checks that concurrent updates to the sketch are not lost
+// NOLINTNEXTLINE
+TEST(HyperLogLogTests, ConcurrentAdd) {
+  const uint32_t num_threads = 8;
+  const uint64_t values_per_thread = 100000;
+  common::HyperLogLog concurrent, serial;
+  std::vector<std::thread> threads;
+  for (uint32_t thread = 0; thread < num_threads; thread++) {
+    threads.emplace_back([&, thread] {
+      for (uint64_t i = thread * values_per_thread; i < (thread + 1) * values_per_thread; i++)
+        concurrent.Add(reinterpret_cast<const byte *>(&i), sizeof(uint64_t));
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  for (uint64_t i = 0; i < num_threads * values_per_thread; i++)
+    serial.Add(reinterpret_cast<const byte *>(&i), sizeof(uint64_t));
+  // Registers only ever take the max, so the outcome is independent of the interleaving
+  EXPECT_EQ(serial.Estimate(), concurrent.Estimate());
+}
+}  // namespace terrier
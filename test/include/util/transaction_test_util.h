@@ -254,6 +254,11 @@ class LargeTransactionTestObject {
    */
   const storage::BlockLayout &Layout() const { return layout_; }
 
+  /**
+   * @return begin timestamp of the transaction that populated the initial table
+   */
+  transaction::timestamp_t InitialTxnBegin() const { return initial_txn_begin_; }
+
   /**
    * Checks the correctness of reads in the committed transactions. No committed transaction should have read some
    * version of the tuple outside of its version. The correct version is reconstructed using the last valid image of
@@ -308,6 +313,7 @@ class LargeTransactionTestObject {
   storage::DataTable table_;
   transaction::TransactionManager txn_manager_;
   transaction::TransactionContext *initial_txn_;
+  transaction::timestamp_t initial_txn_begin_;
   bool gc_on_, wal_on_, bookkeeping_;
 
   // tuple content is meaningless if bookkeeping is off.
@@ -164,6 +164,7 @@ TEST(PlanNodeJsonTest, AnalyzePlanNodeJsonTest) {
                        .SetNamespaceOid(catalog::namespace_oid_t(0))
                        .SetTableOid(catalog::table_oid_t(2))
                        .SetColumnOIDs(std::move(col_oids))
+                       .SetSampling(storage::SamplingMethod::BERNOULLI, 0.01)
                        .Build();
 
   // Serialize to Json
@@ -814,6 +815,7 @@ TEST(PlanNodeJsonTest, SeqScanPlanNodeJsonTest) {
                        .SetDatabaseOid(catalog::db_oid_t(0))
                        .SetNamespaceOid(catalog::namespace_oid_t(0))
                        .SetTableOid(catalog::table_oid_t(0))
+                       .SetSampling(storage::SamplingMethod::SYSTEM, 0.1)
                        .Build();
 
   // Serialize to Json
@@ -0,0 +1,196 @@
+#include "storage/checkpoint/checkpoint_manager.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "storage/garbage_collector.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
+#include "util/catalog_test_util.h"
+#include "util/test_harness.h"
+#include "util/transaction_test_util.h"
+
+#define CHECKPOINT_DIR "checkpoint_test_dir"
+
+namespace terrier {
+
+class CheckpointTests : public TerrierTest {
+ public:
+  void SetUp() override {
+    TerrierTest::SetUp();
+    mkdir(CHECKPOINT_DIR, S_IRWXU);
+  }
+
+  void TearDown() override {
+    DIR *dir = opendir(CHECKPOINT_DIR);
+    for (dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+      if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0)
+        unlink((std::string(CHECKPOINT_DIR) + "/" + entry->d_name).c_str());
+    }
+    closedir(dir);
+    rmdir(CHECKPOINT_DIR);
+    TerrierTest::TearDown();
+  }
+
+  storage::BlockStore block_store_{100, 100};
+  storage::RecordBufferSegmentPool buffer_pool_{10000, 10000};
+  transaction::TransactionManager txn_manager_{&buffer_pool_, true, LOGGING_DISABLED};
+  storage::GarbageCollector gc_{&txn_manager_};
+  const catalog::table_oid_t table_oid_{1};
+  const catalog::col_oid_t int_oid_{1}, bigint_oid_{2}, varchar_oid_{3};
+  const catalog::Schema schema_{{{"int", type::TypeId::INTEGER, false, int_oid_},
+                                 {"bigint", type::TypeId::BIGINT, true, bigint_oid_},
+                                 {"varchar", type::TypeId::VARCHAR, 100, true, varchar_oid_}}};
+
+  // Inserts a tuple derived from the given key. Every third tuple has nulls, and every other one a varlen too long
+  // to be inlined.
+  storage::TupleSlot InsertTuple(transaction::TransactionContext *txn, storage::SqlTable *table, const int32_t key) {
+    auto initializer = table->InitializerForProjectedRow({int_oid_, bigint_oid_, varchar_oid_});
+    storage::RedoRecord *redo = txn->StageWrite(CatalogTestUtil::test_db_oid, table_oid_, initializer.first);
+    storage::ProjectedRow *row = redo->Delta();
+    *reinterpret_cast<int32_t *>(row->AccessForceNotNull(initializer.second[int_oid_])) = key;
+    if (key % 3 == 0) {
+      row->SetNull(initializer.second[bigint_oid_]);
+      row->SetNull(initializer.second[varchar_oid_]);
+    } else {
+      *reinterpret_cast<int64_t *>(row->AccessForceNotNull(initializer.second[bigint_oid_])) = key * 10;
+      const std::string value = key % 2 == 0 ? std::to_string(key) : "a long value for key " + std::to_string(key);
+      byte *dest = row->AccessForceNotNull(initializer.second[varchar_oid_]);
+      if (value.size() <= storage::VarlenEntry::InlineThreshold()) {
+        *reinterpret_cast<storage::VarlenEntry *>(dest) = storage::VarlenEntry::CreateInline(
+            reinterpret_cast<const byte *>(value.data()), static_cast<uint32_t>(value.size()));
+      } else {
+        byte *content = common::AllocationUtil::AllocateAligned(static_cast<uint32_t>(value.size()));
+        std::memcpy(content, value.data(), value.size());
+        *reinterpret_cast<storage::VarlenEntry *>(dest) =
+            storage::VarlenEntry::Create(content, static_cast<uint32_t>(value.size()), true);
+      }
+    }
+    table->Insert(txn, redo);
+    return redo->GetTupleSlot();
+  }
+
+  // Checks that the tuples in the two slots are visible to the txn and equal
+  void ExpectEqualTuples(transaction::TransactionContext *txn, storage::SqlTable *expected_table,
+                         storage::TupleSlot expected_slot, storage::SqlTable *actual_table,
+                         storage::TupleSlot actual_slot) {
+    auto initializer = expected_table->InitializerForProjectedRow({int_oid_, bigint_oid_, varchar_oid_});
+    byte *expected_buffer = common::AllocationUtil::AllocateAligned(initializer.first.ProjectedRowSize());
+    byte *actual_buffer = common::AllocationUtil::AllocateAligned(initializer.first.ProjectedRowSize());
+    storage::ProjectedRow *expected = initializer.first.InitializeRow(expected_buffer);
+    storage::ProjectedRow *actual = initializer.first.InitializeRow(actual_buffer);
+    EXPECT_TRUE(expected_table->Select(txn, expected_slot, expected));
+    EXPECT_TRUE(actual_table->Select(txn, actual_slot, actual));
+    for (const catalog::col_oid_t oid : {int_oid_, bigint_oid_}) {
+      const uint16_t offset = initializer.second[oid];
+      const uint8_t size = schema_.GetColumn(oid).GetAttrSize();
+      ASSERT_EQ(expected->IsNull(offset), actual->IsNull(offset));
+      if (!expected->IsNull(offset)) {
+        EXPECT_EQ(0, std::memcmp(expected->AccessWithNullCheck(offset), actual->AccessWithNullCheck(offset), size));
+      }
+    }
+    const uint16_t offset = initializer.second[varchar_oid_];
+    ASSERT_EQ(expected->IsNull(offset), actual->IsNull(offset));
+    if (!expected->IsNull(offset)) {
+      EXPECT_TRUE(storage::VarlenContentDeepEqual()(
+          *reinterpret_cast<storage::VarlenEntry *>(expected->AccessWithNullCheck(offset)),
+          *reinterpret_cast<storage::VarlenEntry *>(actual->AccessWithNullCheck(offset))));
+    }
+    delete[] expected_buffer;
+    delete[] actual_buffer;
+  }
+
+  void RunGC() {
+    gc_.PerformGarbageCollection();
+    gc_.PerformGarbageCollection();
+  }
+};
+
+// Takes a checkpoint of a table while a concurrent transaction is writing to it, and checks that loading the checkpoint
+// recreates exactly the tuples that were committed before the checkpoint started
+// NOLINTNEXTLINE
+TEST_F(CheckpointTests, CheckpointAndRecover) {
+  const int32_t num_tuples = 1000;
+  storage::SqlTable table(&block_store_, schema_, table_oid_);
+  storage::CheckpointManager checkpoint_manager(CHECKPOINT_DIR, &txn_manager_, 100);
+  EXPECT_FALSE(checkpoint_manager.HasCheckpoint());
+
+  std::vector<storage::TupleSlot> slots;
+  auto *txn = txn_manager_.BeginTransaction();
+  for (int32_t key = 0; key < num_tuples; key++) slots.push_back(InsertTuple(txn, &table, key));
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Neither an uncommitted insert, nor a delete that commits while the checkpoint is being written, are visible to it
+  auto *writer = txn_manager_.BeginTransaction();
+  const storage::TupleSlot uncommitted = InsertTuple(writer, &table, num_tuples);
+  const std::vector<std::pair<storage::SqlTable *, const catalog::Schema *>> tables = {{&table, &schema_}};
+  const transaction::timestamp_t checkpoint_time = checkpoint_manager.Checkpoint(tables);
+  EXPECT_TRUE(table.Delete(writer, slots[0]));
+  txn_manager_.Commit(writer, transaction::TransactionUtil::EmptyCallback, nullptr);
+  EXPECT_TRUE(checkpoint_manager.HasCheckpoint());
+
+  storage::SqlTable recovered(&block_store_, schema_, table_oid_);
+  std::unordered_map<storage::TupleSlot, storage::TupleSlot> slot_map;
+  EXPECT_EQ(checkpoint_time, checkpoint_manager.Recover(CatalogTestUtil::test_db_oid, {{&recovered, &schema_}},
+                                                        &slot_map));
+  EXPECT_EQ(num_tuples, slot_map.size());
+  EXPECT_EQ(0, slot_map.count(uncommitted));
+
+  // The tuple deleted after the checkpoint started is still in it, and every other tuple matches the original
+  txn = txn_manager_.BeginTransaction();
+  auto initializer = table.InitializerForProjectedRow({int_oid_});
+  byte *buffer = common::AllocationUtil::AllocateAligned(initializer.first.ProjectedRowSize());
+  storage::ProjectedRow *row = initializer.first.InitializeRow(buffer);
+  EXPECT_TRUE(recovered.Select(txn, slot_map.at(slots[0]), row));
+  EXPECT_EQ(0, *reinterpret_cast<int32_t *>(row->AccessWithNullCheck(0)));
+  delete[] buffer;
+  for (int32_t key = 1; key < num_tuples; key++)
+    ExpectEqualTuples(txn, &table, slots[key], &recovered, slot_map.at(slots[key]));
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // A newer checkpoint replaces the previous one, and includes the changes since
+  const transaction::timestamp_t second_checkpoint_time = checkpoint_manager.Checkpoint(tables);
+  EXPECT_LT(checkpoint_time, second_checkpoint_time);
+  storage::SqlTable second_recovered(&block_store_, schema_, table_oid_);
+  slot_map.clear();
+  EXPECT_EQ(second_checkpoint_time, checkpoint_manager.Recover(CatalogTestUtil::test_db_oid,
+                                                               {{&second_recovered, &schema_}}, &slot_map));
+  EXPECT_EQ(num_tuples, slot_map.size());
+  EXPECT_EQ(0, slot_map.count(slots[0]));
+  EXPECT_EQ(1, slot_map.count(uncommitted));
+
+  RunGC();
+}
+
+// Checks that recovery rejects a checkpoint that does not match the tables given
+// NOLINTNEXTLINE
+TEST_F(CheckpointTests, RecoverMismatch) {
+  storage::SqlTable table(&block_store_, schema_, table_oid_);
+  storage::CheckpointManager checkpoint_manager(CHECKPOINT_DIR, &txn_manager_);
+  EXPECT_THROW(checkpoint_manager.Recover(CatalogTestUtil::test_db_oid, {{&table, &schema_}}, nullptr),
+               std::runtime_error);
+
+  auto *txn = txn_manager_.BeginTransaction();
+  InsertTuple(txn, &table, 1);
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  checkpoint_manager.Checkpoint({{&table, &schema_}});
+
+  // Missing table
+  storage::SqlTable other_table(&block_store_, schema_, catalog::table_oid_t(2));
+  EXPECT_THROW(checkpoint_manager.Recover(CatalogTestUtil::test_db_oid, {{&other_table, &schema_}}, nullptr),
+               std::runtime_error);
+
+  // Different columns
+  const catalog::Schema other_schema({{"int", type::TypeId::INTEGER, false, int_oid_},
+                                      {"bigint", type::TypeId::INTEGER, true, bigint_oid_},
+                                      {"varchar", type::TypeId::VARCHAR, 100, true, varchar_oid_}});
+  storage::SqlTable recovered(&block_store_, other_schema, table_oid_);
+  EXPECT_THROW(checkpoint_manager.Recover(CatalogTestUtil::test_db_oid, {{&recovered, &other_schema}}, nullptr),
+               std::runtime_error);
+
+  RunGC();
+}
+}  // namespace terrier
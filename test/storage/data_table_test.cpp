@@ -1,6 +1,8 @@
 #include "storage/data_table.h"
+#include <cmath>
 #include <cstring>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "common/object_pool.h"
@@ -142,6 +144,14 @@ class RandomDataTableTestObject {
     table_.Scan(txn, begin, buffer);
   }
 
+  void SampleScan(storage::DataTable::SampleIterator *sample, const transaction::timestamp_t timestamp,
+                  storage::ProjectedColumns *buffer, storage::RecordBufferSegmentPool *buffer_pool) {
+    auto *txn = new transaction::TransactionContext(timestamp, timestamp, buffer_pool, LOGGING_DISABLED,
+                                                    ACTION_FRAMEWORK_DISABLED);
+    loose_txns_.push_back(txn);
+    table_.SampleScan(txn, sample, buffer);
+  }
+
   storage::DataTable &GetTable() { return table_; }
 
  private:
@@ -232,6 +242,65 @@ TEST_F(DataTableTests, SimpleSequentialScan) {
   }
 }
 
+// Insert tuples spanning multiple blocks and draw random samples from them, checking that the samples are of the
+// expected size and shape, contain the correct tuples, and are reproducible given the same seed.
+// NOLINTNEXTLINE
+TEST_F(DataTableTests, SamplingScan) {
+  const uint32_t num_iterations = 5;
+  const uint16_t max_columns = 10;
+  for (uint32_t iteration = 0; iteration < num_iterations; ++iteration) {
+    RandomDataTableTestObject tested(&block_store_, max_columns, null_ratio_(generator_), &generator_);
+    const uint32_t num_slots = tested.Layout().NumSlots();
+    const uint32_t num_inserts = 2 * num_slots + num_slots / 2;
+    auto *txn = new transaction::TransactionContext(transaction::timestamp_t(0), transaction::timestamp_t(0),
+                                                    &buffer_pool_, LOGGING_DISABLED, ACTION_FRAMEWORK_DISABLED);
+    for (uint32_t i = 0; i < num_inserts; i++) tested.InsertRandomTuple(txn, &generator_, &buffer_pool_);
+
+    storage::ProjectedColumnsInitializer initializer(
+        tested.Layout(), StorageTestUtil::ProjectionListAllColumns(tested.Layout()), num_inserts);
+    auto *buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedColumnsSize());
+    storage::ProjectedColumns *columns = initializer.Initialize(buffer);
+    auto sample_slots = [&](storage::SamplingMethod method, double rate, uint64_t seed) {
+      auto sample = tested.GetTable().BeginSample(method, rate, seed);
+      tested.SampleScan(&sample, transaction::timestamp_t(1), columns, &buffer_pool_);
+      // The scan only stops early if the buffer is full
+      EXPECT_TRUE(sample.Done() || columns->NumTuples() == num_inserts);
+      std::vector<storage::TupleSlot> result(columns->TupleSlots(), columns->TupleSlots() + columns->NumTuples());
+      for (uint32_t i = 0; i < columns->NumTuples(); i++) {
+        storage::ProjectedColumns::RowView stored = columns->InterpretAsRow(i);
+        const storage::ProjectedRow *ref =
+            tested.GetReferenceVersionedTuple(columns->TupleSlots()[i], transaction::timestamp_t(1));
+        EXPECT_TRUE(StorageTestUtil::ProjectionListEqualShallow(tested.Layout(), &stored, ref));
+      }
+      return result;
+    };
+
+    for (auto method : {storage::SamplingMethod::BERNOULLI, storage::SamplingMethod::SYSTEM}) {
+      EXPECT_EQ(num_inserts, sample_slots(method, 1.0, iteration).size());
+      EXPECT_TRUE(sample_slots(method, 0.0, iteration).empty());
+    }
+
+    // A Bernoulli sample should be close to the expected size, with no slot sampled twice
+    const double rate = 0.1;
+    std::vector<storage::TupleSlot> sample = sample_slots(storage::SamplingMethod::BERNOULLI, rate, iteration);
+    const double expected = rate * num_inserts, stddev = std::sqrt(expected * (1 - rate));
+    EXPECT_NEAR(expected, static_cast<double>(sample.size()), 5 * stddev + 1);
+    std::unordered_set<storage::TupleSlot> distinct(sample.begin(), sample.end());
+    EXPECT_EQ(sample.size(), distinct.size());
+    EXPECT_EQ(sample, sample_slots(storage::SamplingMethod::BERNOULLI, rate, iteration));
+
+    // A system sample contains either all or none of the tuples of a block
+    sample = sample_slots(storage::SamplingMethod::SYSTEM, 0.5, iteration);
+    std::unordered_map<storage::RawBlock *, uint32_t> tuples_per_block;
+    for (const storage::TupleSlot slot : sample) tuples_per_block[slot.GetBlock()]++;
+    for (const auto &entry : tuples_per_block) EXPECT_EQ(entry.first->insert_head_.load(), entry.second);
+    EXPECT_EQ(sample, sample_slots(storage::SamplingMethod::SYSTEM, 0.5, iteration));
+
+    delete[] buffer;
+    delete txn;
+  }
+}
+
 // Generates a random table layout and coin flip bias for an attribute being null, inserts 1 random tuple into an empty
 // DataTable. Then, randomly updates the tuple num_updates times. Finally, Selects at each timestamp to verify that the
 // delta chain produces the correct tuple. Repeats for num_iterations.
@@ -319,4 +388,58 @@ TEST_F(DataTableTests, InsertNoWrap) {
     delete txn;
   }
 }
+
+// Inserts a tuple with a very large varlen value and then updates a fixed-length column of it. The varlen value should
+// only ever be referenced, never copied: the undo record carries no trace of the large value, and both old and new
+// versions of the tuple point to the same out-of-line buffer.
+// NOLINTNEXTLINE
+TEST_F(DataTableTests, LargeVarlenNotCopiedOnUpdate) {
+  const uint32_t varlen_size = 1 << 16;
+  const storage::BlockLayout layout({8, VARLEN_COLUMN, 8});
+  const storage::col_id_t varlen_col(1), fixed_col(2);
+  storage::DataTable table(&block_store_, layout, storage::layout_version_t(0));
+
+  // Insert a tuple with a large varlen value
+  auto insert_initializer = storage::ProjectedRowInitializer::Create(layout, {varlen_col, fixed_col});
+  byte *insert_buffer = common::AllocationUtil::AllocateAligned(insert_initializer.ProjectedRowSize());
+  storage::ProjectedRow *insert = insert_initializer.InitializeRow(insert_buffer);
+  // The test keeps ownership of the value, as no GC runs to reclaim it
+  byte *content = common::AllocationUtil::AllocateAligned(varlen_size);
+  StorageTestUtil::FillWithRandomBytes(varlen_size, content, &generator_);
+  const uint16_t varlen_offset = insert->ColumnIds()[0] == varlen_col ? 0 : 1;
+  *reinterpret_cast<storage::VarlenEntry *>(insert->AccessForceNotNull(varlen_offset)) =
+      storage::VarlenEntry::Create(content, varlen_size, false);
+  *reinterpret_cast<uint64_t *>(insert->AccessForceNotNull(static_cast<uint16_t>(1 - varlen_offset))) = 1;
+  auto *insert_txn = new transaction::TransactionContext(transaction::timestamp_t(0), transaction::timestamp_t(0),
+                                                         &buffer_pool_, LOGGING_DISABLED, ACTION_FRAMEWORK_DISABLED);
+  const storage::TupleSlot slot = table.Insert(insert_txn, *insert);
+
+  // Update only the fixed-length column
+  auto update_initializer = storage::ProjectedRowInitializer::Create(layout, {fixed_col});
+  byte *update_buffer = common::AllocationUtil::AllocateAligned(update_initializer.ProjectedRowSize());
+  storage::ProjectedRow *update = update_initializer.InitializeRow(update_buffer);
+  *reinterpret_cast<uint64_t *>(update->AccessForceNotNull(0)) = 2;
+  auto *update_txn = new transaction::TransactionContext(transaction::timestamp_t(1), transaction::timestamp_t(1),
+                                                         &buffer_pool_, LOGGING_DISABLED, ACTION_FRAMEWORK_DISABLED);
+  EXPECT_TRUE(table.Update(update_txn, slot, *update));
+  // The before-image recorded for the update only covers the updated column
+  EXPECT_LT(storage::UndoRecord::Size(*update), storage::UndoRecord::Size(*insert));
+  EXPECT_LT(storage::UndoRecord::Size(*insert), varlen_size);
+
+  // Both versions of the tuple should reference the same out-of-line buffer
+  auto select_initializer = storage::ProjectedRowInitializer::Create(layout, {varlen_col});
+  byte *select_buffer = common::AllocationUtil::AllocateAligned(select_initializer.ProjectedRowSize());
+  storage::ProjectedRow *select = select_initializer.InitializeRow(select_buffer);
+  EXPECT_TRUE(table.Select(update_txn, slot, select));
+  EXPECT_EQ(content, reinterpret_cast<storage::VarlenEntry *>(select->AccessWithNullCheck(0))->Content());
+  EXPECT_TRUE(table.Select(insert_txn, slot, select));
+  EXPECT_EQ(content, reinterpret_cast<storage::VarlenEntry *>(select->AccessWithNullCheck(0))->Content());
+
+  delete[] select_buffer;
+  delete[] update_buffer;
+  delete[] insert_buffer;
+  delete[] content;
+  delete update_txn;
+  delete insert_txn;
+}
 }  // namespace terrier
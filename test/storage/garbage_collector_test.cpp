@@ -1,4 +1,5 @@
 #include "storage/garbage_collector.h"
+#include <atomic>
 #include <cstring>
 #include <unordered_map>
 #include <utility>
@@ -60,6 +61,16 @@ class GarbageCollectorDataTableTestObject {
     return version;
   }
 
+  // Returns the number of undo records reachable from the tuple's version chain
+  uint32_t VersionChainLength(const storage::TupleSlot slot) const {
+    const storage::TupleAccessStrategy accessor(layout_);
+    auto *const version_ptr = reinterpret_cast<std::atomic<storage::UndoRecord *> *>(
+        accessor.AccessWithoutNullCheck(slot, VERSION_POINTER_COLUMN_ID));
+    uint32_t length = 0;
+    for (storage::UndoRecord *record = version_ptr->load(); record != nullptr; record = record->Next()) length++;
+    return length;
+  }
+
   storage::ProjectedRow *SelectIntoBuffer(transaction::TransactionContext *const txn, const storage::TupleSlot slot) {
     // generate a redo ProjectedRow for Select
     storage::ProjectedRow *select_row = initializer_.InitializeRow(select_buffer_);
@@ -671,4 +682,119 @@ TEST_F(GarbageCollectorTests, InsertUpdate1) {
     EXPECT_EQ(std::make_pair(2u, 0u), gc.PerformGarbageCollection());
   }
 }
+
+// Run txns that update and delete many tuples, and split their unlinking and deallocation across several GC threads.
+// Confirm that the GC still takes 2 cycles, and that every tuple reads its newest version afterwards.
+// NOLINTNEXTLINE
+TEST_F(GarbageCollectorTests, MultiThreadedGC) {
+  const uint32_t num_gc_threads = 4, num_tuples = 100;
+  for (uint32_t iteration = 0; iteration < num_iterations_; ++iteration) {
+    transaction::TransactionManager txn_manager(&buffer_pool_, true, LOGGING_DISABLED);
+    GarbageCollectorDataTableTestObject tested(&block_store_, max_columns_, &generator_);
+    storage::GarbageCollector gc(&txn_manager, num_gc_threads);
+
+    auto *insert_tuple = tested.GenerateRandomTuple(&generator_);
+    std::vector<storage::TupleSlot> slots;
+    auto *txn = txn_manager.BeginTransaction();
+    for (uint32_t i = 0; i < num_tuples; i++) slots.push_back(tested.table_.Insert(txn, *insert_tuple));
+    txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+    // Unlink and reclaim the Inserts
+    EXPECT_EQ(std::make_pair(0u, 1u), gc.PerformGarbageCollection());
+    EXPECT_EQ(std::make_pair(1u, 0u), gc.PerformGarbageCollection());
+
+    // Two txns update every tuple, and a third deletes every other tuple
+    storage::ProjectedRow *update = tested.GenerateRandomUpdate(&generator_);
+    auto *update_tuple = tested.GenerateVersionFromUpdate(*update, *insert_tuple);
+    for (uint32_t i = 0; i < 2; i++) {
+      txn = txn_manager.BeginTransaction();
+      for (const storage::TupleSlot slot : slots) EXPECT_TRUE(tested.table_.Update(txn, slot, *update));
+      txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    }
+    txn = txn_manager.BeginTransaction();
+    for (uint32_t i = 0; i < num_tuples; i += 2) EXPECT_TRUE(tested.table_.Delete(txn, slots[i]));
+    txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+    // Unlink the three txns, then deallocate them
+    EXPECT_EQ(std::make_pair(0u, 3u), gc.PerformGarbageCollection());
+    EXPECT_EQ(std::make_pair(3u, 0u), gc.PerformGarbageCollection());
+
+    txn = txn_manager.BeginTransaction();
+    for (uint32_t i = 0; i < num_tuples; i++) {
+      storage::ProjectedRow *select_tuple = tested.SelectIntoBuffer(txn, slots[i]);
+      EXPECT_EQ(i % 2 == 1, tested.select_result_);
+      if (i % 2 == 1) {
+        EXPECT_TRUE(StorageTestUtil::ProjectionListEqualShallow(tested.Layout(), select_tuple, update_tuple));
+      }
+    }
+    txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+    // Unlink the read-only transaction
+    EXPECT_EQ(std::make_pair(0u, 1u), gc.PerformGarbageCollection());
+    EXPECT_EQ(std::make_pair(0u, 0u), gc.PerformGarbageCollection());
+  }
+}
+
+// Writers truncate the version chains of the tuples they update once they are older than the oldest running txn the
+// TransactionManager last computed, while readers only traverse them and an older reader keeps its snapshot. The GC
+// still unlinks and deallocates every txn as usual.
+// NOLINTNEXTLINE
+TEST_F(GarbageCollectorTests, CooperativePruning) {
+  const uint32_t num_updates = 5;
+  for (uint32_t iteration = 0; iteration < num_iterations_; ++iteration) {
+    transaction::TransactionManager txn_manager(&buffer_pool_, true, LOGGING_DISABLED);
+    GarbageCollectorDataTableTestObject tested(&block_store_, max_columns_, &generator_);
+    storage::GarbageCollector gc(&txn_manager);
+
+    auto *insert_tuple = tested.GenerateRandomTuple(&generator_);
+    auto *txn = txn_manager.BeginTransaction();
+    storage::TupleSlot slot = tested.table_.Insert(txn, *insert_tuple);
+    txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+    // Unlink and reclaim the Insert
+    EXPECT_EQ(std::make_pair(0u, 1u), gc.PerformGarbageCollection());
+    EXPECT_EQ(std::make_pair(1u, 0u), gc.PerformGarbageCollection());
+    EXPECT_EQ(0, tested.VersionChainLength(slot));
+
+    auto *old_reader = txn_manager.BeginTransaction();
+    storage::ProjectedRow *update = tested.GenerateRandomUpdate(&generator_);
+    auto *update_tuple = tested.GenerateVersionFromUpdate(*update, *insert_tuple);
+    for (uint32_t i = 0; i < num_updates; i++) {
+      txn = txn_manager.BeginTransaction();
+      EXPECT_TRUE(tested.table_.Update(txn, slot, *update));
+      txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    }
+    EXPECT_EQ(num_updates, tested.VersionChainLength(slot));
+
+    // Readers leave the chain alone, and the old reader still needs all of it
+    txn_manager.OldestTransactionStartTime();
+    auto *reader = txn_manager.BeginTransaction();
+    storage::ProjectedRow *select_tuple = tested.SelectIntoBuffer(reader, slot);
+    EXPECT_TRUE(tested.select_result_);
+    EXPECT_TRUE(StorageTestUtil::ProjectionListEqualShallow(tested.Layout(), select_tuple, update_tuple));
+    select_tuple = tested.SelectIntoBuffer(old_reader, slot);
+    EXPECT_TRUE(tested.select_result_);
+    EXPECT_TRUE(StorageTestUtil::ProjectionListEqualShallow(tested.Layout(), select_tuple, insert_tuple));
+    txn_manager.Commit(old_reader, transaction::TransactionUtil::EmptyCallback, nullptr);
+    txn_manager.OldestTransactionStartTime();
+    select_tuple = tested.SelectIntoBuffer(reader, slot);
+    EXPECT_TRUE(tested.select_result_);
+    EXPECT_EQ(num_updates, tested.VersionChainLength(slot));
+
+    // A writer truncates everything below its own undo record that the reader cannot see anymore
+    txn = txn_manager.BeginTransaction();
+    EXPECT_TRUE(tested.table_.Update(txn, slot, *update));
+    EXPECT_EQ(1, tested.VersionChainLength(slot));
+    txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    select_tuple = tested.SelectIntoBuffer(reader, slot);
+    EXPECT_TRUE(tested.select_result_);
+    EXPECT_TRUE(StorageTestUtil::ProjectionListEqualShallow(tested.Layout(), select_tuple, update_tuple));
+    txn_manager.Commit(reader, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+    // Unlink the update and read-only txns, then deallocate the update txns
+    EXPECT_EQ(std::make_pair(0u, num_updates + 3), gc.PerformGarbageCollection());
+    EXPECT_EQ(std::make_pair(num_updates + 1, 0u), gc.PerformGarbageCollection());
+    EXPECT_EQ(0, tested.VersionChainLength(slot));
+  }
+}
 }  // namespace terrier
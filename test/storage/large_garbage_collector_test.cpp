@@ -269,4 +269,69 @@ TEST_F(LargeGCTests, TPCCishHighThreadWithGC) {
     }
   }
 }
+
+// This test duplicates MixedReadWriteWithGC with the unlinking and deallocation split across several GC threads
+// NOLINTNEXTLINE
+TEST_F(LargeGCTests, MixedReadWriteWithMultiThreadedGC) {
+  const uint32_t txn_length = 10;
+  const std::vector<double> update_select_ratio = {0.5, 0.5};
+  const uint32_t num_concurrent_txns = MultiThreadTestUtil::HardwareConcurrency();
+  const uint32_t num_gc_threads = 4;
+  for (uint32_t iteration = 0; iteration < num_iterations; iteration++) {
+    LargeTransactionTestObject tested = LargeTransactionTestObject::Builder()
+                                            .SetMaxColumns(max_columns)
+                                            .SetInitialTableSize(initial_table_size)
+                                            .SetTxnLength(txn_length)
+                                            .SetUpdateSelectRatio(update_select_ratio)
+                                            .SetBlockStore(&block_store_)
+                                            .SetBufferPool(&buffer_pool_)
+                                            .SetGenerator(&generator_)
+                                            .SetGcOn(true)
+                                            .SetBookkeeping(true)
+                                            .SetVarlenAllowed(true)
+                                            .build();
+    storage::GarbageCollectorThread gc_thread(tested.GetTxnManager(), gc_period, num_gc_threads);
+    for (uint32_t batch = 0; batch * batch_size < num_txns; batch++) {
+      auto result = tested.SimulateOltp(batch_size, num_concurrent_txns);
+      gc_thread.PauseGC();
+      tested.CheckReadsCorrect(&result.first);
+      for (auto w : result.first) delete w;
+      for (auto w : result.second) delete w;
+      gc_thread.ResumeGC();
+    }
+  }
+}
+
+// This test duplicates HighAbortRateHighThreadWithGC with 4 GC threads, so that they unlink and deallocate while many
+// writers contend on the same tuples
+// NOLINTNEXTLINE
+TEST_F(LargeGCTests, HighAbortRateHighThreadWithMultiThreadedGC) {
+  const uint32_t txn_length = 40;
+  const std::vector<double> update_select_ratio = {0.8, 0.2};
+  const uint32_t num_concurrent_txns = 2 * MultiThreadTestUtil::HardwareConcurrency();
+  const uint32_t num_gc_threads = 4;
+  for (uint32_t iteration = 0; iteration < num_iterations; iteration++) {
+    LargeTransactionTestObject tested = LargeTransactionTestObject::Builder()
+                                            .SetMaxColumns(max_columns)
+                                            .SetInitialTableSize(initial_table_size)
+                                            .SetTxnLength(txn_length)
+                                            .SetUpdateSelectRatio(update_select_ratio)
+                                            .SetBlockStore(&block_store_)
+                                            .SetBufferPool(&buffer_pool_)
+                                            .SetGenerator(&generator_)
+                                            .SetGcOn(true)
+                                            .SetBookkeeping(true)
+                                            .SetVarlenAllowed(true)
+                                            .build();
+    storage::GarbageCollectorThread gc_thread(tested.GetTxnManager(), gc_period, num_gc_threads);
+    for (uint32_t batch = 0; batch * batch_size < num_txns; batch++) {
+      auto result = tested.SimulateOltp(batch_size, num_concurrent_txns);
+      gc_thread.PauseGC();
+      tested.CheckReadsCorrect(&result.first);
+      for (auto w : result.first) delete w;
+      for (auto w : result.second) delete w;
+      gc_thread.ResumeGC();
+    }
+  }
+}
 }  // namespace terrier
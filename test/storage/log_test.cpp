@@ -1,11 +1,22 @@
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "storage/data_table.h"
+#include "storage/garbage_collector.h"
 #include "storage/garbage_collector_thread.h"
 #include "storage/write_ahead_log/log_manager.h"
+#include "storage/write_ahead_log/log_reader.h"
 #include "transaction/transaction_manager.h"
 #include "util/catalog_test_util.h"
+#include "util/multithread_test_util.h"
 #include "util/storage_test_util.h"
 #include "util/test_harness.h"
 #include "util/transaction_test_util.h"
@@ -27,30 +38,8 @@ class WriteAheadLoggingTests : public TerrierTest {
   }
 
   storage::LogRecord *ReadNextRecord(storage::BufferedLogReader *in) {
-    auto size = in->ReadValue<uint32_t>();
-    byte *buf = common::AllocationUtil::AllocateAligned(size);
-    auto record_type = in->ReadValue<storage::LogRecordType>();
-    auto txn_begin = in->ReadValue<transaction::timestamp_t>();
-    if (record_type == storage::LogRecordType::COMMIT) {
-      auto txn_commit = in->ReadValue<transaction::timestamp_t>();
-      // Okay to fill in null since nobody will invoke the callback.
-      // is_read_only argument is set to false, because we do not write out a commit record for a transaction if it is
-      // not read-only.
-      return storage::CommitRecord::Initialize(buf, txn_begin, txn_commit, nullptr, nullptr, false, nullptr);
-    }
-    // TODO(Tianyu): Without a lookup mechanism this oid is not exactly meaningful. Implement lookup when possible
-    auto table_oid UNUSED_ATTRIBUTE = in->ReadValue<catalog::table_oid_t>();
-    auto tuple_slot = in->ReadValue<storage::TupleSlot>();
-    auto result = storage::RedoRecord::PartialInitialize(buf, size, txn_begin,
-                                                         // TODO(Tianyu): Hacky as hell
-                                                         CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid,
-                                                         tuple_slot);
-    // TODO(Tianyu): For now, without inlined attributes, the delta portion is a straight memory copy. This
-    // will obviously change in the future. Also, this is hacky as hell
-    auto delta_size = in->ReadValue<uint32_t>();
-    byte *dest =
-        reinterpret_cast<byte *>(result->GetUnderlyingRecordBodyAs<storage::RedoRecord>()->Delta()) + sizeof(uint32_t);
-    in->Read(dest, delta_size - static_cast<uint32_t>(sizeof(uint32_t)));
+    storage::LogRecord *result = storage::LogReader::ReadRecord(in);
+    EXPECT_NE(nullptr, result);
     return result;
   }
 
@@ -102,9 +91,7 @@ TEST_F(WriteAheadLoggingTests, LargeLogTest) {
   storage::BufferedLogReader in(LOG_FILE_NAME);
   while (in.HasMore()) {
     storage::LogRecord *log_record = ReadNextRecord(&in);
-    if (log_record->TxnBegin() == transaction::timestamp_t(0)) {
-      // TODO(Tianyu): This is hacky, but it will be a pain to extract the initial transaction. The LargeTranasctionTest
-      // harness probably needs some refactor (later after wal is in)
+    if (log_record->TxnBegin() == tested.InitialTxnBegin()) {
       // This the initial setup transaction
       delete[] reinterpret_cast<byte *>(log_record);
       continue;
@@ -180,9 +167,8 @@ TEST_F(WriteAheadLoggingTests, ReadOnlyTransactionsGenerateNoLogTest) {
   storage::BufferedLogReader in(LOG_FILE_NAME);
   while (in.HasMore()) {
     storage::LogRecord *log_record = ReadNextRecord(&in);
-    if (log_record->TxnBegin() == transaction::timestamp_t(0)) {
-      // (TODO) Currently following pattern from LargeLogTest of skipping the initial transaction. When the transaction
-      // testing framework changes, fix this.
+    if (log_record->TxnBegin() == tested.InitialTxnBegin()) {
+      // Following pattern from LargeLogTest of skipping the initial transaction
       delete[] reinterpret_cast<byte *>(log_record);
       continue;
     }
@@ -196,4 +182,842 @@ TEST_F(WriteAheadLoggingTests, ReadOnlyTransactionsGenerateNoLogTest) {
   for (auto *txn : result.first) delete txn;
   for (auto *txn : result.second) delete txn;
 }
+
+// This test starts the LogManager's own threads, commits transactions with a callback, and checks that every commit is
+// eventually made persistent and has its callback invoked, without anyone driving the LogManager manually.
+// NOLINTNEXTLINE
+TEST_F(WriteAheadLoggingTests, GroupCommitTest) {
+  const uint32_t num_txns = 1000;
+  storage::BlockLayout layout({8, 8});
+  storage::DataTable table(&block_store_, layout, storage::layout_version_t(0));
+  transaction::TransactionManager txn_manager(&pool_, true, &log_manager_);
+  storage::GarbageCollector gc(&txn_manager);
+  const storage::ProjectedRowInitializer initializer =
+      storage::ProjectedRowInitializer::Create(layout, StorageTestUtil::ProjectionListAllColumns(layout));
+
+  log_manager_.Start();
+  std::atomic<uint32_t> persisted = 0;
+  for (uint32_t i = 0; i < num_txns; i++) {
+    auto *txn = txn_manager.BeginTransaction();
+    storage::RedoRecord *redo =
+        txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+    StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.0, &generator_);
+    redo->SetTupleSlot(table.Insert(txn, *redo->Delta()));
+    txn_manager.Commit(txn, [](void *arg) { (*reinterpret_cast<std::atomic<uint32_t> *>(arg))++; }, &persisted);
+  }
+  // The flusher thread persists the commits on its own, well within the time limit
+  for (uint32_t i = 0; i < 1000 && persisted.load() < num_txns; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(num_txns, persisted.load());
+  log_manager_.Shutdown();
+  gc.PerformGarbageCollection();
+  gc.PerformGarbageCollection();
+
+  // Every transaction wrote out a redo and a commit record
+  uint32_t num_redos = 0, num_commits = 0;
+  storage::BufferedLogReader in(LOG_FILE_NAME);
+  while (in.HasMore()) {
+    storage::LogRecord *log_record = ReadNextRecord(&in);
+    if (log_record->RecordType() == storage::LogRecordType::COMMIT)
+      num_commits++;
+    else
+      num_redos++;
+    delete[] reinterpret_cast<byte *>(log_record);
+  }
+  EXPECT_EQ(num_txns, num_redos);
+  EXPECT_EQ(num_txns, num_commits);
+  unlink(LOG_FILE_NAME);
+}
+// This test commits transactions from several threads into a LogManager with multiple streams, and checks that every
+// commit is acknowledged only once the watermark passes it, and that the streams read back in commit order contain
+// every committed transaction exactly once.
+// NOLINTNEXTLINE
+TEST_F(WriteAheadLoggingTests, MultiStreamTest) {
+  const uint32_t num_streams = 4, num_threads = 8, txns_per_thread = 100;
+  storage::BlockLayout layout({8, 8});
+  storage::DataTable table(&block_store_, layout, storage::layout_version_t(0));
+  storage::LogManagerOptions options;
+  options.num_streams_ = num_streams;
+  // Small write batches make the serializers write out records while still draining their queues
+  options.write_batch_size_ = 1 << 12;
+  storage::LogManager log_manager(LOG_FILE_NAME, &pool_, options);
+  transaction::TransactionManager txn_manager(&pool_, true, &log_manager);
+  storage::GarbageCollector gc(&txn_manager);
+  const storage::ProjectedRowInitializer initializer =
+      storage::ProjectedRowInitializer::Create(layout, StorageTestUtil::ProjectionListAllColumns(layout));
+
+  // Each callback remembers the watermark at the time it was invoked, which has to be past its commit
+  struct CommitArg {
+    storage::LogManager *log_manager_;
+    std::atomic<uint32_t> *persisted_;
+    transaction::timestamp_t watermark_;
+  };
+  std::vector<CommitArg> args(num_threads * txns_per_thread);
+  std::vector<transaction::timestamp_t> commit_times(num_threads * txns_per_thread);
+  std::atomic<uint32_t> persisted = 0;
+  log_manager.Start();
+  auto workload = [&](uint32_t thread_id) {
+    std::default_random_engine generator(thread_id);
+    for (uint32_t i = 0; i < txns_per_thread; i++) {
+      auto *txn = txn_manager.BeginTransaction();
+      storage::RedoRecord *redo =
+          txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+      StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.0, &generator);
+      redo->SetTupleSlot(table.Insert(txn, *redo->Delta()));
+      const uint32_t id = thread_id * txns_per_thread + i;
+      args[id] = {&log_manager, &persisted, transaction::timestamp_t(0)};
+      commit_times[id] = txn_manager.Commit(txn,
+                                            [](void *arg) {
+                                              auto *commit = reinterpret_cast<CommitArg *>(arg);
+                                              commit->watermark_ = commit->log_manager_->PersistedWatermark();
+                                              (*commit->persisted_)++;
+                                            },
+                                            &args[id]);
+    }
+  };
+  common::WorkerPool thread_pool(num_threads, {});
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads, workload);
+  log_manager.Shutdown();
+  EXPECT_EQ(num_threads * txns_per_thread, persisted.load());
+  for (uint32_t i = 0; i < num_threads * txns_per_thread; i++) EXPECT_LT(commit_times[i], args[i].watermark_);
+  gc.PerformGarbageCollection();
+  gc.PerformGarbageCollection();
+
+  // Every transaction comes back exactly once with a redo and a commit record, in commit order
+  std::vector<std::string> paths;
+  for (uint32_t i = 0; i < num_streams; i++)
+    paths.push_back(storage::LogManager::StreamFilePath(LOG_FILE_NAME, i, num_streams));
+  storage::LogReader reader(paths);
+  uint32_t num_txns = 0;
+  transaction::timestamp_t last_commit_time(0);
+  while (reader.HasMore()) {
+    std::vector<storage::LogRecord *> records = reader.NextTransaction();
+    ASSERT_EQ(2, records.size());
+    EXPECT_EQ(storage::LogRecordType::REDO, records[0]->RecordType());
+    ASSERT_EQ(storage::LogRecordType::COMMIT, records[1]->RecordType());
+    const transaction::timestamp_t commit_time =
+        records[1]->GetUnderlyingRecordBodyAs<storage::CommitRecord>()->CommitTime();
+    // Transactions that committed in the same group share their commit timestamp
+    EXPECT_LE(last_commit_time, commit_time);
+    last_commit_time = commit_time;
+    num_txns++;
+    for (auto *record : records) delete[] reinterpret_cast<byte *>(record);
+  }
+  EXPECT_EQ(num_threads * txns_per_thread, num_txns);
+  EXPECT_EQ(0, reader.NumDiscarded());
+  for (const std::string &path : paths) unlink(path.c_str());
+  log_manager_.Shutdown();
+  unlink(LOG_FILE_NAME);
+}
+
+// This test keeps a transaction and a read-only snapshot open while transactions commit from several threads into a
+// LogManager with two streams, and checks that the commits are still acknowledged, as the watermark does not wait for
+// transactions that are not committing.
+// NOLINTNEXTLINE
+TEST_F(WriteAheadLoggingTests, MultiStreamOpenReaderTest) {
+  const uint32_t num_streams = 2, num_threads = 4, txns_per_thread = 50;
+  storage::BlockLayout layout({8, 8});
+  storage::DataTable table(&block_store_, layout, storage::layout_version_t(0));
+  storage::LogManagerOptions options;
+  options.num_streams_ = num_streams;
+  storage::LogManager log_manager(LOG_FILE_NAME, &pool_, options);
+  transaction::TransactionManager txn_manager(&pool_, true, &log_manager);
+  storage::GarbageCollector gc(&txn_manager);
+  const storage::ProjectedRowInitializer initializer =
+      storage::ProjectedRowInitializer::Create(layout, StorageTestUtil::ProjectionListAllColumns(layout));
+  log_manager.Start();
+
+  auto *reader = txn_manager.BeginTransaction();
+  auto *snapshot = txn_manager.BeginReadOnlyTransaction();
+  std::atomic<uint32_t> acknowledged = 0;
+  std::vector<transaction::timestamp_t> last_commits(num_threads);
+  auto workload = [&](uint32_t thread_id) {
+    std::default_random_engine generator(thread_id);
+    for (uint32_t i = 0; i < txns_per_thread; i++) {
+      auto *txn = txn_manager.BeginTransaction();
+      storage::RedoRecord *redo =
+          txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+      StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.0, &generator);
+      redo->SetTupleSlot(table.Insert(txn, *redo->Delta()));
+      last_commits[thread_id] = txn_manager.Commit(
+          txn, [](void *arg) { (*reinterpret_cast<std::atomic<uint32_t> *>(arg))++; }, &acknowledged);
+    }
+  };
+  common::WorkerPool thread_pool(num_threads, {});
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads, workload);
+  for (uint32_t i = 0; i < 1000 && acknowledged.load() < num_threads * txns_per_thread; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(num_threads * txns_per_thread, acknowledged.load());
+  for (const transaction::timestamp_t commit_time : last_commits) {
+    log_manager.WaitForPersisted(commit_time);
+    EXPECT_LT(commit_time, log_manager.PersistedWatermark());
+  }
+  // Both are still running, and older than every commit
+  EXPECT_LT(reader->StartTime(), last_commits[0]);
+  EXPECT_LT(snapshot->StartTime(), last_commits[0]);
+  txn_manager.Commit(reader, transaction::TransactionUtil::EmptyCallback, nullptr);
+  txn_manager.Commit(snapshot, transaction::TransactionUtil::EmptyCallback, nullptr);
+  log_manager.Shutdown();
+  gc.PerformGarbageCollection();
+  gc.PerformGarbageCollection();
+  for (uint32_t i = 0; i < num_streams; i++)
+    unlink(storage::LogManager::StreamFilePath(LOG_FILE_NAME, i, num_streams).c_str());
+  log_manager_.Shutdown();
+  unlink(LOG_FILE_NAME);
+}
+
+// This test writes the log with every kind of log device, reopening the log file halfway through, and checks that every
+// committed transaction is read back.
+// NOLINTNEXTLINE
+TEST_F(WriteAheadLoggingTests, LogDeviceTest) {
+  const uint32_t num_txns = 500;
+  storage::BlockLayout layout({8, 8});
+  storage::DataTable table(&block_store_, layout, storage::layout_version_t(0));
+  const storage::ProjectedRowInitializer initializer =
+      storage::ProjectedRowInitializer::Create(layout, StorageTestUtil::ProjectionListAllColumns(layout));
+  log_manager_.Shutdown();
+  unlink(LOG_FILE_NAME);
+
+  for (auto device_type :
+       {storage::LogDeviceType::POSIX, storage::LogDeviceType::DIRECT, storage::LogDeviceType::IO_URING}) {
+    for (uint32_t run = 0; run < 2; run++) {
+      storage::LogManagerOptions options;
+      // Small write batches keep the devices busy with one batch while the next is serialized
+      options.write_batch_size_ = 1 << 10;
+      options.device_type_ = device_type;
+      storage::LogManager log_manager(LOG_FILE_NAME, &pool_, options);
+      transaction::TransactionManager txn_manager(&pool_, true, &log_manager);
+      storage::GarbageCollector gc(&txn_manager);
+      log_manager.Start();
+      std::atomic<uint32_t> persisted = 0;
+      for (uint32_t i = 0; i < num_txns; i++) {
+        auto *txn = txn_manager.BeginTransaction();
+        storage::RedoRecord *redo =
+            txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+        StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.0, &generator_);
+        redo->SetTupleSlot(table.Insert(txn, *redo->Delta()));
+        txn_manager.Commit(txn, [](void *arg) { (*reinterpret_cast<std::atomic<uint32_t> *>(arg))++; }, &persisted);
+      }
+      log_manager.Shutdown();
+      EXPECT_EQ(num_txns, persisted.load());
+      gc.PerformGarbageCollection();
+      gc.PerformGarbageCollection();
+    }
+
+    // Both runs start their timestamps from scratch, so records are counted instead of grouped into transactions
+    uint32_t num_redos = 0, num_commits = 0;
+    storage::BufferedLogReader in(LOG_FILE_NAME);
+    while (in.HasMore()) {
+      storage::LogRecord *log_record = storage::LogReader::ReadRecord(&in);
+      if (log_record == nullptr) break;
+      if (log_record->RecordType() == storage::LogRecordType::COMMIT)
+        num_commits++;
+      else
+        num_redos++;
+      delete[] reinterpret_cast<byte *>(log_record);
+    }
+    // Only padding can follow the last record
+    EXPECT_FALSE(in.HasMore());
+    EXPECT_EQ(2 * num_txns, num_redos);
+    EXPECT_EQ(2 * num_txns, num_commits);
+    unlink(LOG_FILE_NAME);
+  }
+}
+
+// This test runs transactions against every kind of log device that does not write files, and checks that all of their
+// commits are acknowledged without a log file being created. It also checks the ring buffer of the memory device and
+// the latencies of the simulated one.
+// NOLINTNEXTLINE
+TEST_F(WriteAheadLoggingTests, BenchmarkLogDeviceTest) {
+  const uint32_t num_txns = 200;
+  storage::BlockLayout layout({8, 8});
+  storage::DataTable table(&block_store_, layout, storage::layout_version_t(0));
+  const storage::ProjectedRowInitializer initializer =
+      storage::ProjectedRowInitializer::Create(layout, StorageTestUtil::ProjectionListAllColumns(layout));
+  log_manager_.Shutdown();
+  unlink(LOG_FILE_NAME);
+
+  for (auto device_type :
+       {storage::LogDeviceType::NULL_DEVICE, storage::LogDeviceType::MEMORY, storage::LogDeviceType::SIMULATED}) {
+    EXPECT_FALSE(storage::LogDevice::WritesFile(device_type));
+    storage::LogManagerOptions options;
+    options.device_type_ = device_type;
+    storage::LogManager log_manager(LOG_FILE_NAME, &pool_, options);
+    transaction::TransactionManager txn_manager(&pool_, true, &log_manager);
+    storage::GarbageCollector gc(&txn_manager);
+    log_manager.Start();
+    std::atomic<uint32_t> persisted = 0;
+    for (uint32_t i = 0; i < num_txns; i++) {
+      auto *txn = txn_manager.BeginTransaction();
+      storage::RedoRecord *redo =
+          txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+      StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.0, &generator_);
+      redo->SetTupleSlot(table.Insert(txn, *redo->Delta()));
+      txn_manager.Commit(txn, [](void *arg) { (*reinterpret_cast<std::atomic<uint32_t> *>(arg))++; }, &persisted);
+    }
+    log_manager.Shutdown();
+    EXPECT_EQ(num_txns, persisted.load());
+    struct stat file_stat;
+    EXPECT_NE(0, stat(LOG_FILE_NAME, &file_stat));
+    gc.PerformGarbageCollection();
+    gc.PerformGarbageCollection();
+  }
+  // Segments are files
+  storage::LogManagerOptions segmented;
+  segmented.device_type_ = storage::LogDeviceType::NULL_DEVICE;
+  segmented.segment_size_ = 1 << 20;
+  EXPECT_THROW(storage::LogManager(LOG_FILE_NAME, &pool_, segmented), std::runtime_error);
+
+  // The ring buffer keeps the last bytes appended, including those of a region larger than itself
+  storage::MemoryLogDevice memory(16);
+  std::vector<uint8_t> appended;
+  for (const uint32_t size : {10, 10, 40}) {
+    std::vector<uint8_t> region(size);
+    for (uint8_t &value : region) value = static_cast<uint8_t>(appended.size() + (&value - region.data()));
+    appended.insert(appended.end(), region.begin(), region.end());
+    iovec iov{region.data(), region.size()};
+    memory.Append(&iov, 1);
+  }
+  EXPECT_EQ(appended.size(), memory.BytesAppended());
+  for (uint64_t i = appended.size() - 16; i < appended.size(); i++)
+    EXPECT_EQ(appended[i], static_cast<uint8_t>(memory.Ring()[i % 16]));
+
+  // Syncs with a constant latency take at least that long, and syncs drawn from a distribution vary
+  const uint32_t num_syncs = 50;
+  storage::SimulatedLogDevice constant({std::chrono::microseconds(200), std::chrono::microseconds(200)}, 0);
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < num_syncs; i++) constant.Sync();
+  EXPECT_GE(std::chrono::steady_clock::now() - start, num_syncs * std::chrono::microseconds(200));
+  storage::SimulatedLogDevice simulated({std::chrono::microseconds(100), std::chrono::microseconds(1000)}, 0);
+  std::vector<std::chrono::steady_clock::duration> latencies;
+  for (uint32_t i = 0; i < num_syncs; i++) {
+    start = std::chrono::steady_clock::now();
+    simulated.Sync();
+    latencies.push_back(std::chrono::steady_clock::now() - start);
+  }
+  std::sort(latencies.begin(), latencies.end());
+  EXPECT_LT(latencies.front() + std::chrono::microseconds(100), latencies.back());
+}
+
+// This test writes a log split into small segments while a long running transaction is open, and checks that the
+// segments are sealed with their timestamps, that only the segments before the long running transaction are removed
+// or archived, and that restarts seal unsealed segments and continue the numbering.
+// NOLINTNEXTLINE
+TEST_F(WriteAheadLoggingTests, SegmentTest) {
+  const uint32_t num_txns = 200;
+  const std::string archive_dir = "test_archive";
+  storage::BlockLayout layout({8, 8});
+  storage::DataTable table(&block_store_, layout, storage::layout_version_t(0));
+  const storage::ProjectedRowInitializer initializer =
+      storage::ProjectedRowInitializer::Create(layout, StorageTestUtil::ProjectionListAllColumns(layout));
+  log_manager_.Shutdown();
+  unlink(LOG_FILE_NAME);
+  mkdir(archive_dir.c_str(), 0755);
+
+  for (const std::string &archive : {std::string(), archive_dir}) {
+    // Direct devices preallocate their segments, and pad their ends with zeros
+    storage::LogManagerOptions options;
+    options.write_batch_size_ = 1 << 10;
+    options.device_type_ = archive.empty() ? storage::LogDeviceType::POSIX : storage::LogDeviceType::DIRECT;
+    options.segment_size_ = 1 << 12;
+    options.archive_dir_ = archive;
+    transaction::timestamp_t long_txn_begin;
+    {
+      storage::LogManager log_manager(LOG_FILE_NAME, &pool_, options);
+      transaction::TransactionManager txn_manager(&pool_, true, &log_manager);
+      storage::GarbageCollector gc(&txn_manager);
+      auto run_txns = [&](uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+          auto *txn = txn_manager.BeginTransaction();
+          storage::RedoRecord *redo =
+              txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+          StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.0, &generator_);
+          redo->SetTupleSlot(table.Insert(txn, *redo->Delta()));
+          txn_manager.Commit(txn, [](void *) {}, nullptr);
+          // Every round of processing retires at most one full segment
+          if (i % 10 == 0) log_manager.Process();
+        }
+      };
+      run_txns(num_txns);
+      auto *long_txn = txn_manager.BeginTransaction();
+      long_txn_begin = long_txn->StartTime();
+      storage::RedoRecord *redo =
+          long_txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+      StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.0, &generator_);
+      redo->SetTupleSlot(table.Insert(long_txn, *redo->Delta()));
+      run_txns(num_txns);
+      log_manager.Process();
+
+      // The long running transaction holds back the removal of every segment written since it began
+      const std::vector<uint64_t> segments_before = storage::LogSegmentHeader::ListSegments(LOG_FILE_NAME);
+      EXPECT_EQ(long_txn_begin, txn_manager.OldestTransactionStartTime());
+      const uint64_t num_removed = log_manager.RemoveSegmentsBefore(txn_manager.OldestTransactionStartTime());
+      EXPECT_LT(0, num_removed);
+      const std::vector<uint64_t> segments_after = storage::LogSegmentHeader::ListSegments(LOG_FILE_NAME);
+      EXPECT_EQ(segments_before.size() - num_removed, segments_after.size());
+      if (!archive.empty()) {
+        EXPECT_EQ(num_removed, storage::LogSegmentHeader::ListSegments(archive + "/" + LOG_FILE_NAME).size());
+      }
+      txn_manager.Commit(long_txn, [](void *) {}, nullptr);
+      log_manager.Shutdown();
+      gc.PerformGarbageCollection();
+      gc.PerformGarbageCollection();
+    }
+
+    // Segments are numbered consecutively, and the remaining ones are sealed with their timestamps
+    std::vector<uint64_t> segments = storage::LogSegmentHeader::ListSegments(LOG_FILE_NAME);
+    ASSERT_LT(1, segments.size());
+    for (uint32_t i = 0; i < segments.size(); i++) {
+      if (i > 0) {
+        EXPECT_EQ(segments[i - 1] + 1, segments[i]);
+      }
+      storage::LogSegmentHeader header;
+      ASSERT_TRUE(storage::LogSegmentHeader::Read(storage::LogSegmentHeader::FilePath(LOG_FILE_NAME, segments[i]),
+                                                  &header));
+      EXPECT_EQ(1, header.sealed_);
+      EXPECT_EQ(segments[i], header.segment_id_);
+      EXPECT_FALSE(header.last_commit_ < header.first_commit_);
+      EXPECT_FALSE(header.newest_txn_begin_ < long_txn_begin);
+    }
+
+    // Every transaction that began since the long running one is still in the log
+    {
+      storage::LogReader reader(storage::LogManager::LogFilePaths(LOG_FILE_NAME, 1));
+      uint32_t num_recent = 0;
+      while (reader.HasMore()) {
+        std::vector<storage::LogRecord *> records = reader.NextTransaction();
+        if (!(records[0]->TxnBegin() < long_txn_begin)) {
+          EXPECT_EQ(2, records.size());
+          num_recent++;
+        }
+        for (auto *record : records) delete[] reinterpret_cast<byte *>(record);
+      }
+      EXPECT_EQ(num_txns + 1, num_recent);
+    }
+
+    // A segment left unsealed by a crash is sealed with the same header on restart, and the numbering continues
+    const std::string last_path = storage::LogSegmentHeader::FilePath(LOG_FILE_NAME, segments.back());
+    storage::LogSegmentHeader sealed_header, unsealed_header;
+    ASSERT_TRUE(storage::LogSegmentHeader::Read(last_path, &sealed_header));
+    unsealed_header.segment_id_ = sealed_header.segment_id_;
+    unsealed_header.Write(last_path);
+    {
+      storage::LogManager log_manager(LOG_FILE_NAME, &pool_, options);
+      EXPECT_EQ(segments.back() + 1, storage::LogSegmentHeader::ListSegments(LOG_FILE_NAME).back());
+      storage::LogSegmentHeader header;
+      ASSERT_TRUE(storage::LogSegmentHeader::Read(last_path, &header));
+      EXPECT_EQ(1, header.sealed_);
+      EXPECT_EQ(sealed_header.first_commit_, header.first_commit_);
+      EXPECT_EQ(sealed_header.last_commit_, header.last_commit_);
+      EXPECT_EQ(sealed_header.newest_txn_begin_, header.newest_txn_begin_);
+      // An empty segment is not kept
+      log_manager.Shutdown();
+    }
+    EXPECT_EQ(segments, storage::LogSegmentHeader::ListSegments(LOG_FILE_NAME));
+
+    for (const uint64_t segment_id : storage::LogSegmentHeader::ListSegments(LOG_FILE_NAME))
+      unlink(storage::LogSegmentHeader::FilePath(LOG_FILE_NAME, segment_id).c_str());
+    for (const uint64_t segment_id : storage::LogSegmentHeader::ListSegments(archive_dir + "/" + LOG_FILE_NAME))
+      unlink(storage::LogSegmentHeader::FilePath(archive_dir + "/" + LOG_FILE_NAME, segment_id).c_str());
+  }
+  rmdir(archive_dir.c_str());
+}
+
+// This test commits transactions asynchronously, and checks that they are acknowledged right away while synchronous
+// commits still wait for the log, and that the log catches up within the maximum commit lag or when waited for.
+// NOLINTNEXTLINE
+TEST_F(WriteAheadLoggingTests, AsyncCommitTest) {
+  const uint32_t num_txns = 100;
+  storage::BlockLayout layout({8, 8});
+  storage::DataTable table(&block_store_, layout, storage::layout_version_t(0));
+  const storage::ProjectedRowInitializer initializer =
+      storage::ProjectedRowInitializer::Create(layout, StorageTestUtil::ProjectionListAllColumns(layout));
+#ifndef NDEBUG
+  // Without a transaction manager, there is no watermark that could ever pass the commit
+  EXPECT_DEATH(log_manager_.WaitForPersisted(transaction::timestamp_t(0)), "registered transaction manager");
+#endif
+  log_manager_.Shutdown();
+  unlink(LOG_FILE_NAME);
+
+  for (const bool start_threads : {false, true}) {
+    // A flush interval far longer than the commit lag shows that idle streams are not what persists async commits
+    storage::LogManagerOptions options;
+    options.flush_interval_ = std::chrono::seconds(10);
+    options.max_commit_lag_ = std::chrono::milliseconds(5);
+    storage::LogManager log_manager(LOG_FILE_NAME, &pool_, options);
+    transaction::TransactionManager txn_manager(&pool_, true, &log_manager, false);
+    storage::GarbageCollector gc(&txn_manager);
+    if (start_threads) log_manager.Start();
+    std::atomic<uint32_t> acknowledged = 0;
+    auto commit = [&](transaction::TransactionContext *txn) {
+      storage::RedoRecord *redo =
+          txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+      StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.0, &generator_);
+      redo->SetTupleSlot(table.Insert(txn, *redo->Delta()));
+      return txn_manager.Commit(txn, [](void *arg) { (*reinterpret_cast<std::atomic<uint32_t> *>(arg))++; },
+                                &acknowledged);
+    };
+
+    transaction::timestamp_t last_commit(0);
+    for (uint32_t i = 0; i < num_txns; i++) {
+      auto *txn = txn_manager.BeginTransaction();
+      EXPECT_FALSE(txn->SynchronousCommit());
+      last_commit = commit(txn);
+      EXPECT_EQ(i + 1, acknowledged.load());
+    }
+    if (start_threads) {
+      // Nothing waits for the records, but they still have to be persisted within the lag
+      const auto start = std::chrono::steady_clock::now();
+      while (!(last_commit < log_manager.PersistedWatermark()))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    } else {
+      EXPECT_FALSE(last_commit < log_manager.PersistedWatermark());
+      log_manager.WaitForPersisted(last_commit);
+      EXPECT_LT(last_commit, log_manager.PersistedWatermark());
+    }
+
+    // A transaction can still choose to commit synchronously
+    auto *txn = txn_manager.BeginTransaction();
+    txn->SetSynchronousCommit(true);
+    last_commit = commit(txn);
+    if (!start_threads) {
+      EXPECT_EQ(num_txns, acknowledged.load());
+    }
+    log_manager.WaitForPersisted(last_commit);
+    EXPECT_LT(last_commit, log_manager.PersistedWatermark());
+    log_manager.Shutdown();
+    EXPECT_EQ(num_txns + 1, acknowledged.load());
+    gc.PerformGarbageCollection();
+    gc.PerformGarbageCollection();
+
+    // Every transaction made it to the log
+    storage::LogReader reader({LOG_FILE_NAME});
+    uint32_t num_read = 0;
+    while (reader.HasMore()) {
+      for (auto *record : reader.NextTransaction()) delete[] reinterpret_cast<byte *>(record);
+      num_read++;
+    }
+    EXPECT_EQ(num_txns + 1, num_read);
+    unlink(LOG_FILE_NAME);
+  }
+}
+
+// Begins a transaction from the acknowledgement of every commit, without logging, committing asynchronously and
+// committing synchronously, and checks that the transaction sees the commit it was acknowledged for
+// NOLINTNEXTLINE
+TEST_F(WriteAheadLoggingTests, AcknowledgedCommitIsVisible) {
+  const uint32_t num_txns = 10;
+  storage::BlockLayout layout({8, 8});
+  storage::DataTable table(&block_store_, layout, storage::layout_version_t(0));
+  const storage::ProjectedRowInitializer initializer =
+      storage::ProjectedRowInitializer::Create(layout, StorageTestUtil::ProjectionListAllColumns(layout));
+  byte *buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+  log_manager_.Shutdown();
+  unlink(LOG_FILE_NAME);
+
+  struct Acknowledgement {
+    transaction::TransactionManager *txn_manager_;
+    storage::DataTable *table_;
+    storage::TupleSlot slot_;
+    storage::ProjectedRow *row_;
+    std::atomic<uint32_t> num_visible_{0}, num_acknowledged_{0};
+  };
+  auto read_committed = [](void *arg) {
+    auto *ack = reinterpret_cast<Acknowledgement *>(arg);
+    auto *reader = ack->txn_manager_->BeginReadOnlyTransaction();
+    if (ack->table_->Select(reader, ack->slot_, ack->row_)) ack->num_visible_++;
+    ack->txn_manager_->Commit(reader, transaction::TransactionUtil::EmptyCallback, nullptr);
+    ack->num_acknowledged_++;
+  };
+  for (const bool logging : {false, true}) {
+    for (const bool synchronous : {false, true}) {
+      if (!logging && synchronous) continue;
+      std::unique_ptr<storage::LogManager> log_manager =
+          logging ? std::make_unique<storage::LogManager>(LOG_FILE_NAME, &pool_) : nullptr;
+      transaction::TransactionManager txn_manager(&pool_, true, log_manager.get(), synchronous);
+      storage::GarbageCollector gc(&txn_manager);
+      if (synchronous) log_manager->Start();
+      Acknowledgement ack{&txn_manager, &table, storage::TupleSlot(), initializer.InitializeRow(buffer)};
+      for (uint32_t i = 0; i < num_txns; i++) {
+        auto *txn = txn_manager.BeginTransaction();
+        storage::RedoRecord *redo =
+            txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+        StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.0, &generator_);
+        ack.slot_ = table.Insert(txn, *redo->Delta());
+        redo->SetTupleSlot(ack.slot_);
+        txn_manager.Commit(txn, read_committed, &ack);
+        // A synchronous commit is acknowledged by the log manager, which has to be done before the slot changes
+        while (ack.num_acknowledged_.load() <= i) std::this_thread::yield();
+      }
+      if (logging) log_manager->Shutdown();
+      EXPECT_EQ(num_txns, ack.num_visible_.load());
+      gc.PerformGarbageCollection();
+      gc.PerformGarbageCollection();
+      unlink(LOG_FILE_NAME);
+    }
+  }
+  delete[] buffer;
+}
+
+// This test logs inserts and partial updates of tuples with varlen values, both inlined and not, and checks that the
+// records read back hold copies of the same values, along with the column ids and the layout version of the table.
+// NOLINTNEXTLINE
+TEST_F(WriteAheadLoggingTests, VarlenLogTest) {
+  const uint32_t num_txns = 200;
+  const storage::BlockLayout layout = StorageTestUtil::RandomLayoutWithVarlens(10, &generator_);
+  const storage::layout_version_t layout_version(3);
+  storage::DataTable table(&block_store_, layout, layout_version);
+  transaction::TransactionManager txn_manager(&pool_, true, &log_manager_);
+  storage::GarbageCollector gc(&txn_manager);
+
+  // Shallow copies of the logged deltas, in the order they were logged. The table keeps their varlens alive until the
+  // garbage collector runs.
+  std::vector<byte *> expected;
+  std::vector<storage::TupleSlot> slots;
+  for (uint32_t i = 0; i < num_txns; i++) {
+    auto *txn = txn_manager.BeginTransaction();
+    const bool update = i % 2 == 1;
+    const storage::ProjectedRowInitializer initializer = storage::ProjectedRowInitializer::Create(
+        layout, update ? StorageTestUtil::ProjectionListRandomColumns(layout, &generator_)
+                       : StorageTestUtil::ProjectionListAllColumns(layout));
+    storage::RedoRecord *redo =
+        txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+    StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.2, &generator_);
+    if (update) {
+      redo->SetTupleSlot(slots[i / 2]);
+      EXPECT_TRUE(table.Update(txn, redo->GetTupleSlot(), *redo->Delta()));
+    } else {
+      redo->SetTupleSlot(table.Insert(txn, *redo->Delta()));
+      slots.push_back(redo->GetTupleSlot());
+    }
+    byte *copy = common::AllocationUtil::AllocateAligned(redo->Delta()->Size());
+    std::memcpy(copy, redo->Delta(), redo->Delta()->Size());
+    expected.push_back(copy);
+    txn_manager.Commit(txn, [](void *) {}, nullptr);
+  }
+  log_manager_.Shutdown();
+
+  uint32_t num_redos = 0;
+  storage::BufferedLogReader in(LOG_FILE_NAME);
+  while (in.HasMore()) {
+    storage::LogRecord *log_record = ReadNextRecord(&in);
+    if (log_record == nullptr) break;
+    if (log_record->RecordType() == storage::LogRecordType::REDO) {
+      auto *redo = log_record->GetUnderlyingRecordBodyAs<storage::RedoRecord>();
+      auto *logged = reinterpret_cast<storage::ProjectedRow *>(expected[num_redos]);
+      EXPECT_EQ(layout_version, redo->GetLayoutVersion());
+      EXPECT_EQ(slots[num_redos / 2], redo->GetTupleSlot());
+      EXPECT_TRUE(StorageTestUtil::ProjectionListEqualDeep(layout, logged, redo->Delta()));
+      // Varlens that are not inlined live in the record read back, not in the table
+      for (uint16_t col = 0; col < redo->Delta()->NumColumns(); col++) {
+        if (!layout.IsVarlen(redo->Delta()->ColumnIds()[col])) continue;
+        auto *entry = reinterpret_cast<storage::VarlenEntry *>(redo->Delta()->AccessWithNullCheck(col));
+        if (entry == nullptr || entry->IsInlined()) continue;
+        EXPECT_FALSE(entry->NeedReclaim());
+        EXPECT_NE(reinterpret_cast<storage::VarlenEntry *>(logged->AccessForceNotNull(col))->Content(),
+                  entry->Content());
+      }
+      num_redos++;
+    }
+    delete[] reinterpret_cast<byte *>(log_record);
+  }
+  EXPECT_EQ(num_txns, num_redos);
+
+  for (byte *copy : expected) delete[] copy;
+  gc.PerformGarbageCollection();
+  gc.PerformGarbageCollection();
+  unlink(LOG_FILE_NAME);
+}
+
+// This test writes the same transactions to an uncompressed and a compressed log, and checks that the compressed log
+// is smaller and reads back all of them, and that a compressed log cut short in the middle of a frame reads back the
+// transactions before that frame.
+// NOLINTNEXTLINE
+TEST_F(WriteAheadLoggingTests, CompressionTest) {
+  const uint32_t num_txns = 1000;
+  storage::BlockLayout layout({8, 8, 8, 4});
+  storage::DataTable table(&block_store_, layout, storage::layout_version_t(0));
+  const storage::ProjectedRowInitializer initializer =
+      storage::ProjectedRowInitializer::Create(layout, StorageTestUtil::ProjectionListAllColumns(layout));
+  log_manager_.Shutdown();
+  unlink(LOG_FILE_NAME);
+  auto num_committed = [] {
+    storage::LogReader reader({LOG_FILE_NAME});
+    uint32_t result = 0;
+    for (; reader.HasMore(); result++)
+      for (storage::LogRecord *record : reader.NextTransaction()) delete[] reinterpret_cast<byte *>(record);
+    return result;
+  };
+
+  std::vector<off_t> file_sizes;
+  for (const bool compress : {false, true}) {
+    {
+      storage::LogManagerOptions options;
+      options.compress_ = compress;
+      storage::LogManager log_manager(LOG_FILE_NAME, &pool_, options);
+      transaction::TransactionManager txn_manager(&pool_, true, &log_manager);
+      storage::GarbageCollector gc(&txn_manager);
+      for (uint32_t i = 0; i < num_txns; i++) {
+        auto *txn = txn_manager.BeginTransaction();
+        storage::RedoRecord *redo =
+            txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+        // Values repeat across tuples, as they do in most tables
+        for (uint16_t col = 0; col < redo->Delta()->NumColumns(); col++)
+          std::memset(redo->Delta()->AccessForceNotNull(col), static_cast<int>(i % 10),
+                      layout.AttrSize(redo->Delta()->ColumnIds()[col]));
+        redo->SetTupleSlot(table.Insert(txn, *redo->Delta()));
+        txn_manager.Commit(txn, [](void *) {}, nullptr);
+        if (i % 100 == 0) log_manager.Process();
+      }
+      log_manager.Shutdown();
+      gc.PerformGarbageCollection();
+      gc.PerformGarbageCollection();
+    }
+    struct stat file_stat;
+    ASSERT_EQ(0, stat(LOG_FILE_NAME, &file_stat));
+    file_sizes.push_back(file_stat.st_size);
+    EXPECT_EQ(num_txns, num_committed());
+    if (!compress) unlink(LOG_FILE_NAME);
+  }
+  EXPECT_LT(file_sizes[1], file_sizes[0] / 2);
+
+  // The last frame is cut short, and none of its transactions is read back
+  ASSERT_EQ(0, truncate(LOG_FILE_NAME, file_sizes[1] - 1));
+  const uint32_t num_read = num_committed();
+  EXPECT_LT(0, num_read);
+  EXPECT_GT(num_txns, num_read);
+  unlink(LOG_FILE_NAME);
+}
+// Checks that a write torn by a crash at the end of the log is detected and cut off before the log is appended to
+// NOLINTNEXTLINE
+TEST_F(WriteAheadLoggingTests, TornWriteTest) {
+  const uint32_t num_txns = 100;
+  storage::BlockLayout layout({8, 8, 8, 4});
+  storage::DataTable table(&block_store_, layout, storage::layout_version_t(0));
+  const storage::ProjectedRowInitializer initializer =
+      storage::ProjectedRowInitializer::Create(layout, StorageTestUtil::ProjectionListAllColumns(layout));
+  log_manager_.Shutdown();
+  unlink(LOG_FILE_NAME);
+  // Transactions logged after a restart reuse the timestamps of the ones before, so commit records are counted instead
+  auto num_committed = [] {
+    storage::BufferedLogReader in(LOG_FILE_NAME);
+    uint32_t result = 0;
+    while (in.HasMore()) {
+      storage::LogRecord *record = storage::LogReader::ReadRecord(&in);
+      if (record == nullptr) break;
+      if (record->RecordType() == storage::LogRecordType::COMMIT) result++;
+      delete[] reinterpret_cast<byte *>(record);
+    }
+    return result;
+  };
+  auto file_size = [] {
+    struct stat file_stat;
+    return stat(LOG_FILE_NAME, &file_stat) == 0 ? file_stat.st_size : -1;
+  };
+  auto run_txns = [&] {
+    storage::LogManager log_manager(LOG_FILE_NAME, &pool_);
+    transaction::TransactionManager txn_manager(&pool_, true, &log_manager);
+    storage::GarbageCollector gc(&txn_manager);
+    for (uint32_t i = 0; i < num_txns; i++) {
+      auto *txn = txn_manager.BeginTransaction();
+      storage::RedoRecord *redo =
+          txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+      StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.0, &generator_);
+      redo->SetTupleSlot(table.Insert(txn, *redo->Delta()));
+      txn_manager.Commit(txn, [](void *) {}, nullptr);
+      // Write out a frame every 10 transactions
+      if (i % 10 == 9) log_manager.Process();
+    }
+    log_manager.Shutdown();
+    gc.PerformGarbageCollection();
+    gc.PerformGarbageCollection();
+  };
+
+  run_txns();
+  EXPECT_EQ(num_txns, num_committed());
+  const off_t intact_size = file_size();
+
+  // Garbage after the last frame is not mistaken for records
+  const std::vector<char> garbage = {1, 2, 3, 4, 5, 6, 7, 8};
+  int fd = open(LOG_FILE_NAME, O_WRONLY | O_APPEND);
+  ASSERT_EQ(static_cast<ssize_t>(garbage.size()), write(fd, garbage.data(), garbage.size()));
+  close(fd);
+  EXPECT_EQ(num_txns, num_committed());
+
+  // Neither is a frame whose contents were only partially written out, which is where the log ends
+  fd = open(LOG_FILE_NAME, O_WRONLY);
+  ASSERT_EQ(1, pwrite(fd, "x", 1, intact_size - 10));
+  close(fd);
+  const uint32_t num_read = num_committed();
+  EXPECT_LT(0, num_read);
+  EXPECT_GT(num_txns, num_read);
+
+  // Once the torn write is cut off, the transactions logged after the restart are read back after the ones before it.
+  // They take up as many bytes as the ones logged the first time.
+  run_txns();
+  EXPECT_GT(2 * intact_size, file_size());
+  EXPECT_EQ(num_read + num_txns, num_committed());
+  unlink(LOG_FILE_NAME);
+}
+// Checks that the log read through a memory mapping, with frames decoded in parallel, is the log read sequentially
+// NOLINTNEXTLINE
+TEST_F(WriteAheadLoggingTests, MappedReaderTest) {
+  const uint32_t num_txns = 1000;
+  storage::BlockLayout layout({8, 8, 8, 4});
+  storage::DataTable table(&block_store_, layout, storage::layout_version_t(0));
+  const storage::ProjectedRowInitializer initializer =
+      storage::ProjectedRowInitializer::Create(layout, StorageTestUtil::ProjectionListAllColumns(layout));
+  log_manager_.Shutdown();
+  unlink(LOG_FILE_NAME);
+  {
+    // Half of the frames are compressed
+    storage::LogManagerOptions options;
+    options.compress_ = true;
+    storage::LogManager log_manager(LOG_FILE_NAME, &pool_, options);
+    transaction::TransactionManager txn_manager(&pool_, true, &log_manager);
+    storage::GarbageCollector gc(&txn_manager);
+    for (uint32_t i = 0; i < num_txns; i++) {
+      auto *txn = txn_manager.BeginTransaction();
+      storage::RedoRecord *redo =
+          txn->StageWrite(CatalogTestUtil::test_db_oid, CatalogTestUtil::test_table_oid, initializer);
+      if (i % 20 < 10)
+        StorageTestUtil::PopulateRandomRow(redo->Delta(), layout, 0.0, &generator_);
+      else
+        for (uint16_t col = 0; col < redo->Delta()->NumColumns(); col++)
+          std::memset(redo->Delta()->AccessForceNotNull(col), 0, layout.AttrSize(redo->Delta()->ColumnIds()[col]));
+      redo->SetTupleSlot(table.Insert(txn, *redo->Delta()));
+      txn_manager.Commit(txn, [](void *) {}, nullptr);
+      if (i % 10 == 9) log_manager.Process();
+    }
+    log_manager.Shutdown();
+    gc.PerformGarbageCollection();
+    gc.PerformGarbageCollection();
+  }
+
+  std::vector<transaction::timestamp_t> expected;
+  {
+    storage::BufferedLogReader in(LOG_FILE_NAME);
+    while (in.HasMore()) {
+      storage::LogRecord *record = storage::LogReader::ReadRecord(&in);
+      if (record == nullptr) break;
+      if (record->RecordType() == storage::LogRecordType::COMMIT)
+        expected.push_back(record->GetUnderlyingRecordBodyAs<storage::CommitRecord>()->CommitTime());
+      delete[] reinterpret_cast<byte *>(record);
+    }
+  }
+  EXPECT_EQ(num_txns, expected.size());
+
+  for (const uint32_t num_decoders : {1, 8}) {
+    storage::MappedLogReader in(LOG_FILE_NAME);
+    std::vector<transaction::timestamp_t> read;
+    for (storage::LogRecord *record : storage::LogReader::ReadRecords(&in, num_decoders)) {
+      if (record->RecordType() == storage::LogRecordType::COMMIT)
+        read.push_back(record->GetUnderlyingRecordBodyAs<storage::CommitRecord>()->CommitTime());
+      delete[] reinterpret_cast<byte *>(record);
+    }
+    EXPECT_EQ(expected, read);
+  }
+  unlink(LOG_FILE_NAME);
+}
 }  // namespace terrier
@@ -0,0 +1,224 @@
+#include "storage/partitioned_sql_table.h"
+#include <atomic>
+#include <random>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "common/worker_pool.h"
+#include "storage/garbage_collector.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
+#include "util/multithread_test_util.h"
+#include "util/test_harness.h"
+#include "util/transaction_test_util.h"
+
+namespace terrier {
+
+class PartitionedSqlTableTests : public TerrierTest {
+ public:
+  storage::BlockStore block_store_{100, 100};
+  storage::RecordBufferSegmentPool buffer_pool_{10000, 10000};
+  transaction::TransactionManager txn_manager_{&buffer_pool_, true, LOGGING_DISABLED};
+  storage::GarbageCollector gc_{&txn_manager_};
+  const catalog::col_oid_t key_oid_{1}, value_oid_{2};
+  const catalog::Schema schema_{{{"key", type::TypeId::BIGINT, false, key_oid_},
+                                 {"value", type::TypeId::INTEGER, true, value_oid_}}};
+
+  // Inserts a tuple with the given key, and a value equal to the key
+  bool InsertTuple(transaction::TransactionContext *txn, const storage::PartitionedSqlTable &table, const int64_t key,
+                   storage::TupleSlot *slot) {
+    auto initializer = table.InitializerForProjectedRow({key_oid_, value_oid_});
+    storage::RedoRecord *redo = txn->StageWrite(catalog::db_oid_t(0), table.Oid(), initializer.first);
+    *reinterpret_cast<int64_t *>(redo->Delta()->AccessForceNotNull(initializer.second[key_oid_])) = key;
+    *reinterpret_cast<int32_t *>(redo->Delta()->AccessForceNotNull(initializer.second[value_oid_])) =
+        static_cast<int32_t>(key);
+    const bool result = table.Insert(txn, redo);
+    *slot = redo->GetTupleSlot();
+    return result;
+  }
+
+  // Counts the tuples visible to the txn in the given partitions
+  uint32_t CountTuples(transaction::TransactionContext *txn, const std::vector<storage::SqlTable *> &partitions) {
+    uint32_t result = 0;
+    auto initializer = partitions[0]->InitializerForProjectedColumns({key_oid_}, 100).first;
+    byte *buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedColumnsSize());
+    storage::ProjectedColumns *columns = initializer.Initialize(buffer);
+    for (storage::SqlTable *partition : partitions) {
+      auto it = partition->begin();
+      while (it != partition->end()) {
+        partition->Scan(txn, &it, columns);
+        result += columns->NumTuples();
+      }
+    }
+    delete[] buffer;
+    return result;
+  }
+};
+
+// Inserts tuples into a hash partitioned table and checks that they are spread over the partitions, can be found by
+// pruning on their key, and are all seen by a parallel scan
+// NOLINTNEXTLINE
+TEST_F(PartitionedSqlTableTests, HashPartitioning) {
+  const uint32_t num_partitions = 4;
+  const int64_t num_tuples = 1000;
+  storage::PartitionedSqlTable table(&block_store_, schema_, catalog::table_oid_t(1), key_oid_,
+                                     storage::PartitionStrategy::HASH, num_partitions);
+  EXPECT_EQ(num_partitions, table.NumPartitions());
+
+  auto *txn = txn_manager_.BeginTransaction();
+  storage::TupleSlot slot;
+  for (int64_t key = 0; key < num_tuples; key++) {
+    EXPECT_TRUE(InsertTuple(txn, table, key, &slot));
+    // The tuple is in the one partition that pruning on its key returns
+    const std::vector<storage::SqlTable *> pruned = table.PrunePartitions(key, key);
+    EXPECT_EQ(1, pruned.size());
+    auto initializer = table.InitializerForProjectedRow({key_oid_});
+    byte *buffer = common::AllocationUtil::AllocateAligned(initializer.first.ProjectedRowSize());
+    storage::ProjectedRow *row = initializer.first.InitializeRow(buffer);
+    EXPECT_TRUE(pruned[0]->Select(txn, slot, row));
+    EXPECT_EQ(key, *reinterpret_cast<int64_t *>(row->AccessWithNullCheck(0)));
+    delete[] buffer;
+  }
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Parallel scans share the transaction between the workers, which needs it to be read-only
+  txn = txn_manager_.BeginReadOnlyTransaction();
+  for (storage::SqlTable *partition : table.Partitions()) EXPECT_LT(0, CountTuples(txn, {partition}));
+  EXPECT_EQ(num_tuples, CountTuples(txn, table.Partitions()));
+  EXPECT_EQ(num_partitions, table.PrunePartitions(0, 1).size());
+
+  common::WorkerPool workers(num_partitions, {});
+  std::atomic<int64_t> scanned = 0, key_sum = 0;
+  table.ParallelScan(txn, table.Partitions(), {key_oid_}, 100, &workers,
+                     [&](uint32_t partition UNUSED_ATTRIBUTE, storage::ProjectedColumns *columns) {
+                       scanned += columns->NumTuples();
+                       for (uint32_t i = 0; i < columns->NumTuples(); i++)
+                         key_sum += *reinterpret_cast<int64_t *>(columns->InterpretAsRow(i).AccessWithNullCheck(0));
+                     });
+  EXPECT_EQ(num_tuples, scanned);
+  EXPECT_EQ(num_tuples * (num_tuples - 1) / 2, key_sum);
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  gc_.PerformGarbageCollection();
+  gc_.PerformGarbageCollection();
+}
+
+// Creates and drops range partitions and checks that tuples are routed and pruned correctly
+// NOLINTNEXTLINE
+TEST_F(PartitionedSqlTableTests, RangePartitioning) {
+  storage::PartitionedSqlTable table(&block_store_, schema_, catalog::table_oid_t(1), key_oid_,
+                                     storage::PartitionStrategy::RANGE);
+  EXPECT_EQ(0, table.NumPartitions());
+  EXPECT_TRUE(table.CreateRangePartition(0));
+  EXPECT_TRUE(table.CreateRangePartition(100));
+  EXPECT_TRUE(table.CreateRangePartition(200));
+  EXPECT_FALSE(table.CreateRangePartition(100));
+  EXPECT_EQ(3, table.NumPartitions());
+
+  auto *txn = txn_manager_.BeginTransaction();
+  storage::TupleSlot slot;
+  // Keys below the lowest bound are rejected, and the last partition is unbounded
+  EXPECT_FALSE(InsertTuple(txn, table, -1, &slot));
+  for (int64_t key = 0; key < 300; key++) EXPECT_TRUE(InsertTuple(txn, table, key, &slot));
+  EXPECT_TRUE(InsertTuple(txn, table, 1000, &slot));
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  txn = txn_manager_.BeginTransaction();
+  const std::vector<storage::SqlTable *> partitions = table.Partitions();
+  EXPECT_EQ(100, CountTuples(txn, {partitions[0]}));
+  EXPECT_EQ(100, CountTuples(txn, {partitions[1]}));
+  EXPECT_EQ(101, CountTuples(txn, {partitions[2]}));
+
+  // Pruning returns exactly the partitions overlapping the range
+  EXPECT_EQ(std::vector<storage::SqlTable *>({partitions[0]}), table.PrunePartitions(-10, 50));
+  EXPECT_EQ(std::vector<storage::SqlTable *>({partitions[1]}), table.PrunePartitions(100, 199));
+  EXPECT_EQ(std::vector<storage::SqlTable *>({partitions[1], partitions[2]}), table.PrunePartitions(150, 250));
+  EXPECT_EQ(std::vector<storage::SqlTable *>({partitions[2]}), table.PrunePartitions(5000, 6000));
+  EXPECT_TRUE(table.PrunePartitions(-10, -1).empty());
+  EXPECT_EQ(partitions, table.PrunePartitions(0, 1000));
+
+  // Dropping a partition removes its tuples all at once. A transaction that started before the drop can still read the
+  // partition until it finishes.
+  EXPECT_TRUE(table.DropRangePartition(&txn_manager_, 0));
+  EXPECT_FALSE(table.DropRangePartition(&txn_manager_, 0));
+  EXPECT_EQ(2, table.NumPartitions());
+  gc_.PerformGarbageCollection();
+  EXPECT_EQ(100, CountTuples(txn, {partitions[0]}));
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  txn = txn_manager_.BeginTransaction();
+  EXPECT_EQ(201, CountTuples(txn, table.Partitions()));
+  EXPECT_FALSE(InsertTuple(txn, table, 50, &slot));
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Processes the deferred deletion of the dropped partition
+  for (uint32_t i = 0; i < 3; i++) gc_.PerformGarbageCollection();
+}
+
+// Drops and recreates a range partition while writers insert into and update it and the GC runs, and checks that the
+// partition is not freed while the GC still has to unlink the undo records of the writers
+// NOLINTNEXTLINE
+TEST_F(PartitionedSqlTableTests, DropRacingWriters) {
+  const uint32_t num_threads = 4, num_drops = 100, rounds_per_drop = 8;
+  storage::PartitionedSqlTable table(&block_store_, schema_, catalog::table_oid_t(1), key_oid_,
+                                     storage::PartitionStrategy::RANGE);
+  EXPECT_TRUE(table.CreateRangePartition(0));
+  EXPECT_TRUE(table.CreateRangePartition(100));
+  EXPECT_TRUE(table.CreateRangePartition(200));
+  std::atomic<bool> dropping{true};
+  std::atomic<uint32_t> num_rounds{0}, num_dropped{0}, num_committed_above{0};
+  auto workload = [&](uint32_t id) {
+    if (id == 0) {
+      for (uint32_t i = 0; i < num_drops; i++) {
+        // Let the writers get some transactions into the partition before every drop
+        while (num_rounds.load() < (i + 1) * rounds_per_drop) std::this_thread::yield();
+        EXPECT_TRUE(table.DropRangePartition(&txn_manager_, 100));
+        gc_.PerformGarbageCollection();
+        EXPECT_TRUE(table.CreateRangePartition(100));
+        gc_.PerformGarbageCollection();
+        num_dropped++;
+      }
+      dropping = false;
+      return;
+    }
+    std::default_random_engine generator(id);
+    std::uniform_int_distribution<int64_t> key_dist(0, 299);
+    auto initializer = table.InitializerForProjectedRow({value_oid_});
+    for (uint32_t round = 0; dropping; round++) {
+      // Stay at most two drops ahead, so that the GC keeps up
+      if (num_rounds.load() >= (num_dropped.load() + 2) * rounds_per_drop) {
+        std::this_thread::yield();
+        continue;
+      }
+      auto *txn = txn_manager_.BeginTransaction();
+      uint32_t num_above = 0;
+      for (uint32_t i = 0; i < 10; i++) {
+        const int64_t key = key_dist(generator);
+        storage::TupleSlot slot;
+        EXPECT_TRUE(InsertTuple(txn, table, key, &slot));
+        if (key >= 200) num_above++;
+        // The slot stays writable for this transaction even if its partition is dropped meanwhile
+        storage::RedoRecord *redo = txn->StageWrite(catalog::db_oid_t(0), table.Oid(), initializer.first);
+        redo->SetTupleSlot(slot);
+        *reinterpret_cast<int32_t *>(redo->Delta()->AccessForceNotNull(0)) = -1;
+        EXPECT_TRUE(table.Update(txn, redo));
+      }
+      if (round % 4 == 0) {
+        txn_manager_.Abort(txn);
+      } else {
+        txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+        num_committed_above += num_above;
+      }
+      num_rounds++;
+    }
+  };
+  common::WorkerPool thread_pool(num_threads, {});
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads, workload);
+
+  // The partition that was never dropped holds every committed tuple in its range
+  auto *txn = txn_manager_.BeginTransaction();
+  EXPECT_EQ(num_committed_above.load(), CountTuples(txn, table.PrunePartitions(200, 299)));
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  for (uint32_t i = 0; i < 3; i++) gc_.PerformGarbageCollection();
+}
+}  // namespace terrier
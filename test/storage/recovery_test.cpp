@@ -0,0 +1,371 @@
+#include "storage/recovery/recovery_manager.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "storage/checkpoint/checkpoint_manager.h"
+#include "storage/garbage_collector.h"
+#include "storage/write_ahead_log/log_manager.h"
+#include "storage/write_ahead_log/log_reader.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
+#include "util/catalog_test_util.h"
+#include "util/test_harness.h"
+#include "util/transaction_test_util.h"
+
+#define LOG_FILE_NAME "recovery_test.log"
+#define CHECKPOINT_DIR "recovery_test_dir"
+
+namespace terrier {
+
+class RecoveryTests : public TerrierTest {
+ public:
+  void TearDown() override {
+    for (uint32_t i = 0; i < num_streams_; i++)
+      unlink(storage::LogManager::StreamFilePath(LOG_FILE_NAME, i, num_streams_).c_str());
+    TerrierTest::TearDown();
+  }
+
+  storage::LogManagerOptions LogOptions() const {
+    storage::LogManagerOptions options;
+    options.num_streams_ = num_streams_;
+    return options;
+  }
+
+  storage::BlockStore block_store_{100, 100};
+  storage::RecordBufferSegmentPool buffer_pool_{10000, 10000};
+  const uint32_t num_streams_ = 2;
+  storage::LogManager log_manager_{LOG_FILE_NAME, &buffer_pool_, LogOptions()};
+  transaction::TransactionManager txn_manager_{&buffer_pool_, true, &log_manager_};
+  storage::GarbageCollector gc_{&txn_manager_};
+  // Replays are not logged again
+  transaction::TransactionManager recovery_txn_manager_{&buffer_pool_, true, LOGGING_DISABLED};
+  storage::GarbageCollector recovery_gc_{&recovery_txn_manager_};
+  const catalog::col_oid_t key_oid_{1}, value_oid_{2};
+  const catalog::Schema schema_{
+      {{"key", type::TypeId::INTEGER, false, key_oid_}, {"value", type::TypeId::BIGINT, true, value_oid_}}};
+
+  std::vector<std::string> LogFilePaths() const {
+    std::vector<std::string> paths;
+    for (uint32_t i = 0; i < num_streams_; i++)
+      paths.push_back(storage::LogManager::StreamFilePath(LOG_FILE_NAME, i, num_streams_));
+    return paths;
+  }
+
+  storage::TupleSlot Insert(transaction::TransactionContext *txn, storage::SqlTable *table, const int32_t key) {
+    auto initializer = table->InitializerForProjectedRow({key_oid_, value_oid_});
+    storage::RedoRecord *redo = txn->StageWrite(CatalogTestUtil::test_db_oid, table->Oid(), initializer.first);
+    *reinterpret_cast<int32_t *>(redo->Delta()->AccessForceNotNull(initializer.second[key_oid_])) = key;
+    *reinterpret_cast<int64_t *>(redo->Delta()->AccessForceNotNull(initializer.second[value_oid_])) = key;
+    table->Insert(txn, redo);
+    return redo->GetTupleSlot();
+  }
+
+  // Sets the value of the tuple, or to null if the value is negative
+  void Update(transaction::TransactionContext *txn, storage::SqlTable *table, const storage::TupleSlot slot,
+              const int64_t value) {
+    auto initializer = table->InitializerForProjectedRow({value_oid_});
+    storage::RedoRecord *redo = txn->StageWrite(CatalogTestUtil::test_db_oid, table->Oid(), initializer.first);
+    if (value < 0)
+      redo->Delta()->SetNull(0);
+    else
+      *reinterpret_cast<int64_t *>(redo->Delta()->AccessForceNotNull(0)) = value;
+    redo->SetTupleSlot(slot);
+    EXPECT_TRUE(table->Update(txn, redo));
+  }
+
+  void Delete(transaction::TransactionContext *txn, storage::SqlTable *table, const storage::TupleSlot slot) {
+    txn->StageDelete(CatalogTestUtil::test_db_oid, table->Oid(), slot);
+    EXPECT_TRUE(table->Delete(txn, slot));
+  }
+
+  // Checks that exactly the given tuples of the original table were recovered, with the same contents. The original
+  // table is read with the given transaction manager, or the one of the fixture.
+  void ExpectRecovered(storage::SqlTable *original, const std::vector<storage::TupleSlot> &live,
+                       storage::SqlTable *recovered,
+                       const std::unordered_map<storage::TupleSlot, storage::TupleSlot> &slot_map,
+                       transaction::TransactionManager *original_txn_manager = nullptr) {
+    if (original_txn_manager == nullptr) original_txn_manager = &txn_manager_;
+    auto initializer = original->InitializerForProjectedRow({key_oid_, value_oid_});
+    byte *expected_buffer = common::AllocationUtil::AllocateAligned(initializer.first.ProjectedRowSize());
+    byte *actual_buffer = common::AllocationUtil::AllocateAligned(initializer.first.ProjectedRowSize());
+    auto *txn = original_txn_manager->BeginTransaction();
+    auto *recovery_txn = recovery_txn_manager_.BeginTransaction();
+    uint32_t num_recovered = 0;
+    for (auto it = recovered->begin(); it != recovered->end(); it++) {
+      storage::ProjectedRow *row = initializer.first.InitializeRow(actual_buffer);
+      if (recovered->Select(recovery_txn, *it, row)) num_recovered++;
+    }
+    EXPECT_EQ(live.size(), num_recovered);
+    for (const storage::TupleSlot slot : live) {
+      ASSERT_EQ(1, slot_map.count(slot));
+      storage::ProjectedRow *expected = initializer.first.InitializeRow(expected_buffer);
+      storage::ProjectedRow *actual = initializer.first.InitializeRow(actual_buffer);
+      EXPECT_TRUE(original->Select(txn, slot, expected));
+      EXPECT_TRUE(recovered->Select(recovery_txn, slot_map.at(slot), actual));
+      for (const catalog::col_oid_t oid : {key_oid_, value_oid_}) {
+        const uint16_t offset = initializer.second[oid];
+        ASSERT_EQ(expected->IsNull(offset), actual->IsNull(offset));
+        if (!expected->IsNull(offset)) {
+          EXPECT_EQ(0, std::memcmp(expected->AccessWithNullCheck(offset), actual->AccessWithNullCheck(offset),
+                                   schema_.GetColumn(oid).GetAttrSize()));
+        }
+      }
+    }
+    // The log manager is shut down by now, so the original transaction must not commit
+    original_txn_manager->Abort(txn);
+    recovery_txn_manager_.Commit(recovery_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    delete[] expected_buffer;
+    delete[] actual_buffer;
+  }
+
+  void RemoveCheckpoints() {
+    DIR *dir = opendir(CHECKPOINT_DIR);
+    for (dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+      if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0)
+        unlink((std::string(CHECKPOINT_DIR) + "/" + entry->d_name).c_str());
+    }
+    closedir(dir);
+    rmdir(CHECKPOINT_DIR);
+  }
+
+  void RunGC() {
+    gc_.PerformGarbageCollection();
+    gc_.PerformGarbageCollection();
+    recovery_gc_.PerformGarbageCollection();
+    recovery_gc_.PerformGarbageCollection();
+  }
+};
+
+// Logs inserts, updates and deletes to two tables, along with an aborted and an unfinished transaction whose records
+// reached the log, and checks that replaying the log recreates exactly the committed state
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, ReplayLog) {
+  storage::SqlTable table(&block_store_, schema_, catalog::table_oid_t(1));
+  storage::SqlTable other_table(&block_store_, schema_, catalog::table_oid_t(2));
+  log_manager_.Start();
+
+  std::vector<storage::TupleSlot> live, other_live;
+  auto *txn = txn_manager_.BeginTransaction();
+  for (int32_t key = 0; key < 100; key++) live.push_back(Insert(txn, &table, key));
+  for (int32_t key = 0; key < 10; key++) other_live.push_back(Insert(txn, &other_table, key));
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Update some tuples repeatedly, and delete others, one transaction each
+  for (uint32_t i = 0; i < 30; i++) {
+    txn = txn_manager_.BeginTransaction();
+    Update(txn, &table, live[i % 10], i % 3 == 0 ? -1 : i * 1000);
+    txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  }
+  txn = txn_manager_.BeginTransaction();
+  for (uint32_t i = 90; i < 100; i++) Delete(txn, &table, live[i]);
+  Delete(txn, &other_table, other_live.back());
+  Update(txn, &other_table, other_live[0], 42);
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  live.resize(90);
+  other_live.pop_back();
+
+  // Transactions large enough to hand some of their records to the log before they end
+  auto *aborted = txn_manager_.BeginTransaction();
+  for (int32_t key = 1000; key < 2000; key++) Insert(aborted, &table, key);
+  txn_manager_.Abort(aborted);
+  auto *unfinished = txn_manager_.BeginTransaction();
+  for (int32_t key = 2000; key < 3000; key++) Insert(unfinished, &table, key);
+  log_manager_.Shutdown();
+  EXPECT_EQ(2, storage::LogReader(LogFilePaths()).NumDiscarded());
+
+  storage::SqlTable recovered(&block_store_, schema_, catalog::table_oid_t(1));
+  storage::SqlTable other_recovered(&block_store_, schema_, catalog::table_oid_t(2));
+  std::unordered_map<storage::TupleSlot, storage::TupleSlot> slot_map;
+  storage::RecoveryManager recovery_manager(LogFilePaths(), &recovery_txn_manager_, 4);
+  EXPECT_EQ(32, recovery_manager.Recover({&recovered, &other_recovered}, &slot_map));
+  EXPECT_EQ(live.size() + other_live.size(), slot_map.size());
+  ExpectRecovered(&table, live, &recovered, slot_map);
+  ExpectRecovered(&other_table, other_live, &other_recovered, slot_map);
+
+  // The log cannot be replayed without all of its tables
+  storage::SqlTable missing(&block_store_, schema_, catalog::table_oid_t(1));
+  EXPECT_THROW(recovery_manager.Recover({&missing}, nullptr), std::runtime_error);
+
+  txn_manager_.Abort(unfinished);
+  RunGC();
+}
+
+// Loads a checkpoint and replays only the part of the log written after it
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, ReplayLogAfterCheckpoint) {
+  mkdir(CHECKPOINT_DIR, S_IRWXU);
+  storage::SqlTable table(&block_store_, schema_, catalog::table_oid_t(1));
+  storage::CheckpointManager checkpoint_manager(CHECKPOINT_DIR, &txn_manager_);
+  log_manager_.Start();
+
+  std::vector<storage::TupleSlot> live;
+  auto *txn = txn_manager_.BeginTransaction();
+  for (int32_t key = 0; key < 100; key++) live.push_back(Insert(txn, &table, key));
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  const transaction::timestamp_t checkpoint_time = checkpoint_manager.Checkpoint({{&table, &schema_}});
+
+  // Changes after the checkpoint touch both tuples from the checkpoint and new ones
+  txn = txn_manager_.BeginTransaction();
+  for (int32_t key = 100; key < 150; key++) live.push_back(Insert(txn, &table, key));
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  txn = txn_manager_.BeginTransaction();
+  for (uint32_t i = 0; i < 150; i += 10) Update(txn, &table, live[i], i * 1000);
+  for (uint32_t i = 5; i < 150; i += 10) Delete(txn, &table, live[i]);
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  log_manager_.Shutdown();
+  std::vector<storage::TupleSlot> expected;
+  for (uint32_t i = 0; i < 150; i++)
+    if (i % 10 != 5) expected.push_back(live[i]);
+
+  storage::SqlTable recovered(&block_store_, schema_, catalog::table_oid_t(1));
+  std::unordered_map<storage::TupleSlot, storage::TupleSlot> slot_map;
+  storage::CheckpointManager recovery_checkpoint_manager(CHECKPOINT_DIR, &recovery_txn_manager_);
+  EXPECT_EQ(checkpoint_time,
+            recovery_checkpoint_manager.Recover(CatalogTestUtil::test_db_oid, {{&recovered, &schema_}}, &slot_map));
+  storage::RecoveryManager recovery_manager(LogFilePaths(), &recovery_txn_manager_, 2);
+  EXPECT_EQ(2, recovery_manager.Recover({&recovered}, &slot_map, checkpoint_time));
+  EXPECT_EQ(expected.size(), slot_map.size());
+  ExpectRecovered(&table, expected, &recovered, slot_map);
+  RemoveCheckpoints();
+  RunGC();
+}
+
+// Recovers a log, restarts on it as a recovered system would, and checks that recovering again only replays the
+// changes of the restarted run on top of its checkpoint. Without advancing the timestamps of the restarted run, its
+// transactions would be merged with those of the first run, and its checkpoint would be older than the first run.
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, ReplayLogAcrossRestarts) {
+  mkdir(CHECKPOINT_DIR, S_IRWXU);
+  storage::SqlTable table(&block_store_, schema_, catalog::table_oid_t(1));
+  log_manager_.Start();
+  std::vector<storage::TupleSlot> first_run;
+  auto *txn = txn_manager_.BeginTransaction();
+  for (int32_t key = 0; key < 100; key++) first_run.push_back(Insert(txn, &table, key));
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  txn = txn_manager_.BeginTransaction();
+  for (uint32_t i = 0; i < 10; i++) Update(txn, &table, first_run[i], -1);
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  // Records of a transaction that never ends stay in the log for good
+  auto *unfinished = txn_manager_.BeginTransaction();
+  for (int32_t key = 1000; key < 2000; key++) Insert(unfinished, &table, key);
+  log_manager_.Shutdown();
+
+  storage::SqlTable restarted(&block_store_, schema_, catalog::table_oid_t(1));
+  std::unordered_map<storage::TupleSlot, storage::TupleSlot> slot_map;
+  storage::RecoveryManager recovery_manager(LogFilePaths(), &recovery_txn_manager_);
+  EXPECT_EQ(2, recovery_manager.Recover({&restarted}, &slot_map));
+  ExpectRecovered(&table, first_run, &restarted, slot_map);
+
+  // The restarted run appends to the same log, and checkpoints the recovered table before changing it
+  storage::LogManager restarted_log_manager(LOG_FILE_NAME, &buffer_pool_, LogOptions());
+  transaction::TransactionManager restarted_txn_manager(&buffer_pool_, true, &restarted_log_manager);
+  storage::GarbageCollector restarted_gc(&restarted_txn_manager);
+  restarted_txn_manager.AdvanceTimestampsPast(recovery_manager.NewestTimestamp());
+  storage::CheckpointManager checkpoint_manager(CHECKPOINT_DIR, &restarted_txn_manager);
+  restarted_log_manager.Start();
+  const transaction::timestamp_t checkpoint_time = checkpoint_manager.Checkpoint({{&restarted, &schema_}});
+  EXPECT_LT(recovery_manager.NewestTimestamp(), checkpoint_time);
+  std::vector<storage::TupleSlot> second_run;
+  for (const storage::TupleSlot slot : first_run) second_run.push_back(slot_map.at(slot));
+  txn = restarted_txn_manager.BeginTransaction();
+  for (uint32_t i = 0; i < 100; i += 10) Update(txn, &restarted, second_run[i], i * 1000);
+  for (int32_t key = 100; key < 150; key++) second_run.push_back(Insert(txn, &restarted, key));
+  restarted_txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  restarted_log_manager.Shutdown();
+
+  storage::SqlTable recovered(&block_store_, schema_, catalog::table_oid_t(1));
+  std::unordered_map<storage::TupleSlot, storage::TupleSlot> second_slot_map;
+  storage::CheckpointManager recovery_checkpoint_manager(CHECKPOINT_DIR, &recovery_txn_manager_);
+  EXPECT_EQ(checkpoint_time, recovery_checkpoint_manager.Recover(CatalogTestUtil::test_db_oid,
+                                                                 {{&recovered, &schema_}}, &second_slot_map));
+  storage::RecoveryManager second_recovery_manager(LogFilePaths(), &recovery_txn_manager_);
+  EXPECT_EQ(1, second_recovery_manager.Recover({&recovered}, &second_slot_map, checkpoint_time));
+  EXPECT_EQ(second_run.size(), second_slot_map.size());
+  ExpectRecovered(&restarted, second_run, &recovered, second_slot_map, &restarted_txn_manager);
+
+  RemoveCheckpoints();
+  txn_manager_.Abort(unfinished);
+  restarted_gc.PerformGarbageCollection();
+  restarted_gc.PerformGarbageCollection();
+  RunGC();
+}
+
+// Logs tuples with varlen values, both inlined and not, and checks that replaying the log recreates their contents
+// after the original table is gone
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, ReplayVarlenLog) {
+  const catalog::col_oid_t name_oid(3);
+  const catalog::Schema schema({{"key", type::TypeId::INTEGER, false, key_oid_},
+                                {"name", type::TypeId::VARCHAR, 100, true, name_oid}});
+  auto name = [](const int32_t key, const uint32_t version) {
+    return std::string(static_cast<uint32_t>(key) % 30, static_cast<char>('a' + (key + version) % 26));
+  };
+  // Inserts or updates a tuple with the name of the given key and version
+  auto write = [&](transaction::TransactionContext *txn, storage::SqlTable *table, const storage::TupleSlot slot,
+                   const int32_t key, const uint32_t version) {
+    auto initializer = slot == storage::TupleSlot(nullptr, 0) ? table->InitializerForProjectedRow({key_oid_, name_oid})
+                                                               : table->InitializerForProjectedRow({name_oid});
+    storage::RedoRecord *redo = txn->StageWrite(CatalogTestUtil::test_db_oid, table->Oid(), initializer.first);
+    const std::string value = name(key, version);
+    const auto size = static_cast<uint32_t>(value.size());
+    auto *entry =
+        reinterpret_cast<storage::VarlenEntry *>(redo->Delta()->AccessForceNotNull(initializer.second[name_oid]));
+    if (size <= storage::VarlenEntry::InlineThreshold()) {
+      *entry = storage::VarlenEntry::CreateInline(reinterpret_cast<const byte *>(value.data()), size);
+    } else {
+      byte *content = common::AllocationUtil::AllocateAligned(size);
+      std::memcpy(content, value.data(), size);
+      *entry = storage::VarlenEntry::Create(content, size, true);
+    }
+    if (slot != storage::TupleSlot(nullptr, 0)) {
+      redo->SetTupleSlot(slot);
+      EXPECT_TRUE(table->Update(txn, redo));
+      return slot;
+    }
+    *reinterpret_cast<int32_t *>(redo->Delta()->AccessForceNotNull(initializer.second[key_oid_])) = key;
+    table->Insert(txn, redo);
+    return redo->GetTupleSlot();
+  };
+
+  std::vector<storage::TupleSlot> live;
+  std::unordered_map<int32_t, uint32_t> versions;
+  {
+    storage::SqlTable table(&block_store_, schema, catalog::table_oid_t(1));
+    log_manager_.Start();
+    auto *txn = txn_manager_.BeginTransaction();
+    for (int32_t key = 0; key < 100; key++) live.push_back(write(txn, &table, storage::TupleSlot(nullptr, 0), key, 0));
+    txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    txn = txn_manager_.BeginTransaction();
+    for (int32_t key = 0; key < 100; key += 3) write(txn, &table, live[key], key, versions[key] = 1);
+    txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    log_manager_.Shutdown();
+    RunGC();
+  }
+
+  storage::SqlTable recovered(&block_store_, schema, catalog::table_oid_t(1));
+  std::unordered_map<storage::TupleSlot, storage::TupleSlot> slot_map;
+  storage::RecoveryManager recovery_manager(LogFilePaths(), &recovery_txn_manager_, 2);
+  EXPECT_EQ(2, recovery_manager.Recover({&recovered}, &slot_map));
+  EXPECT_EQ(live.size(), slot_map.size());
+  auto initializer = recovered.InitializerForProjectedRow({key_oid_, name_oid});
+  byte *buffer = common::AllocationUtil::AllocateAligned(initializer.first.ProjectedRowSize());
+  auto *txn = recovery_txn_manager_.BeginTransaction();
+  for (const storage::TupleSlot slot : live) {
+    storage::ProjectedRow *row = initializer.first.InitializeRow(buffer);
+    ASSERT_TRUE(recovered.Select(txn, slot_map.at(slot), row));
+    const int32_t key = *reinterpret_cast<int32_t *>(row->AccessWithNullCheck(initializer.second[key_oid_]));
+    const auto *entry =
+        reinterpret_cast<storage::VarlenEntry *>(row->AccessWithNullCheck(initializer.second[name_oid]));
+    ASSERT_NE(nullptr, entry);
+    EXPECT_EQ(name(key, versions[key]),
+              std::string(reinterpret_cast<const char *>(entry->Content()), entry->Size()));
+  }
+  recovery_txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  delete[] buffer;
+  RunGC();
+}
+}  // namespace terrier
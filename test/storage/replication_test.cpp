@@ -0,0 +1,261 @@
+#include <map>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+#include "storage/garbage_collector.h"
+#include "storage/replication/log_shipper.h"
+#include "storage/replication/replica_applier.h"
+#include "storage/write_ahead_log/log_manager.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
+#include "util/catalog_test_util.h"
+#include "util/test_harness.h"
+
+#define LOG_FILE_NAME "replication_test.log"
+#define SOCKET_PATH "replication_test.sock"
+
+namespace terrier {
+
+class ReplicationTests : public TerrierTest {
+ public:
+  void TearDown() override {
+    for (uint32_t i = 0; i < num_streams_; i++)
+      unlink(storage::LogManager::StreamFilePath(LOG_FILE_NAME, i, num_streams_).c_str());
+    unlink(SOCKET_PATH);
+    TerrierTest::TearDown();
+  }
+
+  storage::LogManagerOptions LogOptions() const {
+    storage::LogManagerOptions options;
+    options.num_streams_ = num_streams_;
+    return options;
+  }
+
+  storage::BlockStore block_store_{100, 100};
+  storage::RecordBufferSegmentPool buffer_pool_{10000, 10000};
+  const uint32_t num_streams_ = 2;
+  storage::LogManager log_manager_{LOG_FILE_NAME, &buffer_pool_, LogOptions()};
+  transaction::TransactionManager txn_manager_{&buffer_pool_, true, &log_manager_};
+  storage::GarbageCollector gc_{&txn_manager_};
+  // Changes applied to the replica are not logged again
+  transaction::TransactionManager replica_txn_manager_{&buffer_pool_, true, LOGGING_DISABLED};
+  storage::GarbageCollector replica_gc_{&replica_txn_manager_};
+  const catalog::col_oid_t key_oid_{1}, value_oid_{2};
+  const catalog::Schema schema_{
+      {{"key", type::TypeId::INTEGER, false, key_oid_}, {"value", type::TypeId::BIGINT, true, value_oid_}}};
+
+  storage::TupleSlot Insert(transaction::TransactionContext *txn, storage::SqlTable *table, const int32_t key,
+                            const int64_t value) {
+    auto initializer = table->InitializerForProjectedRow({key_oid_, value_oid_});
+    storage::RedoRecord *redo = txn->StageWrite(CatalogTestUtil::test_db_oid, table->Oid(), initializer.first);
+    *reinterpret_cast<int32_t *>(redo->Delta()->AccessForceNotNull(initializer.second[key_oid_])) = key;
+    *reinterpret_cast<int64_t *>(redo->Delta()->AccessForceNotNull(initializer.second[value_oid_])) = value;
+    table->Insert(txn, redo);
+    return redo->GetTupleSlot();
+  }
+
+  // Sets the value of the tuple, or to null if the value is negative
+  void Update(transaction::TransactionContext *txn, storage::SqlTable *table, const storage::TupleSlot slot,
+              const int64_t value) {
+    auto initializer = table->InitializerForProjectedRow({value_oid_});
+    storage::RedoRecord *redo = txn->StageWrite(CatalogTestUtil::test_db_oid, table->Oid(), initializer.first);
+    if (value < 0)
+      redo->Delta()->SetNull(0);
+    else
+      *reinterpret_cast<int64_t *>(redo->Delta()->AccessForceNotNull(0)) = value;
+    redo->SetTupleSlot(slot);
+    EXPECT_TRUE(table->Update(txn, redo));
+  }
+
+  void Delete(transaction::TransactionContext *txn, storage::SqlTable *table, const storage::TupleSlot slot) {
+    txn->StageDelete(CatalogTestUtil::test_db_oid, table->Oid(), slot);
+    EXPECT_TRUE(table->Delete(txn, slot));
+  }
+
+  // Returns the value of every tuple visible to the transaction by its key, with -1 standing for null
+  std::map<int32_t, int64_t> Contents(transaction::TransactionContext *txn, storage::SqlTable *table) {
+    auto initializer = table->InitializerForProjectedRow({key_oid_, value_oid_});
+    byte *buffer = common::AllocationUtil::AllocateAligned(initializer.first.ProjectedRowSize());
+    std::map<int32_t, int64_t> contents;
+    for (auto it = table->begin(); it != table->end(); it++) {
+      storage::ProjectedRow *row = initializer.first.InitializeRow(buffer);
+      if (!table->Select(txn, *it, row)) continue;
+      const byte *value = row->AccessWithNullCheck(initializer.second[value_oid_]);
+      contents[*reinterpret_cast<int32_t *>(row->AccessWithNullCheck(initializer.second[key_oid_]))] =
+          value == nullptr ? -1 : *reinterpret_cast<const int64_t *>(value);
+    }
+    delete[] buffer;
+    return contents;
+  }
+
+  void RunGC() {
+    gc_.PerformGarbageCollection();
+    gc_.PerformGarbageCollection();
+    replica_gc_.PerformGarbageCollection();
+    replica_gc_.PerformGarbageCollection();
+  }
+};
+
+// Ships inserts, updates and deletes to two tables, along with an aborted and an unfinished transaction, to a replica,
+// and checks that the replica ends up with exactly the committed state of both tables
+// NOLINTNEXTLINE
+TEST_F(ReplicationTests, ReplicateLog) {
+  storage::SqlTable table(&block_store_, schema_, catalog::table_oid_t(1));
+  storage::SqlTable other_table(&block_store_, schema_, catalog::table_oid_t(2));
+  storage::SqlTable replica(&block_store_, schema_, catalog::table_oid_t(1));
+  storage::SqlTable other_replica(&block_store_, schema_, catalog::table_oid_t(2));
+  storage::ReplicaApplier applier(SOCKET_PATH, {&replica, &other_replica}, &replica_txn_manager_);
+  auto shipper = std::make_unique<storage::LogShipper>(SOCKET_PATH);
+  log_manager_.RegisterLogShipper(shipper.get());
+  log_manager_.Start();
+
+  std::vector<storage::TupleSlot> live, other_live;
+  auto *txn = txn_manager_.BeginTransaction();
+  for (int32_t key = 0; key < 100; key++) live.push_back(Insert(txn, &table, key, key));
+  for (int32_t key = 0; key < 10; key++) other_live.push_back(Insert(txn, &other_table, key, key));
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  for (uint32_t i = 0; i < 30; i++) {
+    txn = txn_manager_.BeginTransaction();
+    Update(txn, &table, live[i % 10], i % 3 == 0 ? -1 : i * 1000);
+    txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  }
+  txn = txn_manager_.BeginTransaction();
+  for (uint32_t i = 90; i < 100; i++) Delete(txn, &table, live[i]);
+  Update(txn, &other_table, other_live[0], 42);
+  const transaction::timestamp_t last_commit =
+      txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Transactions large enough to hand some of their records to the log before they end
+  auto *aborted = txn_manager_.BeginTransaction();
+  for (int32_t key = 1000; key < 2000; key++) Insert(aborted, &table, key, key);
+  txn_manager_.Abort(aborted);
+  auto *unfinished = txn_manager_.BeginTransaction();
+  for (int32_t key = 2000; key < 3000; key++) Insert(unfinished, &table, key, key);
+  log_manager_.Shutdown();
+  // The replica applies everything it was shipped once the primary disconnects
+  shipper.reset();
+  EXPECT_TRUE(applier.WaitForVisible(last_commit));
+  EXPECT_EQ(32, applier.NumApplied());
+
+  txn = txn_manager_.BeginTransaction();
+  auto *replica_txn = replica_txn_manager_.BeginTransaction();
+  const std::map<int32_t, int64_t> expected = Contents(txn, &table);
+  EXPECT_EQ(90, expected.size());
+  EXPECT_EQ(expected, Contents(replica_txn, &replica));
+  const std::map<int32_t, int64_t> other_expected = Contents(txn, &other_table);
+  EXPECT_EQ(42, other_expected.at(0));
+  EXPECT_EQ(other_expected, Contents(replica_txn, &other_replica));
+  // The log manager is shut down by now, so the primary transactions must not commit
+  txn_manager_.Abort(txn);
+  txn_manager_.Abort(unfinished);
+  replica_txn_manager_.Commit(replica_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  applier.Stop();
+  RunGC();
+}
+
+// Transfers amounts between accounts on the primary while transactions on the replica keep reading all accounts, and
+// checks that every replica transaction sees a consistent snapshot, in which the amounts add up
+// NOLINTNEXTLINE
+TEST_F(ReplicationTests, ConsistentSnapshots) {
+  const int32_t num_accounts = 10;
+  const int64_t initial_amount = 1000000;
+  storage::SqlTable table(&block_store_, schema_, catalog::table_oid_t(1));
+  storage::SqlTable replica(&block_store_, schema_, catalog::table_oid_t(1));
+  storage::ReplicaApplier applier(SOCKET_PATH, {&replica}, &replica_txn_manager_);
+  auto shipper = std::make_unique<storage::LogShipper>(SOCKET_PATH);
+  log_manager_.RegisterLogShipper(shipper.get());
+  log_manager_.Start();
+
+  std::vector<storage::TupleSlot> accounts;
+  auto *txn = txn_manager_.BeginTransaction();
+  for (int32_t key = 0; key < num_accounts; key++) accounts.push_back(Insert(txn, &table, key, initial_amount));
+  txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  std::atomic<bool> done = false;
+  transaction::timestamp_t last_commit;
+  std::thread primary([&] {
+    auto initializer = table.InitializerForProjectedRow({value_oid_});
+    byte *buffer = common::AllocationUtil::AllocateAligned(initializer.first.ProjectedRowSize());
+    auto amount = [&](transaction::TransactionContext *txn, const storage::TupleSlot slot) {
+      storage::ProjectedRow *row = initializer.first.InitializeRow(buffer);
+      EXPECT_TRUE(table.Select(txn, slot, row));
+      return *reinterpret_cast<int64_t *>(row->AccessWithNullCheck(0));
+    };
+    for (uint32_t i = 0; i < 2000; i++) {
+      const storage::TupleSlot from = accounts[i % num_accounts], to = accounts[(i * 7 + 3) % num_accounts];
+      if (from == to) continue;
+      auto *txn = txn_manager_.BeginTransaction();
+      const int64_t moved = i % 5 + 1;
+      Update(txn, &table, from, amount(txn, from) - moved);
+      Update(txn, &table, to, amount(txn, to) + moved);
+      last_commit = txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    }
+    delete[] buffer;
+    done = true;
+  });
+
+  // Until the accounts are created on the replica, its transactions see none of them
+  bool consistent = true;
+  while (!done && consistent) {
+    auto *replica_txn = replica_txn_manager_.BeginTransaction();
+    const std::map<int32_t, int64_t> contents = Contents(replica_txn, &replica);
+    replica_txn_manager_.Commit(replica_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    int64_t total = 0;
+    for (const auto &account : contents) total += account.second;
+    consistent = contents.empty() || (contents.size() == num_accounts && total == num_accounts * initial_amount);
+  }
+  primary.join();
+  EXPECT_TRUE(consistent);
+  log_manager_.Shutdown();
+  shipper.reset();
+  EXPECT_TRUE(applier.WaitForVisible(last_commit));
+
+  txn = txn_manager_.BeginTransaction();
+  auto *replica_txn = replica_txn_manager_.BeginTransaction();
+  EXPECT_EQ(Contents(txn, &table), Contents(replica_txn, &replica));
+  txn_manager_.Abort(txn);
+  replica_txn_manager_.Commit(replica_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  applier.Stop();
+  RunGC();
+}
+
+// Ships writes to a table the replica does not hold, and checks that the replica stops replicating at the last
+// transaction it could apply instead of skipping them
+// NOLINTNEXTLINE
+TEST_F(ReplicationTests, UnknownTable) {
+  storage::SqlTable table(&block_store_, schema_, catalog::table_oid_t(1));
+  storage::SqlTable other_table(&block_store_, schema_, catalog::table_oid_t(2));
+  storage::SqlTable replica(&block_store_, schema_, catalog::table_oid_t(1));
+  storage::ReplicaApplier applier(SOCKET_PATH, {&replica}, &replica_txn_manager_);
+  auto shipper = std::make_unique<storage::LogShipper>(SOCKET_PATH);
+  log_manager_.RegisterLogShipper(shipper.get());
+  log_manager_.Start();
+
+  auto *txn = txn_manager_.BeginTransaction();
+  for (int32_t key = 0; key < 10; key++) Insert(txn, &table, key, key);
+  const transaction::timestamp_t first_commit =
+      txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  EXPECT_TRUE(applier.WaitForVisible(first_commit));
+
+  txn = txn_manager_.BeginTransaction();
+  Insert(txn, &table, 10, 10);
+  Insert(txn, &other_table, 0, 0);
+  const transaction::timestamp_t second_commit =
+      txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  txn = txn_manager_.BeginTransaction();
+  Insert(txn, &table, 11, 11);
+  const transaction::timestamp_t third_commit =
+      txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  log_manager_.Shutdown();
+  shipper.reset();
+  EXPECT_FALSE(applier.WaitForVisible(second_commit));
+  EXPECT_FALSE(applier.WaitForVisible(third_commit));
+  EXPECT_EQ(1, applier.NumApplied());
+
+  auto *replica_txn = replica_txn_manager_.BeginTransaction();
+  EXPECT_EQ(10, Contents(replica_txn, &replica).size());
+  replica_txn_manager_.Commit(replica_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  applier.Stop();
+  RunGC();
+}
+}  // namespace terrier
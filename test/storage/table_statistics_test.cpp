@@ -0,0 +1,116 @@
+#include "storage/table_statistics.h"
+#include <vector>
+#include "storage/data_table.h"
+#include "storage/garbage_collector.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
+#include "util/storage_test_util.h"
+#include "util/test_harness.h"
+#include "util/transaction_test_util.h"
+
+namespace terrier {
+class TableStatisticsTests : public TerrierTest {
+ public:
+  storage::BlockStore block_store_{100, 100};
+  storage::RecordBufferSegmentPool buffer_pool_{10000, 10000};
+  const storage::BlockLayout layout_{{8, 8, 8}};
+  const storage::col_id_t key_col_{1}, value_col_{2};
+  std::vector<byte *> loose_pointers_;
+
+  void TearDown() override {
+    for (byte *ptr : loose_pointers_) delete[] ptr;
+    TerrierTest::TearDown();
+  }
+
+  // Generates a row that writes the given value to the given columns. A null value pointer means SQL null.
+  storage::ProjectedRow *Row(const std::vector<storage::col_id_t> &col_ids, const std::vector<const int64_t *> &vals) {
+    auto initializer = storage::ProjectedRowInitializer::Create(layout_, col_ids);
+    byte *buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+    loose_pointers_.push_back(buffer);
+    storage::ProjectedRow *row = initializer.InitializeRow(buffer);
+    for (uint16_t i = 0; i < row->NumColumns(); i++) {
+      for (uint16_t j = 0; j < col_ids.size(); j++) {
+        if (row->ColumnIds()[i] != col_ids[j]) continue;
+        if (vals[j] == nullptr)
+          row->SetNull(i);
+        else
+          *reinterpret_cast<int64_t *>(row->AccessForceNotNull(i)) = *vals[j];
+      }
+    }
+    return row;
+  }
+};
+
+// Runs inserts, updates, deletes and aborts through the transaction manager and checks that the table statistics
+// reflect exactly the committed changes
+// NOLINTNEXTLINE
+TEST_F(TableStatisticsTests, MaintainedOnCommit) {
+  transaction::TransactionManager txn_manager(&buffer_pool_, true, LOGGING_DISABLED);
+  storage::DataTable table(&block_store_, layout_, storage::layout_version_t(0), true);
+  EXPECT_TRUE(table.CollectsStatistics());
+  EXPECT_FALSE(storage::DataTable(&block_store_, layout_, storage::layout_version_t(0)).CollectsStatistics());
+  storage::GarbageCollector gc(&txn_manager);
+  const storage::TableStatistics &stats = table.GetTableStatistics();
+  EXPECT_EQ(0, stats.NumTuples());
+  EXPECT_FALSE(stats.GetColumnStatistics(key_col_).HasMinMax());
+
+  // Insert 100 tuples, with a null value in every other one and 5 distinct non-null values
+  const int64_t num_tuples = 100;
+  std::vector<storage::TupleSlot> slots;
+  auto *txn = txn_manager.BeginTransaction();
+  for (int64_t i = 0; i < num_tuples; i++) {
+    const int64_t value = i % 10;
+    slots.push_back(table.Insert(txn, *Row({key_col_, value_col_}, {&i, i % 2 == 0 ? nullptr : &value})));
+  }
+  // Nothing is visible until commit
+  EXPECT_EQ(0, stats.NumTuples());
+  txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  EXPECT_EQ(num_tuples, stats.NumTuples());
+  EXPECT_EQ(0, stats.GetColumnStatistics(key_col_).NullCount());
+  EXPECT_NEAR(num_tuples, stats.GetColumnStatistics(key_col_).DistinctValues(), 5);
+  EXPECT_TRUE(stats.GetColumnStatistics(key_col_).HasMinMax());
+  EXPECT_EQ(0, stats.GetColumnStatistics(key_col_).Min());
+  EXPECT_EQ(num_tuples - 1, stats.GetColumnStatistics(key_col_).Max());
+  EXPECT_EQ(num_tuples / 2, stats.GetColumnStatistics(value_col_).NullCount());
+  EXPECT_EQ(5, stats.GetColumnStatistics(value_col_).DistinctValues());
+  EXPECT_EQ(1, stats.GetColumnStatistics(value_col_).Min());
+  EXPECT_EQ(9, stats.GetColumnStatistics(value_col_).Max());
+
+  // Update the same tuples multiple times in a transaction, only the net effect should count
+  const int64_t five = 5, six = 6, seven = 7;
+  txn = txn_manager.BeginTransaction();
+  EXPECT_TRUE(table.Update(txn, slots[0], *Row({value_col_}, {&seven})));
+  EXPECT_TRUE(table.Update(txn, slots[0], *Row({value_col_}, {nullptr})));
+  EXPECT_TRUE(table.Update(txn, slots[2], *Row({value_col_}, {&five})));
+  EXPECT_TRUE(table.Update(txn, slots[2], *Row({value_col_}, {&six})));
+  EXPECT_TRUE(table.Update(txn, slots[1], *Row({value_col_}, {nullptr})));
+  txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  EXPECT_EQ(num_tuples, stats.NumTuples());
+  EXPECT_EQ(num_tuples / 2, stats.GetColumnStatistics(value_col_).NullCount());
+
+  // Deletes remove the before-image of the tuple, even when it was updated in the same transaction
+  txn = txn_manager.BeginTransaction();
+  EXPECT_TRUE(table.Update(txn, slots[3], *Row({value_col_}, {nullptr})));
+  EXPECT_TRUE(table.Delete(txn, slots[3]));
+  EXPECT_TRUE(table.Delete(txn, slots[4]));
+  txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  EXPECT_EQ(num_tuples - 2, stats.NumTuples());
+  EXPECT_EQ(num_tuples / 2 - 1, stats.GetColumnStatistics(value_col_).NullCount());
+
+  // Aborted transactions and tuples that were inserted and deleted by the same transaction leave no trace
+  const int64_t large = 1000;
+  txn = txn_manager.BeginTransaction();
+  table.Insert(txn, *Row({key_col_, value_col_}, {&large, nullptr}));
+  txn_manager.Abort(txn);
+  txn = txn_manager.BeginTransaction();
+  storage::TupleSlot slot = table.Insert(txn, *Row({key_col_, value_col_}, {&large, nullptr}));
+  EXPECT_TRUE(table.Delete(txn, slot));
+  txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  EXPECT_EQ(num_tuples - 2, stats.NumTuples());
+  EXPECT_EQ(num_tuples / 2 - 1, stats.GetColumnStatistics(value_col_).NullCount());
+  EXPECT_EQ(num_tuples - 1, stats.GetColumnStatistics(key_col_).Max());
+
+  gc.PerformGarbageCollection();
+  gc.PerformGarbageCollection();
+}
+}  // namespace terrier
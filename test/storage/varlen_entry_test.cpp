@@ -60,4 +60,40 @@ TEST(VarlenEntryTests, StringView) {
   EXPECT_EQ(non_inlined_string_view, not_hello_world);
   delete[] large_buffer;
 }
+
+// Tests that comparisons of varlen entries give the correct answer both when they can be decided on the inlined prefix
+// and when they have to look at the out-of-line content, including when the content is shared between entries.
+// NOLINTNEXTLINE
+TEST(VarlenEntryTests, Comparisons) {
+  std::string lhs_string = "this is a long string that is not inlined: aaaa";
+  std::string rhs_string = "this is a long string that is not inlined: aaab";
+  std::string other_prefix = "that is a long string that is not inlined: aaaa";
+  auto make_entry = [](std::string *str) {
+    return storage::VarlenEntry::Create(reinterpret_cast<byte *>(str->data()), static_cast<uint32_t>(str->length()),
+                                        false);
+  };
+  const storage::VarlenEntry lhs = make_entry(&lhs_string), rhs = make_entry(&rhs_string),
+                             other = make_entry(&other_prefix);
+  // An entry copied around still refers to the same content
+  const storage::VarlenEntry lhs_copy = lhs;
+
+  storage::VarlenContentDeepEqual equal;
+  storage::VarlenContentCompare less;
+  EXPECT_TRUE(equal(lhs, lhs_copy));
+  EXPECT_FALSE(equal(lhs, rhs));
+  EXPECT_FALSE(equal(lhs, other));
+  EXPECT_TRUE(less(lhs, rhs));
+  EXPECT_FALSE(less(rhs, lhs));
+  EXPECT_TRUE(less(other, lhs));
+  EXPECT_FALSE(less(lhs, other));
+  EXPECT_FALSE(less(lhs, lhs_copy));
+
+  // Shorter values and inlined values still compare correctly against out-of-line ones
+  std::string short_string = "this";
+  const auto inlined = storage::VarlenEntry::CreateInline(reinterpret_cast<byte *>(short_string.data()),
+                                                          static_cast<uint32_t>(short_string.length()));
+  EXPECT_FALSE(equal(inlined, lhs));
+  EXPECT_TRUE(less(inlined, lhs));
+  EXPECT_FALSE(less(lhs, inlined));
+}
 }  // namespace terrier
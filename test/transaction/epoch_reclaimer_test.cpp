@@ -0,0 +1,70 @@
+#include <atomic>
+#include "common/worker_pool.h"
+#include "transaction/epoch_reclaimer.h"
+#include "transaction/timestamp_allocator.h"
+#include "util/multithread_test_util.h"
+#include "util/test_harness.h"
+
+namespace terrier {
+
+class EpochReclaimerTests : public TerrierTest {
+ public:
+  // Runs everything that is safe to run, closing the visible epoch if anything waits for it
+  uint32_t CollectAndReclaim() {
+    if (reclaimer_.Collect() > allocator_.OldestStartTimestamp()) allocator_.Advance();
+    return reclaimer_.Reclaim(allocator_.OldestStartTimestamp());
+  }
+
+  transaction::TimestampAllocator allocator_;
+  transaction::EpochReclaimer reclaimer_;
+};
+
+// Checks that a retired action waits for a transaction that was running when it was retired, but not for the
+// transactions that begin later
+// NOLINTNEXTLINE
+TEST_F(EpochReclaimerTests, WaitsForRunningTransactions) {
+  uint32_t num_run = 0;
+  const transaction::timestamp_t running = allocator_.StartTimestamp();
+  reclaimer_.Retire(allocator_.RetireTimestamp(), [&] { num_run++; });
+  EXPECT_EQ(0, reclaimer_.Reclaim(allocator_.OldestStartTimestamp()));
+
+  EXPECT_LT(allocator_.OldestStartTimestamp(), reclaimer_.Collect());
+  EXPECT_EQ(0, reclaimer_.Reclaim(running));
+  allocator_.Advance();
+  const transaction::timestamp_t later = allocator_.StartTimestamp();
+  EXPECT_EQ(0, reclaimer_.Reclaim(running));
+  EXPECT_EQ(0, num_run);
+
+  EXPECT_EQ(1, reclaimer_.Reclaim(later));
+  EXPECT_EQ(1, num_run);
+  EXPECT_EQ(transaction::timestamp_t(0), reclaimer_.Collect());
+  EXPECT_EQ(0, reclaimer_.Reclaim(later));
+}
+
+// Retires actions from concurrent threads, some of which retire further actions when run, while one thread keeps
+// reclaiming, and checks that every action runs exactly once
+// NOLINTNEXTLINE
+TEST_F(EpochReclaimerTests, ConcurrentRetire) {
+  const uint32_t num_threads = 8, num_actions = 1000;
+  std::atomic<uint32_t> num_run{0};
+  auto workload = [&](uint32_t id) {
+    for (uint32_t i = 0; i < num_actions; i++) {
+      if (i % 2 == 0) {
+        reclaimer_.Retire(allocator_.RetireTimestamp(), [&] { num_run++; });
+      } else {
+        reclaimer_.Retire(allocator_.RetireTimestamp(), [&] {
+          num_run++;
+          reclaimer_.Retire(allocator_.RetireTimestamp(), [&] { num_run++; });
+        });
+      }
+      if (id == 0) CollectAndReclaim();
+    }
+  };
+  common::WorkerPool thread_pool(num_threads, {});
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads, workload);
+
+  while (CollectAndReclaim() != 0) {
+  }
+  EXPECT_EQ(num_threads * num_actions * 3 / 2, num_run.load());
+}
+}  // namespace terrier
@@ -0,0 +1,138 @@
+#include <array>
+#include <utility>
+#include "common/worker_pool.h"
+#include "storage/data_table.h"
+#include "storage/garbage_collector.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
+#include "util/multithread_test_util.h"
+#include "util/storage_test_util.h"
+#include "util/test_harness.h"
+
+namespace terrier {
+
+class ReadOnlyTransactionTests : public TerrierTest {
+ public:
+  void SetUp() override {
+    TerrierTest::SetUp();
+    for (auto &buffer : buffers_) buffer = common::AllocationUtil::AllocateAligned(initializer_.ProjectedRowSize());
+  }
+
+  void TearDown() override {
+    for (auto *buffer : buffers_) delete[] buffer;
+    TerrierTest::TearDown();
+  }
+
+  storage::ProjectedRow *Row(const uint32_t index, const int64_t value) {
+    storage::ProjectedRow *row = initializer_.InitializeRow(buffers_[index]);
+    *reinterpret_cast<int64_t *>(row->AccessForceNotNull(0)) = value;
+    return row;
+  }
+
+  // Returns the value of the tuple visible to the transaction given, or -1 if there is none
+  int64_t Read(storage::DataTable *const table, transaction::TransactionContext *const txn,
+               const storage::TupleSlot slot) {
+    storage::ProjectedRow *row = initializer_.InitializeRow(buffers_[2]);
+    if (!table->Select(txn, slot, row)) return -1;
+    return *reinterpret_cast<int64_t *>(row->AccessWithNullCheck(0));
+  }
+
+  const storage::BlockLayout layout_{{8, 8}};
+  const storage::ProjectedRowInitializer initializer_ =
+      storage::ProjectedRowInitializer::Create(layout_, StorageTestUtil::ProjectionListAllColumns(layout_));
+  storage::BlockStore block_store_{100, 100};
+  storage::RecordBufferSegmentPool buffer_pool_{10000, 10000};
+  std::array<byte *, 3> buffers_;
+};
+
+// A read-only transaction reads the snapshot it began with, and the GC keeps that snapshot around for as long as the
+// transaction runs without ever being handed the transaction itself
+// NOLINTNEXTLINE
+TEST_F(ReadOnlyTransactionTests, KeepsSnapshot) {
+  storage::DataTable table(&block_store_, layout_, storage::layout_version_t(0));
+  transaction::TransactionManager txn_manager(&buffer_pool_, true, LOGGING_DISABLED);
+  storage::GarbageCollector gc(&txn_manager);
+
+  auto *txn0 = txn_manager.BeginTransaction();
+  const storage::TupleSlot slot = table.Insert(txn0, *Row(0, 0));
+  txn_manager.Commit(txn0, transaction::TransactionUtil::EmptyCallback, nullptr);
+  EXPECT_EQ(std::make_pair(0u, 1u), gc.PerformGarbageCollection());
+  EXPECT_EQ(std::make_pair(1u, 0u), gc.PerformGarbageCollection());
+
+  auto *reader = txn_manager.BeginReadOnlyTransaction();
+  EXPECT_TRUE(reader->IsReadOnly());
+  EXPECT_EQ(0, Read(&table, reader, slot));
+
+  auto *txn1 = txn_manager.BeginTransaction();
+  EXPECT_FALSE(txn1->IsReadOnly());
+  EXPECT_TRUE(table.Update(txn1, slot, *Row(1, 1)));
+  txn_manager.Commit(txn1, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // The update cannot be unlinked while the reader runs
+  for (uint32_t i = 0; i < 3; i++) {
+    EXPECT_EQ(std::make_pair(0u, 0u), gc.PerformGarbageCollection());
+    EXPECT_EQ(0, Read(&table, reader, slot));
+  }
+
+  auto *later_reader = txn_manager.BeginReadOnlyTransaction();
+  EXPECT_EQ(1, Read(&table, later_reader, slot));
+  EXPECT_EQ(0, Read(&table, reader, slot));
+
+  bool committed = false;
+  reader->RegisterCommitAction([&] { committed = true; });
+  txn_manager.Commit(reader, transaction::TransactionUtil::EmptyCallback, nullptr);
+  EXPECT_TRUE(committed);
+  txn_manager.Abort(later_reader);
+
+  // Only the update is collected
+  EXPECT_EQ(std::make_pair(0u, 1u), gc.PerformGarbageCollection());
+  EXPECT_EQ(std::make_pair(1u, 0u), gc.PerformGarbageCollection());
+  EXPECT_EQ(std::make_pair(0u, 0u), gc.PerformGarbageCollection());
+}
+
+// Read-only transactions of concurrent threads always read a committed value, which never goes back in time within a
+// thread, while another thread keeps updating the tuple and the GC keeps collecting the old versions
+// NOLINTNEXTLINE
+TEST_F(ReadOnlyTransactionTests, ConcurrentSnapshots) {
+  const uint32_t num_threads = 4, num_txns = 2000;
+  storage::DataTable table(&block_store_, layout_, storage::layout_version_t(0));
+  transaction::TransactionManager txn_manager(&buffer_pool_, true, LOGGING_DISABLED);
+  storage::GarbageCollector gc(&txn_manager);
+
+  auto *txn0 = txn_manager.BeginTransaction();
+  const storage::TupleSlot slot = table.Insert(txn0, *Row(0, 0));
+  txn_manager.Commit(txn0, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  auto workload = [&](uint32_t id) {
+    if (id == 0) {
+      for (uint32_t i = 1; i <= num_txns; i++) {
+        auto *txn = txn_manager.BeginTransaction();
+        EXPECT_TRUE(table.Update(txn, slot, *Row(1, i)));
+        txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+        if (i % 10 == 0) gc.PerformGarbageCollection();
+      }
+      return;
+    }
+    // Each reader thread needs its own select buffer
+    byte *const buffer = common::AllocationUtil::AllocateAligned(initializer_.ProjectedRowSize());
+    int64_t last = 0;
+    for (uint32_t i = 0; i < num_txns; i++) {
+      auto *txn = txn_manager.BeginReadOnlyTransaction();
+      storage::ProjectedRow *row = initializer_.InitializeRow(buffer);
+      EXPECT_TRUE(table.Select(txn, slot, row));
+      const int64_t value = *reinterpret_cast<int64_t *>(row->AccessWithNullCheck(0));
+      EXPECT_LE(last, value);
+      EXPECT_GE(static_cast<int64_t>(num_txns), value);
+      last = value;
+      txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    }
+    delete[] buffer;
+  };
+  common::WorkerPool thread_pool(num_threads, {});
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads, workload);
+
+  while (gc.PerformGarbageCollection() != std::make_pair(0u, 0u)) {
+  }
+  gc.PerformGarbageCollection();
+}
+}  // namespace terrier
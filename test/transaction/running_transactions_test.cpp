@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <vector>
+#include "common/worker_pool.h"
+#include "transaction/running_transactions.h"
+#include "transaction/timestamp_allocator.h"
+#include "util/multithread_test_util.h"
+#include "util/test_harness.h"
+
+namespace terrier {
+
+class RunningTransactionsTests : public TerrierTest {
+ public:
+  const uint32_t num_threads_ = 8;
+  transaction::TimestampAllocator allocator_;
+  transaction::RunningTransactions running_;
+};
+
+// Registers and unregisters transactions from concurrent threads, each of which keeps its oldest transaction running
+// until the end, and checks that the oldest of those is always reported
+// NOLINTNEXTLINE
+TEST_F(RunningTransactionsTests, OldestRunning) {
+  const uint32_t num_txns = 2000;
+  const transaction::timestamp_t none_running = transaction::timestamp_t(UINT64_MAX);
+  EXPECT_EQ(none_running, running_.Oldest(none_running));
+
+  std::vector<transaction::timestamp_t> first(num_threads_);
+  for (uint32_t id = 0; id < num_threads_; id++) {
+    first[id] = allocator_.StartTimestamp();
+    running_.Add(first[id]);
+  }
+  const transaction::timestamp_t oldest = *std::min_element(first.begin(), first.end());
+
+  auto workload = [&](uint32_t id) {
+    std::vector<transaction::timestamp_t> started;
+    for (uint32_t i = 0; i < num_txns; i++) {
+      started.push_back(allocator_.StartTimestamp());
+      running_.Add(started.back());
+      EXPECT_EQ(oldest, running_.Oldest(none_running));
+      // Finish transactions in a different order than they started in
+      if (i % 3 == 2) {
+        running_.Remove(started[started.size() - 2], nullptr);
+        started.erase(started.end() - 2);
+      }
+    }
+    for (const transaction::timestamp_t start_time : started) running_.Remove(start_time, nullptr);
+  };
+  common::WorkerPool thread_pool(num_threads_, {});
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+
+  EXPECT_EQ(oldest, running_.Oldest(none_running));
+  EXPECT_EQ(transaction::timestamp_t(0), running_.Oldest(transaction::timestamp_t(0)));
+  for (const transaction::timestamp_t start_time : first) running_.Remove(start_time, nullptr);
+  EXPECT_EQ(none_running, running_.Oldest(none_running));
+  EXPECT_TRUE(running_.TakeCompleted().empty());
+}
+}  // namespace terrier
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <vector>
+#include "common/worker_pool.h"
+#include "transaction/timestamp_allocator.h"
+#include "util/multithread_test_util.h"
+#include "util/test_harness.h"
+
+namespace terrier {
+
+class TimestampAllocatorTests : public TerrierTest {
+ public:
+  const uint32_t num_threads_ = 8;
+  transaction::TimestampAllocator allocator_;
+};
+
+// Hands out more start timestamps than fit into the lanes of one epoch from concurrent threads, some of which commit
+// in between, and checks that no start timestamp is handed out twice
+// NOLINTNEXTLINE
+TEST_F(TimestampAllocatorTests, UniqueStartTimestamps) {
+  const uint32_t num_starts = 5000;
+  std::vector<std::vector<transaction::timestamp_t>> starts(num_threads_);
+  auto workload = [&](uint32_t id) {
+    for (uint32_t i = 0; i < num_starts; i++) {
+      starts[id].push_back(allocator_.StartTimestamp());
+      if (id % 2 == 0 && i % 100 == 0) allocator_.Advance();
+    }
+  };
+  common::WorkerPool thread_pool(num_threads_, {});
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+
+  std::vector<transaction::timestamp_t> all;
+  for (auto &thread_starts : starts) all.insert(all.end(), thread_starts.begin(), thread_starts.end());
+  std::sort(all.begin(), all.end());
+  EXPECT_EQ(num_threads_ * num_starts, all.size());
+  EXPECT_EQ(all.end(), std::adjacent_find(all.begin(), all.end()));
+}
+
+// Commits from concurrent threads, and checks that every commit timestamp lies between the start timestamps handed
+// out before the commit joined its group and those handed out after the commit finished
+// NOLINTNEXTLINE
+TEST_F(TimestampAllocatorTests, CommitGroupOrder) {
+  const uint32_t num_commits = 2000;
+  auto workload = [&](uint32_t id) {
+    for (uint32_t i = 0; i < num_commits; i++) {
+      const transaction::timestamp_t before = allocator_.StartTimestamp();
+      EXPECT_LE(transaction::TimestampAllocator::SnapshotTimestamp(before), before);
+      const transaction::timestamp_t commit_time = allocator_.JoinCommit();
+      EXPECT_LT(before, commit_time);
+      allocator_.FinishCommit(commit_time);
+      EXPECT_LT(commit_time, allocator_.OldestStartTimestamp());
+      const transaction::timestamp_t after = allocator_.StartTimestamp();
+      EXPECT_LT(commit_time, after);
+      EXPECT_LE(commit_time, transaction::TimestampAllocator::SnapshotTimestamp(after));
+    }
+  };
+  common::WorkerPool thread_pool(num_threads_, {});
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+}
+
+// Moves a fresh allocator past the start and commit timestamps of another one, and checks that it only hands out
+// newer timestamps
+// NOLINTNEXTLINE
+TEST_F(TimestampAllocatorTests, AdvancePast) {
+  allocator_.StartTimestamp();
+  const transaction::timestamp_t start = allocator_.StartTimestamp();
+  const transaction::timestamp_t commit = allocator_.Advance();
+  for (const transaction::timestamp_t newest : {start, commit}) {
+    transaction::TimestampAllocator restarted;
+    restarted.AdvancePast(newest);
+    EXPECT_LT(newest, restarted.OldestStartTimestamp());
+    EXPECT_LT(newest, restarted.StartTimestamp());
+    EXPECT_LT(newest, restarted.Advance());
+    // Moving back is a no-op
+    const transaction::timestamp_t oldest = restarted.OldestStartTimestamp();
+    restarted.AdvancePast(transaction::timestamp_t(0));
+    EXPECT_EQ(oldest, restarted.OldestStartTimestamp());
+  }
+}
+}  // namespace terrier
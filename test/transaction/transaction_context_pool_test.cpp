@@ -0,0 +1,74 @@
+#include <utility>
+#include "storage/data_table.h"
+#include "storage/garbage_collector.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
+#include "util/storage_test_util.h"
+#include "util/test_harness.h"
+
+namespace terrier {
+
+class TransactionContextPoolTests : public TerrierTest {
+ public:
+  void SetUp() override {
+    TerrierTest::SetUp();
+    redo_buffer_ = common::AllocationUtil::AllocateAligned(initializer_.ProjectedRowSize());
+    redo_ = initializer_.InitializeRow(redo_buffer_);
+    StorageTestUtil::PopulateRandomRow(redo_, layout_, 0, &generator_);
+  }
+
+  void TearDown() override {
+    delete[] redo_buffer_;
+    TerrierTest::TearDown();
+  }
+
+  const storage::BlockLayout layout_{{8, 8}};
+  const storage::ProjectedRowInitializer initializer_ =
+      storage::ProjectedRowInitializer::Create(layout_, StorageTestUtil::ProjectionListAllColumns(layout_));
+  std::default_random_engine generator_;
+  storage::BlockStore block_store_{100, 100};
+  storage::RecordBufferSegmentPool buffer_pool_{10000, 10000};
+
+  byte *redo_buffer_;
+  storage::ProjectedRow *redo_;
+};
+
+// Frees a transaction through the GC, and checks that the next transaction of the same thread reuses its context
+// without inheriting anything from it
+// NOLINTNEXTLINE
+TEST_F(TransactionContextPoolTests, ReuseContext) {
+  storage::DataTable table(&block_store_, layout_, storage::layout_version_t(0));
+  transaction::TransactionManager txn_manager(&buffer_pool_, true, LOGGING_DISABLED);
+  storage::GarbageCollector gc(&txn_manager);
+
+  bool aborted = false;
+  auto *txn0 = txn_manager.BeginTransaction();
+  table.Insert(txn0, *redo_);
+  txn0->RegisterAbortAction([&] { aborted = true; });
+  const transaction::timestamp_t start_time = txn0->StartTime();
+  txn_manager.Commit(txn0, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Unlink the Insert's UndoRecord, then deallocate it on the next run
+  EXPECT_EQ(std::make_pair(0u, 1u), gc.PerformGarbageCollection());
+  EXPECT_EQ(std::make_pair(1u, 0u), gc.PerformGarbageCollection());
+
+  auto *txn1 = txn_manager.BeginTransaction();
+  EXPECT_EQ(txn0, txn1);
+  EXPECT_LT(start_time, txn1->StartTime());
+  EXPECT_FALSE(transaction::TransactionUtil::Committed(txn1->TxnId().load()));
+  txn_manager.Abort(txn1);
+  EXPECT_FALSE(aborted);
+
+  // Nothing is left in the undo buffer, so the GC deallocates the transaction right away like any read-only one
+  EXPECT_EQ(std::make_pair(0u, 1u), gc.PerformGarbageCollection());
+  EXPECT_EQ(std::make_pair(0u, 0u), gc.PerformGarbageCollection());
+
+  // A reused context still takes writes
+  auto *txn2 = txn_manager.BeginTransaction();
+  EXPECT_EQ(txn0, txn2);
+  table.Insert(txn2, *redo_);
+  txn_manager.Commit(txn2, transaction::TransactionUtil::EmptyCallback, nullptr);
+  EXPECT_EQ(std::make_pair(0u, 1u), gc.PerformGarbageCollection());
+  EXPECT_EQ(std::make_pair(1u, 0u), gc.PerformGarbageCollection());
+}
+}  // namespace terrier
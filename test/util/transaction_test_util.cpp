@@ -193,6 +193,7 @@ void LargeTransactionTestObject::SimulateOneTransaction(terrier::RandomWorkloadT
 template <class Random>
 void LargeTransactionTestObject::PopulateInitialTable(uint32_t num_tuples, Random *generator) {
   initial_txn_ = txn_manager_.BeginTransaction();
+  initial_txn_begin_ = initial_txn_->StartTime();
   byte *redo_buffer = nullptr;
   if (!bookkeeping_) {
     // If no bookkeeping is required we can reuse the same buffer over and over again.
@@ -247,7 +248,8 @@ VersionedSnapshots LargeTransactionTestObject::ReconstructVersionedTable(
 
   for (RandomWorkloadTransaction *txn : *txns) {
     auto ret = result.emplace(txn->commit_time_, TableSnapshot());
-    UpdateSnapshot(txn, &(ret.first->second), *prev);
+    // Transactions that committed in the same group share their commit timestamp, and thus their snapshot
+    UpdateSnapshot(txn, &(ret.first->second), ret.second ? *prev : TableSnapshot());
     prev = &(ret.first->second);
   }
   return result;
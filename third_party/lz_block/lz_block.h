@@ -0,0 +1,162 @@
+// lz_block: a single-header compressor and decompressor for the LZ4 block format.
+//
+// The format is described in https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md, and blocks produced here
+// can be decompressed by any LZ4 block decoder (and vice versa). Only the block format is implemented: there is no
+// frame format, dictionary or streaming support, and the compressor uses the simple single-probe hash table of the
+// LZ4 fast mode.
+//
+// Licensed under the Apache License, Version 2.0.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace lz_block {
+namespace detail {
+constexpr size_t MIN_MATCH = 4;
+// The last match must start at least this many bytes before the end of the block
+constexpr size_t MF_LIMIT = 12;
+// The last this many bytes of a block are always literals
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_LOG = 12;
+// Every this many consecutive misses, the compressor starts skipping ahead faster on incompressible data
+constexpr int SKIP_TRIGGER = 6;
+
+inline uint32_t Read32(const uint8_t *p) {
+  uint32_t result;
+  std::memcpy(&result, p, sizeof(result));
+  return result;
+}
+
+inline uint32_t Hash(const uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_LOG); }
+
+inline uint8_t *WriteLength(uint8_t *out, size_t length) {
+  for (; length >= 255; length -= 255) *out++ = 255;
+  *out++ = static_cast<uint8_t>(length);
+  return out;
+}
+
+// Writes a sequence of literals followed by a match, or only literals if match_length is 0
+inline uint8_t *WriteSequence(uint8_t *out, const uint8_t *literals, const size_t num_literals, const size_t offset,
+                              const size_t match_length) {
+  uint8_t *token = out++;
+  *token = static_cast<uint8_t>((num_literals >= 15 ? 15 : num_literals) << 4);
+  if (num_literals >= 15) out = WriteLength(out, num_literals - 15);
+  std::memcpy(out, literals, num_literals);
+  out += num_literals;
+  if (match_length == 0) return out;
+  *out++ = static_cast<uint8_t>(offset & 0xFF);
+  *out++ = static_cast<uint8_t>(offset >> 8);
+  const size_t length_code = match_length - MIN_MATCH;
+  *token = static_cast<uint8_t>(*token | (length_code >= 15 ? 15 : length_code));
+  if (length_code >= 15) out = WriteLength(out, length_code - 15);
+  return out;
+}
+}  // namespace detail
+
+/**
+ * @param size number of bytes to compress
+ * @return maximum size of the compressed block for an input of the given size
+ */
+inline size_t CompressBound(const size_t size) { return size + size / 255 + 16; }
+
+/**
+ * Compresses a block.
+ * @param src bytes to compress
+ * @param size number of bytes to compress
+ * @param dst output buffer of at least CompressBound(size) bytes
+ * @return size of the compressed block
+ */
+inline size_t Compress(const uint8_t *const src, const size_t size, uint8_t *const dst) {
+  using namespace detail;  // NOLINT
+  uint8_t *out = dst;
+  size_t anchor = 0;
+  if (size > MF_LIMIT) {
+    uint32_t table[1 << HASH_LOG] = {};
+    const size_t match_start_limit = size - MF_LIMIT, match_end_limit = size - LAST_LITERALS;
+    size_t pos = 1;
+    while (pos < match_start_limit) {
+      // Find a match, skipping ahead faster the longer none is found
+      size_t candidate = 0, misses = 0;
+      bool found = false;
+      while (pos < match_start_limit) {
+        const uint32_t sequence = Read32(src + pos);
+        const uint32_t hash = Hash(sequence);
+        candidate = table[hash];
+        table[hash] = static_cast<uint32_t>(pos);
+        if (candidate < pos && pos - candidate <= MAX_OFFSET && Read32(src + candidate) == sequence) {
+          found = true;
+          break;
+        }
+        pos += 1 + (misses++ >> SKIP_TRIGGER);
+      }
+      if (!found) break;
+      // Extend the match backwards over the pending literals, and then forwards
+      while (pos > anchor && candidate > 0 && src[pos - 1] == src[candidate - 1]) {
+        pos--;
+        candidate--;
+      }
+      size_t length = MIN_MATCH;
+      while (pos + length < match_end_limit && src[pos + length] == src[candidate + length]) length++;
+      out = WriteSequence(out, src + anchor, pos - anchor, pos - candidate, length);
+      pos += length;
+      anchor = pos;
+      // Make the positions inside the match findable
+      if (pos - 2 < match_start_limit) table[Hash(Read32(src + pos - 2))] = static_cast<uint32_t>(pos - 2);
+    }
+  }
+  out = WriteSequence(out, src + anchor, size - anchor, 0, 0);
+  return static_cast<size_t>(out - dst);
+}
+
+/**
+ * Decompresses a block, checking that it is well-formed without trusting any of its contents.
+ * @param src compressed block
+ * @param size size of the compressed block
+ * @param dst output buffer
+ * @param dst_size size the decompressed block must have
+ * @return whether the block was well-formed and decompressed to exactly dst_size bytes
+ */
+inline bool Decompress(const uint8_t *const src, const size_t size, uint8_t *const dst, const size_t dst_size) {
+  size_t in = 0, out = 0;
+  auto read_length = [&](size_t *length) {
+    uint8_t next;
+    do {
+      if (in >= size) return false;
+      next = src[in++];
+      *length += next;
+    } while (next == 255);
+    return true;
+  };
+  while (true) {
+    if (in >= size) return false;
+    const uint8_t token = src[in++];
+    size_t num_literals = token >> 4;
+    if (num_literals == 15 && !read_length(&num_literals)) return false;
+    if (num_literals > size - in || num_literals > dst_size - out) return false;
+    std::memcpy(dst + out, src + in, num_literals);
+    in += num_literals;
+    out += num_literals;
+    // The last sequence has no match
+    if (in == size) return out == dst_size;
+    if (size - in < 2) return false;
+    const size_t offset = src[in] | static_cast<size_t>(src[in + 1]) << 8;
+    in += 2;
+    if (offset == 0 || offset > out) return false;
+    size_t length = token & 15;
+    if (length == 15 && !read_length(&length)) return false;
+    length += detail::MIN_MATCH;
+    if (length > dst_size - out) return false;
+    if (offset >= length) {
+      std::memcpy(dst + out, dst + out - offset, length);
+      out += length;
+    } else {
+      // The match overlaps the bytes it produces
+      for (size_t i = 0; i < length; i++, out++) dst[out] = dst[out - offset];
+    }
+  }
+}
+}  // namespace lz_block